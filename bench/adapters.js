@@ -0,0 +1,179 @@
+"use strict";
+
+var collection = require("../lib/collection");
+
+/*
+ * Adapters give every implementation the same interface, so that a benchmark can be written once and run against
+ * collection.js types as well as the built-in alternatives. An adapter leaves out operations that the implementation
+ * does not support, and lists in `linear` the operations that take O(n) time, so that they can be skipped for large
+ * sizes.
+ */
+
+var ESMap = typeof Map === "function" ? Map : null,
+    ESSet = typeof Set === "function" ? Set : null;
+
+exports.Vector = {
+  linear: ["has", "remove"],
+  build: function(keys) { return new collection.Vector(keys); },
+  empty: function() { return new collection.Vector(); },
+  add: function(c, k) { c.add(k); },
+  has: function(c, k) { return c.has(k); },
+  get: function(c, k, i) { return c.get(i); },
+  remove: function(c, k) { c.remove(k); },
+  each: function(c, fn) { c.each(function(v) { fn(v); }); },
+  filter: function(c) { return c.filter(function() { return true; }); },
+  reduce: function(c) { return c.reduce(function(memo) { return memo + 1; }, 0); },
+  toArray: function(c) { return c.toArray(); },
+  toString: function(c) { return c.toString(); },
+  equals: function(c1, c2) { return c1.equals(c2); }
+};
+
+exports.Set = {
+  linear: ["get"],
+  build: function(keys) { return new collection.Set(keys); },
+  empty: function() { return new collection.Set(); },
+  add: function(c, k) { c.add(k); },
+  has: function(c, k) { return c.has(k); },
+  get: function(c, k, i) { return c.get(i); },
+  remove: function(c, k) { c.remove(k); },
+  each: function(c, fn) { c.each(fn); },
+  filter: function(c) { return c.filter(function() { return true; }); },
+  reduce: function(c) { return c.reduce(function(memo) { return memo + 1; }, 0); },
+  toArray: function(c) { return c.toArray(); },
+  toString: function(c) { return c.toString(); },
+  equals: function(c1, c2) { return c1.equals(c2); }
+};
+
+exports.SortedVector = {
+  linear: ["add", "remove"],
+  build: function(keys) { return new collection.SortedVector(keys); },
+  empty: function() { return new collection.SortedVector(); },
+  add: function(c, k) { c.add(k); },
+  has: function(c, k) { return c.has(k); },
+  get: function(c, k, i) { return c.get(i); },
+  remove: function(c, k) { c.remove(k); },
+  each: function(c, fn) { c.each(fn); },
+  filter: function(c) { return c.filter(function() { return true; }); },
+  reduce: function(c) { return c.reduce(function(memo) { return memo + 1; }, 0); },
+  toArray: function(c) { return c.toArray(); },
+  toString: function(c) { return c.toString(); },
+  equals: function(c1, c2) { return c1.equals(c2); }
+};
+
+exports.Map = {
+  linear: [],
+  build: function(keys) {
+    var m = new collection.Map();
+    for (var i = 0; i < keys.length; i++) {
+      m.set(keys[i], i);
+    }
+    return m;
+  },
+  empty: function() { return new collection.Map(); },
+  add: function(c, k, i) { c.set(k, i); },
+  has: function(c, k) { return c.has(k); },
+  get: function(c, k) { return c.get(k); },
+  remove: function(c, k) { c.remove(k); },
+  each: function(c, fn) { c.each(fn); },
+  filter: function(c) { return c.filter(function() { return true; }); },
+  reduce: function(c) { return c.reduce(function(memo) { return memo + 1; }, 0); },
+  toArray: function(c) { return c.toArray(); },
+  toString: function(c) { return c.toString(); },
+  equals: function(c1, c2) { return c1.equals(c2); }
+};
+
+exports.Array = {
+  linear: ["has", "remove", "equals"],
+  build: function(keys) { return keys.slice(); },
+  empty: function() { return []; },
+  add: function(c, k) { c.push(k); },
+  has: function(c, k) { return c.indexOf(k) !== -1; },
+  get: function(c, k, i) { return c[i]; },
+  remove: function(c, k) {
+    var index = c.indexOf(k);
+    if (index !== -1) {
+      c.splice(index, 1);
+    }
+  },
+  each: function(c, fn) { c.forEach(fn); },
+  filter: function(c) { return c.filter(function() { return true; }); },
+  reduce: function(c) { return c.reduce(function(memo) { return memo + 1; }, 0); },
+  toArray: function(c) { return c.slice(); },
+  toString: function(c) { return JSON.stringify(c); },
+  equals: function(c1, c2) {
+    if (c1.length !== c2.length) {
+      return false;
+    }
+    for (var i = 0; i < c1.length; i++) {
+      if (c1[i] !== c2[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+exports.Object = {
+  keyTypes: ["number", "string"],
+  linear: ["toArray"],
+  build: function(keys) {
+    var o = {};
+    for (var i = 0; i < keys.length; i++) {
+      o[keys[i]] = i;
+    }
+    return o;
+  },
+  empty: function() { return {}; },
+  add: function(c, k, i) { c[k] = i; },
+  has: function(c, k) { return c.hasOwnProperty(k); },
+  get: function(c, k) { return c[k]; },
+  remove: function(c, k) { delete c[k]; },
+  each: function(c, fn) {
+    for (var k in c) {
+      fn(c[k]);
+    }
+  },
+  toArray: function(c) { return Object.keys(c); },
+  toString: function(c) { return JSON.stringify(c); }
+};
+
+if (ESMap && typeof ESMap.prototype.set === "function") {
+  exports.ESMap = {
+    linear: [],
+    build: function(keys) {
+      var m = new ESMap();
+      for (var i = 0; i < keys.length; i++) {
+        m.set(keys[i], i);
+      }
+      return m;
+    },
+    empty: function() { return new ESMap(); },
+    add: function(c, k, i) { c.set(k, i); },
+    has: function(c, k) { return c.has(k); },
+    get: function(c, k) { return c.get(k); },
+    remove: function(c, k) { c["delete"](k); }
+  };
+  if (typeof ESMap.prototype.forEach === "function") {
+    exports.ESMap.each = function(c, fn) { c.forEach(fn); };
+  }
+}
+
+if (ESSet && typeof ESSet.prototype.add === "function") {
+  exports.ESSet = {
+    linear: [],
+    build: function(keys) {
+      var s = new ESSet();
+      for (var i = 0; i < keys.length; i++) {
+        s.add(keys[i]);
+      }
+      return s;
+    },
+    empty: function() { return new ESSet(); },
+    add: function(c, k) { c.add(k); },
+    has: function(c, k) { return c.has(k); },
+    remove: function(c, k) { c["delete"](k); }
+  };
+  if (typeof ESSet.prototype.forEach === "function") {
+    exports.ESSet.each = function(c, fn) { c.forEach(fn); };
+  }
+}
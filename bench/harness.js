@@ -0,0 +1,156 @@
+"use strict";
+
+var collection = require("../lib/collection");
+
+/*
+ * Key generators. Every generator returns an array of n distinct keys of the given type, in ascending order.
+ */
+var generators = {
+  number: function(n) {
+    var keys = new Array(n);
+    for (var i = 0; i < n; i++) {
+      keys[i] = i;
+    }
+    return keys;
+  },
+
+  string: function(n) {
+    var keys = new Array(n);
+    for (var i = 0; i < n; i++) {
+      keys[i] = "key" + (1e9 + i);
+    }
+    return keys;
+  },
+
+  date: function(n) {
+    var keys = new Array(n);
+    for (var i = 0; i < n; i++) {
+      keys[i] = new Date(1e12 + i);
+    }
+    return keys;
+  },
+
+  array: function(n) {
+    var keys = new Array(n);
+    for (var i = 0; i < n; i++) {
+      keys[i] = [i >> 8, i & 0xff];
+    }
+    return keys;
+  },
+
+  collection: function(n) {
+    var keys = new Array(n);
+    for (var i = 0; i < n; i++) {
+      keys[i] = new collection.Vector([i]);
+    }
+    return keys;
+  }
+};
+
+exports.keyTypes = Object.keys(generators);
+
+exports.keys = function(type, n) {
+  if (!generators[type]) {
+    throw new Error("Unknown key type: " + type);
+  }
+  return generators[type](n);
+};
+
+/*
+ * Deterministic shuffle, so that lookups do not simply walk the keys in insertion order.
+ */
+exports.shuffle = function(array) {
+  var result = array.slice(), seed = 12345;
+  for (var i = result.length - 1; i > 0; i--) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    var j = seed % (i + 1), tmp = result[i];
+    result[i] = result[j];
+    result[j] = tmp;
+  }
+  return result;
+};
+
+function now() {
+  var t = process.hrtime();
+  return t[0] * 1e9 + t[1];
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) {
+    return 0;
+  }
+  var index = Math.min(sorted.length - 1, Math.floor(sorted.length * p));
+  return sorted[index];
+}
+
+exports.percentile = percentile;
+
+exports.gc = function() {
+  if (typeof global.gc === "function") {
+    global.gc();
+    global.gc();
+  }
+};
+
+/*
+ * Time a benchmark case. A case provides fn(state, i), which performs `count` operations, and optionally
+ * before(), which prepares a fresh state outside of the timed region for every call of fn.
+ *
+ * Calls of fn are grouped into timed samples of at least `minSample` nanoseconds. Latency percentiles are computed
+ * over the per-operation average of each sample.
+ */
+exports.time = function(c, options) {
+  var count = c.count || 1;
+  var budget = (options.time || 200) * 1e6;
+  var minSample = options.minSample || 5e4;
+  var samples = [];
+  var totalTime = 0, totalOps = 0, batch = 1, i = 0;
+  var state = c.before && !c.fresh ? c.before() : undefined;
+
+  while (totalTime < budget || samples.length < 5) {
+    var elapsed = 0;
+    for (var b = 0; b < batch; b++) {
+      if (c.fresh) {
+        state = c.before();
+      }
+      var start = now();
+      c.fn(state, i++);
+      elapsed += now() - start;
+    }
+    if (elapsed < minSample && !c.fresh) {
+      batch *= 2;
+      continue;
+    }
+    samples.push(elapsed / (batch * count));
+    totalTime += elapsed;
+    totalOps += batch * count;
+    if (c.fresh && elapsed > budget) {
+      break;
+    }
+  }
+
+  samples.sort(function(a, b) { return a - b; });
+  return {
+    opsPerSec: totalOps / (totalTime / 1e9),
+    p50: percentile(samples, 0.5),
+    p99: percentile(samples, 0.99),
+    samples: samples.length
+  };
+};
+
+/*
+ * Measure memory held by the value returned from build(), per element.
+ */
+exports.memory = function(build, size) {
+  exports.gc();
+  var before = process.memoryUsage();
+  var value = build();
+  exports.gc();
+  var after = process.memoryUsage();
+  var result = {
+    heapPerElement: (after.heapUsed - before.heapUsed) / size,
+    rssPerElement: (after.rss - before.rss) / size
+  };
+  value = null;
+  return result;
+};
@@ -0,0 +1,190 @@
+"use strict";
+
+/*
+ * Benchmark runner.
+ *
+ *   node bench/run.js [options]
+ *
+ *   --suites a,b,...    suites under bench/suites to run (default: all)
+ *   --ops a,b,...       operations to run (default: all)
+ *   --impls a,b,...     implementations to run, e.g. Set,ESSet (default: all)
+ *   --sizes a,b,...     collection sizes (default: 10,1000,100000; up to 10000000 is supported)
+ *   --types a,b,...     key types: number,string,date,array,collection (default: all)
+ *   --time ms           time budget per case (default: 200)
+ *   --linear-limit n    largest size for operations that are O(n) per call (default: 100000)
+ *   --out file          where to write JSON results (default: bench/results/<timestamp>.json)
+ *   --baseline file     baseline to compare against (default: bench/baseline.json, if it exists)
+ *   --save-baseline     also write the results to the baseline file
+ *   --threshold pct     slowdown reported as a regression (default: 10)
+ */
+
+var fs = require("fs"),
+    path = require("path"),
+    spawn = require("child_process").spawn,
+    harness = require("./harness");
+
+// Memory figures need an explicit garbage collection, so make sure the runner has access to gc().
+if (typeof global.gc !== "function") {
+  var child = spawn(process.execPath, ["--expose-gc"].concat(process.execArgv, process.argv.slice(1)), {
+    stdio: "inherit"
+  });
+  child.on("exit", function(code) {
+    process.exit(code);
+  });
+  return;
+}
+
+var STANDARD_FIELDS = ["suite", "op", "impl", "keyType", "size", "opsPerSec", "p50", "p99", "samples"];
+
+function parseArguments(argv) {
+  var options = {
+    suites: null,
+    ops: null,
+    impls: null,
+    sizes: [10, 1000, 100000],
+    keyTypes: harness.keyTypes,
+    time: 200,
+    linearLimit: 100000,
+    out: path.join(__dirname, "results", new Date().toISOString().replace(/[:.]/g, "-") + ".json"),
+    baseline: path.join(__dirname, "baseline.json"),
+    saveBaseline: false,
+    threshold: 10
+  };
+  var list = function(value) {
+    return value.split(",").filter(function(s) { return s.length > 0; });
+  };
+  for (var i = 0; i < argv.length; i++) {
+    var arg = argv[i], value = argv[i + 1];
+    switch (arg) {
+      case "--suites": options.suites = list(value); i++; break;
+      case "--ops": options.ops = list(value); i++; break;
+      case "--impls": options.impls = list(value); i++; break;
+      case "--sizes": options.sizes = list(value).map(Number); i++; break;
+      case "--types": options.keyTypes = list(value); i++; break;
+      case "--time": options.time = Number(value); i++; break;
+      case "--linear-limit": options.linearLimit = Number(value); i++; break;
+      case "--out": options.out = value; i++; break;
+      case "--baseline": options.baseline = value; i++; break;
+      case "--save-baseline": options.saveBaseline = true; break;
+      case "--threshold": options.threshold = Number(value); i++; break;
+      default: throw new Error("Unknown option: " + arg);
+    }
+  }
+  options.matches = function(op) {
+    return options.ops === null || options.ops.indexOf(op) !== -1;
+  };
+  return options;
+}
+
+function key(result) {
+  return [result.suite, result.op, result.impl, result.keyType, result.size].join("/");
+}
+
+function format(n, digits) {
+  if (n === undefined || n === null || isNaN(n)) {
+    return "-";
+  }
+  return n.toFixed(digits);
+}
+
+function pad(s, width) {
+  s = String(s);
+  while (s.length < width) {
+    s = s + " ";
+  }
+  return s;
+}
+
+function loadSuites(options) {
+  var dir = path.join(__dirname, "suites");
+  return fs.readdirSync(dir).filter(function(file) {
+    return /\.js$/.test(file) && (options.suites === null || options.suites.indexOf(file.replace(/\.js$/, "")) !== -1);
+  }).sort().map(function(file) {
+    return require(path.join(dir, file));
+  });
+}
+
+function run(options) {
+  var results = [];
+  loadSuites(options).forEach(function(suite) {
+    suite.cases(options).forEach(function(c) {
+      if (options.impls !== null && options.impls.indexOf(c.impl) === -1) {
+        return;
+      }
+      var spec = c.create();
+      var result = {suite: c.suite, op: c.op, impl: c.impl, keyType: c.keyType, size: c.size};
+      var metrics = spec.measure ? spec.measure(options) : harness.time(spec, options);
+      Object.keys(metrics).forEach(function(name) {
+        result[name] = metrics[name];
+      });
+      if (spec.memory) {
+        var memory = harness.memory(spec.memory, c.size);
+        result.heapPerElement = memory.heapPerElement;
+        result.rssPerElement = memory.rssPerElement;
+      }
+      spec = null;
+      harness.gc();
+
+      results.push(result);
+      var line = pad(key(result), 48);
+      if (result.opsPerSec !== undefined) {
+        line += pad(format(result.opsPerSec, 0) + " ops/s", 20) +
+                pad("p50 " + format(result.p50, 1) + "ns", 18) +
+                pad("p99 " + format(result.p99, 1) + "ns", 18);
+      }
+      Object.keys(result).forEach(function(name) {
+        if (STANDARD_FIELDS.indexOf(name) === -1 && typeof result[name] === "number") {
+          line += name + " " + format(result[name], 1) + " ";
+        }
+      });
+      console.log(line);
+    });
+  });
+  return results;
+}
+
+function compare(results, baseline, threshold) {
+  var previous = {};
+  baseline.results.forEach(function(result) {
+    previous[key(result)] = result;
+  });
+  var regressions = 0;
+  console.log("\nCompared with baseline from " + baseline.date + ":");
+  results.forEach(function(result) {
+    var old = previous[key(result)];
+    if (!old || !old.opsPerSec || !result.opsPerSec) {
+      return;
+    }
+    var change = (result.opsPerSec / old.opsPerSec - 1) * 100;
+    var regressed = change < -threshold;
+    if (regressed) {
+      regressions++;
+    }
+    console.log(pad(key(result), 48) + (change >= 0 ? "+" : "") + format(change, 1) + "%" +
+                (regressed ? "  REGRESSION" : ""));
+  });
+  console.log(regressions + " regression(s) beyond " + threshold + "%.");
+}
+
+var options = parseArguments(process.argv.slice(2));
+var output = {
+  date: new Date().toISOString(),
+  node: process.version,
+  platform: process.platform + "-" + process.arch,
+  options: {sizes: options.sizes, keyTypes: options.keyTypes, time: options.time},
+  results: run(options)
+};
+
+if (!fs.existsSync(path.dirname(options.out))) {
+  fs.mkdirSync(path.dirname(options.out));
+}
+fs.writeFileSync(options.out, JSON.stringify(output, null, 2));
+console.log("\nResults written to " + options.out);
+
+if (fs.existsSync(options.baseline) && !options.saveBaseline) {
+  compare(output.results, JSON.parse(fs.readFileSync(options.baseline, "utf8")), options.threshold);
+}
+if (options.saveBaseline) {
+  fs.writeFileSync(options.baseline, JSON.stringify(output, null, 2));
+  console.log("Baseline written to " + options.baseline);
+}
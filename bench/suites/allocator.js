@@ -0,0 +1,109 @@
+"use strict";
+
+var adapters = require("../adapters"),
+    harness = require("../harness");
+
+/*
+ * Insert/erase throughput and resident memory of tree-based collections, whose nodes come from a per-collection
+ * pool. Run with --save-baseline before changing the allocator to compare against.
+ */
+
+var keyTypes = ["number", "string"];
+
+var operations = {
+  insert: function(a, keys) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return a.empty(); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          a.add(c, keys[i], i);
+        }
+      }
+    };
+  },
+
+  erase: function(a, keys, probes) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return a.build(keys); },
+      fn: function(c) {
+        for (var i = 0; i < probes.length; i++) {
+          a.remove(c, probes[i]);
+        }
+      }
+    };
+  },
+
+  churn: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return a.empty(); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          a.add(c, keys[i], i);
+        }
+        c.clear();
+      }
+    };
+  },
+
+  rss: function(a, keys) {
+    return {
+      measure: function() {
+        harness.gc();
+        var before = process.memoryUsage().rss;
+        var c = a.build(keys);
+        harness.gc();
+        var filled = process.memoryUsage().rss;
+        c.clear();
+        harness.gc();
+        var cleared = process.memoryUsage().rss;
+        return {
+          rssPerElement: (filled - before) / keys.length,
+          rssRetainedPerElement: (cleared - before) / keys.length
+        };
+      }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    keyTypes.forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      var keys = null, probes = null;
+      var prepare = function() {
+        if (keys === null) {
+          keys = harness.keys(keyType, size);
+          probes = harness.shuffle(keys);
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        ["Set", "Map"].forEach(function(impl) {
+          cases.push({
+            suite: "allocator",
+            op: op,
+            impl: impl,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](adapters[impl], keys, probes);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
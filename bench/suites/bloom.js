@@ -0,0 +1,123 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * Pre-check workloads. Bloom filters are compared with the exact sets they stand in for. Lookups are of values that
+ * were not added, which is the case a pre-check exists for, and the false positive rate measured over them is
+ * reported along with throughput.
+ */
+
+var keyTypes = ["number", "string", "array"];
+
+var RATE = 0.01;
+
+var impls = {
+  BloomFilter: {
+    create: function(size) { return new collection.BloomFilter(size, RATE); },
+    add: function(c, k) { c.add(k); },
+    check: function(c, k) { return c.mightHave(k); }
+  },
+
+  CountingBloomFilter: {
+    create: function(size) { return new collection.CountingBloomFilter(size, RATE); },
+    add: function(c, k) { c.add(k); },
+    check: function(c, k) { return c.mightHave(k); }
+  },
+
+  Set: {
+    create: function() { return new collection.Set(); },
+    add: function(c, k) { c.add(k); },
+    check: function(c, k) { return c.has(k); }
+  }
+};
+
+if (typeof Set === "function" && typeof Set.prototype.add === "function") {
+  impls.ESSet = {
+    create: function() { return new Set(); },
+    add: function(c, k) { c.add(k); },
+    check: function(c, k) { return c.has(k); }
+  };
+}
+
+function build(impl, keys) {
+  var c = impl.create(keys.length);
+  for (var i = 0; i < keys.length; i++) {
+    impl.add(c, keys[i]);
+  }
+  return c;
+}
+
+var operations = {
+  add: function(impl, keys) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return impl.create(keys.length); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          impl.add(c, keys[i]);
+        }
+      },
+      memory: function() { return build(impl, keys); }
+    };
+  },
+
+  check: function(impl, keys, absent) {
+    var spec = {
+      before: function() { return build(impl, keys); },
+      fn: function(c, i) { impl.check(c, absent[i % absent.length]); }
+    };
+    spec.measure = function(options) {
+      var metrics = harness.time(spec, options);
+      var c = build(impl, keys), positives = 0;
+      for (var i = 0; i < absent.length; i++) {
+        positives += impl.check(c, absent[i]) ? 1 : 0;
+      }
+      metrics.falsePositiveRate = positives / absent.length;
+      return metrics;
+    };
+    return spec;
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    keyTypes.forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      var keys = null, absent = null;
+      var prepare = function() {
+        if (keys === null) {
+          // Generated keys are distinct, so the second half was never added.
+          var all = harness.keys(keyType, size + Math.max(size, 10000));
+          keys = all.slice(0, size);
+          absent = harness.shuffle(all.slice(size));
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        Object.keys(impls).forEach(function(name) {
+          cases.push({
+            suite: "bloom",
+            op: op,
+            impl: name,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](impls[name], keys, absent);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
@@ -0,0 +1,157 @@
+"use strict";
+
+var adapters = require("../adapters"),
+    harness = require("../harness");
+
+/*
+ * Every collection operation, on every implementation, for every size and key type.
+ */
+
+function noop() {
+}
+
+var operations = {
+  construction: function(a, keys) {
+    return {
+      count: keys.length,
+      fn: function() { a.build(keys); },
+      memory: function() { return a.build(keys); }
+    };
+  },
+
+  add: function(a, keys) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return a.empty(); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          a.add(c, keys[i], i);
+        }
+      }
+    };
+  },
+
+  has: function(a, keys, probes) {
+    return {
+      before: function() { return a.build(keys); },
+      fn: function(c, i) { a.has(c, probes[i % probes.length]); }
+    };
+  },
+
+  get: function(a, keys, probes, indexes) {
+    return {
+      before: function() { return a.build(keys); },
+      fn: function(c, i) {
+        var j = i % probes.length;
+        a.get(c, probes[j], indexes[j]);
+      }
+    };
+  },
+
+  remove: function(a, keys, probes) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return a.build(keys); },
+      fn: function(c) {
+        for (var i = 0; i < probes.length; i++) {
+          a.remove(c, probes[i]);
+        }
+      }
+    };
+  },
+
+  each: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return a.build(keys); },
+      fn: function(c) { a.each(c, noop); }
+    };
+  },
+
+  filter: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return a.build(keys); },
+      fn: function(c) { a.filter(c); }
+    };
+  },
+
+  reduce: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return a.build(keys); },
+      fn: function(c) { a.reduce(c); }
+    };
+  },
+
+  toArray: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return a.build(keys); },
+      fn: function(c) { a.toArray(c); }
+    };
+  },
+
+  toString: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return a.build(keys); },
+      fn: function(c) { a.toString(c); }
+    };
+  },
+
+  equals: function(a, keys) {
+    return {
+      count: keys.length,
+      before: function() { return [a.build(keys), a.build(keys)]; },
+      fn: function(pair) { a.equals(pair[0], pair[1]); }
+    };
+  }
+};
+
+exports.operations = Object.keys(operations);
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    options.keyTypes.forEach(function(keyType) {
+      var keys = null, probes = null, indexes = null;
+      var prepare = function() {
+        if (keys === null) {
+          keys = harness.keys(keyType, size);
+          indexes = harness.shuffle(keys.map(function(k, i) { return i; }));
+          probes = indexes.map(function(i) { return keys[i]; });
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        Object.keys(adapters).forEach(function(impl) {
+          var a = adapters[impl];
+          var adapterOp = op === "construction" ? "build" : op;
+          if (!a.hasOwnProperty(adapterOp) ||
+              (a.keyTypes && a.keyTypes.indexOf(keyType) === -1) ||
+              (a.linear.indexOf(op) !== -1 && size > options.linearLimit)) {
+            return;
+          }
+          cases.push({
+            suite: "collections",
+            op: op,
+            impl: impl,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](a, keys, probes, indexes);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
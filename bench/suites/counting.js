@@ -0,0 +1,120 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * Frequency counting workloads. MultiSet is compared with the patterns it replaces: counts kept in a Map, read and
+ * written back on every event, and counts kept in a plain object.
+ */
+
+var keyTypes = ["number", "string"];
+
+// Events draw from this many times fewer distinct values, skewed so that a few values are much more common.
+var REPEAT = 16;
+
+var TOP = 10;
+
+var impls = {
+  MultiSet: {
+    create: function() { return new collection.MultiSet(); },
+    count: function(c, k) { c.add(k); },
+    top: function(c, n) { return c.mostCommon(n); }
+  },
+
+  Map: {
+    create: function() { return new collection.Map(); },
+    count: function(c, k) { c.set(k, (c.get(k) || 0) + 1); },
+    top: function(c, n) {
+      var entries = c.toArray().map(function(entry) { return [entry.key(), entry.value()]; });
+      return entries.sort(function(a, b) { return b[1] - a[1]; }).slice(0, n);
+    }
+  },
+
+  Object: {
+    create: function() { return {}; },
+    count: function(c, k) { c[k] = (c[k] || 0) + 1; },
+    top: function(c, n) {
+      var entries = Object.keys(c).map(function(k) { return [k, c[k]]; });
+      return entries.sort(function(a, b) { return b[1] - a[1]; }).slice(0, n);
+    }
+  }
+};
+
+function events(keys, n) {
+  var result = new Array(n);
+  for (var i = 0; i < n; i++) {
+    var r = Math.random();
+    result[i] = keys[Math.floor(r * r * r * keys.length)];
+  }
+  return result;
+}
+
+var operations = {
+  count: function(impl, values) {
+    return {
+      count: values.length,
+      fresh: true,
+      before: function() { return impl.create(); },
+      fn: function(c) {
+        for (var i = 0; i < values.length; i++) {
+          impl.count(c, values[i]);
+        }
+      }
+    };
+  },
+
+  // The most common values of a populated table. Reported per call.
+  top: function(impl, values) {
+    return {
+      count: 1,
+      before: function() {
+        var c = impl.create();
+        for (var i = 0; i < values.length; i++) {
+          impl.count(c, values[i]);
+        }
+        return c;
+      },
+      fn: function(c) {
+        impl.top(c, TOP);
+      }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    keyTypes.forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      var values = null;
+      var prepare = function() {
+        if (values === null) {
+          values = events(harness.keys(keyType, Math.max(1, Math.floor(size / REPEAT))), size);
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        Object.keys(impls).forEach(function(name) {
+          cases.push({
+            suite: "counting",
+            op: op,
+            impl: name,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](impls[name], values);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
@@ -0,0 +1,124 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * Queue workloads. Deque is compared with a Vector and an array used as FIFO queues, which shift all their elements
+ * on every dequeue.
+ */
+
+var impls = {
+  Deque: {
+    create: function() { return new collection.Deque(); },
+    enqueue: function(q, v) { q.pushBack(v); },
+    dequeue: function(q) { return q.popFront(); }
+  },
+
+  Vector: {
+    linear: true,
+    create: function() { return new collection.Vector(); },
+    enqueue: function(q, v) { q.add(v); },
+    dequeue: function(q) {
+      var value = q.get(0);
+      q.removeAt(0);
+      return value;
+    }
+  },
+
+  Array: {
+    create: function() { return []; },
+    enqueue: function(q, v) { q.push(v); },
+    dequeue: function(q) { return q.shift(); }
+  }
+};
+
+var operations = {
+  enqueue: function(impl, values) {
+    return {
+      count: values.length,
+      fresh: true,
+      before: function() { return impl.create(); },
+      fn: function(q) {
+        for (var i = 0; i < values.length; i++) {
+          impl.enqueue(q, values[i]);
+        }
+      }
+    };
+  },
+
+  dequeue: function(impl, values) {
+    return {
+      count: values.length,
+      fresh: true,
+      before: function() {
+        var q = impl.create();
+        for (var i = 0; i < values.length; i++) {
+          impl.enqueue(q, values[i]);
+        }
+        return q;
+      },
+      fn: function(q) {
+        for (var i = 0; i < values.length; i++) {
+          impl.dequeue(q);
+        }
+      }
+    };
+  },
+
+  // Job queue at a steady size: every job taken from the front is followed by one added to the back.
+  cycle: function(impl, values) {
+    return {
+      count: values.length,
+      before: function() {
+        var q = impl.create();
+        for (var i = 0; i < values.length; i++) {
+          impl.enqueue(q, values[i]);
+        }
+        return q;
+      },
+      fn: function(q) {
+        for (var i = 0; i < values.length; i++) {
+          impl.enqueue(q, impl.dequeue(q));
+        }
+      }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    options.keyTypes.forEach(function(keyType) {
+      var values = null;
+      var prepare = function() {
+        if (values === null) {
+          values = harness.keys(keyType, size);
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        Object.keys(impls).forEach(function(name) {
+          if (impls[name].linear && size > options.linearLimit) {
+            return;
+          }
+          cases.push({
+            suite: "deque",
+            op: op,
+            impl: name,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](impls[name], values);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
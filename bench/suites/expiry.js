@@ -0,0 +1,175 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * TTL workloads. ExpiringMap is compared with the pattern it replaces: a Map, or an ES Map where the runtime provides
+ * one, holding each value with its expiry time, and swept by a timer that visits every entry.
+ */
+
+var keyTypes = ["number", "string"];
+
+var TTL = 60000;
+
+function sleep(ms) {
+  var end = Date.now() + ms;
+  while (Date.now() <= end) {
+  }
+}
+
+var impls = {
+  ExpiringMap: {
+    create: function(ttl) { return new collection.ExpiringMap(ttl); },
+    get: function(c, k) { return c.get(k); },
+    set: function(c, k, v) { c.set(k, v); },
+    sweep: function(c) { c.expire(); }
+  },
+
+  // Map swept with each(), as done before ExpiringMap existed.
+  MapSweep: {
+    create: function(ttl) { return {map: new collection.Map(), ttl: ttl}; },
+    get: function(c, k) {
+      var entry = c.map.get(k);
+      return entry !== undefined && entry[1] > Date.now() ? entry[0] : undefined;
+    },
+    set: function(c, k, v) { c.map.set(k, [v, Date.now() + c.ttl]); },
+    sweep: function(c) {
+      var now = Date.now(), expired = [];
+      c.map.each(function(entry) {
+        if (entry.value()[1] <= now) {
+          expired.push(entry.key());
+        }
+      });
+      if (expired.length > 0) {
+        c.map.remove.apply(c.map, expired);
+      }
+    }
+  }
+};
+
+if (typeof Map === "function" && typeof Map.prototype.forEach === "function") {
+  impls.ESMapSweep = {
+    create: function(ttl) { return {map: new Map(), ttl: ttl}; },
+    get: function(c, k) {
+      var entry = c.map.get(k);
+      return entry !== undefined && entry.expiry > Date.now() ? entry.value : undefined;
+    },
+    set: function(c, k, v) { c.map.set(k, {value: v, expiry: Date.now() + c.ttl}); },
+    sweep: function(c) {
+      var now = Date.now(), map = c.map;
+      map.forEach(function(entry, k) {
+        if (entry.expiry <= now) {
+          map["delete"](k);
+        }
+      });
+    }
+  };
+}
+
+var operations = {
+  set: function(impl, keys) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return impl.create(TTL); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          impl.set(c, keys[i], i);
+        }
+      }
+    };
+  },
+
+  get: function(impl, keys, probes) {
+    return {
+      count: probes.length,
+      before: function() {
+        var c = impl.create(TTL);
+        for (var i = 0; i < keys.length; i++) {
+          impl.set(c, keys[i], i);
+        }
+        return c;
+      },
+      fn: function(c) {
+        for (var i = 0; i < probes.length; i++) {
+          impl.get(c, probes[i]);
+        }
+      }
+    };
+  },
+
+  // A periodic sweep that finds nothing to remove, which is what most sweeps of a long-lived table do.
+  idle: function(impl, keys) {
+    return {
+      count: 1,
+      before: function() {
+        var c = impl.create(TTL);
+        for (var i = 0; i < keys.length; i++) {
+          impl.set(c, keys[i], i);
+        }
+        return c;
+      },
+      fn: function(c) {
+        impl.sweep(c);
+      }
+    };
+  },
+
+  // Remove every entry once all of them have expired. Reported per entry.
+  expire: function(impl, keys) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() {
+        var c = impl.create(1);
+        for (var i = 0; i < keys.length; i++) {
+          impl.set(c, keys[i], i);
+        }
+        sleep(2);
+        return c;
+      },
+      fn: function(c) {
+        impl.sweep(c);
+      }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    keyTypes.forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      var keys = null, probes = null;
+      var prepare = function() {
+        if (keys === null) {
+          keys = harness.keys(keyType, size);
+          probes = harness.shuffle(keys.slice());
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        Object.keys(impls).forEach(function(name) {
+          cases.push({
+            suite: "expiry",
+            op: op,
+            impl: name,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](impls[name], keys, probes);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
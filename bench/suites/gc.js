@@ -0,0 +1,63 @@
+"use strict";
+
+var adapters = require("../adapters"),
+    harness = require("../harness");
+
+/*
+ * Full garbage collection pause while a large collection is alive. Primitive elements are stored natively and add
+ * nothing for the collector to trace. Object elements of a collection share one backing array, so the number of
+ * roots the collector visits does not grow with the collection either.
+ */
+
+var keyTypes = ["number", "string", "date", "array"];
+var impls = ["Vector", "Set", "Map", "Array"];
+var ROUNDS = 5;
+
+function now() {
+  var t = process.hrtime();
+  return t[0] * 1e9 + t[1];
+}
+
+exports.cases = function(options) {
+  var cases = [];
+  if (!options.matches("pause")) {
+    return cases;
+  }
+  options.sizes.forEach(function(size) {
+    keyTypes.forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      impls.forEach(function(impl) {
+        cases.push({
+          suite: "gc",
+          op: "pause",
+          impl: impl,
+          keyType: keyType,
+          size: size,
+          create: function() {
+            return {
+              measure: function() {
+                var c = adapters[impl].build(harness.keys(keyType, size));
+                harness.gc();
+                var pauses = [];
+                for (var i = 0; i < ROUNDS; i++) {
+                  var start = now();
+                  harness.gc();
+                  pauses.push((now() - start) / 1e6);
+                }
+                pauses.sort(function(a, b) { return a - b; });
+                c = null;
+                return {
+                  pauseMs: harness.percentile(pauses, 50),
+                  maxPauseMs: pauses[pauses.length - 1]
+                };
+              }
+            };
+          }
+        });
+      });
+    });
+  });
+  return cases;
+};
@@ -0,0 +1,158 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * Priority queue workloads. PriorityQueue is compared with the Set of [priority, id] arrays it replaces, and with a
+ * binary heap of {priority, value} objects written in JavaScript.
+ */
+
+var impls = {
+  PriorityQueue: {
+    create: function() { return new collection.PriorityQueue({priority: true}); },
+    push: function(q, p, v) { q.push(v, p); },
+    pop: function(q) { return q.pop(); }
+  },
+
+  // Set of [priority, id] arrays, popped with get(0) and removeAt(0).
+  SetOfArrays: {
+    linear: true,
+    create: function() { return new collection.Set(); },
+    push: function(q, p, v) { q.add([p, v]); },
+    pop: function(q) {
+      var top = q.get(0);
+      q.removeAt(0);
+      return top[1];
+    }
+  },
+
+  JSHeap: {
+    create: function() { return []; },
+    push: function(q, p, v) {
+      var i = q.length;
+      q.push(null);
+      while (i > 0) {
+        var parent = (i - 1) >> 1;
+        if (q[parent].priority <= p) {
+          break;
+        }
+        q[i] = q[parent];
+        i = parent;
+      }
+      q[i] = {priority: p, value: v};
+    },
+    pop: function(q) {
+      var top = q[0], last = q.pop(), n = q.length, i = 0;
+      if (n > 0) {
+        while (true) {
+          var child = 2 * i + 1;
+          if (child >= n) {
+            break;
+          }
+          if (child + 1 < n && q[child + 1].priority < q[child].priority) {
+            child++;
+          }
+          if (q[child].priority >= last.priority) {
+            break;
+          }
+          q[i] = q[child];
+          i = child;
+        }
+        q[i] = last;
+      }
+      return top.value;
+    }
+  }
+};
+
+var operations = {
+  push: function(impl, priorities) {
+    return {
+      count: priorities.length,
+      fresh: true,
+      before: function() { return impl.create(); },
+      fn: function(q) {
+        for (var i = 0; i < priorities.length; i++) {
+          impl.push(q, priorities[i], i);
+        }
+      }
+    };
+  },
+
+  pop: function(impl, priorities) {
+    return {
+      count: priorities.length,
+      fresh: true,
+      before: function() {
+        var q = impl.create();
+        for (var i = 0; i < priorities.length; i++) {
+          impl.push(q, priorities[i], i);
+        }
+        return q;
+      },
+      fn: function(q) {
+        for (var i = 0; i < priorities.length; i++) {
+          impl.pop(q);
+        }
+      }
+    };
+  },
+
+  // Scheduler loop: pop the next task and push it back with a later priority.
+  reschedule: function(impl, priorities) {
+    return {
+      count: priorities.length,
+      before: function() {
+        var q = impl.create();
+        for (var i = 0; i < priorities.length; i++) {
+          impl.push(q, priorities[i], i);
+        }
+        return q;
+      },
+      fn: function(q) {
+        for (var i = 0; i < priorities.length; i++) {
+          impl.push(q, priorities[i] + priorities.length, impl.pop(q));
+        }
+      }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    if (options.keyTypes.indexOf("number") === -1) {
+      return;
+    }
+    var priorities = null;
+    var prepare = function() {
+      if (priorities === null) {
+        priorities = harness.shuffle(harness.keys("number", size));
+      }
+    };
+
+    Object.keys(operations).forEach(function(op) {
+      if (!options.matches(op)) {
+        return;
+      }
+      Object.keys(impls).forEach(function(name) {
+        if (impls[name].linear && size > options.linearLimit) {
+          return;
+        }
+        cases.push({
+          suite: "heap",
+          op: op,
+          impl: name,
+          keyType: "number",
+          size: size,
+          create: function() {
+            prepare();
+            return operations[op](impls[name], priorities);
+          }
+        });
+      });
+    });
+  });
+  return cases;
+};
@@ -0,0 +1,195 @@
+"use strict";
+
+var collection = require("../../lib/collection");
+
+/*
+ * Integer id workloads. IntSet is compared with a Set, an ES Set where the runtime provides one, and sorted arrays,
+ * which are intersected by merging.
+ */
+
+// Ids are drawn from a range this many times the size of a set, so that half of the bitmap containers are dense.
+var SPREAD = 2;
+
+function ids(n, seed) {
+  var result = [], x = seed;
+  for (var i = 0; i < n; i++) {
+    x = (x * 1103515245 + 12345) % 2147483648;
+    result.push(x % (n * SPREAD));
+  }
+  return result;
+}
+
+function sortedUnique(values) {
+  var sorted = values.slice().sort(function(a, b) { return a - b; }), result = [];
+  for (var i = 0; i < sorted.length; i++) {
+    if (i === 0 || sorted[i] !== sorted[i - 1]) {
+      result.push(sorted[i]);
+    }
+  }
+  return result;
+}
+
+var impls = {
+  IntSet: {
+    create: function(values) { return new collection.IntSet(values); },
+    add: function(c, v) { c.add(v); },
+    has: function(c, v) { return c.has(v); },
+    and: function(c1, c2) { return c1.and(c2); }
+  },
+
+  Set: {
+    create: function(values) { return new collection.Set(values); },
+    add: function(c, v) { c.add(v); },
+    has: function(c, v) { return c.has(v); },
+    and: function(c1, c2) { return c1.filter(function(v) { return c2.has(v); }); }
+  },
+
+  // Sorted arrays of unique ids, looked up with a binary search.
+  SortedArray: {
+    create: function(values) { return sortedUnique(values); },
+    add: function(c, v) {
+      var low = 0, high = c.length;
+      while (low < high) {
+        var middle = (low + high) >>> 1;
+        if (c[middle] < v) {
+          low = middle + 1;
+        } else {
+          high = middle;
+        }
+      }
+      if (c[low] !== v) {
+        c.splice(low, 0, v);
+      }
+    },
+    has: function(c, v) {
+      var low = 0, high = c.length - 1;
+      while (low <= high) {
+        var middle = (low + high) >>> 1;
+        if (c[middle] < v) {
+          low = middle + 1;
+        } else if (c[middle] > v) {
+          high = middle - 1;
+        } else {
+          return true;
+        }
+      }
+      return false;
+    },
+    and: function(c1, c2) {
+      var result = [], i = 0, j = 0;
+      while (i < c1.length && j < c2.length) {
+        if (c1[i] < c2[j]) {
+          i++;
+        } else if (c1[i] > c2[j]) {
+          j++;
+        } else {
+          result.push(c1[i]);
+          i++;
+          j++;
+        }
+      }
+      return result;
+    }
+  }
+};
+
+if (typeof Set === "function" && typeof Set.prototype.forEach === "function") {
+  impls.ESSet = {
+    create: function(values) {
+      var c = new Set();
+      for (var i = 0; i < values.length; i++) {
+        c.add(values[i]);
+      }
+      return c;
+    },
+    add: function(c, v) { c.add(v); },
+    has: function(c, v) { return c.has(v); },
+    and: function(c1, c2) {
+      var result = new Set();
+      c1.forEach(function(v) {
+        if (c2.has(v)) {
+          result.add(v);
+        }
+      });
+      return result;
+    }
+  };
+}
+
+var operations = {
+  add: function(impl, values) {
+    return {
+      count: values.length,
+      fresh: true,
+      before: function() { return impl.create([]); },
+      fn: function(c) {
+        for (var i = 0; i < values.length; i++) {
+          impl.add(c, values[i]);
+        }
+      }
+    };
+  },
+
+  has: function(impl, values, others) {
+    return {
+      count: others.length,
+      before: function() { return impl.create(values); },
+      fn: function(c) {
+        for (var i = 0; i < others.length; i++) {
+          impl.has(c, others[i]);
+        }
+      }
+    };
+  },
+
+  // Intersection of two sets of the same size. Reported per call.
+  and: function(impl, values, others) {
+    return {
+      count: 1,
+      before: function() { return [impl.create(values), impl.create(others)]; },
+      fn: function(c) {
+        impl.and(c[0], c[1]);
+      }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  if (options.keyTypes.indexOf("number") === -1) {
+    return cases;
+  }
+  options.sizes.forEach(function(size) {
+    var values = null, others = null;
+    var prepare = function() {
+      if (values === null) {
+        values = ids(size, 1);
+        others = ids(size, 2);
+      }
+    };
+
+    Object.keys(operations).forEach(function(op) {
+      if (!options.matches(op)) {
+        return;
+      }
+      Object.keys(impls).forEach(function(name) {
+        if (name === "SortedArray" && op === "add" && size > 100000) {
+          // Inserting into the middle of an array is quadratic.
+          return;
+        }
+        cases.push({
+          suite: "intset",
+          op: op,
+          impl: name,
+          keyType: "number",
+          size: size,
+          create: function() {
+            prepare();
+            return operations[op](impls[name], values, others);
+          }
+        });
+      });
+    });
+  });
+  return cases;
+};
@@ -0,0 +1,198 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * LRU cache workloads. LruMap is compared with the Map plus recency Vector pattern it replaces, with a cache built on
+ * the insertion order of ES Map, and with the lru-cache and quick-lru packages when they are installed
+ * (npm install lru-cache quick-lru).
+ */
+
+var keyTypes = ["number", "string"];
+
+function optional(name) {
+  try {
+    return require(name);
+  } catch (e) {
+    return null;
+  }
+}
+
+var impls = {
+  LruMap: {
+    create: function(capacity) { return new collection.LruMap(capacity); },
+    get: function(c, k) { return c.get(k); },
+    set: function(c, k, v) { c.set(k, v); }
+  },
+
+  // Map with a Vector of keys in order of use, as done before LruMap existed. Every access is O(n).
+  MapVector: {
+    linear: true,
+    create: function(capacity) {
+      return {map: new collection.Map(), recency: new collection.Vector(), capacity: capacity};
+    },
+    get: function(c, k) {
+      var value = c.map.get(k);
+      if (value !== undefined) {
+        c.recency.removeAt(c.recency.index(k)).add(k);
+      }
+      return value;
+    },
+    set: function(c, k, v) {
+      if (c.map.has(k)) {
+        c.recency.removeAt(c.recency.index(k));
+      } else if (c.map.size() >= c.capacity) {
+        c.map.remove(c.recency.get(0));
+        c.recency.removeAt(0);
+      }
+      c.map.set(k, v);
+      c.recency.add(k);
+    }
+  }
+};
+
+if (typeof Map === "function" && typeof Map.prototype.keys === "function") {
+  impls.ESMap = {
+    create: function(capacity) { return {map: new Map(), capacity: capacity}; },
+    get: function(c, k) {
+      var value = c.map.get(k);
+      if (value !== undefined) {
+        c.map["delete"](k);
+        c.map.set(k, value);
+      }
+      return value;
+    },
+    set: function(c, k, v) {
+      c.map["delete"](k);
+      if (c.map.size >= c.capacity) {
+        c.map["delete"](c.map.keys().next().value);
+      }
+      c.map.set(k, v);
+    }
+  };
+}
+
+var LRU = optional("lru-cache");
+if (LRU) {
+  var LRUCache = LRU.LRUCache || LRU;
+  impls["lru-cache"] = {
+    create: function(capacity) { return new LRUCache({max: capacity}); },
+    get: function(c, k) { return c.get(k); },
+    set: function(c, k, v) { c.set(k, v); }
+  };
+}
+
+var QuickLRU = optional("quick-lru");
+if (QuickLRU) {
+  QuickLRU = QuickLRU["default"] || QuickLRU;
+  impls["quick-lru"] = {
+    create: function(capacity) { return new QuickLRU({maxSize: capacity}); },
+    get: function(c, k) { return c.get(k); },
+    set: function(c, k, v) { c.set(k, v); }
+  };
+}
+
+var operations = {
+  // Insert twice as many keys as fit, so that half of the insertions evict an entry.
+  set: function(impl, keys, size) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return impl.create(size); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          impl.set(c, keys[i], i);
+        }
+      }
+    };
+  },
+
+  // Every lookup is a hit.
+  get: function(impl, keys, size, probes) {
+    return {
+      count: probes.length,
+      before: function() {
+        var c = impl.create(size);
+        for (var i = 0; i < size; i++) {
+          impl.set(c, keys[i], i);
+        }
+        return c;
+      },
+      fn: function(c) {
+        for (var i = 0; i < probes.length; i++) {
+          impl.get(c, probes[i]);
+        }
+      }
+    };
+  },
+
+  // Read-through cache with a skewed access pattern: 80% of the accesses go to 20% of the keys.
+  mixed: function(impl, keys, size, probes, accesses) {
+    return {
+      count: accesses.length,
+      before: function() { return impl.create(size); },
+      fn: function(c) {
+        for (var i = 0; i < accesses.length; i++) {
+          var k = accesses[i];
+          if (impl.get(c, k) === undefined) {
+            impl.set(c, k, i);
+          }
+        }
+      }
+    };
+  }
+};
+
+function skewed(keys, n) {
+  var result = new Array(n), seed = 54321, hot = Math.max(1, Math.floor(keys.length / 5));
+  for (var i = 0; i < n; i++) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    var r = seed / 0x7fffffff;
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    result[i] = r < 0.8 ? keys[seed % hot] : keys[seed % keys.length];
+  }
+  return result;
+}
+
+exports.cases = function(options) {
+  var cases = [];
+  options.sizes.forEach(function(size) {
+    keyTypes.forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      var keys = null, probes = null, accesses = null;
+      var prepare = function() {
+        if (keys === null) {
+          keys = harness.keys(keyType, size * 2);
+          probes = harness.shuffle(keys.slice(0, size));
+          accesses = skewed(keys, size * 2);
+        }
+      };
+
+      Object.keys(operations).forEach(function(op) {
+        if (!options.matches(op)) {
+          return;
+        }
+        Object.keys(impls).forEach(function(name) {
+          if (impls[name].linear && size > options.linearLimit) {
+            return;
+          }
+          cases.push({
+            suite: "lru",
+            op: op,
+            impl: name,
+            keyType: keyType,
+            size: size,
+            create: function() {
+              prepare();
+              return operations[op](impls[name], keys, size, probes, accesses);
+            }
+          });
+        });
+      });
+    });
+  });
+  return cases;
+};
@@ -0,0 +1,223 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * Dashboard workloads: counting distinct values and reading percentiles of a stream. The sketches are compared with
+ * the unbounded collections they replace, and the relative error of their answers is reported along with
+ * throughput. The exact answers of Vector, including the greatest values and a histogram, are selected natively and
+ * compared with sorting the values in JavaScript.
+ */
+
+// Values of the stream are drawn from this many times fewer distinct values.
+var REPEAT = 4;
+
+var PERCENTILES = [0.5, 0.9, 0.99, 0.999];
+
+var TOP_K = 10;
+
+var BUCKETS = 20;
+
+var distinct = {
+  DistinctCounter: {
+    create: function() { return new collection.DistinctCounter(); },
+    add: function(c, v) { c.add(v); },
+    answer: function(c) { return c.size(); }
+  },
+
+  Set: {
+    create: function() { return new collection.Set(); },
+    add: function(c, v) { c.add(v); },
+    answer: function(c) { return c.size(); }
+  }
+};
+
+if (typeof Set === "function" && typeof Set.prototype.add === "function") {
+  distinct.ESSet = {
+    create: function() { return new Set(); },
+    add: function(c, v) { c.add(v); },
+    answer: function(c) { return c.size; }
+  };
+}
+
+var quantiles = {
+  QuantileSketch: {
+    create: function() { return new collection.QuantileSketch(); },
+    add: function(c, v) { c.add(v); },
+    answer: function(c) { return c.quantile.apply(c, PERCENTILES); }
+  },
+
+  // Exact percentiles, top values and histograms selected natively.
+  Vector: {
+    create: function() { return new collection.Vector(); },
+    add: function(c, v) { c.add(v); },
+    answer: function(c) { return c.quantile.apply(c, PERCENTILES); },
+    topK: function(c) { return c.topK(TOP_K); },
+    histogram: function(c) { return c.histogram(BUCKETS); }
+  },
+
+  // The same answers from a sorted copy of a vector's elements.
+  VectorSort: {
+    create: function() { return new collection.Vector(); },
+    add: function(c, v) { c.add(v); },
+    answer: function(c) { return percentiles(sorted(c.toArray())); },
+    topK: function(c) { return sorted(c.toArray()).slice(-TOP_K).reverse(); },
+    histogram: function(c) { return histogram(sorted(c.toArray())); }
+  },
+
+  Array: {
+    create: function() { return []; },
+    add: function(c, v) { c.push(v); },
+    answer: function(c) { return percentiles(sorted(c.slice())); },
+    topK: function(c) { return sorted(c.slice()).slice(-TOP_K).reverse(); },
+    histogram: function(c) { return histogram(sorted(c.slice())); }
+  }
+};
+
+function sorted(array) {
+  return array.sort(function(a, b) { return a - b; });
+}
+
+function percentiles(sorted) {
+  return PERCENTILES.map(function(q) { return sorted[Math.min(sorted.length - 1, Math.floor(q * sorted.length))]; });
+}
+
+// Buckets of equal width between the least and the greatest value, as Vector#histogram counts them.
+function histogram(sorted) {
+  var counts = [], min = sorted[0], range = sorted[sorted.length - 1] - min;
+  for (var i = 0; i < BUCKETS; i++) {
+    counts.push(0);
+  }
+  for (i = 0; i < sorted.length; i++) {
+    var position = range > 0 ? (sorted[i] - min) / range * BUCKETS : 0;
+    counts[Math.min(BUCKETS - 1, Math.floor(position))]++;
+  }
+  return counts;
+}
+
+// Latencies with a long tail.
+function latencies(n) {
+  var result = new Array(n), seed = 12345;
+  for (var i = 0; i < n; i++) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    result[i] = -Math.log((seed + 1) / 2147483649) * 10;
+  }
+  return result;
+}
+
+function stream(keyType, n) {
+  var keys = harness.keys(keyType, Math.max(1, Math.floor(n / REPEAT)));
+  var result = new Array(n);
+  for (var i = 0; i < n; i++) {
+    result[i] = keys[(i * 7919) % keys.length];
+  }
+  return result;
+}
+
+function build(impl, values) {
+  var c = impl.create();
+  for (var i = 0; i < values.length; i++) {
+    impl.add(c, values[i]);
+  }
+  return c;
+}
+
+function operations(impl, values, exact) {
+  var answer = {
+    count: 1,
+    before: function() { return build(impl, values); },
+    fn: function(c) { impl.answer(c); }
+  };
+  answer.measure = function(options) {
+    var metrics = harness.time(answer, options);
+    var result = [].concat(impl.answer(build(impl, values))), expected = [].concat(exact), error = 0;
+    for (var i = 0; i < result.length; i++) {
+      error = Math.max(error, Math.abs(result[i] - expected[i]) / expected[i]);
+    }
+    metrics.relativeError = error;
+    return metrics;
+  };
+
+  return {
+    add: {
+      count: values.length,
+      fresh: true,
+      before: function() { return impl.create(); },
+      fn: function(c) {
+        for (var i = 0; i < values.length; i++) {
+          impl.add(c, values[i]);
+        }
+      },
+      memory: function() { return build(impl, values); }
+    },
+
+    // The answer of a populated collection: the number of distinct values, or the percentiles. Reported per call.
+    answer: answer,
+
+    // The greatest values and a histogram of a populated collection, for collections that keep every value.
+    topK: {
+      count: 1,
+      before: function() { return build(impl, values); },
+      fn: function(c) { impl.topK(c); }
+    },
+
+    histogram: {
+      count: 1,
+      before: function() { return build(impl, values); },
+      fn: function(c) { impl.histogram(c); }
+    }
+  };
+}
+
+exports.cases = function(options) {
+  var cases = [];
+  var push = function(impls, keyType, size, values) {
+    Object.keys(impls).forEach(function(name) {
+      ["add", "answer", "topK", "histogram"].forEach(function(op) {
+        if (!options.matches(op) || (op !== "add" && op !== "answer" && !impls[name][op])) {
+          return;
+        }
+        cases.push({
+          suite: "sketches",
+          op: op,
+          impl: name,
+          keyType: keyType,
+          size: size,
+          create: function() {
+            var v = values();
+            return operations(impls[name], v.values, v.exact)[op];
+          }
+        });
+      });
+    });
+  };
+
+  options.sizes.forEach(function(size) {
+    ["number", "string"].forEach(function(keyType) {
+      if (options.keyTypes.indexOf(keyType) === -1) {
+        return;
+      }
+      var cache = null;
+      push(distinct, keyType, size, function() {
+        if (cache === null) {
+          var values = stream(keyType, size);
+          cache = {values: values, exact: Math.max(1, Math.floor(size / REPEAT))};
+        }
+        return cache;
+      });
+    });
+
+    if (options.keyTypes.indexOf("number") !== -1) {
+      var cache = null;
+      push(quantiles, "number", size, function() {
+        if (cache === null) {
+          var values = latencies(size);
+          cache = {values: values, exact: quantiles.Array.answer(values)};
+        }
+        return cache;
+      });
+    }
+  });
+  return cases;
+};
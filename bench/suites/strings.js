@@ -0,0 +1,135 @@
+"use strict";
+
+var collection = require("../../lib/collection"),
+    harness = require("../harness");
+
+/*
+ * String key workloads with long shared prefixes, such as URL paths and metric names. StringSet is compared with a
+ * Set and an ES Set where the runtime provides one. Prefix queries of the sets without a radix tree scan all keys.
+ */
+
+var SERVICES = ["api", "billing", "search", "static"];
+
+function paths(n) {
+  var result = new Array(n);
+  for (var i = 0; i < n; i++) {
+    result[i] = "/" + SERVICES[i % SERVICES.length] + "/v" + (i % 3) + "/users/" + (i >> 4) + "/items/" + i;
+  }
+  return harness.shuffle(result);
+}
+
+function startsWith(s, prefix) {
+  return s.lastIndexOf(prefix, 0) === 0;
+}
+
+var impls = {
+  StringSet: {
+    create: function() { return new collection.StringSet(); },
+    add: function(c, k) { c.add(k); },
+    has: function(c, k) { return c.has(k); },
+    prefix: function(c, p) { return c.keysWithPrefix(p); }
+  },
+
+  Set: {
+    create: function() { return new collection.Set(); },
+    add: function(c, k) { c.add(k); },
+    has: function(c, k) { return c.has(k); },
+    prefix: function(c, p) { return c.filter(function(k) { return startsWith(k, p); }); }
+  }
+};
+
+if (typeof Set === "function" && typeof Set.prototype.forEach === "function") {
+  impls.ESSet = {
+    create: function() { return new Set(); },
+    add: function(c, k) { c.add(k); },
+    has: function(c, k) { return c.has(k); },
+    prefix: function(c, p) {
+      var result = [];
+      c.forEach(function(k) {
+        if (startsWith(k, p)) {
+          result.push(k);
+        }
+      });
+      return result.sort();
+    }
+  };
+}
+
+function build(impl, keys) {
+  var c = impl.create();
+  for (var i = 0; i < keys.length; i++) {
+    impl.add(c, keys[i]);
+  }
+  return c;
+}
+
+var operations = {
+  add: function(impl, keys) {
+    return {
+      count: keys.length,
+      fresh: true,
+      before: function() { return impl.create(); },
+      fn: function(c) {
+        for (var i = 0; i < keys.length; i++) {
+          impl.add(c, keys[i]);
+        }
+      },
+      memory: function() { return build(impl, keys); }
+    };
+  },
+
+  has: function(impl, keys) {
+    return {
+      before: function() { return build(impl, keys); },
+      fn: function(c, i) { impl.has(c, keys[i % keys.length]); }
+    };
+  },
+
+  // The keys under one user, a few out of all of them. Reported per call.
+  prefix: function(impl, keys) {
+    var prefixes = keys.map(function(k) { return k.substring(0, k.indexOf("/items/") + 1); });
+    return {
+      before: function() { return build(impl, keys); },
+      fn: function(c, i) { impl.prefix(c, prefixes[i % prefixes.length]); }
+    };
+  }
+};
+
+exports.cases = function(options) {
+  var cases = [];
+  if (options.keyTypes.indexOf("string") === -1) {
+    return cases;
+  }
+  options.sizes.forEach(function(size) {
+    var keys = null;
+    var prepare = function() {
+      if (keys === null) {
+        keys = paths(size);
+      }
+    };
+
+    Object.keys(operations).forEach(function(op) {
+      if (!options.matches(op)) {
+        return;
+      }
+      Object.keys(impls).forEach(function(name) {
+        if (op === "prefix" && name !== "StringSet" && size > options.linearLimit) {
+          // Scanning every key for each query.
+          return;
+        }
+        cases.push({
+          suite: "strings",
+          op: op,
+          impl: name,
+          keyType: "string",
+          size: size,
+          create: function() {
+            prepare();
+            return operations[op](impls[name], keys);
+          }
+        });
+      });
+    });
+  });
+  return cases;
+};
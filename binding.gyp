@@ -1,13 +1,39 @@
 {
+  "variables": {
+    "collection_profile%": "false"
+  },
   "targets": [
     {
       "target_name": "NativeTypes",
       "sources": ["src/common.cc",
                   "src/NativeTypes.cc",
+                  "src/Element.cc",
+                  "src/JsonWriter.cc",
+                  "src/Pool.cc",
+                  "src/Profile.cc",
+                  "src/RoaringBitmap.cc",
+                  "src/HyperLogLog.cc",
+                  "src/TDigest.cc",
+                  "src/BloomFilter.cc",
+                  "src/Deque.cc",
+                  "src/DistinctCounter.cc",
+                  "src/ExpiringMap.cc",
+                  "src/IntSet.cc",
+                  "src/LruMap.cc",
                   "src/Map.cc",
+                  "src/MultiMap.cc",
+                  "src/MultiSet.cc",
+                  "src/PriorityQueue.cc",
+                  "src/QuantileSketch.cc",
                   "src/Set.cc",
+                  "src/SortedVector.cc",
+                  "src/StringMap.cc",
+                  "src/StringSet.cc",
                   "src/Vector.cc"],
       "conditions": [
+        ['collection_profile=="true"', {
+          'defines': ['COLLECTION_PROFILE']
+        }],
         ['OS=="linux"', {
           'cflags_cc!': ['-fno-exceptions']
         }],
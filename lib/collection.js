@@ -2,6 +2,20 @@
 
 var NativeTypes = require('bindings')('NativeTypes.node');
 
+exports.BloomFilter = NativeTypes.BloomFilter;
+exports.CountingBloomFilter = NativeTypes.CountingBloomFilter;
+exports.Deque = NativeTypes.Deque;
+exports.DistinctCounter = NativeTypes.DistinctCounter;
+exports.ExpiringMap = NativeTypes.ExpiringMap;
+exports.IntSet = NativeTypes.IntSet;
+exports.LruMap = NativeTypes.LruMap;
 exports.Map = NativeTypes.Map;
+exports.MultiMap = NativeTypes.MultiMap;
+exports.MultiSet = NativeTypes.MultiSet;
+exports.PriorityQueue = NativeTypes.PriorityQueue;
+exports.QuantileSketch = NativeTypes.QuantileSketch;
 exports.Set = NativeTypes.Set;
+exports.SortedVector = NativeTypes.SortedVector;
+exports.StringMap = NativeTypes.StringMap;
+exports.StringSet = NativeTypes.StringSet;
 exports.Vector = NativeTypes.Vector;
@@ -0,0 +1,484 @@
+#include <cmath>
+#include <node_buffer.h>
+#include "BloomFilter.h"
+#include "common.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class BloomFilter
+ */
+
+Persistent<FunctionTemplate> BloomFilter::constructor;
+
+BloomFilter::BloomFilter() : bits(0), hashes(0) {
+}
+
+BloomFilter::~BloomFilter() {
+}
+
+void BloomFilter::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("BloomFilter"));
+
+  exports->Set(String::NewSymbol("BloomFilter"), constructor->GetFunction());
+}
+
+uint32_t BloomFilter::PositionsPerWord() const {
+  return 64;
+}
+
+uint32_t BloomFilter::Cookie() const {
+  return SERIAL_COOKIE;
+}
+
+void BloomFilter::Insert(uint64_t hash) {
+  uint64_t position, step;
+  Probe(hash, position, step);
+  for (uint32_t i = 0; i < hashes; i++) {
+    words[position >> 6] |= 1ULL << (position & 63);
+    position += step;
+    if (position >= bits) {
+      position -= bits;
+    }
+  }
+}
+
+bool BloomFilter::Test(uint64_t hash) const {
+  uint64_t position, step;
+  Probe(hash, position, step);
+  for (uint32_t i = 0; i < hashes; i++) {
+    if ((words[position >> 6] & (1ULL << (position & 63))) == 0) {
+      return false;
+    }
+    position += step;
+    if (position >= bits) {
+      position -= bits;
+    }
+  }
+  return true;
+}
+
+uint64_t BloomFilter::CountSet() const {
+  uint64_t count = 0;
+  for (size_t i = 0; i < words.size(); i++) {
+#ifdef __GNUC__
+    count += (uint64_t) __builtin_popcountll(words[i]);
+#else
+    for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+      count++;
+    }
+#endif
+  }
+  return count;
+}
+
+/*
+ * Merge another filter of the same size into this one, so that it might have the values of either.
+ */
+void BloomFilter::Union(const BloomFilter& other) {
+  for (size_t i = 0; i < words.size(); i++) {
+    words[i] |= other.words[i];
+  }
+}
+
+bool BloomFilter::Allocate(uint64_t bits, uint32_t hashes) {
+  if (bits == 0 || bits % 64 != 0 || bits > MAX_BITS || hashes == 0 || hashes > MAX_HASHES) {
+    return false;
+  }
+  this->bits = bits;
+  this->hashes = hashes;
+  words.assign((size_t) (bits / PositionsPerWord()), 0);
+  return true;
+}
+
+/*
+ * A serialized filter is a cookie, the number of hashes and the number of positions, followed by the words of the
+ * filter, all little-endian.
+ */
+bool BloomFilter::Deserialize(const char* data, size_t length) {
+  if (length < HEADER_SIZE || Read32(data) != Cookie()) {
+    return false;
+  }
+  uint32_t hashes = Read32(data + 4);
+  uint64_t bits = (uint64_t) Read32(data + 8) | ((uint64_t) Read32(data + 12) << 32);
+  if (!Allocate(bits, hashes) || length != HEADER_SIZE + 8 * words.size()) {
+    return false;
+  }
+  const char* word = data + HEADER_SIZE;
+  for (size_t i = 0; i < words.size(); i++, word += 8) {
+    words[i] = (uint64_t) Read32(word) | ((uint64_t) Read32(word + 4) << 32);
+  }
+  return true;
+}
+
+/*
+ * Initialize a new filter from the arguments of its constructor: the number of values it is expected to hold and
+ * an optional false positive rate, or a buffer returned by toBuffer().
+ */
+Handle<Value> BloomFilter::Create(const Arguments& args, BloomFilter* obj) {
+  if (!args.IsConstructCall()) {
+    delete obj;
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool isBuffer = args.Length() == 1 && Buffer::HasInstance(args[0]);
+  if (!isBuffer && (args.Length() < 1 || args.Length() > 2 || !(args[0]->IsUint32()) || args[0]->Uint32Value() == 0 ||
+      !(args[1]->IsUndefined() || (args[1]->IsNumber() && args[1]->NumberValue() > 0 && args[1]->NumberValue() < 1)))) {
+    delete obj;
+    return ThrowException(Exception::Error(String::New("Arguments must be a positive capacity and an optional false positive rate between 0 and 1, or a buffer.")));
+  }
+
+  obj->Wrap(args.This());
+
+  if (isBuffer) {
+    if (!obj->Deserialize(Buffer::Data(args[0]), Buffer::Length(args[0]))) {
+      return ThrowException(Exception::Error(String::New("Buffer does not hold a serialized filter of this type.")));
+    }
+  } else {
+    double capacity = args[0]->NumberValue();
+    double rate = args[1]->IsUndefined() ? 0.01 : args[1]->NumberValue();
+    double positions = ceil(-capacity * log(rate) / (log(2.0) * log(2.0)));
+    double hashes = floor(positions / capacity * log(2.0) + 0.5);
+    positions = ceil(positions / 64) * 64;
+    if (positions > (double) MAX_BITS) {
+      return ThrowException(Exception::Error(String::New("Filter would be too large for the capacity and false positive rate.")));
+    }
+    if (hashes < 1) {
+      hashes = 1;
+    } else if (hashes > MAX_HASHES) {
+      hashes = MAX_HASHES;
+    }
+    obj->Allocate((uint64_t) positions, (uint32_t) hashes);
+  }
+
+  Handle<Object> thisObject = args.This();
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("estimatedSize"), FunctionTemplate::New(EstimatedSize)->GetFunction());
+  thisObject->Set(String::NewSymbol("falsePositiveRate"), FunctionTemplate::New(FalsePositiveRate)->GetFunction());
+  thisObject->Set(String::NewSymbol("merge"), FunctionTemplate::New(Merge)->GetFunction());
+  thisObject->Set(String::NewSymbol("mightHave"), FunctionTemplate::New(MightHave)->GetFunction());
+  thisObject->Set(String::NewSymbol("mightHaveEach"), FunctionTemplate::New(MightHaveEach)->GetFunction());
+  thisObject->Set(String::NewSymbol("toBuffer"), FunctionTemplate::New(ToBuffer)->GetFunction());
+
+  return args.This();
+}
+
+bool BloomFilter::HasInstance(Handle<Value> value) {
+  return constructor->HasInstance(value) || CountingBloomFilter::constructor->HasInstance(value);
+}
+
+/*
+ * Values are those that collections compare by content. Other objects are all equal to a set, so a filter would
+ * not tell them apart.
+ */
+bool BloomFilter::IsSupportedType(Handle<Value> value) {
+  return ValueComparator::GetTypeScore(value) > 0;
+}
+
+uint64_t BloomFilter::Hash(Handle<Value> value) {
+  ValueHasher hasher;
+  return hasher.Hash64(value);
+}
+
+void BloomFilter::Write32(char*& data, uint32_t value) {
+  *data++ = (char) (value & 0xff);
+  *data++ = (char) ((value >> 8) & 0xff);
+  *data++ = (char) ((value >> 16) & 0xff);
+  *data++ = (char) ((value >> 24) & 0xff);
+}
+
+uint32_t BloomFilter::Read32(const char* data) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+Handle<Value> BloomFilter::New(const Arguments& args) {
+  return Create(args, new BloomFilter());
+}
+
+Handle<Value> BloomFilter::Add(const Arguments& args) {
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!IsSupportedType(args[i])) {
+      return ThrowException(Exception::Error(String::New("add(value, ...) takes only primitives, dates, arrays, sets and vectors.")));
+    }
+  }
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    obj->Insert(Hash(args[i]));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> BloomFilter::AddAll(const Arguments& args) {
+  if (args.Length() != 1 || !(args[0]->IsArray())) {
+    return ThrowException(Exception::Error(String::New("addAll(array) takes an array.")));
+  }
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  Handle<Array> array = Handle<Array>::Cast(args[0]);
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    if (!IsSupportedType(array->Get(i))) {
+      return ThrowException(Exception::Error(String::New("addAll(array) takes only primitives, dates, arrays, sets and vectors.")));
+    }
+  }
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    HandleScope scope;
+    obj->Insert(Hash(array->Get(i)));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> BloomFilter::Clear(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  obj->words.assign(obj->words.size(), 0);
+  return scope.Close(args.This());
+}
+
+/*
+ * Estimate the number of distinct values added from the fraction of positions that are set.
+ */
+Handle<Value> BloomFilter::EstimatedSize(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(estimatedSize, args);
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  double set = (double) obj->CountSet();
+  double bits = (double) obj->bits;
+  if (set >= bits) {
+    set = bits - 1;
+  }
+  double size = -bits / obj->hashes * log(1 - set / bits);
+  return scope.Close(Number::New(floor(size + 0.5)));
+}
+
+/*
+ * Estimate the probability that mightHave() returns true for a value that was not added, given the positions that
+ * are set.
+ */
+Handle<Value> BloomFilter::FalsePositiveRate(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(falsePositiveRate, args);
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  return scope.Close(Number::New(pow((double) obj->CountSet() / obj->bits, (double) obj->hashes)));
+}
+
+Handle<Value> BloomFilter::Merge(const Arguments& args) {
+  if (args.Length() != 1 || !HasInstance(args[0])) {
+    return ThrowException(Exception::Error(String::New("merge(filter) takes a filter.")));
+  }
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  BloomFilter* other = ObjectWrap::Unwrap<BloomFilter>(Handle<Object>::Cast(args[0]));
+  if (other->Cookie() != obj->Cookie() || other->bits != obj->bits || other->hashes != obj->hashes) {
+    return ThrowException(Exception::Error(String::New("merge(filter) takes a filter of the same type, created with the same capacity and false positive rate.")));
+  }
+  obj->Union(*other);
+  return scope.Close(args.This());
+}
+
+Handle<Value> BloomFilter::MightHave(const Arguments& args) {
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("mightHave(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  if (args.Length() == 1) {
+    return scope.Close(Boolean::New(IsSupportedType(args[0]) && obj->Test(Hash(args[0]))));
+  } else {
+    Handle<Array> array = Array::New(args.Length());
+    for (int i = 0; i < args.Length(); i++) {
+      array->Set(i, Boolean::New(IsSupportedType(args[i]) && obj->Test(Hash(args[i]))));
+    }
+    return scope.Close(array);
+  }
+}
+
+/*
+ * Test each value of an array, which would otherwise be tested as a single value.
+ */
+Handle<Value> BloomFilter::MightHaveEach(const Arguments& args) {
+  if (args.Length() != 1 || !(args[0]->IsArray())) {
+    return ThrowException(Exception::Error(String::New("mightHaveEach(array) takes an array.")));
+  }
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  Handle<Array> values = Handle<Array>::Cast(args[0]);
+  uint32_t length = values->Length();
+  Handle<Array> array = Array::New(length);
+  for (uint32_t i = 0; i < length; i++) {
+    HandleScope scope;
+    Local<Value> value = values->Get(i);
+    array->Set(i, Boolean::New(IsSupportedType(value) && obj->Test(Hash(value))));
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> BloomFilter::ToBuffer(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toBuffer, args);
+
+  HandleScope scope;
+  BloomFilter* obj = ObjectWrap::Unwrap<BloomFilter>(args.This());
+  Buffer* buffer = Buffer::New(HEADER_SIZE + 8 * obj->words.size());
+  char* data = Buffer::Data(buffer->handle_);
+  Write32(data, obj->Cookie());
+  Write32(data, obj->hashes);
+  Write32(data, (uint32_t) obj->bits);
+  Write32(data, (uint32_t) (obj->bits >> 32));
+  for (size_t i = 0; i < obj->words.size(); i++) {
+    Write32(data, (uint32_t) obj->words[i]);
+    Write32(data, (uint32_t) (obj->words[i] >> 32));
+  }
+  return scope.Close(buffer->handle_);
+}
+
+
+/*
+ * class CountingBloomFilter
+ */
+
+Persistent<FunctionTemplate> CountingBloomFilter::constructor;
+
+void CountingBloomFilter::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("CountingBloomFilter"));
+
+  exports->Set(String::NewSymbol("CountingBloomFilter"), constructor->GetFunction());
+}
+
+uint32_t CountingBloomFilter::PositionsPerWord() const {
+  return 16;
+}
+
+uint32_t CountingBloomFilter::Cookie() const {
+  return SERIAL_COOKIE;
+}
+
+void CountingBloomFilter::Insert(uint64_t hash) {
+  uint64_t position, step;
+  Probe(hash, position, step);
+  for (uint32_t i = 0; i < hashes; i++) {
+    uint64_t& word = words[position >> 4];
+    uint32_t shift = (uint32_t) (position & 15) * 4;
+    if (((word >> shift) & 15) != 15) {
+      word += 1ULL << shift;
+    }
+    position += step;
+    if (position >= bits) {
+      position -= bits;
+    }
+  }
+}
+
+bool CountingBloomFilter::Test(uint64_t hash) const {
+  uint64_t position, step;
+  Probe(hash, position, step);
+  for (uint32_t i = 0; i < hashes; i++) {
+    if (((words[position >> 4] >> ((position & 15) * 4)) & 15) == 0) {
+      return false;
+    }
+    position += step;
+    if (position >= bits) {
+      position -= bits;
+    }
+  }
+  return true;
+}
+
+void CountingBloomFilter::Delete(uint64_t hash) {
+  uint64_t position, step;
+  Probe(hash, position, step);
+  for (uint32_t i = 0; i < hashes; i++) {
+    uint64_t& word = words[position >> 4];
+    uint32_t shift = (uint32_t) (position & 15) * 4;
+    uint64_t counter = (word >> shift) & 15;
+    if (counter != 0 && counter != 15) {
+      word -= 1ULL << shift;
+    }
+    position += step;
+    if (position >= bits) {
+      position -= bits;
+    }
+  }
+}
+
+uint64_t CountingBloomFilter::CountSet() const {
+  uint64_t count = 0;
+  for (size_t i = 0; i < words.size(); i++) {
+    for (uint64_t word = words[i]; word != 0; word >>= 4) {
+      if ((word & 15) != 0) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+void CountingBloomFilter::Union(const BloomFilter& other) {
+  const vector<uint64_t>& otherWords = static_cast<const CountingBloomFilter&>(other).words;
+  for (size_t i = 0; i < words.size(); i++) {
+    uint64_t word = words[i];
+    uint64_t otherWord = otherWords[i];
+    if (otherWord == 0) {
+      continue;
+    }
+    uint64_t result = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 4) {
+      uint64_t counter = ((word >> shift) & 15) + ((otherWord >> shift) & 15);
+      result |= (counter > 15 ? 15 : counter) << shift;
+    }
+    words[i] = result;
+  }
+}
+
+Handle<Value> CountingBloomFilter::New(const Arguments& args) {
+  Handle<Value> result = Create(args, new CountingBloomFilter());
+  if (!result.IsEmpty() && result->IsObject()) {
+    Handle<Object>::Cast(result)->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  }
+  return result;
+}
+
+/*
+ * Remove values that were added. Values that the filter definitely does not have are ignored; removing a value that
+ * was never added may cause the filter to miss other values.
+ */
+Handle<Value> CountingBloomFilter::Remove(const Arguments& args) {
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  CountingBloomFilter* obj = ObjectWrap::Unwrap<CountingBloomFilter>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    if (IsSupportedType(args[i])) {
+      uint64_t hash = Hash(args[i]);
+      if (obj->Test(hash)) {
+        obj->Delete(hash);
+      }
+    }
+  }
+  return scope.Close(args.This());
+}
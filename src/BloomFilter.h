@@ -0,0 +1,120 @@
+#ifndef COLLECTION_BLOOM_FILTER_H
+#define COLLECTION_BLOOM_FILTER_H
+
+#include <stdint.h>
+#include <vector>
+#include <node.h>
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class BloomFilter
+ *
+ * An approximate set that answers whether a value might have been added, in far less memory than a set holding the
+ * values. It never misses a value that was added, but reports a value that was not added with a small probability,
+ * which is chosen when the filter is created along with the number of values it is expected to hold.
+ *
+ * Values are hashed with ValueHasher::Hash64, so values that are equal in a set are equal in a filter. The bits
+ * tested for a value are derived from its hash by double hashing.
+ */
+
+class BloomFilter : public ObjectWrap {
+  public:
+    static void Init(Handle<Object> exports);
+
+    static Persistent<FunctionTemplate> constructor;
+
+  protected:
+    BloomFilter();
+    virtual ~BloomFilter();
+
+    static const uint32_t SERIAL_COOKIE = 0x31464c42; // "BLF1"
+    static const size_t HEADER_SIZE = 16;
+    static const uint64_t MAX_BITS = 1ULL << 34;
+    static const uint32_t MAX_HASHES = 32;
+
+    // Number of positions held by each word of `words`.
+    virtual uint32_t PositionsPerWord() const;
+    virtual uint32_t Cookie() const;
+    virtual void Insert(uint64_t hash);
+    virtual bool Test(uint64_t hash) const;
+    virtual uint64_t CountSet() const;
+    virtual void Union(const BloomFilter& other);
+
+    /*
+     * The positions of a value are position, position + step, position + 2 * step, ..., modulo the number of
+     * positions. The step is mixed again from the hash, so that it does not depend on the first position.
+     */
+    inline void Probe(uint64_t hash, uint64_t& position, uint64_t& step) const {
+      position = hash % bits;
+      step = (hash ^ (hash >> 29)) * 0xbf58476d1ce4e5b9ULL;
+      step = (step ^ (step >> 32)) % bits;
+    }
+
+    bool Allocate(uint64_t bits, uint32_t hashes);
+    bool Deserialize(const char* data, size_t length);
+
+    static Handle<Value> Create(const Arguments& args, BloomFilter* obj);
+    static bool HasInstance(Handle<Value> value);
+    static bool IsSupportedType(Handle<Value> value);
+    static uint64_t Hash(Handle<Value> value);
+
+    static void Write32(char*& data, uint32_t value);
+    static uint32_t Read32(const char* data);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> Clear(const Arguments& args);
+    static Handle<Value> EstimatedSize(const Arguments& args);
+    static Handle<Value> FalsePositiveRate(const Arguments& args);
+    static Handle<Value> Merge(const Arguments& args);
+    static Handle<Value> MightHave(const Arguments& args);
+    static Handle<Value> MightHaveEach(const Arguments& args);
+    static Handle<Value> ToBuffer(const Arguments& args);
+
+    // Number of positions, which is a multiple of 64.
+    uint64_t bits;
+    uint32_t hashes;
+    vector<uint64_t> words;
+};
+
+
+/*
+ * class CountingBloomFilter
+ *
+ * A Bloom filter that keeps a 4-bit counter instead of a bit at each position, so that values can be removed. It
+ * takes four times the memory of a Bloom filter. A counter that reaches 15 is never decremented again, which keeps
+ * the filter from missing values at the cost of a slightly higher false positive rate.
+ */
+
+class CountingBloomFilter : public BloomFilter {
+  public:
+    static void Init(Handle<Object> exports);
+
+    static Persistent<FunctionTemplate> constructor;
+
+  protected:
+    static const uint32_t SERIAL_COOKIE = 0x31464243; // "CBF1"
+
+    virtual uint32_t PositionsPerWord() const;
+    virtual uint32_t Cookie() const;
+    virtual void Insert(uint64_t hash);
+    virtual bool Test(uint64_t hash) const;
+    virtual uint64_t CountSet() const;
+    virtual void Union(const BloomFilter& other);
+
+    void Delete(uint64_t hash);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Remove(const Arguments& args);
+
+    friend class BloomFilter;
+};
+
+#endif
@@ -0,0 +1,253 @@
+#include "Deque.h"
+#include "Vector.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class Deque
+ */
+
+Deque::Deque(size_t capacity) : capacity(capacity) {
+}
+
+Handle<Value> Deque::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  return scope.Close(value.ToValue());
+}
+
+void Deque::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("Deque"));
+
+  exports->Set(String::NewSymbol("Deque"), constructor->GetFunction());
+}
+
+void Deque::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("capacity"), FunctionTemplate::New(Capacity)->GetFunction());
+  thisObject->Set(String::NewSymbol("peek"), FunctionTemplate::New(Peek)->GetFunction());
+  thisObject->Set(String::NewSymbol("peekBack"), FunctionTemplate::New(PeekBack)->GetFunction());
+  thisObject->Set(String::NewSymbol("popBack"), FunctionTemplate::New(PopBack)->GetFunction());
+  thisObject->Set(String::NewSymbol("popFront"), FunctionTemplate::New(PopFront)->GetFunction());
+  thisObject->Set(String::NewSymbol("pushBack"), FunctionTemplate::New(PushBack)->GetFunction());
+  thisObject->Set(String::NewSymbol("pushFront"), FunctionTemplate::New(PushFront)->GetFunction());
+  thisObject->Set(String::NewSymbol("set"), FunctionTemplate::New(Set)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSON"), FunctionTemplate::New(ToJSON)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSONBuffer"), FunctionTemplate::New(ToJSONBuffer)->GetFunction());
+  thisObject->Set(String::NewSymbol("writeJSON"), FunctionTemplate::New(WriteJSON)->GetFunction());
+}
+
+void Deque::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (argument->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(argument);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      PushBack(Element::New(array->Get(i), &backing));
+    }
+  } else if (Vector::constructor->HasInstance(argument)) {
+    Vector* object = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(argument));
+    Vector::Storage::const_iterator it = object->storage.begin();
+    while (it != object->storage.end()) {
+      PushBack((it++)->Copy(&backing));
+    }
+  } else if (constructor->HasInstance(argument)) {
+    Deque* object = ObjectWrap::Unwrap<Deque>(Handle<Object>::Cast(argument));
+    Storage::const_iterator it = object->storage.begin();
+    while (it != object->storage.end()) {
+      PushBack((it++)->Copy(&backing));
+    }
+  }
+}
+
+bool Deque::IsSupportedObject(Handle<Value> value) {
+  return Vector::constructor->HasInstance(value) || constructor->HasInstance(value);
+}
+
+bool Deque::IsSupportedType(Handle<Value> value) {
+  return true;
+}
+
+/*
+ * Add an element owned by the caller. If the deque is full, the element at the other end is dropped.
+ */
+void Deque::PushBack(const Element& element) {
+  if (capacity > 0 && storage.size() == capacity) {
+    storage.front().Dispose();
+    storage.pop_front();
+  }
+  storage.push_back(element);
+}
+
+void Deque::PushFront(const Element& element) {
+  if (capacity > 0 && storage.size() == capacity) {
+    storage.back().Dispose();
+    storage.pop_back();
+  }
+  storage.push_front(element);
+}
+
+Handle<Value> Deque::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool argError = args.Length() > 2;
+  int optionsIndex = 0;
+  if (args[0]->IsArray() || Vector::constructor->HasInstance(args[0]) || constructor->HasInstance(args[0])) {
+    optionsIndex = 1;
+  } else if (args.Length() > 1) {
+    argError = true;
+  }
+  Handle<Value> capacity = Undefined();
+  if (args[optionsIndex]->IsObject() && !(args[optionsIndex]->IsArray())) {
+    capacity = Handle<Object>::Cast(args[optionsIndex])->Get(String::NewSymbol("capacity"));
+    argError = argError || !(capacity->IsUndefined() || (capacity->IsUint32() && capacity->Uint32Value() > 0));
+  } else if (!(args[optionsIndex]->IsUndefined())) {
+    argError = true;
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Arguments must be an optional array or object, and optional options {capacity: integer}.")));
+  }
+
+  Deque* obj = new Deque(capacity->IsUint32() ? capacity->Uint32Value() : 0);
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  if (optionsIndex == 1) {
+    obj->InitializeValues(args.This(), args[0]);
+  }
+
+  return args.This();
+}
+
+Handle<Value> Deque::Capacity(const Arguments& args) {
+  PROFILE_METHOD(capacity, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(capacity, args);
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  if (obj->capacity == 0) {
+    return Undefined();
+  }
+  return scope.Close(Number::New((double) obj->capacity));
+}
+
+Handle<Value> Deque::Peek(const Arguments& args) {
+  PROFILE_METHOD(peek, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(peek, args);
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  if (obj->storage.empty()) {
+    return Undefined();
+  }
+  return scope.Close(obj->storage.front().ToValue());
+}
+
+Handle<Value> Deque::PeekBack(const Arguments& args) {
+  PROFILE_METHOD(peekBack, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(peekBack, args);
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  if (obj->storage.empty()) {
+    return Undefined();
+  }
+  return scope.Close(obj->storage.back().ToValue());
+}
+
+Handle<Value> Deque::PopBack(const Arguments& args) {
+  PROFILE_METHOD(popBack, args);
+  CHECK_ITERATING(popBack, args);
+  CHECK_WRITABLE(popBack, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(popBack, args);
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  if (obj->storage.empty()) {
+    return Undefined();
+  }
+  Element element = obj->storage.back();
+  obj->storage.pop_back();
+  Handle<Value> value = element.ToValue();
+  element.Dispose();
+  return scope.Close(value);
+}
+
+Handle<Value> Deque::PopFront(const Arguments& args) {
+  PROFILE_METHOD(popFront, args);
+  CHECK_ITERATING(popFront, args);
+  CHECK_WRITABLE(popFront, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(popFront, args);
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  if (obj->storage.empty()) {
+    return Undefined();
+  }
+  Element element = obj->storage.front();
+  obj->storage.pop_front();
+  Handle<Value> value = element.ToValue();
+  element.Dispose();
+  return scope.Close(value);
+}
+
+Handle<Value> Deque::PushBack(const Arguments& args) {
+  PROFILE_METHOD(pushBack, args);
+  CHECK_ITERATING(pushBack, args);
+  CHECK_WRITABLE(pushBack, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("pushBack(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    obj->PushBack(Element::New(args[i], &obj->backing));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> Deque::PushFront(const Arguments& args) {
+  PROFILE_METHOD(pushFront, args);
+  CHECK_ITERATING(pushFront, args);
+  CHECK_WRITABLE(pushFront, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("pushFront(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    obj->PushFront(Element::New(args[i], &obj->backing));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> Deque::Set(const Arguments& args) {
+  PROFILE_METHOD(set, args);
+  CHECK_ITERATING(set, args);
+  CHECK_WRITABLE(set, args);
+  if (args.Length() != 2 || !(args[0]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("set(index, value) takes an integer index and a value.")));
+  }
+  Deque* obj = ObjectWrap::Unwrap<Deque>(args.This());
+  uint32_t index = args[0]->Uint32Value();
+  if (index > obj->storage.size()) {
+    return ThrowException(Exception::Error(String::New("Index is greater than size of this deque.")));
+  }
+
+  HandleScope scope;
+  if (index < obj->storage.size()) {
+    Storage::iterator it = obj->storage.begin() + index;
+    it->Dispose();
+    *it = Element::New(args[1], &obj->backing);
+  } else {
+    obj->PushBack(Element::New(args[1], &obj->backing));
+  }
+  return scope.Close(args.This());
+}
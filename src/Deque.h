@@ -0,0 +1,75 @@
+#ifndef COLLECTION_DEQUE_H
+#define COLLECTION_DEQUE_H
+
+#include <deque>
+#include <node.h>
+#include "common.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class InternalDeque
+ */
+
+template < class T, class Comparator, class Alloc = allocator<T> > class InternalDeque : public deque<T, Alloc> {
+  public:
+    inline typename deque<T, Alloc>::const_iterator find(const T& value) const {
+      Comparator comparator;
+      typename deque<T, Alloc>::const_iterator it = deque<T, Alloc>::begin();
+      while (it != deque<T, Alloc>::end()) {
+        PROFILE_VISITS(1);
+        if (!comparator(*it, value) && !comparator(value, *it)) {
+          break;
+        }
+        it++;
+      }
+      return it;
+    }
+};
+
+
+/*
+ * class Deque
+ *
+ * A sequence that can be added to and removed from at both ends in constant time. Elements are kept in fixed-size
+ * blocks, so that no element is moved when the deque grows, and getting an element by index also takes constant time.
+ * A deque may be given a capacity, in which case adding an element to a full deque drops the element at the other end.
+ */
+
+class Deque : public Collection< InternalDeque<Element, ValueComparator> > {
+  public:
+    typedef InternalDeque<Element, ValueComparator> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    Deque(size_t capacity);
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    void PushBack(const Element& element);
+    void PushFront(const Element& element);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Capacity(const Arguments& args);
+    static Handle<Value> Peek(const Arguments& args);
+    static Handle<Value> PeekBack(const Arguments& args);
+    static Handle<Value> PopBack(const Arguments& args);
+    static Handle<Value> PopFront(const Arguments& args);
+    static Handle<Value> PushBack(const Arguments& args);
+    static Handle<Value> PushFront(const Arguments& args);
+    static Handle<Value> Set(const Arguments& args);
+
+  private:
+    size_t capacity;
+};
+
+#endif
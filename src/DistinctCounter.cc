@@ -0,0 +1,155 @@
+#include <cmath>
+#include <node_buffer.h>
+#include "DistinctCounter.h"
+#include "common.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class DistinctCounter
+ */
+
+Persistent<FunctionTemplate> DistinctCounter::constructor;
+
+DistinctCounter::DistinctCounter(uint32_t precision) : counter(precision) {
+}
+
+void DistinctCounter::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("DistinctCounter"));
+
+  exports->Set(String::NewSymbol("DistinctCounter"), constructor->GetFunction());
+}
+
+bool DistinctCounter::IsSupportedType(Handle<Value> value) {
+  return ValueComparator::GetTypeScore(value) > 0;
+}
+
+Handle<Value> DistinctCounter::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool isBuffer = args.Length() == 1 && Buffer::HasInstance(args[0]);
+  if (!isBuffer && (args.Length() > 1 || !(args[0]->IsUndefined() || (args[0]->IsUint32() &&
+      args[0]->Uint32Value() >= HyperLogLog::MIN_PRECISION && args[0]->Uint32Value() <= HyperLogLog::MAX_PRECISION)))) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional precision between 4 and 18, or a buffer.")));
+  }
+
+  uint32_t precision = DEFAULT_PRECISION;
+  if (args[0]->IsUint32()) {
+    precision = args[0]->Uint32Value();
+  }
+  DistinctCounter* obj = new DistinctCounter(precision);
+  obj->Wrap(args.This());
+
+  Handle<Object> thisObject = args.This();
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("merge"), FunctionTemplate::New(Merge)->GetFunction());
+  thisObject->Set(String::NewSymbol("size"), FunctionTemplate::New(Size)->GetFunction());
+  thisObject->Set(String::NewSymbol("toBuffer"), FunctionTemplate::New(ToBuffer)->GetFunction());
+
+  if (isBuffer && !obj->counter.Deserialize(Buffer::Data(args[0]), Buffer::Length(args[0]))) {
+    return ThrowException(Exception::Error(String::New("Buffer does not hold a serialized distinct counter.")));
+  }
+
+  return args.This();
+}
+
+Handle<Value> DistinctCounter::Add(const Arguments& args) {
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!IsSupportedType(args[i])) {
+      return ThrowException(Exception::Error(String::New("add(value, ...) takes only primitives, dates, arrays, sets and vectors.")));
+    }
+  }
+
+  HandleScope scope;
+  DistinctCounter* obj = ObjectWrap::Unwrap<DistinctCounter>(args.This());
+  ValueHasher hasher;
+  for (int i = 0; i < args.Length(); i++) {
+    obj->counter.Add(hasher.Hash64(args[i]));
+  }
+  return scope.Close(args.This());
+}
+
+/*
+ * Add the values of an array, or the numbers of a Float64Array, which are read directly from its memory.
+ */
+Handle<Value> DistinctCounter::AddAll(const Arguments& args) {
+  size_t length;
+  const double* numbers = args.Length() == 1 ? CollectionUtil::GetDoubles(args[0], length) : NULL;
+  if (args.Length() != 1 || !(numbers != NULL || args[0]->IsArray())) {
+    return ThrowException(Exception::Error(String::New("addAll(array) takes an array or a Float64Array.")));
+  }
+
+  HandleScope scope;
+  DistinctCounter* obj = ObjectWrap::Unwrap<DistinctCounter>(args.This());
+  ValueHasher hasher;
+  if (numbers != NULL) {
+    for (size_t i = 0; i < length; i++) {
+      obj->counter.Add(hasher.Hash64(numbers[i]));
+    }
+  } else {
+    Handle<Array> array = Handle<Array>::Cast(args[0]);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      if (!IsSupportedType(array->Get(i))) {
+        return ThrowException(Exception::Error(String::New("addAll(array) takes only primitives, dates, arrays, sets and vectors.")));
+      }
+    }
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      HandleScope scope;
+      obj->counter.Add(hasher.Hash64(array->Get(i)));
+    }
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> DistinctCounter::Clear(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
+
+  HandleScope scope;
+  DistinctCounter* obj = ObjectWrap::Unwrap<DistinctCounter>(args.This());
+  obj->counter.Clear();
+  return scope.Close(args.This());
+}
+
+Handle<Value> DistinctCounter::Merge(const Arguments& args) {
+  if (args.Length() != 1 || !constructor->HasInstance(args[0])) {
+    return ThrowException(Exception::Error(String::New("merge(counter) takes a distinct counter.")));
+  }
+
+  HandleScope scope;
+  DistinctCounter* obj = ObjectWrap::Unwrap<DistinctCounter>(args.This());
+  DistinctCounter* other = ObjectWrap::Unwrap<DistinctCounter>(Handle<Object>::Cast(args[0]));
+  if (!obj->counter.Merge(other->counter)) {
+    return ThrowException(Exception::Error(String::New("merge(counter) takes a distinct counter of the same precision.")));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> DistinctCounter::Size(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(size, args);
+
+  HandleScope scope;
+  DistinctCounter* obj = ObjectWrap::Unwrap<DistinctCounter>(args.This());
+  return scope.Close(Number::New(floor(obj->counter.Estimate() + 0.5)));
+}
+
+Handle<Value> DistinctCounter::ToBuffer(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toBuffer, args);
+
+  HandleScope scope;
+  DistinctCounter* obj = ObjectWrap::Unwrap<DistinctCounter>(args.This());
+  Buffer* buffer = Buffer::New(obj->counter.SerializedSize());
+  obj->counter.Serialize(Buffer::Data(buffer->handle_));
+  return scope.Close(buffer->handle_);
+}
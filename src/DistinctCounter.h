@@ -0,0 +1,44 @@
+#ifndef COLLECTION_DISTINCT_COUNTER_H
+#define COLLECTION_DISTINCT_COUNTER_H
+
+#include <node.h>
+#include "HyperLogLog.h"
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class DistinctCounter
+ *
+ * Estimates the number of distinct values added, in a fixed amount of memory. Values are hashed with
+ * ValueHasher::Hash64, so values that are equal in a set are counted once.
+ */
+
+class DistinctCounter : public ObjectWrap {
+  public:
+    static void Init(Handle<Object> exports);
+
+    static Persistent<FunctionTemplate> constructor;
+
+  protected:
+    static const uint32_t DEFAULT_PRECISION = 14;
+
+    explicit DistinctCounter(uint32_t precision);
+
+    static bool IsSupportedType(Handle<Value> value);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> Clear(const Arguments& args);
+    static Handle<Value> Merge(const Arguments& args);
+    static Handle<Value> Size(const Arguments& args);
+    static Handle<Value> ToBuffer(const Arguments& args);
+
+    HyperLogLog counter;
+};
+
+#endif
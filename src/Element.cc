@@ -0,0 +1,335 @@
+#include <cstdlib>
+#include <cstring>
+#include "common.h"
+#include "Element.h"
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class Atom
+ */
+
+Atom** Atom::buckets = NULL;
+size_t Atom::bucketCount = 0;
+size_t Atom::atomCount = 0;
+
+Atom::Atom(const char* data, size_t length, uint32_t hash, bool interned) : length(length), hash(hash), refs(1),
+    interned(interned), next(NULL) {
+  this->data = static_cast<char*>(malloc(length + 1));
+  memcpy(this->data, data, length);
+  this->data[length] = '\0';
+}
+
+Atom::~Atom() {
+  free(data);
+}
+
+Atom* Atom::Intern(const char* data, size_t length) {
+  uint32_t hash = Hash(data, length);
+  if (bucketCount > 0) {
+    Atom* atom = buckets[hash & (bucketCount - 1)];
+    while (atom != NULL) {
+      if (atom->hash == hash && atom->length == length && memcmp(atom->data, data, length) == 0) {
+        atom->Ref();
+        return atom;
+      }
+      atom = atom->next;
+    }
+  }
+
+  if (atomCount >= bucketCount) {
+    Grow();
+  }
+  Atom* atom = new Atom(data, length, hash, true);
+  Atom** bucket = &buckets[hash & (bucketCount - 1)];
+  atom->next = *bucket;
+  *bucket = atom;
+  atomCount++;
+  return atom;
+}
+
+Atom* Atom::New(const char* data, size_t length) {
+  return new Atom(data, length, Hash(data, length), false);
+}
+
+void Atom::Ref() {
+  refs++;
+}
+
+void Atom::Release() {
+  if (--refs > 0) {
+    return;
+  }
+  if (interned) {
+    Atom** link = &buckets[hash & (bucketCount - 1)];
+    while (*link != this) {
+      link = &(*link)->next;
+    }
+    *link = next;
+    atomCount--;
+  }
+  delete this;
+}
+
+int Atom::Compare(const Atom* other) const {
+  if (this == other) {
+    return 0;
+  }
+  size_t min = length < other->length ? length : other->length;
+  int result = memcmp(data, other->data, min);
+  if (result != 0) {
+    return result;
+  }
+  return length < other->length ? -1 : (length > other->length ? 1 : 0);
+}
+
+uint32_t Atom::Hash(const char* data, size_t length) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char) data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void Atom::Grow() {
+  size_t newCount = bucketCount == 0 ? 1024 : bucketCount * 2;
+  Atom** newBuckets = static_cast<Atom**>(calloc(newCount, sizeof(Atom*)));
+  for (size_t i = 0; i < bucketCount; i++) {
+    Atom* atom = buckets[i];
+    while (atom != NULL) {
+      Atom* next = atom->next;
+      Atom** bucket = &newBuckets[atom->hash & (newCount - 1)];
+      atom->next = *bucket;
+      *bucket = atom;
+      atom = next;
+    }
+  }
+  free(buckets);
+  buckets = newBuckets;
+  bucketCount = newCount;
+}
+
+
+/*
+ * class BackingStore
+ */
+
+BackingStore::BackingStore() : length(0) {
+}
+
+BackingStore::~BackingStore() {
+  Clear();
+}
+
+uint32_t BackingStore::Add(Handle<Value> value) {
+  if (array.IsEmpty()) {
+    array = Persistent<Array>::New(Array::New());
+  }
+  uint32_t slot;
+  if (freeSlots.empty()) {
+    slot = length++;
+  } else {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  }
+  array->Set(slot, value);
+  return slot;
+}
+
+Local<Value> BackingStore::Get(uint32_t slot) const {
+  return array->Get(slot);
+}
+
+void BackingStore::Release(uint32_t slot) {
+  if (array.IsEmpty()) {
+    return;
+  }
+  freeSlots.push_back(slot);
+  if (freeSlots.size() == length) {
+    Clear();
+  } else {
+    array->Set(slot, Undefined());
+  }
+}
+
+void BackingStore::Clear() {
+  if (!array.IsEmpty()) {
+    array.Dispose();
+    array.Clear();
+  }
+  length = 0;
+  freeSlots.clear();
+}
+
+
+/*
+ * class Element
+ */
+
+Element::Element() : type(0), borrowed(false), slot(0) {
+  data.object = NULL;
+}
+
+Element Element::New(Handle<Value> value, BackingStore* backing) {
+  Element element;
+  element.type = ValueComparator::GetTypeScore(value);
+  switch (element.type) {
+    case 0:
+    case 1:
+    case 2:
+      break;
+    case 4:
+      element.data.boolean = value->BooleanValue();
+      break;
+    case 5:
+    case 6:
+    case 8:
+      element.data.number = value->NumberValue();
+      break;
+    case 9:
+      element.data.number = Handle<Date>::Cast(value)->NumberValue();
+      break;
+    case 11: {
+      String::Utf8Value utf8(value);
+      element.data.string = Atom::Intern(*utf8, utf8.length());
+      break;
+    }
+    default:
+      element.data.backing = backing;
+      element.slot = backing->Add(value);
+      break;
+  }
+  return element;
+}
+
+/*
+ * Create the element of a number without creating a V8 value. The type is the one GetTypeScore() gives the number.
+ */
+Element Element::New(uint32_t value) {
+  Element element;
+  element.type = value <= 0x7fffffff ? 5 : 6;
+  element.data.number = value;
+  return element;
+}
+
+/*
+ * Create the element of a number in the same way as New(uint32_t). Like Value::IsInt32(), -0 is not an Int32.
+ */
+Element Element::NewNumber(double value) {
+  Element element;
+  if (value >= -2147483648.0 && value <= 2147483647.0 && value == (int32_t) value && !(value == 0 && 1 / value < 0)) {
+    element.type = 5;
+  } else if (value >= 0 && value <= 4294967295.0 && value == (uint32_t) value) {
+    element.type = 6;
+  } else {
+    element.type = 8;
+  }
+  element.data.number = value;
+  return element;
+}
+
+Element Element::NewBoolean(bool value) {
+  Element element;
+  element.type = 4;
+  element.data.boolean = value;
+  return element;
+}
+
+Element Element::Copy(BackingStore* backing) const {
+  if (type == 11) {
+    data.string->Ref();
+  } else if (!IsPrimitive()) {
+    return New(ToValue(), backing);
+  }
+  return *this;
+}
+
+Element Element::Move(BackingStore* backing) const {
+  if (!IsPrimitive()) {
+    return New(ToValue(), backing);
+  }
+  return *this;
+}
+
+void Element::Dispose() {
+  if (type == 11) {
+    data.string->Release();
+  } else if (!IsPrimitive() && !borrowed) {
+    data.backing->Release(slot);
+  }
+  type = 0;
+  data.object = NULL;
+}
+
+Handle<Value> Element::ToValue() const {
+  switch (type) {
+    case 0:
+      return Handle<Value>();
+    case 1:
+      return Undefined();
+    case 2:
+      return Null();
+    case 4:
+      return Boolean::New(data.boolean);
+    case 5:
+    case 6:
+    case 8:
+      return Number::New(data.number);
+    case 9:
+      return Date::New(data.number);
+    case 11:
+      return String::New(data.string->data, (int) data.string->length);
+    default:
+      if (borrowed) {
+        return Handle<Value>(data.object);
+      }
+      return data.backing->Get(slot);
+  }
+}
+
+bool Element::IsPrimitiveType(int type) {
+  switch (type) {
+    case 0:
+    case 1:
+    case 2:
+    case 4:
+    case 5:
+    case 6:
+    case 8:
+    case 9:
+    case 11:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+/*
+ * class ElementProbe
+ */
+
+ElementProbe::ElementProbe(Handle<Value> value) {
+  int typeScore = ValueComparator::GetTypeScore(value);
+  if (typeScore == 11) {
+    String::Utf8Value utf8(value);
+    data.string = Atom::New(*utf8, utf8.length());
+  } else if (IsPrimitiveType(typeScore)) {
+    Element::operator=(Element::New(value, NULL));
+  } else {
+    data.object = *value;
+  }
+  type = typeScore;
+  borrowed = true;
+}
+
+ElementProbe::~ElementProbe() {
+  if (type == 11) {
+    data.string->Release();
+  }
+}
@@ -0,0 +1,192 @@
+#ifndef COLLECTION_ELEMENT_H
+#define COLLECTION_ELEMENT_H
+
+#include <stdint.h>
+#include <vector>
+#include <node.h>
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class Atom
+ *
+ * UTF-8 bytes of a string, interned in a process-wide table so that equal strings held by collections share storage.
+ */
+
+class Atom {
+  public:
+    static Atom* Intern(const char* data, size_t length);
+    static Atom* New(const char* data, size_t length);
+
+    void Ref();
+    void Release();
+
+    int Compare(const Atom* other) const;
+
+    static uint32_t Hash(const char* data, size_t length);
+
+    size_t length;
+    uint32_t hash;
+    char* data;
+
+  private:
+    Atom(const char* data, size_t length, uint32_t hash, bool interned);
+    ~Atom();
+
+    static void Grow();
+
+    size_t refs;
+    bool interned;
+    Atom* next;
+
+    static Atom** buckets;
+    static size_t bucketCount;
+    static size_t atomCount;
+};
+
+
+/*
+ * class BackingStore
+ *
+ * Slots of a V8 array that keep the non-primitive elements of one collection alive. The collection holds a single
+ * persistent handle to the array, created when the first slot is taken, however many objects it contains. Released
+ * slots are reused before the array grows.
+ */
+
+class BackingStore {
+  public:
+    BackingStore();
+    ~BackingStore();
+
+    uint32_t Add(Handle<Value> value);
+    Local<Value> Get(uint32_t slot) const;
+    void Release(uint32_t slot);
+    void Clear();
+
+    inline bool IsEmpty() const {
+      return length == 0;
+    }
+
+  private:
+    BackingStore(const BackingStore& other);
+    BackingStore& operator=(const BackingStore& other);
+
+    Persistent<Array> array;
+    uint32_t length;
+    vector<uint32_t> freeSlots;
+};
+
+
+/*
+ * class Element
+ *
+ * A value held by a collection. Primitive values (undefined, null, booleans, numbers, dates and strings) are stored
+ * natively, so that a collection of primitives holds no V8 handle at all, and a JavaScript value is only created
+ * when an element is returned. Other values are kept in a slot of the collection's backing store.
+ *
+ * Elements are copied shallowly. Dispose() releases what an element owns.
+ */
+
+class Element {
+  public:
+    Element();
+
+    static Element New(Handle<Value> value, BackingStore* backing);
+    static Element New(uint32_t value);
+    static Element NewNumber(double value);
+    static Element NewBoolean(bool value);
+    Element Copy(BackingStore* backing) const;
+
+    /*
+     * The element to hold in another collection in place of this one, which is not disposed. A primitive value passes
+     * as it is; any other value takes a slot of the new backing store, and its old slot is left to the old one.
+     */
+    Element Move(BackingStore* backing) const;
+
+    void Dispose();
+
+    Handle<Value> ToValue() const;
+
+    inline bool IsEmpty() const {
+      return type == 0;
+    }
+
+    inline bool IsPrimitive() const {
+      return IsPrimitiveType(type);
+    }
+
+    inline int GetTypeScore() const {
+      return type;
+    }
+
+    inline bool BooleanValue() const {
+      return data.boolean;
+    }
+
+    inline bool IsNumber() const {
+      return type == 5 || type == 6 || type == 8;
+    }
+
+    inline double NumberValue() const {
+      return data.number;
+    }
+
+    /*
+     * Whether this element is a number that is an unsigned 32-bit integer, as tested by Value::IsUint32().
+     */
+    inline bool IsUint32() const {
+      return (type == 5 || type == 6) && data.number >= 0;
+    }
+
+    inline uint32_t Uint32Value() const {
+      return (uint32_t) data.number;
+    }
+
+    inline bool IsString() const {
+      return type == 11;
+    }
+
+    inline const Atom* StringValue() const {
+      return data.string;
+    }
+
+    static bool IsPrimitiveType(int type);
+
+  protected:
+    union {
+      bool boolean;
+      double number;
+      Atom* string;
+      Value* object;
+      BackingStore* backing;
+    } data;
+    signed char type;
+    bool borrowed;
+    uint32_t slot;
+
+    friend class ValueComparator;
+    friend class ValueHasher;
+};
+
+
+/*
+ * class ElementProbe
+ *
+ * An element that refers to a value without owning it, used to look up a value in a collection without creating a
+ * persistent handle or interning a string. It must not outlive the value it is created from.
+ */
+
+class ElementProbe : public Element {
+  public:
+    explicit ElementProbe(Handle<Value> value);
+    ~ElementProbe();
+
+  private:
+    ElementProbe(const ElementProbe& other);
+    ElementProbe& operator=(const ElementProbe& other);
+};
+
+#endif
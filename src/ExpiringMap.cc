@@ -0,0 +1,415 @@
+#include <cmath>
+#include "ExpiringMap.h"
+#include "Map.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class ExpiringMap
+ */
+
+ExpiringMap::ExpiringMap(double ttl) : ttl(ttl), origin(uv_hrtime()), timer(NULL) {
+}
+
+ExpiringMap::~ExpiringMap() {
+  if (timer != NULL) {
+    uv_timer_stop(timer);
+    timer->data = NULL;
+    uv_close(reinterpret_cast<uv_handle_t*>(timer), OnClose);
+  }
+  if (!onExpire.IsEmpty()) {
+    onExpire.Dispose();
+  }
+
+  // The wheel is destroyed before the entries, which would otherwise unlink themselves from it.
+  Storage::iterator it = storage.begin();
+  while (it != storage.end()) {
+    (it++).node->link.Unlink();
+  }
+}
+
+Handle<Value> ExpiringMap::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  Handle<Value> parameters[2];
+  parameters[0] = value.first.ToValue();
+  parameters[1] = value.second.ToValue();
+  Local<Object> object = MapEntry::constructor->GetFunction()->NewInstance(2, parameters);
+  return scope.Close(object);
+}
+
+void ExpiringMap::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("ExpiringMap"));
+
+  exports->Set(String::NewSymbol("ExpiringMap"), constructor->GetFunction());
+}
+
+void ExpiringMap::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("expire"), FunctionTemplate::New(Expire)->GetFunction());
+  thisObject->Set(String::NewSymbol("get"), FunctionTemplate::New(Get)->GetFunction());
+  thisObject->Set(String::NewSymbol("getAt"), FunctionTemplate::New(GetAt)->GetFunction());
+  thisObject->Set(String::NewSymbol("keys"), FunctionTemplate::New(Keys)->GetFunction());
+  thisObject->Set(String::NewSymbol("refresh"), FunctionTemplate::New(Refresh)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("set"), FunctionTemplate::New(Set)->GetFunction());
+  thisObject->Set(String::NewSymbol("toObject"), FunctionTemplate::New(ToObject)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+  thisObject->Set(String::NewSymbol("ttl"), FunctionTemplate::New(Ttl)->GetFunction());
+
+  // Methods inherited from Collection must not see entries that have expired.
+  thisObject->Set(String::NewSymbol("equals"), FunctionTemplate::New(Expiring<Equals>)->GetFunction());
+  thisObject->Set(String::NewSymbol("has"), FunctionTemplate::New(Expiring<Has>)->GetFunction());
+  thisObject->Set(String::NewSymbol("isEmpty"), FunctionTemplate::New(Expiring<IsEmpty>)->GetFunction());
+  thisObject->Set(String::NewSymbol("removeAt"), FunctionTemplate::New(Expiring<RemoveAt>)->GetFunction());
+  thisObject->Set(String::NewSymbol("removeLast"), FunctionTemplate::New(Expiring<RemoveLast>)->GetFunction());
+  thisObject->Set(String::NewSymbol("removeRange"), FunctionTemplate::New(Expiring<RemoveRange>)->GetFunction());
+  thisObject->Set(String::NewSymbol("size"), FunctionTemplate::New(Expiring<Size>)->GetFunction());
+  thisObject->Set(String::NewSymbol("toArray"), FunctionTemplate::New(Expiring<ToArray>)->GetFunction());
+
+  thisObject->Set(String::NewSymbol("each"), FunctionTemplate::New(Expiring<Each>)->GetFunction());
+  thisObject->Set(String::NewSymbol("filter"), FunctionTemplate::New(Expiring<Filter>)->GetFunction());
+  thisObject->Set(String::NewSymbol("find"), FunctionTemplate::New(Expiring<Find>)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduce"), FunctionTemplate::New(Expiring<Reduce>)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduceRight"), FunctionTemplate::New(Expiring<ReduceRight>)->GetFunction());
+}
+
+void ExpiringMap::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (argument->IsObject()) {
+    Handle<Object> options = Handle<Object>::Cast(argument);
+    Handle<Value> callback = options->Get(String::NewSymbol("onExpire"));
+    if (callback->IsFunction()) {
+      onExpire = Persistent<Function>::New(Handle<Function>::Cast(callback));
+    }
+    Handle<Value> interval = options->Get(String::NewSymbol("interval"));
+    if (interval->IsUint32()) {
+      // The timer does not keep the process alive; it is stopped when the map is garbage collected.
+      timer = new uv_timer_t;
+      uv_timer_init(uv_default_loop(), timer);
+      timer->data = this;
+      uv_timer_start(timer, OnTimer, interval->Uint32Value(), interval->Uint32Value());
+      uv_unref(reinterpret_cast<uv_handle_t*>(timer));
+    }
+  }
+}
+
+bool ExpiringMap::IsSupportedObject(Handle<Value> value) {
+  return value->IsObject();
+}
+
+bool ExpiringMap::IsSupportedType(Handle<Value> value) {
+  return IsSupportedObject(value);
+}
+
+/*
+ * Remove the entries that have expired, and pass them to the expiry callback. Return false if the callback threw an
+ * exception, which is then pending. Nothing is removed while the map is being iterated.
+ */
+bool ExpiringMap::RemoveExpired(bool fromTimer) {
+  if (IsIterating()) {
+    return true;
+  }
+  vector<Storage::Node*> expired;
+  wheel.Advance((uint64_t) Now(), expired);
+  if (expired.empty()) {
+    return true;
+  }
+
+  HandleScope scope;
+  version++;
+  bool notify = !onExpire.IsEmpty();
+  Local<Array> entries;
+  if (notify) {
+    entries = Array::New((int) expired.size());
+  }
+  for (size_t i = 0; i < expired.size(); i++) {
+    Storage::iterator it(expired[i]);
+    if (notify) {
+      entries->Set((uint32_t) i, GetValue(*it));
+    }
+    Element key = it->first;
+    Element value = it->second;
+    storage.erase(it);
+    key.Dispose();
+    value.Dispose();
+  }
+  if (!notify) {
+    return true;
+  }
+
+  // The callback must not modify this map while expired entries are being handed over.
+  Handle<Value> parameters[1];
+  parameters[0] = entries;
+  iterationLevel++;
+  if (fromTimer) {
+    MakeCallback(handle_, onExpire, 1, parameters);
+    iterationLevel--;
+    return true;
+  }
+  TryCatch tryCatch;
+  Handle<Value> result = onExpire->Call(Context::GetCurrent()->Global(), 1, parameters);
+  iterationLevel--;
+  if (result.IsEmpty()) {
+    ThrowException(tryCatch.Exception());
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Milliseconds since the map was created.
+ */
+double ExpiringMap::Now() const {
+  return (uv_hrtime() - origin) / 1e6;
+}
+
+void ExpiringMap::Schedule(Storage::iterator it, double ttl) {
+  if (isinf(ttl)) {
+    it.node->link.Unlink();
+  } else {
+    wheel.Schedule(it.node, (uint64_t) ceil(Now() + ttl));
+  }
+}
+
+void ExpiringMap::OnTimer(uv_timer_t* handle, int status) {
+  ExpiringMap* obj = static_cast<ExpiringMap*>(handle->data);
+  if (obj != NULL) {
+    HandleScope scope;
+    obj->RemoveExpired(true);
+  }
+}
+
+void ExpiringMap::OnClose(uv_handle_t* handle) {
+  delete reinterpret_cast<uv_timer_t*>(handle);
+}
+
+Handle<Value> ExpiringMap::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool argError = true;
+  if (args.Length() >= 1 && args.Length() <= 2 && args[0]->IsNumber() && args[0]->NumberValue() > 0) {
+    if (args[1]->IsUndefined()) {
+      argError = false;
+    } else if (args[1]->IsObject()) {
+      Handle<Object> options = Handle<Object>::Cast(args[1]);
+      Handle<Value> callback = options->Get(String::NewSymbol("onExpire"));
+      Handle<Value> interval = options->Get(String::NewSymbol("interval"));
+      argError = (!(callback->IsUndefined()) && !(callback->IsFunction())) ||
+          (!(interval->IsUndefined()) && !(interval->IsUint32() && interval->Uint32Value() > 0));
+    }
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Arguments must be a positive time to live in milliseconds and optional options {onExpire: function, interval: integer}.")));
+  }
+
+  ExpiringMap* obj = new ExpiringMap(args[0]->NumberValue());
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[1]);
+
+  return args.This();
+}
+
+Handle<Value> ExpiringMap::Expire(const Arguments& args) {
+  PROFILE_METHOD(expire, args);
+  CHECK_ITERATING(expire, args);
+  CHECK_WRITABLE(expire, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(expire, args);
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> ExpiringMap::Get(const Arguments& args) {
+  PROFILE_METHOD(get, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("get(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return Undefined();
+  }
+  // During iteration, expired entries are still in the map.
+  if (it.node->link.IsLinked() && it.node->link.tick <= obj->Now()) {
+    return Undefined();
+  }
+  return scope.Close(it->second.ToValue());
+}
+
+Handle<Value> ExpiringMap::GetAt(const Arguments& args) {
+  PROFILE_METHOD(getAt, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("getAt(index, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    Handle<Value> arg = args[i];
+    if (!(arg->IsUndefined()) && !(arg->IsNull()) && !(arg->IsUint32())) {
+      return ThrowException(Exception::Error(String::New("getAt(index, ...) takes only integer arguments.")));
+    }
+  }
+
+  return Expiring<Collection<Storage>::Get>(args);
+}
+
+Handle<Value> ExpiringMap::Keys(const Arguments& args) {
+  PROFILE_METHOD(keys, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(keys, args);
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  Local<Array> array = Array::New((int) obj->storage.size());
+  Storage::iterator it = obj->storage.begin();
+  int i = 0;
+  while (it != obj->storage.end()) {
+    array->Set(i++, (it++)->first.ToValue());
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> ExpiringMap::Refresh(const Arguments& args) {
+  PROFILE_METHOD(refresh, args);
+  if (args.Length() < 1 || args.Length() > 2 ||
+      (args.Length() == 2 && !(args[1]->IsNumber() && args[1]->NumberValue() > 0))) {
+    return ThrowException(Exception::Error(String::New("refresh(key, ttl) takes a key and an optional positive time to live.")));
+  }
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return scope.Close(Boolean::New(false));
+  }
+  obj->Schedule(it, args.Length() == 2 ? args[1]->NumberValue() : obj->ttl);
+  return scope.Close(Boolean::New(true));
+}
+
+Handle<Value> ExpiringMap::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(key, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.find(probe);
+    if (it != obj->storage.end()) {
+      Element key = it->first;
+      Element value = it->second;
+      obj->storage.erase(it);
+      key.Dispose();
+      value.Dispose();
+    }
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> ExpiringMap::Set(const Arguments& args) {
+  PROFILE_METHOD(set, args);
+  CHECK_ITERATING(set, args);
+  CHECK_WRITABLE(set, args);
+  if (args.Length() < 2 || args.Length() > 3 ||
+      (args.Length() == 3 && !(args[2]->IsNumber() && args[2]->NumberValue() > 0))) {
+    return ThrowException(Exception::Error(String::New("set(key, value, ttl) takes a key, a value and an optional positive time to live.")));
+  }
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    it = obj->storage.push_back(Storage::value_type(Element::New(args[0], &obj->backing),
+        Element::New(args[1], &obj->backing)));
+  } else {
+    it->second.Dispose();
+    it->second = Element::New(args[1], &obj->backing);
+  }
+  obj->Schedule(it, args.Length() == 3 ? args[2]->NumberValue() : obj->ttl);
+  return scope.Close(args.This());
+}
+
+Handle<Value> ExpiringMap::ToObject(const Arguments& args) {
+  PROFILE_METHOD(toObject, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  Local<Object> result = Object::New();
+  Storage::iterator it = obj->storage.begin();
+  while (it != obj->storage.end()) {
+    result->Set(it->first.ToValue(), it->second.ToValue());
+    it++;
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> ExpiringMap::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
+
+  HandleScope scope;
+  return scope.Close(CollectionUtil::Stringify(ToObject(args)));
+}
+
+Handle<Value> ExpiringMap::Ttl(const Arguments& args) {
+  PROFILE_METHOD(ttl, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("ttl(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+  if (!obj->RemoveExpired(false)) {
+    return Undefined();
+  }
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return Undefined();
+  }
+  if (!(it.node->link.IsLinked())) {
+    return scope.Close(Number::New(INFINITY));
+  }
+  double remaining = it.node->link.tick - obj->Now();
+  return scope.Close(Number::New(remaining > 0 ? remaining : 0));
+}
@@ -0,0 +1,90 @@
+#ifndef COLLECTION_EXPIRING_MAP_H
+#define COLLECTION_EXPIRING_MAP_H
+
+#include <vector>
+#include <node.h>
+#include <uv.h>
+#include "common.h"
+#include "LinkedHashMap.h"
+#include "TimerWheel.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class ExpiryLink
+ *
+ * Schedules an entry of an ExpiringMap in the timer wheel of the map.
+ */
+
+struct ExpiryLink : public TimerLink< LinkedHashNode<ExpiryLink> > {
+};
+
+
+/*
+ * class ExpiringMap
+ *
+ * A map whose entries expire after a time to live. Entries are kept in a hash table in the order they were added,
+ * and are scheduled in a timer wheel with a resolution of one millisecond. The wheel is advanced whenever the map is
+ * accessed, and optionally by a timer, so that expired entries are removed in amortized constant time each. Entries
+ * that expire together are passed to the expiry callback in one batch.
+ */
+
+class ExpiringMap : public Collection< LinkedHashMap<ExpiryLink> > {
+  public:
+    typedef LinkedHashMap<ExpiryLink> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    ExpiringMap(double ttl);
+    virtual ~ExpiringMap();
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    bool RemoveExpired(bool fromTimer);
+    double Now() const;
+    void Schedule(Storage::iterator it, double ttl);
+
+    static void OnTimer(uv_timer_t* handle, int status);
+    static void OnClose(uv_handle_t* handle);
+
+    /*
+     * Call a method of Collection after removing the entries that have expired.
+     */
+    template <Handle<Value> (*method)(const Arguments&)> static Handle<Value> Expiring(const Arguments& args) {
+      ExpiringMap* obj = ObjectWrap::Unwrap<ExpiringMap>(args.This());
+      if (!obj->RemoveExpired(false)) {
+        return Undefined();
+      }
+      return method(args);
+    }
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Expire(const Arguments& args);
+    static Handle<Value> Get(const Arguments& args);
+    static Handle<Value> GetAt(const Arguments& args);
+    static Handle<Value> Keys(const Arguments& args);
+    static Handle<Value> Refresh(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> Set(const Arguments& args);
+    static Handle<Value> ToObject(const Arguments& args);
+    static Handle<Value> ToString(const Arguments& args);
+    static Handle<Value> Ttl(const Arguments& args);
+
+  private:
+    double ttl;
+    uint64_t origin;
+    TimerWheel<Storage::Node> wheel;
+    uv_timer_t* timer;
+    Persistent<Function> onExpire;
+};
+
+#endif
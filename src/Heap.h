@@ -0,0 +1,416 @@
+#ifndef COLLECTION_HEAP_H
+#define COLLECTION_HEAP_H
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <node.h>
+#include "common.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class Heap
+ *
+ * A 4-ary min-heap of elements. The heap array holds only the priority of each element, the order in which it was
+ * pushed, and its index in a separate table of elements, so that the four children of a node share a cache line and
+ * are compared without touching the elements. Elements are ordered either by a numeric priority given with each of
+ * them, or by ValueComparator; elements of equal priority come out in the order they were pushed.
+ *
+ * Elements are identified by an id that stays the same while they move in the heap. An id is reused once its element
+ * is removed; ToHandle() combines it with a generation count, so that a handle of a removed element is never taken for
+ * one of a later element.
+ */
+
+class Heap {
+  public:
+    typedef Element value_type;
+    typedef size_t size_type;
+
+    static const uint32_t NONE = 0xffffffff;
+
+    template <class T> class Iterator : public std::iterator<bidirectional_iterator_tag, T> {
+      public:
+        Iterator() : heap(NULL), index(0) {
+        }
+
+        Iterator(Heap* heap, size_t index) : heap(heap), index(index) {
+        }
+
+        template <class U> Iterator(const Iterator<U>& other) : heap(other.heap), index(other.index) {
+        }
+
+        inline T& operator*() const {
+          return heap->items[heap->entries[index].id].element;
+        }
+
+        inline T* operator->() const {
+          return &**this;
+        }
+
+        inline Iterator& operator++() {
+          index++;
+          return *this;
+        }
+
+        inline Iterator operator++(int) {
+          Iterator result = *this;
+          index++;
+          return result;
+        }
+
+        inline Iterator& operator--() {
+          index--;
+          return *this;
+        }
+
+        inline Iterator operator--(int) {
+          Iterator result = *this;
+          index--;
+          return result;
+        }
+
+        inline bool operator==(const Iterator& other) const {
+          return index == other.index;
+        }
+
+        inline bool operator!=(const Iterator& other) const {
+          return index != other.index;
+        }
+
+        Heap* heap;
+        size_t index;
+    };
+
+    typedef Iterator<Element> iterator;
+    typedef Iterator<const Element> const_iterator;
+
+    Heap() : numeric(false), sequence(0) {
+    }
+
+    inline iterator begin() {
+      return iterator(this, 0);
+    }
+
+    inline const_iterator begin() const {
+      return const_iterator(const_cast<Heap*>(this), 0);
+    }
+
+    inline iterator end() {
+      return iterator(this, entries.size());
+    }
+
+    inline const_iterator end() const {
+      return const_iterator(const_cast<Heap*>(this), entries.size());
+    }
+
+    inline size_type size() const {
+      return entries.size();
+    }
+
+    inline bool empty() const {
+      return entries.empty();
+    }
+
+    const_iterator find(const Element& element) const {
+      ValueComparator comparator;
+      for (size_t i = 0; i < entries.size(); i++) {
+        PROFILE_VISITS(1);
+        const Element& other = items[entries[i].id].element;
+        if (!comparator(other, element) && !comparator(element, other)) {
+          return const_iterator(const_cast<Heap*>(this), i);
+        }
+      }
+      return end();
+    }
+
+    void erase(iterator it) {
+      Remove(entries[it.index].id);
+    }
+
+    void erase(iterator first, iterator last) {
+      vector<uint32_t> ids;
+      for (size_t i = first.index; i < last.index; i++) {
+        ids.push_back(entries[i].id);
+      }
+      for (size_t i = 0; i < ids.size(); i++) {
+        Remove(ids[i]);
+      }
+    }
+
+    void clear() {
+      for (size_t i = 0; i < entries.size(); i++) {
+        Item& item = items[entries[i].id];
+        item.element = Element();
+        item.position = NONE;
+        item.generation++;
+        freeIds.push_back(entries[i].id);
+      }
+      entries.clear();
+    }
+
+    /*
+     * Whether elements are ordered by the priorities given with them rather than by ValueComparator.
+     */
+    inline bool IsNumeric() const {
+      return numeric;
+    }
+
+    inline void SetNumeric(bool numeric) {
+      this->numeric = numeric;
+    }
+
+    /*
+     * Add an element owned by the caller, and return its id. With `order` false, the heap is left unordered until
+     * Order() is called, which restores it in linear time.
+     */
+    uint32_t Push(const Element& element, double priority, bool order = true) {
+      uint32_t id;
+      if (freeIds.empty()) {
+        id = (uint32_t) items.size();
+        items.push_back(Item());
+      } else {
+        id = freeIds.back();
+        freeIds.pop_back();
+      }
+      items[id].element = element;
+      items[id].position = (uint32_t) entries.size();
+
+      Entry entry;
+      entry.priority = priority;
+      entry.sequence = sequence++;
+      entry.id = id;
+      entries.push_back(entry);
+      if (order) {
+        SiftUp(entries.size() - 1);
+      }
+      return id;
+    }
+
+    void Order() {
+      if (entries.size() > 1) {
+        for (size_t i = (entries.size() - 2) / ARITY + 1; i > 0; i--) {
+          SiftDown(i - 1);
+        }
+      }
+    }
+
+    inline uint32_t Top() const {
+      return entries[0].id;
+    }
+
+    inline const Element& Get(uint32_t id) const {
+      return items[id].element;
+    }
+
+    inline double GetPriority(uint32_t id) const {
+      return entries[items[id].position].priority;
+    }
+
+    /*
+     * Whether an element of the given priority would be ordered before the top of the heap.
+     */
+    bool PrecedesTop(const Element& element, double priority) const {
+      const Entry& top = entries[0];
+      if (numeric) {
+        return priority < top.priority;
+      }
+      ValueComparator comparator;
+      return comparator(element, items[top.id].element);
+    }
+
+    /*
+     * Replace the top element with an element owned by the caller, and return the old top element, which is then
+     * owned by the caller.
+     */
+    Element ReplaceTop(const Element& element, double priority) {
+      Entry& top = entries[0];
+      Element result = items[top.id].element;
+      items[top.id].element = element;
+      top.priority = priority;
+      top.sequence = sequence++;
+      SiftDown(0);
+      return result;
+    }
+
+    /*
+     * Remove an element, which is then owned by the caller.
+     */
+    Element Remove(uint32_t id) {
+      Element result = items[id].element;
+      size_t position = items[id].position;
+      size_t last = entries.size() - 1;
+      if (position != last) {
+        Place(position, entries[last]);
+        entries.pop_back();
+        Reorder(position);
+      } else {
+        entries.pop_back();
+      }
+      items[id].element = Element();
+      items[id].position = NONE;
+      items[id].generation++;
+      freeIds.push_back(id);
+      return result;
+    }
+
+    void Update(uint32_t id, double priority) {
+      size_t position = items[id].position;
+      entries[position].priority = priority;
+      Reorder(position);
+    }
+
+    /*
+     * Restore the order after the element with the given id was changed in place.
+     */
+    void Restore(uint32_t id) {
+      Reorder(items[id].position);
+    }
+
+    /*
+     * Get the ids of all elements in the order they would be popped.
+     */
+    void Sort(vector<uint32_t>& ids) const {
+      vector<Entry> sorted(entries);
+      sort(sorted.begin(), sorted.end(), EntryLess(this));
+      ids.reserve(sorted.size());
+      for (size_t i = 0; i < sorted.size(); i++) {
+        ids.push_back(sorted[i].id);
+      }
+    }
+
+    /*
+     * Convert between ids and handles given out to JavaScript. Handles are integers below 2^53.
+     */
+    inline double ToHandle(uint32_t id) const {
+      return (double) (items[id].generation & GENERATION_MASK) * 4294967296.0 + id;
+    }
+
+    uint32_t FromHandle(double handle) const {
+      if (!(handle >= 0) || handle >= 9007199254740992.0) {
+        return NONE;
+      }
+      uint64_t value = (uint64_t) handle;
+      uint32_t id = (uint32_t) value;
+      uint32_t generation = (uint32_t) (value >> 32);
+      if (id >= items.size() || items[id].position == NONE ||
+          (items[id].generation & GENERATION_MASK) != generation) {
+        return NONE;
+      }
+      return id;
+    }
+
+  private:
+    static const size_t ARITY = 4;
+    static const uint32_t GENERATION_MASK = (1 << 21) - 1;
+
+    struct Entry {
+      double priority;
+      uint32_t sequence;
+      uint32_t id;
+    };
+
+    struct Item {
+      Item() : position(NONE), generation(0) {
+      }
+
+      Element element;
+      uint32_t position;
+      uint32_t generation;
+    };
+
+    struct EntryLess {
+      explicit EntryLess(const Heap* heap) : heap(heap) {
+      }
+
+      inline bool operator()(const Entry& entry1, const Entry& entry2) const {
+        return heap->Less(entry1, entry2);
+      }
+
+      const Heap* heap;
+    };
+
+    inline bool Less(const Entry& entry1, const Entry& entry2) const {
+      if (numeric) {
+        if (entry1.priority != entry2.priority) {
+          return entry1.priority < entry2.priority;
+        }
+      } else {
+        ValueComparator comparator;
+        const Element& element1 = items[entry1.id].element;
+        const Element& element2 = items[entry2.id].element;
+        if (comparator(element1, element2)) {
+          return true;
+        } else if (comparator(element2, element1)) {
+          return false;
+        }
+      }
+      return entry1.sequence < entry2.sequence;
+    }
+
+    inline void Place(size_t position, const Entry& entry) {
+      entries[position] = entry;
+      items[entry.id].position = (uint32_t) position;
+    }
+
+    void Reorder(size_t position) {
+      if (position > 0 && Less(entries[position], entries[(position - 1) / ARITY])) {
+        SiftUp(position);
+      } else {
+        SiftDown(position);
+      }
+    }
+
+    void SiftUp(size_t position) {
+      Entry entry = entries[position];
+      while (position > 0) {
+        size_t parent = (position - 1) / ARITY;
+        PROFILE_VISITS(1);
+        if (!Less(entry, entries[parent])) {
+          break;
+        }
+        Place(position, entries[parent]);
+        position = parent;
+      }
+      Place(position, entry);
+    }
+
+    void SiftDown(size_t position) {
+      Entry entry = entries[position];
+      size_t count = entries.size();
+      while (true) {
+        size_t first = position * ARITY + 1;
+        if (first >= count) {
+          break;
+        }
+        size_t last = first + ARITY < count ? first + ARITY : count;
+        size_t least = first;
+        for (size_t child = first + 1; child < last; child++) {
+          if (Less(entries[child], entries[least])) {
+            least = child;
+          }
+        }
+        PROFILE_VISITS(1);
+        if (!Less(entries[least], entry)) {
+          break;
+        }
+        Place(position, entries[least]);
+        position = least;
+      }
+      Place(position, entry);
+    }
+
+    bool numeric;
+    uint32_t sequence;
+    vector<Entry> entries;
+    vector<Item> items;
+    vector<uint32_t> freeIds;
+
+    friend class Iterator<Element>;
+    friend class Iterator<const Element>;
+    friend struct EntryLess;
+};
+
+#endif
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "HyperLogLog.h"
+
+using namespace std;
+
+
+/*
+ * class HyperLogLog
+ */
+
+HyperLogLog::HyperLogLog(uint32_t precision) : precision(precision), sparse(true) {
+}
+
+void HyperLogLog::Add(uint64_t hash) {
+  if (sparse) {
+    AddEntry(Encode(hash));
+    return;
+  }
+  uint64_t rest = hash << precision;
+  uint8_t rank = (uint8_t) (rest == 0 ? 64 - precision + 1 : LeadingZeros(rest) + 1);
+  uint8_t& reg = registers[(size_t) (hash >> (64 - precision))];
+  if (rank > reg) {
+    reg = rank;
+  }
+}
+
+double HyperLogLog::Estimate() {
+  if (sparse) {
+    Compact();
+  }
+  if (sparse) {
+    // Linear counting over the registers of the sparse precision, of which hardly any are taken.
+    double m = (double) (1U << SPARSE_PRECISION);
+    return m * log(m / (m - (double) entries.size()));
+  }
+
+  uint32_t q = 64 - precision;
+  double m = (double) registers.size();
+  vector<uint32_t> counts(q + 2, 0);
+  for (size_t i = 0; i < registers.size(); i++) {
+    counts[registers[i]]++;
+  }
+  double z = m * Tau(1 - counts[q + 1] / m);
+  for (uint32_t k = q; k >= 1; k--) {
+    z = 0.5 * (z + counts[k]);
+  }
+  z += m * Sigma(counts[0] / m);
+  return m * m / (2 * log(2.0) * z);
+}
+
+void HyperLogLog::Clear() {
+  sparse = true;
+  vector<uint32_t>().swap(entries);
+  vector<uint32_t>().swap(pending);
+  vector<uint8_t>().swap(registers);
+}
+
+bool HyperLogLog::Merge(HyperLogLog& other) {
+  if (other.precision != precision) {
+    return false;
+  }
+  if (other.sparse) {
+    other.Compact();
+  }
+  if (other.sparse) {
+    for (size_t i = 0; i < other.entries.size(); i++) {
+      if (sparse) {
+        AddEntry(other.entries[i]);
+      } else {
+        SetRegister(other.entries[i]);
+      }
+    }
+  } else {
+    if (sparse) {
+      ToDense();
+    }
+    for (size_t i = 0; i < registers.size(); i++) {
+      if (other.registers[i] > registers[i]) {
+        registers[i] = other.registers[i];
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * A serialized estimator is a cookie, the precision, whether it is sparse, and then either the number of entries of
+ * the sparse list followed by the entries, or a byte for each register. Integers are little-endian.
+ */
+size_t HyperLogLog::SerializedSize() {
+  if (sparse) {
+    Compact();
+  }
+  return HEADER_SIZE + (sparse ? 4 + 4 * entries.size() : registers.size());
+}
+
+void HyperLogLog::Serialize(char* data) {
+  if (sparse) {
+    Compact();
+  }
+  Write32(data, SERIAL_COOKIE);
+  *data++ = (char) precision;
+  *data++ = (char) (sparse ? 1 : 0);
+  *data++ = 0;
+  *data++ = 0;
+  if (sparse) {
+    Write32(data, (uint32_t) entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+      Write32(data, entries[i]);
+    }
+  } else {
+    for (size_t i = 0; i < registers.size(); i++) {
+      *data++ = (char) registers[i];
+    }
+  }
+}
+
+bool HyperLogLog::Deserialize(const char* data, size_t length) {
+  if (length < HEADER_SIZE || Read32(data) != SERIAL_COOKIE) {
+    return false;
+  }
+  uint32_t precision = (unsigned char) data[4];
+  bool sparse = data[5] == 1;
+  if (precision < MIN_PRECISION || precision > MAX_PRECISION || (unsigned char) data[5] > 1) {
+    return false;
+  }
+  Clear();
+  this->precision = precision;
+  data += HEADER_SIZE;
+  length -= HEADER_SIZE;
+  if (sparse) {
+    if (length < 4 || length != 4 + 4 * (size_t) Read32(data)) {
+      return false;
+    }
+    size_t count = Read32(data);
+    for (size_t i = 0; i < count; i++) {
+      uint32_t entry = Read32(data + 4 + 4 * i);
+      uint32_t rank = entry & 63;
+      if (rank == 0 || rank > 64 - SPARSE_PRECISION + 1 || (i > 0 && (entry >> 6) <= (entries.back() >> 6))) {
+        Clear();
+        return false;
+      }
+      entries.push_back(entry);
+    }
+    if (entries.size() > ((size_t) 1 << precision) / 4) {
+      ToDense();
+    }
+  } else {
+    if (length != ((size_t) 1 << precision)) {
+      return false;
+    }
+    this->sparse = false;
+    registers.assign(data, data + length);
+    for (size_t i = 0; i < registers.size(); i++) {
+      if (registers[i] > 64 - precision + 1) {
+        Clear();
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * Entries are buffered and merged into the sorted list in batches, so that adding a hash takes amortized
+ * logarithmic time.
+ */
+void HyperLogLog::AddEntry(uint32_t entry) {
+  pending.push_back(entry);
+  if (pending.size() >= ((size_t) 1 << precision) / 4) {
+    Compact();
+  }
+}
+
+/*
+ * Update the register of a sparse entry, whose rank is counted from a finer register index.
+ */
+void HyperLogLog::SetRegister(uint32_t entry) {
+  uint32_t shift = SPARSE_PRECISION - precision;
+  uint32_t index = entry >> 6;
+  uint32_t low = index & ((1U << shift) - 1);
+  uint8_t rank = (uint8_t) (low != 0 ? shift - (63 - LeadingZeros(low)) : shift + (entry & 63));
+  uint8_t& reg = registers[index >> shift];
+  if (rank > reg) {
+    reg = rank;
+  }
+}
+
+/*
+ * Merge pending entries into the sorted list, keeping the highest rank of each index, and switch to registers if the
+ * list has grown too long.
+ */
+void HyperLogLog::Compact() {
+  if (pending.empty()) {
+    return;
+  }
+  sort(pending.begin(), pending.end());
+  vector<uint32_t> merged(entries.size() + pending.size());
+  merge(entries.begin(), entries.end(), pending.begin(), pending.end(), merged.begin());
+  pending.clear();
+  entries.clear();
+  for (size_t i = 0; i < merged.size(); i++) {
+    // Entries of equal index are ordered by rank, so a later entry replaces an earlier one.
+    if (!entries.empty() && (entries.back() >> 6) == (merged[i] >> 6)) {
+      entries.back() = merged[i];
+    } else {
+      entries.push_back(merged[i]);
+    }
+  }
+  if (entries.size() > ((size_t) 1 << precision) / 4) {
+    ToDense();
+  }
+}
+
+void HyperLogLog::ToDense() {
+  registers.assign((size_t) 1 << precision, 0);
+  sparse = false;
+  for (size_t i = 0; i < entries.size(); i++) {
+    SetRegister(entries[i]);
+  }
+  for (size_t i = 0; i < pending.size(); i++) {
+    SetRegister(pending[i]);
+  }
+  vector<uint32_t>().swap(entries);
+  vector<uint32_t>().swap(pending);
+}
+
+double HyperLogLog::Sigma(double x) {
+  if (x == 1) {
+    return numeric_limits<double>::infinity();
+  }
+  double y = 1;
+  double z = x;
+  double previous;
+  do {
+    x *= x;
+    previous = z;
+    z += x * y;
+    y += y;
+  } while (z != previous);
+  return z;
+}
+
+double HyperLogLog::Tau(double x) {
+  if (x == 0 || x == 1) {
+    return 0;
+  }
+  double y = 1;
+  double z = 1 - x;
+  double previous;
+  do {
+    x = sqrt(x);
+    previous = z;
+    y *= 0.5;
+    z -= (1 - x) * (1 - x) * y;
+  } while (z != previous);
+  return z / 3;
+}
+
+void HyperLogLog::Write32(char*& data, uint32_t value) {
+  *data++ = (char) (value & 0xff);
+  *data++ = (char) ((value >> 8) & 0xff);
+  *data++ = (char) ((value >> 16) & 0xff);
+  *data++ = (char) ((value >> 24) & 0xff);
+}
+
+uint32_t HyperLogLog::Read32(const char* data) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
@@ -0,0 +1,91 @@
+#ifndef COLLECTION_HYPER_LOG_LOG_H
+#define COLLECTION_HYPER_LOG_LOG_H
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * class HyperLogLog
+ *
+ * Estimates the number of distinct 64-bit hashes added, in the manner of HyperLogLog++. The top `precision` bits of
+ * a hash pick one of 2^precision registers, which keeps the longest run of leading zeros seen in the remaining bits;
+ * the relative standard error of the estimate is about 1.04 / sqrt(2^precision).
+ *
+ * While few hashes have been added, they are kept in a sparse list at a precision of 25 bits instead, which takes
+ * less memory than the registers and counts small sets almost exactly. The list is turned into registers once it
+ * would take as much memory as they do. Estimates from the registers use the improved raw estimator of Ertl, which
+ * needs no empirical bias correction.
+ */
+
+class HyperLogLog {
+  public:
+    static const uint32_t MIN_PRECISION = 4;
+    static const uint32_t MAX_PRECISION = 18;
+
+    explicit HyperLogLog(uint32_t precision);
+
+    inline uint32_t Precision() const {
+      return precision;
+    }
+
+    void Add(uint64_t hash);
+    double Estimate();
+    void Clear();
+
+    /*
+     * Add the hashes of another estimator of the same precision. Returns false if the precisions differ.
+     */
+    bool Merge(HyperLogLog& other);
+
+    size_t SerializedSize();
+    void Serialize(char* data);
+    bool Deserialize(const char* data, size_t length);
+
+  private:
+    static const uint32_t SPARSE_PRECISION = 25;
+    static const uint32_t SERIAL_COOKIE = 0x314c4c48; // "HLL1"
+    static const size_t HEADER_SIZE = 8;
+
+    // An entry of the sparse list is a register index at SPARSE_PRECISION bits, shifted left by 6, and its rank.
+    static inline uint32_t Encode(uint64_t hash) {
+      uint64_t rest = hash << SPARSE_PRECISION;
+      uint32_t rank = rest == 0 ? 64 - SPARSE_PRECISION + 1 : LeadingZeros(rest) + 1;
+      return ((uint32_t) (hash >> (64 - SPARSE_PRECISION)) << 6) | rank;
+    }
+
+    static inline uint32_t LeadingZeros(uint64_t word) {
+#ifdef __GNUC__
+      return (uint32_t) __builtin_clzll(word);
+#else
+      uint32_t zeros = 0;
+      while ((word & 0x8000000000000000ULL) == 0) {
+        word <<= 1;
+        zeros++;
+      }
+      return zeros;
+#endif
+    }
+
+    void AddEntry(uint32_t entry);
+    void SetRegister(uint32_t entry);
+    void Compact();
+    void ToDense();
+
+    static double Sigma(double x);
+    static double Tau(double x);
+
+    static void Write32(char*& data, uint32_t value);
+    static uint32_t Read32(const char* data);
+
+    uint32_t precision;
+    bool sparse;
+    // Sorted entries with distinct indexes, and entries added since the list was last sorted.
+    vector<uint32_t> entries;
+    vector<uint32_t> pending;
+    vector<uint8_t> registers;
+};
+
+#endif
@@ -0,0 +1,299 @@
+#include <cmath>
+#include <node_buffer.h>
+#include "IntSet.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class IntSet
+ */
+
+IntSet::~IntSet() {
+  // Members hold nothing to dispose, so the bitmap is cleared without visiting them.
+  storage.clear();
+}
+
+Handle<Value> IntSet::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  return scope.Close(value.ToValue());
+}
+
+void IntSet::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("IntSet"));
+
+  exports->Set(String::NewSymbol("IntSet"), constructor->GetFunction());
+}
+
+void IntSet::InitializeFields(Handle<Object> thisObject) {
+  // Functions of Collection that take an index are left out; select() gets a member by its index.
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("and"), FunctionTemplate::New(And)->GetFunction());
+  thisObject->Set(String::NewSymbol("andNot"), FunctionTemplate::New(AndNot)->GetFunction());
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("equals"), FunctionTemplate::New(Equals)->GetFunction());
+  thisObject->Set(String::NewSymbol("has"), FunctionTemplate::New(Has)->GetFunction());
+  thisObject->Set(String::NewSymbol("isEmpty"), FunctionTemplate::New(IsEmpty)->GetFunction());
+  thisObject->Set(String::NewSymbol("or"), FunctionTemplate::New(Or)->GetFunction());
+  thisObject->Set(String::NewSymbol("profile"), FunctionTemplate::New(Profile)->GetFunction());
+  thisObject->Set(String::NewSymbol("rank"), FunctionTemplate::New(Rank)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("runOptimize"), FunctionTemplate::New(RunOptimize)->GetFunction());
+  thisObject->Set(String::NewSymbol("select"), FunctionTemplate::New(Select)->GetFunction());
+  thisObject->Set(String::NewSymbol("size"), FunctionTemplate::New(Size)->GetFunction());
+  thisObject->Set(String::NewSymbol("toArray"), FunctionTemplate::New(ToArray)->GetFunction());
+  thisObject->Set(String::NewSymbol("toBuffer"), FunctionTemplate::New(ToBuffer)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+  thisObject->Set(String::NewSymbol("xor"), FunctionTemplate::New(Xor)->GetFunction());
+
+  thisObject->Set(String::NewSymbol("each"), FunctionTemplate::New(Each)->GetFunction());
+  thisObject->Set(String::NewSymbol("filter"), FunctionTemplate::New(Filter)->GetFunction());
+  thisObject->Set(String::NewSymbol("find"), FunctionTemplate::New(Find)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduce"), FunctionTemplate::New(Reduce)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduceRight"), FunctionTemplate::New(ReduceRight)->GetFunction());
+}
+
+/*
+ * Add the members of an array or of an int set. Values of an array must already be checked with IsIntArray().
+ */
+void IntSet::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (argument->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(argument);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      PROFILE_LOOKUP();
+      storage.Add(array->Get(i)->Uint32Value());
+    }
+  } else if (constructor->HasInstance(argument)) {
+    IntSet* other = ObjectWrap::Unwrap<IntSet>(Handle<Object>::Cast(argument));
+    RoaringBitmap result;
+    RoaringBitmap::Combine(storage, other->storage, RoaringBitmap::OR, result);
+    storage.swap(result);
+  }
+}
+
+bool IntSet::IsSupportedObject(Handle<Value> value) {
+  return constructor->HasInstance(value);
+}
+
+bool IntSet::IsSupportedType(Handle<Value> value) {
+  return value->IsUint32();
+}
+
+bool IntSet::IsIntArray(Handle<Value> value) {
+  if (!(value->IsArray())) {
+    return false;
+  }
+  Handle<Array> array = Handle<Array>::Cast(value);
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    if (!(array->Get(i)->IsUint32())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Handle<Value> IntSet::Combine(const Arguments& args, RoaringBitmap::Operation operation, const char* error) {
+  if (args.Length() != 1 || !constructor->HasInstance(args[0])) {
+    return ThrowException(Exception::Error(String::New(error)));
+  }
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  IntSet* other = ObjectWrap::Unwrap<IntSet>(Handle<Object>::Cast(args[0]));
+  Local<Object> resultObject = constructor->GetFunction()->NewInstance();
+  IntSet* result = ObjectWrap::Unwrap<IntSet>(resultObject);
+  RoaringBitmap::Combine(obj->storage, other->storage, operation, result->storage);
+  return scope.Close(resultObject);
+}
+
+Handle<Value> IntSet::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool argError = args.Length() > 1;
+  if (!argError && !(args[0]->IsUndefined()) && !(constructor->HasInstance(args[0])) && !(Buffer::HasInstance(args[0]))) {
+    argError = !IsIntArray(args[0]);
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional array of integers between 0 and 4294967295, int set or buffer.")));
+  }
+
+  IntSet* obj = new IntSet();
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  if (Buffer::HasInstance(args[0])) {
+    if (!obj->storage.Deserialize(Buffer::Data(args[0]), Buffer::Length(args[0]))) {
+      return ThrowException(Exception::Error(String::New("Buffer does not hold a serialized int set.")));
+    }
+  } else {
+    obj->InitializeValues(args.This(), args[0]);
+  }
+
+  return args.This();
+}
+
+Handle<Value> IntSet::Add(const Arguments& args) {
+  PROFILE_METHOD(add, args);
+  CHECK_ITERATING(add, args);
+  CHECK_WRITABLE(add, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!(args[i]->IsUint32())) {
+      return ThrowException(Exception::Error(String::New("add(value, ...) takes only integers between 0 and 4294967295.")));
+    }
+  }
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    PROFILE_LOOKUP();
+    obj->storage.Add(args[i]->Uint32Value());
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> IntSet::AddAll(const Arguments& args) {
+  PROFILE_METHOD(addAll, args);
+  CHECK_ITERATING(addAll, args);
+  CHECK_WRITABLE(addAll, args);
+  if (args.Length() != 1 || !(IsIntArray(args[0]) || constructor->HasInstance(args[0]))) {
+    return ThrowException(Exception::Error(String::New("addAll(object) takes an array of integers between 0 and 4294967295, or an int set.")));
+  }
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+  return scope.Close(args.This());
+}
+
+Handle<Value> IntSet::And(const Arguments& args) {
+  PROFILE_METHOD(and, args);
+  return Combine(args, RoaringBitmap::AND, "and(object) takes an int set argument.");
+}
+
+Handle<Value> IntSet::AndNot(const Arguments& args) {
+  PROFILE_METHOD(andNot, args);
+  return Combine(args, RoaringBitmap::AND_NOT, "andNot(object) takes an int set argument.");
+}
+
+Handle<Value> IntSet::Clear(const Arguments& args) {
+  PROFILE_METHOD(clear, args);
+  CHECK_ITERATING(clear, args);
+  CHECK_WRITABLE(clear, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
+
+  HandleScope scope;
+  ObjectWrap::Unwrap<IntSet>(args.This())->storage.clear();
+  return scope.Close(args.This());
+}
+
+Handle<Value> IntSet::Equals(const Arguments& args) {
+  PROFILE_METHOD(equals, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("equals(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  if (!constructor->HasInstance(args[0])) {
+    return scope.Close(Boolean::New(false));
+  }
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  IntSet* other = ObjectWrap::Unwrap<IntSet>(Handle<Object>::Cast(args[0]));
+  return scope.Close(Boolean::New(obj->storage.Equals(other->storage)));
+}
+
+Handle<Value> IntSet::Or(const Arguments& args) {
+  PROFILE_METHOD(or, args);
+  return Combine(args, RoaringBitmap::OR, "or(object) takes an int set argument.");
+}
+
+Handle<Value> IntSet::Rank(const Arguments& args) {
+  PROFILE_METHOD(rank, args);
+  if (args.Length() != 1 || !(args[0]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("rank(value) takes an integer between 0 and 4294967295.")));
+  }
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  return scope.Close(Number::New((double) obj->storage.Rank(args[0]->Uint32Value())));
+}
+
+Handle<Value> IntSet::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    if (args[i]->IsUint32()) {
+      PROFILE_LOOKUP();
+      obj->storage.Remove(args[i]->Uint32Value());
+    }
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> IntSet::RunOptimize(const Arguments& args) {
+  PROFILE_METHOD(runOptimize, args);
+  CHECK_ITERATING(runOptimize, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(runOptimize, args);
+
+  HandleScope scope;
+  ObjectWrap::Unwrap<IntSet>(args.This())->storage.RunOptimize();
+  return scope.Close(args.This());
+}
+
+Handle<Value> IntSet::Select(const Arguments& args) {
+  PROFILE_METHOD(select, args);
+  if (args.Length() != 1 || !(args[0]->IsNumber()) || !(args[0]->NumberValue() >= 0) ||
+      args[0]->NumberValue() != floor(args[0]->NumberValue())) {
+    return ThrowException(Exception::Error(String::New("select(rank) takes a non-negative integer argument.")));
+  }
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  uint32_t value;
+  double rank = args[0]->NumberValue();
+  if (rank >= (double) obj->storage.Cardinality() || !obj->storage.Select((uint64_t) rank, value)) {
+    return Undefined();
+  }
+  return scope.Close(Number::New(value));
+}
+
+Handle<Value> IntSet::Size(const Arguments& args) {
+  PROFILE_METHOD(size, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(size, args);
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  return scope.Close(Number::New((double) obj->storage.Cardinality()));
+}
+
+Handle<Value> IntSet::ToBuffer(const Arguments& args) {
+  PROFILE_METHOD(toBuffer, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toBuffer, args);
+
+  HandleScope scope;
+  IntSet* obj = ObjectWrap::Unwrap<IntSet>(args.This());
+  Buffer* buffer = Buffer::New(obj->storage.SerializedSize());
+  obj->storage.Serialize(Buffer::Data(buffer->handle_));
+  return scope.Close(buffer->handle_);
+}
+
+Handle<Value> IntSet::Xor(const Arguments& args) {
+  PROFILE_METHOD(xor, args);
+  return Combine(args, RoaringBitmap::XOR, "xor(object) takes an int set argument.");
+}
@@ -0,0 +1,56 @@
+#ifndef COLLECTION_INT_SET_H
+#define COLLECTION_INT_SET_H
+
+#include <node.h>
+#include "common.h"
+#include "RoaringBitmap.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class IntSet
+ *
+ * A set of unsigned 32-bit integers, kept in a compressed bitmap. Members are iterated in ascending order. Set
+ * operations between int sets are done natively and return new int sets.
+ */
+
+class IntSet : public Collection<RoaringBitmap> {
+  public:
+    typedef RoaringBitmap Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    virtual ~IntSet();
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    static bool IsIntArray(Handle<Value> value);
+    static Handle<Value> Combine(const Arguments& args, RoaringBitmap::Operation operation, const char* error);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> And(const Arguments& args);
+    static Handle<Value> AndNot(const Arguments& args);
+    static Handle<Value> Clear(const Arguments& args);
+    static Handle<Value> Equals(const Arguments& args);
+    static Handle<Value> Or(const Arguments& args);
+    static Handle<Value> Rank(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> RunOptimize(const Arguments& args);
+    static Handle<Value> Select(const Arguments& args);
+    static Handle<Value> Size(const Arguments& args);
+    static Handle<Value> ToBuffer(const Arguments& args);
+    static Handle<Value> Xor(const Arguments& args);
+};
+
+#endif
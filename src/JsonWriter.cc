@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <node_buffer.h>
+#include "common.h"
+#include "JsonWriter.h"
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class JsonWriter
+ */
+
+JsonWriter::JsonWriter() : flushed(0), failed(false) {
+}
+
+JsonWriter::JsonWriter(Handle<Function> callback) : flushed(0), callback(callback), failed(false) {
+}
+
+bool JsonWriter::Write(const Element& element) {
+  switch (element.GetTypeScore()) {
+    case 1:
+      return false;
+    case 2:
+      WriteRaw("null", 4);
+      return true;
+    case 4:
+      if (element.BooleanValue()) {
+        WriteRaw("true", 4);
+      } else {
+        WriteRaw("false", 5);
+      }
+      return true;
+    case 5:
+    case 6:
+    case 8:
+      WriteNumber(element.NumberValue());
+      return true;
+    case 11:
+      WriteString(element.StringValue()->data, element.StringValue()->length);
+      return true;
+    default: {
+      HandleScope scope;
+      return Write(element.ToValue());
+    }
+  }
+}
+
+bool JsonWriter::Write(Handle<Value> value) {
+  if (value.IsEmpty() || value->IsUndefined()) {
+    return false;
+  } else if (value->IsNull()) {
+    WriteRaw("null", 4);
+  } else if (value->IsBoolean()) {
+    if (value->BooleanValue()) {
+      WriteRaw("true", 4);
+    } else {
+      WriteRaw("false", 5);
+    }
+  } else if (value->IsNumber()) {
+    WriteNumber(value->NumberValue());
+  } else if (value->IsString()) {
+    String::Utf8Value utf8(value);
+    WriteString(*utf8, utf8.length());
+  } else if (!CollectionUtil::WriteJson(*this, Handle<Object>::Cast(value))) {
+    // Dates, arrays and other objects, which may have a toJSON() function of their own.
+    HandleScope scope;
+    Handle<Value> text = CollectionUtil::Stringify(value);
+    if (text.IsEmpty()) {
+      failed = true;
+      return false;
+    } else if (text->IsUndefined()) {
+      return false;
+    }
+    String::Utf8Value utf8(text);
+    WriteRaw(*utf8, utf8.length());
+  }
+  return true;
+}
+
+/*
+ * Quote a string of UTF-8 bytes. Only quotes, backslashes and control characters are escaped, as JSON.stringify()
+ * does; other characters are copied as they are.
+ */
+void JsonWriter::WriteString(const char* data, size_t length) {
+  static const char* HEX = "0123456789abcdef";
+  buffer.reserve(buffer.size() + length + 2);
+  buffer.push_back('"');
+  size_t start = 0;
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = (unsigned char) data[i];
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    buffer.append(data + start, i - start);
+    start = i + 1;
+    switch (c) {
+      case '"':
+        buffer.append("\\\"", 2);
+        break;
+      case '\\':
+        buffer.append("\\\\", 2);
+        break;
+      case '\b':
+        buffer.append("\\b", 2);
+        break;
+      case '\f':
+        buffer.append("\\f", 2);
+        break;
+      case '\n':
+        buffer.append("\\n", 2);
+        break;
+      case '\r':
+        buffer.append("\\r", 2);
+        break;
+      case '\t':
+        buffer.append("\\t", 2);
+        break;
+      default: {
+        char escaped[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf]};
+        buffer.append(escaped, 6);
+      }
+    }
+  }
+  buffer.append(data + start, length - start);
+  buffer.push_back('"');
+}
+
+bool JsonWriter::Enter(const void* collection) {
+  if (find(path.begin(), path.end(), collection) != path.end()) {
+    ThrowException(Exception::Error(String::New("Converting circular structure to JSON.")));
+    failed = true;
+    return false;
+  }
+  path.push_back(collection);
+  return true;
+}
+
+void JsonWriter::Leave() {
+  path.pop_back();
+}
+
+void JsonWriter::Flush() {
+  if (callback.IsEmpty() || failed || buffer.empty()) {
+    return;
+  }
+
+  HandleScope scope;
+  Buffer* chunk = Buffer::New(buffer.data(), buffer.size());
+  flushed += buffer.size();
+  buffer.clear();
+  Handle<Value> parameters[1];
+  parameters[0] = chunk->handle_;
+  if (callback->Call(Context::GetCurrent()->Global(), 1, parameters).IsEmpty()) {
+    failed = true;
+  }
+}
+
+Local<String> JsonWriter::ToString() const {
+  return String::New(buffer.data(), (int) buffer.size());
+}
+
+Handle<Object> JsonWriter::ToBuffer() const {
+  return Buffer::New(buffer.data(), buffer.size())->handle_;
+}
+
+bool JsonWriter::GetKey(const Element& key, string& result) {
+  char number[32];
+  switch (key.GetTypeScore()) {
+    case 1:
+      result.assign("undefined");
+      return true;
+    case 2:
+      result.assign("null");
+      return true;
+    case 4:
+      result.assign(key.BooleanValue() ? "true" : "false");
+      return true;
+    case 5:
+    case 6:
+    case 8:
+      result.assign(number, FormatNumber(key.NumberValue(), number));
+      return true;
+    case 11:
+      result.assign(key.StringValue()->data, key.StringValue()->length);
+      return true;
+    default: {
+      // Dates and objects are converted by JavaScript, which may call their own toString().
+      HandleScope scope;
+      Local<String> text = key.ToValue()->ToString();
+      if (text.IsEmpty()) {
+        failed = true;
+        return false;
+      }
+      String::Utf8Value utf8(text);
+      result.assign(*utf8, utf8.length());
+      return true;
+    }
+  }
+}
+
+bool JsonWriter::IsArrayIndex(const char* data, size_t length, uint32_t& index) {
+  if (length == 0 || length > 10 || (data[0] == '0' && length > 1)) {
+    return false;
+  }
+  uint64_t value = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (data[i] < '0' || data[i] > '9') {
+      return false;
+    }
+    value = value * 10 + (data[i] - '0');
+  }
+  if (value >= 4294967295ULL) {
+    return false;
+  }
+  index = (uint32_t) value;
+  return true;
+}
+
+/*
+ * Numbers are formatted as ECMAScript specifies for ToString(): the shortest digits that read back as the same
+ * number, in fixed notation from 1e-7 up to 1e21 and in exponential notation otherwise. Integers below 2^53 are
+ * exact. For other numbers, the digits rounded to 15 places are the shortest ones, with trailing zeros removed, if they
+ * read back as the number; otherwise 16 or 17 places are needed. Subnormal numbers carry fewer digits, and are tried
+ * from one place up.
+ */
+size_t JsonWriter::FormatNumber(double value, char* result) {
+  char* out = result;
+  if (value != value) {
+    strcpy(result, "NaN");
+    return 3;
+  } else if (value == 0) {
+    result[0] = '0';
+    return 1;
+  } else if (value < 0) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (value > 1.7976931348623157e308) {
+    strcpy(out, "Infinity");
+    return out - result + 8;
+  }
+  if (value < 9007199254740992.0 && value == floor(value)) {
+    return out - result + sprintf(out, "%.0f", value);
+  }
+
+  char scientific[32];
+  int precision = value < 2.2250738585072014e-308 ? 1 : 15;
+  for (; precision < 17; precision++) {
+    sprintf(scientific, "%.*e", precision - 1, value);
+    if (strtod(scientific, NULL) == value) {
+      break;
+    }
+  }
+  if (precision == 17) {
+    sprintf(scientific, "%.16e", value);
+  }
+
+  // The number is 0.digits times 10 to the power of n.
+  char digits[20];
+  int k = 0;
+  const char* p = scientific;
+  for (; *p != 'e'; p++) {
+    if (*p != '.') {
+      digits[k++] = *p;
+    }
+  }
+  while (k > 1 && digits[k - 1] == '0') {
+    k--;
+  }
+  int n = atoi(p + 1) + 1;
+
+  if (k <= n && n <= 21) {
+    memcpy(out, digits, k);
+    out += k;
+    for (int i = k; i < n; i++) {
+      *out++ = '0';
+    }
+  } else if (0 < n && n <= 21) {
+    memcpy(out, digits, n);
+    out += n;
+    *out++ = '.';
+    memcpy(out, digits + n, k - n);
+    out += k - n;
+  } else if (-6 < n && n <= 0) {
+    *out++ = '0';
+    *out++ = '.';
+    for (int i = n; i < 0; i++) {
+      *out++ = '0';
+    }
+    memcpy(out, digits, k);
+    out += k;
+  } else {
+    *out++ = digits[0];
+    if (k > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, k - 1);
+      out += k - 1;
+    }
+    out += sprintf(out, "e%c%d", n > 0 ? '+' : '-', abs(n - 1));
+  }
+  return out - result;
+}
+
+void JsonWriter::WriteNumber(double value) {
+  // Infinity and NaN have no JSON text.
+  if (value - value != 0) {
+    WriteRaw("null", 4);
+    return;
+  }
+  char number[32];
+  WriteRaw(number, FormatNumber(value, number));
+}
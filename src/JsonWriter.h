@@ -0,0 +1,122 @@
+#ifndef COLLECTION_JSON_WRITER_H
+#define COLLECTION_JSON_WRITER_H
+
+#include <string>
+#include <vector>
+#include <node.h>
+#include "Element.h"
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class JsonWriter
+ *
+ * Writes the JSON text of collections into a growable buffer, walking their storage instead of first copying their
+ * values into JavaScript arrays and objects. The text is the same as JSON.stringify() gives for those copies. Elements
+ * that are primitive are written natively, nested collections are walked in turn, and only other objects are passed
+ * to JSON.stringify().
+ *
+ * With a callback, the text is handed to it in chunks of about CHUNK_SIZE bytes while it is written, so that the
+ * whole text of a huge collection is never held at once.
+ *
+ * Writing stops once JavaScript code called by the writer throws an exception, or a collection is found inside
+ * itself; HasFailed() then returns true, and the exception is pending.
+ */
+
+class JsonWriter {
+  public:
+    static const size_t CHUNK_SIZE = 65536;
+
+    JsonWriter();
+    explicit JsonWriter(Handle<Function> callback);
+
+    /*
+     * Write a value. Returns false and writes nothing if the value has no JSON text, such as undefined or a function,
+     * in which case an array holds null in its place and an object leaves the property out.
+     */
+    bool Write(const Element& element);
+    bool Write(Handle<Value> value);
+
+    void WriteString(const char* data, size_t length);
+
+    inline void WriteRaw(const char* data, size_t length) {
+      buffer.append(data, length);
+    }
+
+    inline void Put(char c) {
+      buffer.push_back(c);
+    }
+
+    /*
+     * Begin writing a collection. Returns false, with an exception pending, if the collection is already being
+     * written.
+     */
+    bool Enter(const void* collection);
+    void Leave();
+
+    /*
+     * The position of the text written so far, and a way back to it for a value that turns out to write nothing.
+     */
+    inline size_t Mark() const {
+      return flushed + buffer.size();
+    }
+
+    inline void Rewind(size_t mark) {
+      buffer.resize(mark - flushed);
+    }
+
+    /*
+     * Called between values: hand a full chunk to the callback, if there is one.
+     */
+    inline void Checkpoint() {
+      if (!callback.IsEmpty() && buffer.size() >= CHUNK_SIZE) {
+        Flush();
+      }
+    }
+
+    void Flush();
+
+    inline bool HasFailed() const {
+      return failed;
+    }
+
+    inline size_t Size() const {
+      return flushed + buffer.size();
+    }
+
+    Local<String> ToString() const;
+    Handle<Object> ToBuffer() const;
+
+    /*
+     * The text of a key of an object, as it is converted to a string when used as a property name. Returns false,
+     * and fails, if the conversion throws.
+     */
+    bool GetKey(const Element& key, string& result);
+
+    /*
+     * Whether a key is an array index, which JavaScript objects order numerically before their other properties.
+     */
+    static bool IsArrayIndex(const char* data, size_t length, uint32_t& index);
+
+    /*
+     * Format a number as Number.prototype.toString() does: in the fewest digits that read back as the same number.
+     */
+    static size_t FormatNumber(double value, char* result);
+
+  private:
+    JsonWriter(const JsonWriter& other);
+    JsonWriter& operator=(const JsonWriter& other);
+
+    void WriteNumber(double value);
+
+    string buffer;
+    size_t flushed;
+    Handle<Function> callback;
+    vector<const void*> path;
+    bool failed;
+};
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef COLLECTION_LINKED_HASH_MAP_H
+#define COLLECTION_LINKED_HASH_MAP_H
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <node.h>
+#include "common.h"
+#include "Pool.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class LinkedHashNode
+ *
+ * An entry of a LinkedHashMap. `link` holds whatever else a collection needs to keep with each entry.
+ */
+
+struct NoLink {
+};
+
+template <class Link> struct LinkedHashNode {
+  LinkedHashNode() : prev(this), next(this), chain(NULL), hash(0) {
+  }
+
+  LinkedHashNode(const pair<const Element, Element>& entry, uint32_t hash) : entry(entry), prev(NULL), next(NULL),
+      chain(NULL), hash(hash) {
+  }
+
+  pair<const Element, Element> entry;
+  LinkedHashNode* prev;
+  LinkedHashNode* next;
+  LinkedHashNode* chain;
+  uint32_t hash;
+  Link link;
+};
+
+
+/*
+ * class LinkedHashMap
+ *
+ * Hash table of (key, value) entries that are also threaded on a doubly linked list, so that an entry can be found
+ * by key, moved to either end of the list, or removed in constant time. Keys are hashed with ValueHasher and
+ * compared with ValueComparator, so that they have the same semantics as keys of a Map. Iteration follows the list,
+ * from front to back. Entries are allocated from a per-instance pool.
+ */
+
+template <class Link = NoLink> class LinkedHashMap {
+  public:
+    typedef pair<const Element, Element> value_type;
+    typedef size_t size_type;
+    typedef LinkedHashNode<Link> Node;
+
+    template <class T> class Iterator : public std::iterator<bidirectional_iterator_tag, T> {
+      public:
+        Iterator() : node(NULL) {
+        }
+
+        explicit Iterator(Node* node) : node(node) {
+        }
+
+        template <class U> Iterator(const Iterator<U>& other) : node(other.node) {
+        }
+
+        inline T& operator*() const {
+          return node->entry;
+        }
+
+        inline T* operator->() const {
+          return &node->entry;
+        }
+
+        inline Iterator& operator++() {
+          node = node->next;
+          return *this;
+        }
+
+        inline Iterator operator++(int) {
+          Iterator result = *this;
+          node = node->next;
+          return result;
+        }
+
+        inline Iterator& operator--() {
+          node = node->prev;
+          return *this;
+        }
+
+        inline Iterator operator--(int) {
+          Iterator result = *this;
+          node = node->prev;
+          return result;
+        }
+
+        inline bool operator==(const Iterator& other) const {
+          return node == other.node;
+        }
+
+        inline bool operator!=(const Iterator& other) const {
+          return node != other.node;
+        }
+
+        Node* node;
+    };
+
+    typedef Iterator<value_type> iterator;
+    typedef Iterator<const value_type> const_iterator;
+
+    LinkedHashMap() : count(0), pool(new NodePool()) {
+      bucketCount = MIN_BUCKETS;
+      buckets = static_cast<Node**>(calloc(bucketCount, sizeof(Node*)));
+    }
+
+    ~LinkedHashMap() {
+      clear();
+      free(buckets);
+      pool->Unref();
+    }
+
+    inline iterator begin() {
+      return iterator(head.next);
+    }
+
+    inline const_iterator begin() const {
+      return const_iterator(head.next);
+    }
+
+    inline iterator end() {
+      return iterator(&head);
+    }
+
+    inline const_iterator end() const {
+      return const_iterator(const_cast<Node*>(&head));
+    }
+
+    inline size_type size() const {
+      return count;
+    }
+
+    inline bool empty() const {
+      return count == 0;
+    }
+
+    iterator find(const Element& key) {
+      Node* node = Find(key);
+      return node == NULL ? end() : iterator(node);
+    }
+
+    const_iterator find(const Element& key) const {
+      Node* node = Find(key);
+      return node == NULL ? end() : const_iterator(node);
+    }
+
+    /*
+     * Insert an entry whose key is not yet in the map at the front or at the back of the list.
+     */
+    iterator push_front(const value_type& entry) {
+      Node* node = Insert(entry);
+      Attach(node, head.next);
+      return iterator(node);
+    }
+
+    iterator push_back(const value_type& entry) {
+      Node* node = Insert(entry);
+      Attach(node, &head);
+      return iterator(node);
+    }
+
+    void move_to_front(iterator it) {
+      if (it.node != head.next) {
+        Detach(it.node);
+        Attach(it.node, head.next);
+      }
+    }
+
+    void move_to_back(iterator it) {
+      if (it.node != head.prev) {
+        Detach(it.node);
+        Attach(it.node, &head);
+      }
+    }
+
+    void erase(iterator it) {
+      Node* node = it.node;
+      Detach(node);
+      Node** link = &buckets[node->hash & (bucketCount - 1)];
+      while (*link != node) {
+        link = &(*link)->chain;
+      }
+      *link = node->chain;
+      count--;
+      Destroy(node);
+    }
+
+    void erase(iterator first, iterator last) {
+      while (first != last) {
+        erase(first++);
+      }
+    }
+
+    void clear() {
+      Node* node = head.next;
+      while (node != &head) {
+        Node* next = node->next;
+        Destroy(node);
+        node = next;
+      }
+      head.prev = head.next = &head;
+      count = 0;
+
+      if (bucketCount > MIN_BUCKETS) {
+        free(buckets);
+        bucketCount = MIN_BUCKETS;
+        buckets = static_cast<Node**>(calloc(bucketCount, sizeof(Node*)));
+      } else {
+        memset(buckets, 0, bucketCount * sizeof(Node*));
+      }
+    }
+
+  private:
+    LinkedHashMap(const LinkedHashMap& other);
+    LinkedHashMap& operator=(const LinkedHashMap& other);
+
+    static const size_t MIN_BUCKETS = 16;
+
+    Node* Find(const Element& key) const {
+      ValueHasher hasher;
+      ValueComparator comparator;
+      uint32_t hash = hasher(key);
+      Node* node = buckets[hash & (bucketCount - 1)];
+      while (node != NULL) {
+        PROFILE_VISITS(1);
+        if (node->hash == hash && !comparator(node->entry.first, key) && !comparator(key, node->entry.first)) {
+          return node;
+        }
+        node = node->chain;
+      }
+      return NULL;
+    }
+
+    Node* Insert(const value_type& entry) {
+      ValueHasher hasher;
+      if (count >= bucketCount) {
+        Rehash(bucketCount * 2);
+      }
+      Node* node = new(pool->Allocate(sizeof(Node))) Node(entry, hasher(entry.first));
+      Node** bucket = &buckets[node->hash & (bucketCount - 1)];
+      node->chain = *bucket;
+      *bucket = node;
+      count++;
+      return node;
+    }
+
+    void Destroy(Node* node) {
+      node->~Node();
+      pool->Deallocate(node, sizeof(Node));
+    }
+
+    void Attach(Node* node, Node* before) {
+      node->next = before;
+      node->prev = before->prev;
+      before->prev->next = node;
+      before->prev = node;
+    }
+
+    void Detach(Node* node) {
+      node->prev->next = node->next;
+      node->next->prev = node->prev;
+    }
+
+    void Rehash(size_t newCount) {
+      Node** newBuckets = static_cast<Node**>(calloc(newCount, sizeof(Node*)));
+      for (size_t i = 0; i < bucketCount; i++) {
+        Node* node = buckets[i];
+        while (node != NULL) {
+          Node* chain = node->chain;
+          Node** bucket = &newBuckets[node->hash & (newCount - 1)];
+          node->chain = *bucket;
+          *bucket = node;
+          node = chain;
+        }
+      }
+      free(buckets);
+      buckets = newBuckets;
+      bucketCount = newCount;
+    }
+
+    Node head;
+    Node** buckets;
+    size_t bucketCount;
+    size_t count;
+    NodePool* pool;
+};
+
+#endif
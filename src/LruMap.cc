@@ -0,0 +1,331 @@
+#include "LruMap.h"
+#include "Map.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class LruMap
+ */
+
+LruMap::LruMap(uint32_t capacity) : capacity(capacity), hits(0), misses(0), evictions(0) {
+}
+
+LruMap::~LruMap() {
+  if (!onEvict.IsEmpty()) {
+    onEvict.Dispose();
+  }
+}
+
+Handle<Value> LruMap::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  Handle<Value> parameters[2];
+  parameters[0] = value.first.ToValue();
+  parameters[1] = value.second.ToValue();
+  Local<Object> object = MapEntry::constructor->GetFunction()->NewInstance(2, parameters);
+  return scope.Close(object);
+}
+
+void LruMap::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("LruMap"));
+
+  exports->Set(String::NewSymbol("LruMap"), constructor->GetFunction());
+}
+
+void LruMap::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("capacity"), FunctionTemplate::New(Capacity)->GetFunction());
+  thisObject->Set(String::NewSymbol("get"), FunctionTemplate::New(Get)->GetFunction());
+  thisObject->Set(String::NewSymbol("getAt"), FunctionTemplate::New(GetAt)->GetFunction());
+  thisObject->Set(String::NewSymbol("keys"), FunctionTemplate::New(Keys)->GetFunction());
+  thisObject->Set(String::NewSymbol("peek"), FunctionTemplate::New(Peek)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("resize"), FunctionTemplate::New(Resize)->GetFunction());
+  thisObject->Set(String::NewSymbol("set"), FunctionTemplate::New(Set)->GetFunction());
+  thisObject->Set(String::NewSymbol("stats"), FunctionTemplate::New(Stats)->GetFunction());
+  thisObject->Set(String::NewSymbol("toObject"), FunctionTemplate::New(ToObject)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+  thisObject->Set(String::NewSymbol("touch"), FunctionTemplate::New(Touch)->GetFunction());
+}
+
+void LruMap::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (argument->IsObject()) {
+    Handle<Value> callback = Handle<Object>::Cast(argument)->Get(String::NewSymbol("onEvict"));
+    if (callback->IsFunction()) {
+      onEvict = Persistent<Function>::New(Handle<Function>::Cast(callback));
+    }
+  }
+}
+
+bool LruMap::IsSupportedObject(Handle<Value> value) {
+  return value->IsObject();
+}
+
+bool LruMap::IsSupportedType(Handle<Value> value) {
+  return IsSupportedObject(value);
+}
+
+Handle<Value> LruMap::Evict(Handle<Object> thisObject) {
+  TryCatch tryCatch;
+  while (storage.size() > capacity) {
+    HandleScope scope;
+    Storage::iterator it = storage.end();
+    --it;
+    Element key = it->first;
+    Element value = it->second;
+    Handle<Value> parameters[2];
+    parameters[0] = key.ToValue();
+    parameters[1] = value.ToValue();
+    storage.erase(it);
+    key.Dispose();
+    value.Dispose();
+    evictions++;
+
+    if (!onEvict.IsEmpty()) {
+      // The callback must not modify this map while it is being trimmed.
+      iterationLevel++;
+      Handle<Value> result = onEvict->Call(Context::GetCurrent()->Global(), 2, parameters);
+      iterationLevel--;
+      if (result.IsEmpty()) {
+        return ThrowException(tryCatch.Exception());
+      }
+    }
+  }
+  return thisObject;
+}
+
+Handle<Value> LruMap::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool argError = true;
+  if (args.Length() >= 1 && args.Length() <= 2 && args[0]->IsUint32() && args[0]->Uint32Value() > 0) {
+    if (args[1]->IsUndefined()) {
+      argError = false;
+    } else if (args[1]->IsObject()) {
+      Handle<Value> callback = Handle<Object>::Cast(args[1])->Get(String::NewSymbol("onEvict"));
+      argError = !(callback->IsUndefined()) && !(callback->IsFunction());
+    }
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Arguments must be a positive integer capacity and optional options {onEvict: function}.")));
+  }
+
+  LruMap* obj = new LruMap(args[0]->Uint32Value());
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[1]);
+
+  return args.This();
+}
+
+Handle<Value> LruMap::Capacity(const Arguments& args) {
+  PROFILE_METHOD(capacity, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(capacity, args);
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  return scope.Close(Uint32::New(obj->capacity));
+}
+
+Handle<Value> LruMap::Get(const Arguments& args) {
+  PROFILE_METHOD(get, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("get(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    obj->misses++;
+    return Undefined();
+  }
+  obj->hits++;
+  if (!obj->IsIterating()) {
+    obj->storage.move_to_front(it);
+    obj->version++;
+  }
+  return scope.Close(it->second.ToValue());
+}
+
+Handle<Value> LruMap::GetAt(const Arguments& args) {
+  PROFILE_METHOD(getAt, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("getAt(index, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    Handle<Value> arg = args[i];
+    if (!(arg->IsUndefined()) && !(arg->IsNull()) && !(arg->IsUint32())) {
+      return ThrowException(Exception::Error(String::New("getAt(index, ...) takes only integer arguments.")));
+    }
+  }
+
+  return Collection<Storage>::Get(args);
+}
+
+Handle<Value> LruMap::Keys(const Arguments& args) {
+  PROFILE_METHOD(keys, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(keys, args);
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  Local<Array> array = Array::New((int) obj->storage.size());
+  Storage::iterator it = obj->storage.begin();
+  int i = 0;
+  while (it != obj->storage.end()) {
+    array->Set(i++, (it++)->first.ToValue());
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> LruMap::Peek(const Arguments& args) {
+  PROFILE_METHOD(peek, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("peek(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return Undefined();
+  }
+  return scope.Close(it->second.ToValue());
+}
+
+Handle<Value> LruMap::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(key, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.find(probe);
+    if (it != obj->storage.end()) {
+      Element key = it->first;
+      Element value = it->second;
+      obj->storage.erase(it);
+      key.Dispose();
+      value.Dispose();
+    }
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> LruMap::Resize(const Arguments& args) {
+  PROFILE_METHOD(resize, args);
+  CHECK_ITERATING(resize, args);
+  CHECK_WRITABLE(resize, args);
+  if (args.Length() != 1 || !(args[0]->IsUint32()) || args[0]->Uint32Value() == 0) {
+    return ThrowException(Exception::Error(String::New("resize(capacity) takes a positive integer argument.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  obj->capacity = args[0]->Uint32Value();
+  return scope.Close(obj->Evict(args.This()));
+}
+
+Handle<Value> LruMap::Set(const Arguments& args) {
+  PROFILE_METHOD(set, args);
+  CHECK_ITERATING(set, args);
+  CHECK_WRITABLE(set, args);
+  if (args.Length() != 2) {
+    return ThrowException(Exception::Error(String::New("set(key, value) takes a key and a value.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    obj->storage.push_front(Storage::value_type(Element::New(args[0], &obj->backing),
+        Element::New(args[1], &obj->backing)));
+  } else {
+    it->second.Dispose();
+    it->second = Element::New(args[1], &obj->backing);
+    obj->storage.move_to_front(it);
+  }
+  return scope.Close(obj->Evict(args.This()));
+}
+
+Handle<Value> LruMap::Stats(const Arguments& args) {
+  PROFILE_METHOD(stats, args);
+  if (args.Length() > 1 || (args.Length() == 1 && !(args[0]->IsBoolean()))) {
+    return ThrowException(Exception::Error(String::New("stats(reset) takes an optional boolean argument.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  Local<Object> result = Object::New();
+  result->Set(String::NewSymbol("hits"), Number::New(obj->hits));
+  result->Set(String::NewSymbol("misses"), Number::New(obj->misses));
+  result->Set(String::NewSymbol("evictions"), Number::New(obj->evictions));
+  if (args[0]->IsTrue()) {
+    obj->hits = obj->misses = obj->evictions = 0;
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> LruMap::ToObject(const Arguments& args) {
+  PROFILE_METHOD(toObject, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  Local<Object> result = Object::New();
+  Storage::iterator it = obj->storage.begin();
+  while (it != obj->storage.end()) {
+    result->Set(it->first.ToValue(), it->second.ToValue());
+    it++;
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> LruMap::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
+
+  HandleScope scope;
+  return scope.Close(CollectionUtil::Stringify(ToObject(args)));
+}
+
+Handle<Value> LruMap::Touch(const Arguments& args) {
+  PROFILE_METHOD(touch, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("touch(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  LruMap* obj = ObjectWrap::Unwrap<LruMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return scope.Close(Boolean::New(false));
+  }
+  if (!obj->IsIterating()) {
+    obj->storage.move_to_front(it);
+    obj->version++;
+  }
+  return scope.Close(Boolean::New(true));
+}
@@ -0,0 +1,62 @@
+#ifndef COLLECTION_LRU_MAP_H
+#define COLLECTION_LRU_MAP_H
+
+#include <node.h>
+#include "common.h"
+#include "LinkedHashMap.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class LruMap
+ *
+ * A map that holds at most a given number of entries. Entries are kept in a hash table, and are ordered from the most
+ * recently used to the least recently used one. When an entry is added to a full map, the least recently used entry
+ * is evicted.
+ */
+
+class LruMap : public Collection< LinkedHashMap<> > {
+  public:
+    typedef LinkedHashMap<> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    LruMap(uint32_t capacity);
+    virtual ~LruMap();
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    Handle<Value> Evict(Handle<Object> thisObject);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Capacity(const Arguments& args);
+    static Handle<Value> Get(const Arguments& args);
+    static Handle<Value> GetAt(const Arguments& args);
+    static Handle<Value> Keys(const Arguments& args);
+    static Handle<Value> Peek(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> Resize(const Arguments& args);
+    static Handle<Value> Set(const Arguments& args);
+    static Handle<Value> Stats(const Arguments& args);
+    static Handle<Value> ToObject(const Arguments& args);
+    static Handle<Value> ToString(const Arguments& args);
+    static Handle<Value> Touch(const Arguments& args);
+
+  private:
+    uint32_t capacity;
+    Persistent<Function> onEvict;
+    double hits;
+    double misses;
+    double evictions;
+};
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include "JsonWriter.h"
 #include "Map.h"
 
 using namespace std;
@@ -10,9 +12,9 @@ using namespace v8;
 
 Handle<Value> Map::GetValue(const Storage::value_type& value) const {
   HandleScope scope;
-  Persistent<Value> parameters[2];
-  parameters[0] = value.first;
-  parameters[1] = value.second;
+  Handle<Value> parameters[2];
+  parameters[0] = value.first.ToValue();
+  parameters[1] = value.second.ToValue();
   Local<Object> object = MapEntry::constructor->GetFunction()->NewInstance(2, parameters);
   return scope.Close(object);
 }
@@ -30,14 +32,28 @@ void Map::Init(Handle<Object> exports) {
 void Map::InitializeFields(Handle<Object> thisObject) {
   Collection<Storage>::InitializeFields(thisObject);
 
+  thisObject->Set(String::NewSymbol("clone"), FunctionTemplate::New(Clone)->GetFunction());
+  thisObject->Set(String::NewSymbol("compute"), FunctionTemplate::New(Compute)->GetFunction());
+  thisObject->Set(String::NewSymbol("drainTo"), FunctionTemplate::New(DrainTo)->GetFunction());
   thisObject->Set(String::NewSymbol("get"), FunctionTemplate::New(Get)->GetFunction());
   thisObject->Set(String::NewSymbol("getAt"), FunctionTemplate::New(GetAt)->GetFunction());
+  thisObject->Set(String::NewSymbol("getMany"), FunctionTemplate::New(GetMany)->GetFunction());
+  thisObject->Set(String::NewSymbol("getOrSet"), FunctionTemplate::New(GetOrSet)->GetFunction());
+  thisObject->Set(String::NewSymbol("hasMany"), FunctionTemplate::New(HasMany)->GetFunction());
+  thisObject->Set(String::NewSymbol("increment"), FunctionTemplate::New(Increment)->GetFunction());
   thisObject->Set(String::NewSymbol("keys"), FunctionTemplate::New(Keys)->GetFunction());
+  thisObject->Set(String::NewSymbol("merge"), FunctionTemplate::New(Merge)->GetFunction());
+  thisObject->Set(String::NewSymbol("moveFrom"), FunctionTemplate::New(MoveFrom)->GetFunction());
   thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
   thisObject->Set(String::NewSymbol("set"), FunctionTemplate::New(Set)->GetFunction());
   thisObject->Set(String::NewSymbol("setAll"), FunctionTemplate::New(SetAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("setMany"), FunctionTemplate::New(SetMany)->GetFunction());
+  thisObject->Set(String::NewSymbol("snapshot"), FunctionTemplate::New(Snapshot)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSON"), FunctionTemplate::New(ToJSON)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSONBuffer"), FunctionTemplate::New(ToJSONBuffer)->GetFunction());
   thisObject->Set(String::NewSymbol("toObject"), FunctionTemplate::New(ToObject)->GetFunction());
   thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+  thisObject->Set(String::NewSymbol("writeJSON"), FunctionTemplate::New(WriteJSON)->GetFunction());
 }
 
 void Map::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
@@ -46,9 +62,22 @@ void Map::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
     Handle<Object> initObject = Handle<Object>::Cast(argument);
     if (Map::constructor->HasInstance(argument)) {
       Map* init = ObjectWrap::Unwrap<Map>(initObject);
+      if (init == obj) {
+        return;
+      } else if (obj->storage.empty() && init->backing.IsEmpty()) {
+        obj->storage.Share(init->storage);
+        return;
+      }
       Storage::iterator it = init->storage.begin();
       while (it != init->storage.end()) {
-        obj->storage[Persistent<Value>::New(it->first)] = Persistent<Value>::New(it->second);
+        bool found;
+        Storage::iterator existing = obj->Locate(it->first, found);
+        if (!found) {
+          obj->storage.insert(existing, Storage::value_type(it->first.Copy(&obj->backing), it->second.Copy(&obj->backing)));
+        } else {
+          existing->second.Dispose();
+          existing->second = it->second.Copy(&obj->backing);
+        }
         it++;
       }
     } else {
@@ -56,13 +85,10 @@ void Map::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
       for (size_t i = 0; i < propertyNames->Length(); i++) {
         Local<Value> key = propertyNames->Get((uint32_t) i)->ToString();
         Local<Value> value = initObject->Get(key);
-        Storage::iterator it = obj->storage.find((Persistent<Value>) key);
-        if (it == obj->storage.end()) {
-          obj->storage[Persistent<Value>::New(key)] = Persistent<Value>::New(value);
-        } else {
-          it->second.Dispose();
-          it->second = Persistent<Value>::New(value);
-        }
+        ElementProbe probe(key);
+        bool found;
+        Storage::iterator it = obj->Locate(probe, found);
+        obj->Store(it, found, key, value);
       }
     }
   }
@@ -76,6 +102,101 @@ bool Map::IsSupportedType(Handle<Value> value) {
   return IsSupportedObject(value);
 }
 
+/*
+ * Find the entry of a key with a single descent. If there is none, the iterator returned is the position before which
+ * the key belongs, so that Store() inserts the entry there without descending again.
+ */
+Map::Storage::iterator Map::Locate(const Element& key, bool& found) {
+  PROFILE_LOOKUP();
+  Storage::iterator it = storage.lower_bound(key);
+  found = it != storage.end() && !ValueComparator()(key, it->first);
+  return it;
+}
+
+/*
+ * Replace the value of the entry found by Locate() in place, or insert the entry at the position it returned.
+ */
+void Map::Store(Storage::iterator& it, bool found, Handle<Value> key, Handle<Value> value) {
+  if (found) {
+    it->second.Dispose();
+    it->second = Element::New(value, &backing);
+  } else {
+    it = storage.insert(it, Storage::value_type(Element::New(key, &backing), Element::New(value, &backing)));
+  }
+}
+
+void Map::Erase(Storage::iterator it) {
+  Element key = it->first;
+  Element value = it->second;
+  storage.erase(it);
+  key.Dispose();
+  value.Dispose();
+}
+
+/*
+ * Call the function given to compute(), getOrSet() or merge(). As in each(), the function cannot modify this map.
+ * Returns an empty handle if the function throws.
+ */
+Handle<Value> Map::Invoke(Handle<Value> function, int argc, Handle<Value> parameters[]) {
+  iterationLevel++;
+  Handle<Value> result = Handle<Function>::Cast(function)->Call(Context::GetCurrent()->Global(), argc, parameters);
+  iterationLevel--;
+  return result;
+}
+
+/*
+ * Begin the write again after a function was called, since the function may have cloned or hashed this map. The key
+ * is located again only if a clone came to share the storage.
+ */
+Map::Storage::iterator Map::Resume(const Element& key, Storage::iterator it, bool& found) {
+  bool shared = storage.IsShared();
+  BeginWrite();
+  return shared ? Locate(key, found) : it;
+}
+
+/*
+ * Build the object that toObject() returns, in which each key names a property by its string.
+ */
+Local<Object> Map::BuildObject(Map* map) {
+  HandleScope scope;
+  Local<Object> result = Object::New();
+  Storage::iterator it = map->storage.begin();
+  while (it != map->storage.end()) {
+    result->Set(it->first.ToValue(), it->second.ToValue());
+    it++;
+  }
+  return scope.Close(result);
+}
+
+/*
+ * Hand the entries of a map over to another, leaving the source empty. Entries keep what they own, and an empty map
+ * takes over the storage of one holding only primitive values. A moved entry replaces the value of an equal key.
+ */
+void Map::MoveEntries(Map* target, Map* source) {
+  if (target->storage.empty() && source->backing.IsEmpty()) {
+    target->storage.swap(source->storage);
+    return;
+  }
+  Storage::iterator it = source->storage.begin();
+  while (it != source->storage.end()) {
+    bool found;
+    Storage::iterator existing = target->Locate(it->first, found);
+    if (!found) {
+      target->storage.insert(existing, Storage::value_type(it->first.Move(&target->backing), it->second.Move(&target->backing)));
+    } else {
+      existing->second.Dispose();
+      existing->second = it->second.Move(&target->backing);
+      if (it->first.IsPrimitive()) {
+        Element key = it->first;
+        key.Dispose();
+      }
+    }
+    it++;
+  }
+  source->storage.clear();
+  source->backing.Clear();
+}
+
 Handle<Value> Map::New(const Arguments& args) {
   if (!args.IsConstructCall()) {
     return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
@@ -101,7 +222,75 @@ Handle<Value> Map::New(const Arguments& args) {
   return args.This();
 }
 
+Handle<Value> Map::Clone(const Arguments& args) {
+  PROFILE_METHOD(clone, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clone, args);
+
+  return CollectionUtil::Clone<Map>(args.This(), false);
+}
+
+Handle<Value> Map::Compute(const Arguments& args) {
+  PROFILE_METHOD(compute, args);
+  CHECK_ITERATING(compute, args);
+  CHECK_WRITABLE(compute, args);
+  if (args.Length() != 2 || !args[1]->IsFunction()) {
+    return ThrowException(Exception::Error(String::New("compute(key, function) takes a key and a function.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  ElementProbe probe(args[0]);
+  bool found;
+  Storage::iterator it = obj->Locate(probe, found);
+  Handle<Value> parameters[2];
+  if (found) {
+    parameters[0] = it->second.ToValue();
+  } else {
+    parameters[0] = Undefined();
+  }
+  parameters[1] = args[0];
+  TryCatch tryCatch;
+  Handle<Value> result = obj->Invoke(args[1], 2, parameters);
+  if (result.IsEmpty()) {
+    return ThrowException(tryCatch.Exception());
+  }
+  it = obj->Resume(probe, it, found);
+  if (result->IsUndefined()) {
+    if (found) {
+      obj->Erase(it);
+    }
+    return Undefined();
+  }
+  obj->Store(it, found, args[0], result);
+  return scope.Close(result);
+}
+
+Handle<Value> Map::DrainTo(const Arguments& args) {
+  PROFILE_METHOD(drainTo, args);
+  CHECK_ITERATING(drainTo, args);
+  CHECK_WRITABLE(drainTo, args);
+  if (args.Length() != 1 || !Map::constructor->HasInstance(args[0])) {
+    return ThrowException(Exception::Error(String::New("drainTo(object) takes one map argument.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  Map* target = ObjectWrap::Unwrap<Map>(Handle<Object>::Cast(args[0]));
+  if (target == obj) {
+    return args.This();
+  }
+  if (target->IsIterating()) {
+    return ThrowException(Exception::Error(String::New("drainTo() cannot be called while the target is being iterated.")));
+  }
+  if (!target->BeginWrite()) {
+    return ThrowException(Exception::Error(String::New("drainTo() cannot be called with a snapshot.")));
+  }
+  MoveEntries(target, obj);
+  return args.This();
+}
+
 Handle<Value> Map::Get(const Arguments& args) {
+  PROFILE_METHOD(get, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("get(key, ...) takes at least one argument.")));
   }
@@ -109,17 +298,20 @@ Handle<Value> Map::Get(const Arguments& args) {
   HandleScope scope;
   Map* obj = ObjectWrap::Unwrap<Map>(args.This());
   if (args.Length() == 1) {
-    Storage::iterator it = obj->storage.find((Persistent<Value>) args[0]);
+    ElementProbe probe(args[0]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.find(probe);
     if (it != obj->storage.end()) {
-      return scope.Close(Local<Value>::New(it->second));
+      return scope.Close(it->second.ToValue());
     }
   } else {
     Handle<Array> array = Array::New();
     for (int i = 0; i < args.Length(); i++) {
-      Handle<Value> arg = args[i];
-      Storage::iterator it = obj->storage.find((Persistent<Value>) arg);
+      ElementProbe probe(args[i]);
+      PROFILE_LOOKUP();
+      Storage::iterator it = obj->storage.find(probe);
       if (it != obj->storage.end()) {
-        array->Set(i, Local<Value>::New(it->second));
+        array->Set(i, it->second.ToValue());
       }
     }
     return scope.Close(array);
@@ -128,6 +320,7 @@ Handle<Value> Map::Get(const Arguments& args) {
 }
 
 Handle<Value> Map::GetAt(const Arguments& args) {
+  PROFILE_METHOD(getAt, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("getAt(index, ...) takes at least one argument.")));
   }
@@ -141,7 +334,99 @@ Handle<Value> Map::GetAt(const Arguments& args) {
   return Collection<Storage>::Get(args);
 }
 
+Handle<Value> Map::GetMany(const Arguments& args) {
+  PROFILE_METHOD(getMany, args);
+  uint32_t length;
+  if (args.Length() != 1 || !CollectionUtil::GetArrayLength(args[0], length)) {
+    return ThrowException(Exception::Error(String::New("getMany(keys) takes an array or a typed array.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  Local<Array> array = Array::New(length);
+  SortedProbes probes(Handle<Object>::Cast(args[0]), length);
+  Storage::iterator finger = obj->storage.begin();
+  for (uint32_t i = 0; i < probes.Size(); i++) {
+    bool found;
+    finger = probes.Seek(obj->storage, i, finger, found);
+    if (found) {
+      array->Set(probes.Index(i), finger->second.ToValue());
+    }
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> Map::GetOrSet(const Arguments& args) {
+  PROFILE_METHOD(getOrSet, args);
+  CHECK_ITERATING(getOrSet, args);
+  CHECK_WRITABLE(getOrSet, args);
+  if (args.Length() != 2) {
+    return ThrowException(Exception::Error(String::New("getOrSet(key, value) takes a key and a value or function.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  ElementProbe probe(args[0]);
+  bool found;
+  Storage::iterator it = obj->Locate(probe, found);
+  if (found) {
+    return scope.Close(it->second.ToValue());
+  }
+  Handle<Value> value = args[1];
+  if (value->IsFunction()) {
+    Handle<Value> parameters[1];
+    parameters[0] = args[0];
+    TryCatch tryCatch;
+    value = obj->Invoke(args[1], 1, parameters);
+    if (value.IsEmpty()) {
+      return ThrowException(tryCatch.Exception());
+    }
+    it = obj->Resume(probe, it, found);
+  }
+  obj->Store(it, found, args[0], value);
+  return scope.Close(value);
+}
+
+Handle<Value> Map::HasMany(const Arguments& args) {
+  PROFILE_METHOD(hasMany, args);
+  uint32_t length;
+  if (args.Length() != 1 || !CollectionUtil::GetArrayLength(args[0], length)) {
+    return ThrowException(Exception::Error(String::New("hasMany(keys) takes an array or a typed array.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  return scope.Close(CollectionUtil::HasMany(obj->storage, Handle<Object>::Cast(args[0]), length));
+}
+
+Handle<Value> Map::Increment(const Arguments& args) {
+  PROFILE_METHOD(increment, args);
+  CHECK_ITERATING(increment, args);
+  CHECK_WRITABLE(increment, args);
+  if (args.Length() == 0 || args.Length() > 2 || (args.Length() == 2 && !args[1]->IsNumber())) {
+    return ThrowException(Exception::Error(String::New("increment(key, delta) takes a key and an optional number.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  double value = args.Length() == 2 ? args[1]->NumberValue() : 1;
+  ElementProbe probe(args[0]);
+  bool found;
+  Storage::iterator it = obj->Locate(probe, found);
+  if (found) {
+    if (!it->second.IsNumber()) {
+      return ThrowException(Exception::Error(String::New("increment() cannot be called on a value that is not a number.")));
+    }
+    value += it->second.NumberValue();
+    it->second = Element::NewNumber(value);
+  } else {
+    obj->storage.insert(it, Storage::value_type(Element::New(args[0], &obj->backing), Element::NewNumber(value)));
+  }
+  return scope.Close(Number::New(value));
+}
+
 Handle<Value> Map::Keys(const Arguments& args) {
+  PROFILE_METHOD(keys, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(keys, args);
 
   HandleScope scope;
@@ -150,13 +435,72 @@ Handle<Value> Map::Keys(const Arguments& args) {
   Storage::iterator it = obj->storage.begin();
   int i = 0;
   while (it != obj->storage.end()) {
-    array->Set(i++, (it++)->first);
+    array->Set(i++, (it++)->first.ToValue());
   }
   return scope.Close(array);
 }
 
+Handle<Value> Map::Merge(const Arguments& args) {
+  PROFILE_METHOD(merge, args);
+  CHECK_ITERATING(merge, args);
+  CHECK_WRITABLE(merge, args);
+  if (args.Length() != 3 || !args[2]->IsFunction()) {
+    return ThrowException(Exception::Error(String::New("merge(key, value, function) takes a key, a value and a function.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  ElementProbe probe(args[0]);
+  bool found;
+  Storage::iterator it = obj->Locate(probe, found);
+  Handle<Value> value = args[1];
+  if (found) {
+    Handle<Value> parameters[2];
+    parameters[0] = it->second.ToValue();
+    parameters[1] = args[1];
+    TryCatch tryCatch;
+    value = obj->Invoke(args[2], 2, parameters);
+    if (value.IsEmpty()) {
+      return ThrowException(tryCatch.Exception());
+    }
+    it = obj->Resume(probe, it, found);
+    if (value->IsUndefined()) {
+      obj->Erase(it);
+      return Undefined();
+    }
+  }
+  obj->Store(it, found, args[0], value);
+  return scope.Close(value);
+}
+
+Handle<Value> Map::MoveFrom(const Arguments& args) {
+  PROFILE_METHOD(moveFrom, args);
+  CHECK_ITERATING(moveFrom, args);
+  CHECK_WRITABLE(moveFrom, args);
+  if (args.Length() != 1 || !Map::constructor->HasInstance(args[0])) {
+    return ThrowException(Exception::Error(String::New("moveFrom(object) takes one map argument.")));
+  }
+
+  HandleScope scope;
+  Map* obj = ObjectWrap::Unwrap<Map>(args.This());
+  Map* source = ObjectWrap::Unwrap<Map>(Handle<Object>::Cast(args[0]));
+  if (source == obj) {
+    return args.This();
+  }
+  if (source->IsIterating()) {
+    return ThrowException(Exception::Error(String::New("moveFrom() cannot be called while the source is being iterated.")));
+  }
+  if (!source->BeginWrite()) {
+    return ThrowException(Exception::Error(String::New("moveFrom() cannot be called with a snapshot.")));
+  }
+  MoveEntries(obj, source);
+  return args.This();
+}
+
 Handle<Value> Map::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
   CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("remove(key, ...) takes at least one argument.")));
   }
@@ -164,40 +508,38 @@ Handle<Value> Map::Remove(const Arguments& args) {
   HandleScope scope;
   Map* obj = ObjectWrap::Unwrap<Map>(args.This());
   for (int i = 0; i < args.Length(); i++) {
-    Handle<Value> arg = args[i];
-    Storage::iterator it = obj->storage.find((Persistent<Value>) arg);
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.find(probe);
     if (it != obj->storage.end()) {
-      Persistent<Value> key = it->first;
-      Persistent<Value> value = it->second;
-      obj->storage.erase(it);
-      key.Dispose();
-      value.Dispose();
+      obj->Erase(it);
     }
   }
   return scope.Close(args.This());
 }
 
 Handle<Value> Map::Set(const Arguments& args) {
+  PROFILE_METHOD(set, args);
   CHECK_ITERATING(set, args);
+  CHECK_WRITABLE(set, args);
   if (args.Length() != 2) {
     return ThrowException(Exception::Error(String::New("set(key, value) takes a key and a value.")));
   }
 
   HandleScope scope;
   Map* obj = ObjectWrap::Unwrap<Map>(args.This());
-  Storage::iterator it = obj->storage.find((Persistent<Value>) args[0]);
-  if (it == obj->storage.end()) {
-    obj->storage[Persistent<Value>::New(args[0])] = Persistent<Value>::New(args[1]);
-  } else {
-    it->second.Dispose();
-    it->second = Persistent<Value>::New(args[1]);
-  }
+  ElementProbe probe(args[0]);
+  bool found;
+  Storage::iterator it = obj->Locate(probe, found);
+  obj->Store(it, found, args[0], args[1]);
 
   return args.This();
 }
 
 Handle<Value> Map::SetAll(const Arguments& args) {
+  PROFILE_METHOD(setAll, args);
   CHECK_ITERATING(setAll, args);
+  CHECK_WRITABLE(setAll, args);
   if (args.Length() != 1 || !args[0]->IsObject()) {
     return ThrowException(Exception::Error(String::New("setAll(object) takes one object argument.")));
   }
@@ -209,25 +551,152 @@ Handle<Value> Map::SetAll(const Arguments& args) {
   return args.This();
 }
 
-Handle<Value> Map::ToObject(const Arguments& args) {
-  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+Handle<Value> Map::SetMany(const Arguments& args) {
+  PROFILE_METHOD(setMany, args);
+  CHECK_ITERATING(setMany, args);
+  CHECK_WRITABLE(setMany, args);
+  uint32_t length;
+  uint32_t valuesLength;
+  if (args.Length() != 2 || !CollectionUtil::GetArrayLength(args[0], length) ||
+      !CollectionUtil::GetArrayLength(args[1], valuesLength) || length != valuesLength) {
+    return ThrowException(Exception::Error(String::New("setMany(keys, values) takes two arrays or typed arrays of the same length.")));
+  }
 
   HandleScope scope;
   Map* obj = ObjectWrap::Unwrap<Map>(args.This());
-  Local<Object> result = Object::New();
-  Storage::iterator it = obj->storage.begin();
-  while (it != obj->storage.end()) {
-    result->Set(it->first, Local<Value>::New(it->second));
-    it++;
+  Handle<Object> valuesObject = Handle<Object>::Cast(args[1]);
+  vector< Local<Value> > values(length);
+  for (uint32_t i = 0; i < length; i++) {
+    values[i] = valuesObject->Get(i);
   }
-  return scope.Close(result);
+  SortedProbes probes(Handle<Object>::Cast(args[0]), length);
+  Storage::iterator finger = obj->storage.begin();
+  for (uint32_t i = 0; i < probes.Size(); i++) {
+    bool found;
+    finger = probes.Seek(obj->storage, i, finger, found);
+    obj->Store(finger, found, probes.Key(i), values[probes.Index(i)]);
+  }
+  return args.This();
+}
+
+Handle<Value> Map::Snapshot(const Arguments& args) {
+  PROFILE_METHOD(snapshot, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(snapshot, args);
+
+  return CollectionUtil::Clone<Map>(args.This(), true);
+}
+
+Handle<Value> Map::ToJSON(const Arguments& args) {
+  PROFILE_METHOD(toJSON, args);
+
+  // JSON.stringify() passes the key of the map, which is ignored.
+  HandleScope scope;
+  return scope.Close(BuildObject(ObjectWrap::Unwrap<Map>(args.This())));
+}
+
+Handle<Value> Map::ToObject(const Arguments& args) {
+  PROFILE_METHOD(toObject, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+
+  HandleScope scope;
+  return scope.Close(BuildObject(ObjectWrap::Unwrap<Map>(args.This())));
 }
 
 Handle<Value> Map::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
 
   HandleScope scope;
-  return scope.Close(CollectionUtil::Stringify(ToObject(args)));
+  TryCatch tryCatch;
+  JsonWriter writer;
+  ObjectWrap::Unwrap<Map>(args.This())->WriteJson(writer);
+  if (writer.HasFailed()) {
+    return ThrowException(tryCatch.Exception());
+  }
+  return scope.Close(writer.ToString());
+}
+
+/*
+ * Keys become the strings that name the properties of the object, so that keys such as 1 and "1" name the same
+ * property, which holds the last of their values at the place of the first. As in the object, properties named by
+ * array indexes come first in numeric order, and the others in the order of the keys. "__proto__" names no property.
+ */
+void Map::WriteJson(JsonWriter& writer) {
+  if (!writer.Enter(this)) {
+    return;
+  }
+  iterationLevel++;
+
+  // Keys that are all strings, or all numbers of one type, have distinct names. Keys of different types may not,
+  // such as 0 and -0, or true and new Boolean(true).
+  bool distinct = true;
+  if (!storage.empty()) {
+    Storage::iterator last = storage.end();
+    last--;
+    int firstType = storage.begin()->first.GetTypeScore();
+    int lastType = last->first.GetTypeScore();
+    distinct = firstType == lastType && (firstType == 5 || firstType == 6 || firstType == 8 || firstType == 11);
+  }
+
+  vector<JsonProperty> properties(storage.size());
+  vector< pair<uint32_t, size_t> > indexes;
+  std::map<string, size_t> names;
+  size_t count = 0;
+  for (Storage::iterator it = storage.begin(); it != storage.end(); it++) {
+    JsonProperty& property = properties[count];
+    if (!writer.GetKey(it->first, property.key)) {
+      break;
+    } else if (property.key == "__proto__") {
+      continue;
+    } else if (!distinct) {
+      pair<std::map<string, size_t>::iterator, bool> name = names.insert(make_pair(property.key, count));
+      if (!name.second) {
+        properties[name.first->second].value = &it->second;
+        continue;
+      }
+    }
+    property.value = &it->second;
+    property.isIndex = JsonWriter::IsArrayIndex(property.key.data(), property.key.size(), property.index);
+    if (property.isIndex) {
+      indexes.push_back(make_pair(property.index, count));
+    }
+    count++;
+  }
+  sort(indexes.begin(), indexes.end());
+
+  vector<size_t> order;
+  order.reserve(count);
+  for (size_t i = 0; i < indexes.size(); i++) {
+    order.push_back(indexes[i].second);
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (!properties[i].isIndex) {
+      order.push_back(i);
+    }
+  }
+
+  writer.Put('{');
+  bool first = true;
+  for (size_t i = 0; i < order.size() && !writer.HasFailed(); i++) {
+    const JsonProperty& property = properties[order[i]];
+    size_t mark = writer.Mark();
+    if (!first) {
+      writer.Put(',');
+    }
+    writer.WriteString(property.key.data(), property.key.size());
+    writer.Put(':');
+    PROFILE_VISITS(1);
+    if (writer.Write(*property.value)) {
+      first = false;
+      writer.Checkpoint();
+    } else {
+      // Properties of undefined values and functions are left out.
+      writer.Rewind(mark);
+    }
+  }
+  writer.Put('}');
+  iterationLevel--;
+  writer.Leave();
 }
 
 
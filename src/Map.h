@@ -4,6 +4,7 @@
 #include <map>
 #include <node.h>
 #include "common.h"
+#include "Pool.h"
 
 using namespace std;
 using namespace v8;
@@ -13,12 +14,18 @@ using namespace v8;
  * class Set
  */
 
-class Map : public Collection< map<Persistent<Value>, Persistent<Value>, ValueComparator> > {
+class Map : public Collection< SharedStorage< map<Element, Element, ValueComparator, PoolAllocator<pair<const Element, Element> > > > > {
   public:
-    typedef map<Persistent<Value>, Persistent<Value>, ValueComparator> Storage;
+    typedef SharedStorage< map<Element, Element, ValueComparator, PoolAllocator<pair<const Element, Element> > > > Storage;
 
     virtual Handle<Value> GetValue(const Storage::value_type& value) const;
 
+    /*
+     * Write the entries as the JSON text of an object, the same as JSON.stringify() gives for toObject(), without
+     * creating the object.
+     */
+    virtual void WriteJson(JsonWriter& writer);
+
     static void Init(Handle<Object> exports);
 
   protected:
@@ -27,16 +34,46 @@ class Map : public Collection< map<Persistent<Value>, Persistent<Value>, ValueCo
     virtual bool IsSupportedObject(Handle<Value> value);
     virtual bool IsSupportedType(Handle<Value> value);
 
+    Storage::iterator Locate(const Element& key, bool& found);
+    void Store(Storage::iterator& it, bool found, Handle<Value> key, Handle<Value> value);
+    void Erase(Storage::iterator it);
+    Handle<Value> Invoke(Handle<Value> function, int argc, Handle<Value> parameters[]);
+    Storage::iterator Resume(const Element& key, Storage::iterator it, bool& found);
+
+    static Local<Object> BuildObject(Map* map);
+    static void MoveEntries(Map* target, Map* source);
+
     static Handle<Value> New(const Arguments& args);
 
+    static Handle<Value> Clone(const Arguments& args);
+    static Handle<Value> Compute(const Arguments& args);
+    static Handle<Value> DrainTo(const Arguments& args);
     static Handle<Value> Get(const Arguments& args);
     static Handle<Value> GetAt(const Arguments& args);
+    static Handle<Value> GetMany(const Arguments& args);
+    static Handle<Value> GetOrSet(const Arguments& args);
+    static Handle<Value> HasMany(const Arguments& args);
+    static Handle<Value> Increment(const Arguments& args);
     static Handle<Value> Keys(const Arguments& args);
+    static Handle<Value> Merge(const Arguments& args);
+    static Handle<Value> MoveFrom(const Arguments& args);
     static Handle<Value> Remove(const Arguments& args);
     static Handle<Value> Set(const Arguments& args);
     static Handle<Value> SetAll(const Arguments& args);
+    static Handle<Value> SetMany(const Arguments& args);
+    static Handle<Value> Snapshot(const Arguments& args);
+    static Handle<Value> ToJSON(const Arguments& args);
     static Handle<Value> ToObject(const Arguments& args);
     static Handle<Value> ToString(const Arguments& args);
+
+  private:
+    // A property of the object written by WriteJson().
+    struct JsonProperty {
+      string key;
+      uint32_t index;
+      bool isIndex;
+      const Element* value;
+    };
 };
 
 
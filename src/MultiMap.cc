@@ -0,0 +1,289 @@
+#include "MultiMap.h"
+#include "Map.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class MultiMap
+ */
+
+Handle<Value> MultiMap::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  Handle<Value> parameters[2];
+  parameters[0] = value.first.ToValue();
+  parameters[1] = value.second.ToValue();
+  Local<Object> object = MapEntry::constructor->GetFunction()->NewInstance(2, parameters);
+  return scope.Close(object);
+}
+
+void MultiMap::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("MultiMap"));
+
+  exports->Set(String::NewSymbol("MultiMap"), constructor->GetFunction());
+}
+
+void MultiMap::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("count"), FunctionTemplate::New(Count)->GetFunction());
+  thisObject->Set(String::NewSymbol("get"), FunctionTemplate::New(Get)->GetFunction());
+  thisObject->Set(String::NewSymbol("getAt"), FunctionTemplate::New(GetAt)->GetFunction());
+  thisObject->Set(String::NewSymbol("keys"), FunctionTemplate::New(Keys)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("removeValue"), FunctionTemplate::New(RemoveValue)->GetFunction());
+  thisObject->Set(String::NewSymbol("toObject"), FunctionTemplate::New(ToObject)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+}
+
+void MultiMap::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (constructor->HasInstance(argument)) {
+    MultiMap* other = ObjectWrap::Unwrap<MultiMap>(Handle<Object>::Cast(argument));
+    Storage::iterator it = other->storage.begin();
+    while (it != other->storage.end()) {
+      HandleScope scope;
+      Vector* values = GetValues(it->first.ToValue());
+      values->BeginWrite();
+      Vector::Storage::const_iterator value = it.node->link.values->storage.begin();
+      while (value != it.node->link.values->storage.end()) {
+        values->storage.push_back((value++)->Copy(&values->backing));
+      }
+      it++;
+    }
+  }
+}
+
+bool MultiMap::IsSupportedObject(Handle<Value> value) {
+  return constructor->HasInstance(value);
+}
+
+bool MultiMap::IsSupportedType(Handle<Value> value) {
+  return true;
+}
+
+/*
+ * Get the values of a key, adding the key with an empty Vector if it is not in the map.
+ */
+Vector* MultiMap::GetValues(Handle<Value> key) {
+  ElementProbe probe(key);
+  PROFILE_LOOKUP();
+  Storage::iterator it = storage.find(probe);
+  if (it == storage.end()) {
+    HandleScope scope;
+    Local<Object> object = Vector::constructor->GetFunction()->NewInstance();
+    it = storage.push_back(Storage::value_type(Element::New(key, &backing), Element::New(object, &backing)));
+    it.node->link.values = ObjectWrap::Unwrap<Vector>(object);
+  }
+  return it.node->link.values;
+}
+
+Handle<Value> MultiMap::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  if (args.Length() > 1 || !(args[0]->IsUndefined() || constructor->HasInstance(args[0]))) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional multimap.")));
+  }
+
+  MultiMap* obj = new MultiMap();
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+
+  return args.This();
+}
+
+Handle<Value> MultiMap::Add(const Arguments& args) {
+  PROFILE_METHOD(add, args);
+  CHECK_ITERATING(add, args);
+  CHECK_WRITABLE(add, args);
+  if (args.Length() < 2) {
+    return ThrowException(Exception::Error(String::New("add(key, value, ...) takes a key and at least one value.")));
+  }
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  Vector* values = obj->GetValues(args[0]);
+  if (values->IsIterating()) {
+    return ThrowException(Exception::Error(String::New("add() cannot be called while the values of the key are being iterated.")));
+  }
+  values->BeginWrite();
+  for (int i = 1; i < args.Length(); i++) {
+    values->storage.push_back(Element::New(args[i], &values->backing));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> MultiMap::Count(const Arguments& args) {
+  PROFILE_METHOD(count, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("count(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return scope.Close(Uint32::New(0));
+  }
+  return scope.Close(Uint32::New((uint32_t) it.node->link.values->storage.size()));
+}
+
+Handle<Value> MultiMap::Get(const Arguments& args) {
+  PROFILE_METHOD(get, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("get(key) takes one argument.")));
+  }
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return Undefined();
+  }
+  return scope.Close(it->second.ToValue());
+}
+
+Handle<Value> MultiMap::GetAt(const Arguments& args) {
+  PROFILE_METHOD(getAt, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("getAt(index, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    Handle<Value> arg = args[i];
+    if (!(arg->IsUndefined()) && !(arg->IsNull()) && !(arg->IsUint32())) {
+      return ThrowException(Exception::Error(String::New("getAt(index, ...) takes only integer arguments.")));
+    }
+  }
+
+  return Collection<Storage>::Get(args);
+}
+
+Handle<Value> MultiMap::Keys(const Arguments& args) {
+  PROFILE_METHOD(keys, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(keys, args);
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  Local<Array> array = Array::New((int) obj->storage.size());
+  Storage::iterator it = obj->storage.begin();
+  int i = 0;
+  while (it != obj->storage.end()) {
+    array->Set(i++, (it++)->first.ToValue());
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> MultiMap::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(key, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.find(probe);
+    if (it != obj->storage.end()) {
+      Element key = it->first;
+      Element value = it->second;
+      obj->storage.erase(it);
+      key.Dispose();
+      value.Dispose();
+    }
+  }
+  return scope.Close(args.This());
+}
+
+/*
+ * Remove the first value of a key that is equal to the given value. A key is removed with its last value.
+ */
+Handle<Value> MultiMap::RemoveValue(const Arguments& args) {
+  PROFILE_METHOD(removeValue, args);
+  CHECK_ITERATING(removeValue, args);
+  CHECK_WRITABLE(removeValue, args);
+  if (args.Length() != 2) {
+    return ThrowException(Exception::Error(String::New("removeValue(key, value) takes a key and a value.")));
+  }
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it == obj->storage.end()) {
+    return scope.Close(Boolean::New(false));
+  }
+  Vector* values = it.node->link.values;
+  if (values->IsIterating()) {
+    return ThrowException(Exception::Error(String::New("removeValue() cannot be called while the values of the key are being iterated.")));
+  }
+  ElementProbe valueProbe(args[1]);
+  Vector::Storage::iterator value = values->storage.begin();
+  ValueComparator comparator;
+  while (value != values->storage.end()) {
+    PROFILE_VISITS(1);
+    if (!comparator(*value, valueProbe) && !comparator(valueProbe, *value)) {
+      break;
+    }
+    value++;
+  }
+  if (value == values->storage.end()) {
+    return scope.Close(Boolean::New(false));
+  }
+  values->BeginWrite();
+  Element element = *value;
+  values->storage.erase(value);
+  element.Dispose();
+  if (values->storage.empty()) {
+    Element key = it->first;
+    Element list = it->second;
+    obj->storage.erase(it);
+    key.Dispose();
+    list.Dispose();
+  }
+  return scope.Close(Boolean::New(true));
+}
+
+Handle<Value> MultiMap::ToObject(const Arguments& args) {
+  PROFILE_METHOD(toObject, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+
+  HandleScope scope;
+  MultiMap* obj = ObjectWrap::Unwrap<MultiMap>(args.This());
+  Local<Object> result = Object::New();
+  Storage::iterator it = obj->storage.begin();
+  while (it != obj->storage.end()) {
+    Vector::Storage& values = it.node->link.values->storage;
+    Local<Array> array = Array::New((int) values.size());
+    for (uint32_t i = 0; i < values.size(); i++) {
+      array->Set(i, values[i].ToValue());
+    }
+    result->Set(it->first.ToValue(), array);
+    it++;
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> MultiMap::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
+
+  HandleScope scope;
+  return scope.Close(CollectionUtil::Stringify(ToObject(args)));
+}
@@ -0,0 +1,64 @@
+#ifndef COLLECTION_MULTI_MAP_H
+#define COLLECTION_MULTI_MAP_H
+
+#include <node.h>
+#include "common.h"
+#include "LinkedHashMap.h"
+#include "Vector.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class ValueList
+ *
+ * The Vector that holds the values of a key of a MultiMap. The map holds the Vector as the value of the entry; the
+ * link points to it, so that values are added without unwrapping it.
+ */
+
+struct ValueList {
+  ValueList() : values(NULL) {
+  }
+
+  Vector* values;
+};
+
+
+/*
+ * class MultiMap
+ *
+ * A map that holds any number of values per key. Keys are kept in a hash table in the order they were first added,
+ * and the values of each key in a Vector, in the order they were added.
+ */
+
+class MultiMap : public Collection< LinkedHashMap<ValueList> > {
+  public:
+    typedef LinkedHashMap<ValueList> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    Vector* GetValues(Handle<Value> key);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> Count(const Arguments& args);
+    static Handle<Value> Get(const Arguments& args);
+    static Handle<Value> GetAt(const Arguments& args);
+    static Handle<Value> Keys(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> RemoveValue(const Arguments& args);
+    static Handle<Value> ToObject(const Arguments& args);
+    static Handle<Value> ToString(const Arguments& args);
+};
+
+#endif
@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <vector>
+#include "MultiSet.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class MultiSet
+ */
+
+MultiSet::MultiSet() : total(0) {
+}
+
+Handle<Value> MultiSet::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  return scope.Close(value.first.ToValue());
+}
+
+void MultiSet::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("MultiSet"));
+
+  exports->Set(String::NewSymbol("MultiSet"), constructor->GetFunction());
+}
+
+void MultiSet::InitializeFields(Handle<Object> thisObject) {
+  // Functions of Collection that remove elements by index are left out, since they would not keep the total count.
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("count"), FunctionTemplate::New(Count)->GetFunction());
+  thisObject->Set(String::NewSymbol("distinctSize"), FunctionTemplate::New(DistinctSize)->GetFunction());
+  thisObject->Set(String::NewSymbol("equals"), FunctionTemplate::New(Equals)->GetFunction());
+  thisObject->Set(String::NewSymbol("has"), FunctionTemplate::New(Has)->GetFunction());
+  thisObject->Set(String::NewSymbol("isEmpty"), FunctionTemplate::New(IsEmpty)->GetFunction());
+  thisObject->Set(String::NewSymbol("mostCommon"), FunctionTemplate::New(MostCommon)->GetFunction());
+  thisObject->Set(String::NewSymbol("profile"), FunctionTemplate::New(Profile)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("size"), FunctionTemplate::New(Size)->GetFunction());
+  thisObject->Set(String::NewSymbol("toArray"), FunctionTemplate::New(ToArray)->GetFunction());
+  thisObject->Set(String::NewSymbol("toObject"), FunctionTemplate::New(ToObject)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+
+  thisObject->Set(String::NewSymbol("each"), FunctionTemplate::New(Each)->GetFunction());
+  thisObject->Set(String::NewSymbol("filter"), FunctionTemplate::New(Filter)->GetFunction());
+  thisObject->Set(String::NewSymbol("find"), FunctionTemplate::New(Find)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduce"), FunctionTemplate::New(Reduce)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduceRight"), FunctionTemplate::New(ReduceRight)->GetFunction());
+}
+
+void MultiSet::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (argument->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(argument);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      Add(array->Get(i), 1);
+    }
+  } else if (constructor->HasInstance(argument)) {
+    MultiSet* other = ObjectWrap::Unwrap<MultiSet>(Handle<Object>::Cast(argument));
+    Storage::iterator it = other->storage.begin();
+    while (it != other->storage.end()) {
+      Storage::iterator added = storage.push_back(Storage::value_type(it->first.Copy(&backing), Element()));
+      added.node->link.count = it.node->link.count;
+      it++;
+    }
+    total = other->total;
+  }
+}
+
+bool MultiSet::IsSupportedObject(Handle<Value> value) {
+  return constructor->HasInstance(value);
+}
+
+bool MultiSet::IsSupportedType(Handle<Value> value) {
+  return true;
+}
+
+void MultiSet::Add(Handle<Value> value, double count) {
+  ElementProbe probe(value);
+  PROFILE_LOOKUP();
+  Storage::iterator it = storage.find(probe);
+  if (it == storage.end()) {
+    it = storage.push_back(Storage::value_type(Element::New(value, &backing), Element()));
+  }
+  it.node->link.count += count;
+  total += count;
+}
+
+bool MultiSet::IsCount(Handle<Value> value) {
+  if (!(value->IsNumber())) {
+    return false;
+  }
+  double count = value->NumberValue();
+  return count > 0 && count < 9007199254740992.0 && count == (double) (int64_t) count;
+}
+
+Handle<Value> MultiSet::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  if (args.Length() > 1 || !(args[0]->IsUndefined() || args[0]->IsArray() || constructor->HasInstance(args[0]))) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional array or multiset.")));
+  }
+
+  MultiSet* obj = new MultiSet();
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+
+  return args.This();
+}
+
+Handle<Value> MultiSet::Add(const Arguments& args) {
+  PROFILE_METHOD(add, args);
+  CHECK_ITERATING(add, args);
+  CHECK_WRITABLE(add, args);
+  if (args.Length() == 0 || args.Length() > 2 || (args.Length() == 2 && !IsCount(args[1]))) {
+    return ThrowException(Exception::Error(String::New("add(value, count) takes a value and an optional positive integer count.")));
+  }
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  obj->Add(args[0], args.Length() == 2 ? args[1]->NumberValue() : 1);
+  return scope.Close(args.This());
+}
+
+Handle<Value> MultiSet::AddAll(const Arguments& args) {
+  PROFILE_METHOD(addAll, args);
+  CHECK_ITERATING(addAll, args);
+  CHECK_WRITABLE(addAll, args);
+  if (args.Length() != 1 || !(args[0]->IsArray())) {
+    return ThrowException(Exception::Error(String::New("addAll(array) takes an array argument.")));
+  }
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+  return scope.Close(args.This());
+}
+
+Handle<Value> MultiSet::Clear(const Arguments& args) {
+  PROFILE_METHOD(clear, args);
+  CHECK_ITERATING(clear, args);
+  CHECK_WRITABLE(clear, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  obj->backing.Clear();
+  Storage::iterator it = obj->storage.begin();
+  while (it != obj->storage.end()) {
+    Element key = (it++)->first;
+    key.Dispose();
+  }
+  obj->storage.clear();
+  obj->total = 0;
+  return scope.Close(args.This());
+}
+
+Handle<Value> MultiSet::Count(const Arguments& args) {
+  PROFILE_METHOD(count, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("count(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  return scope.Close(Number::New(it == obj->storage.end() ? 0 : it.node->link.count));
+}
+
+Handle<Value> MultiSet::DistinctSize(const Arguments& args) {
+  PROFILE_METHOD(distinctSize, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(distinctSize, args);
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  return scope.Close(Uint32::New((uint32_t) obj->storage.size()));
+}
+
+/*
+ * Multisets are equal if they count the same elements the same number of times, whatever order the elements were
+ * added in.
+ */
+Handle<Value> MultiSet::Equals(const Arguments& args) {
+  PROFILE_METHOD(equals, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("equals(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  if (!constructor->HasInstance(args[0])) {
+    return scope.Close(Boolean::New(false));
+  }
+  MultiSet* obj1 = ObjectWrap::Unwrap<MultiSet>(args.This());
+  MultiSet* obj2 = ObjectWrap::Unwrap<MultiSet>(Handle<Object>::Cast(args[0]));
+  if (obj1->storage.size() != obj2->storage.size() || obj1->total != obj2->total) {
+    return scope.Close(Boolean::New(false));
+  }
+  Storage::iterator it1 = obj1->storage.begin();
+  while (it1 != obj1->storage.end()) {
+    PROFILE_LOOKUP();
+    Storage::iterator it2 = obj2->storage.find(it1->first);
+    if (it2 == obj2->storage.end() || it2.node->link.count != it1.node->link.count) {
+      return scope.Close(Boolean::New(false));
+    }
+    it1++;
+  }
+  return scope.Close(Boolean::New(true));
+}
+
+Handle<Value> MultiSet::MostCommon(const Arguments& args) {
+  PROFILE_METHOD(mostCommon, args);
+  if (args.Length() > 1 || !(args[0]->IsUndefined() || args[0]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("mostCommon(count) takes an optional integer argument.")));
+  }
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  vector<CountEntry> entries;
+  entries.reserve(obj->storage.size());
+  Storage::iterator it = obj->storage.begin();
+  for (size_t i = 0; it != obj->storage.end(); it++, i++) {
+    CountEntry entry;
+    entry.count = it.node->link.count;
+    entry.index = i;
+    entry.it = it;
+    entries.push_back(entry);
+  }
+
+  size_t count = entries.size();
+  if (args[0]->IsUint32() && args[0]->Uint32Value() < count) {
+    count = args[0]->Uint32Value();
+  }
+  partial_sort(entries.begin(), entries.begin() + count, entries.end(), MoreCommon());
+
+  Local<Array> array = Array::New((int) count);
+  for (size_t i = 0; i < count; i++) {
+    Local<Array> pair = Array::New(2);
+    pair->Set(0, entries[i].it->first.ToValue());
+    pair->Set(1, Number::New(entries[i].count));
+    array->Set((uint32_t) i, pair);
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> MultiSet::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0 || args.Length() > 2 || (args.Length() == 2 && !IsCount(args[1]))) {
+    return ThrowException(Exception::Error(String::New("remove(value, count) takes a value and an optional positive integer count.")));
+  }
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.find(probe);
+  if (it != obj->storage.end()) {
+    double count = args.Length() == 2 ? args[1]->NumberValue() : 1;
+    if (count < it.node->link.count) {
+      it.node->link.count -= count;
+      obj->total -= count;
+    } else {
+      obj->total -= it.node->link.count;
+      Element key = it->first;
+      obj->storage.erase(it);
+      key.Dispose();
+    }
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> MultiSet::Size(const Arguments& args) {
+  PROFILE_METHOD(size, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(size, args);
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  return scope.Close(Number::New(obj->total));
+}
+
+Handle<Value> MultiSet::ToObject(const Arguments& args) {
+  PROFILE_METHOD(toObject, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+
+  HandleScope scope;
+  MultiSet* obj = ObjectWrap::Unwrap<MultiSet>(args.This());
+  Local<Object> result = Object::New();
+  Storage::iterator it = obj->storage.begin();
+  while (it != obj->storage.end()) {
+    result->Set(it->first.ToValue(), Number::New(it.node->link.count));
+    it++;
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> MultiSet::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
+
+  HandleScope scope;
+  return scope.Close(CollectionUtil::Stringify(ToObject(args)));
+}
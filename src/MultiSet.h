@@ -0,0 +1,89 @@
+#ifndef COLLECTION_MULTI_SET_H
+#define COLLECTION_MULTI_SET_H
+
+#include <node.h>
+#include "common.h"
+#include "LinkedHashMap.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class Occurrences
+ *
+ * Number of times an element of a MultiSet was added.
+ */
+
+struct Occurrences {
+  Occurrences() : count(0) {
+  }
+
+  double count;
+};
+
+
+/*
+ * class MultiSet
+ *
+ * A set that counts how many times each element was added. Distinct elements are kept in a hash table in the order
+ * they were first added, each with a native count, so that counting an element is one lookup that creates no handle.
+ */
+
+class MultiSet : public Collection< LinkedHashMap<Occurrences> > {
+  public:
+    typedef LinkedHashMap<Occurrences> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    MultiSet();
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    void Add(Handle<Value> value, double count);
+
+    static bool IsCount(Handle<Value> value);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> Clear(const Arguments& args);
+    static Handle<Value> Count(const Arguments& args);
+    static Handle<Value> DistinctSize(const Arguments& args);
+    static Handle<Value> Equals(const Arguments& args);
+    static Handle<Value> MostCommon(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> Size(const Arguments& args);
+    static Handle<Value> ToObject(const Arguments& args);
+    static Handle<Value> ToString(const Arguments& args);
+
+  private:
+    struct CountEntry {
+      double count;
+      size_t index;
+      Storage::iterator it;
+    };
+
+    /*
+     * Orders entries by descending count; entries of equal count stay in the order they were first added.
+     */
+    struct MoreCommon {
+      inline bool operator()(const CountEntry& entry1, const CountEntry& entry2) const {
+        if (entry1.count != entry2.count) {
+          return entry1.count > entry2.count;
+        }
+        return entry1.index < entry2.index;
+      }
+    };
+
+    double total;
+};
+
+#endif
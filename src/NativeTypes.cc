@@ -1,13 +1,40 @@
+#include "BloomFilter.h"
+#include "Deque.h"
+#include "DistinctCounter.h"
+#include "ExpiringMap.h"
+#include "IntSet.h"
+#include "LruMap.h"
 #include "Map.h"
+#include "MultiMap.h"
+#include "MultiSet.h"
+#include "PriorityQueue.h"
+#include "QuantileSketch.h"
 #include "Set.h"
+#include "SortedVector.h"
+#include "StringMap.h"
+#include "StringSet.h"
 #include "Vector.h"
 
 using namespace v8;
 
 extern "C" void InitAll(Handle<Object> exports) {
+  BloomFilter::Init(exports);
+  CountingBloomFilter::Init(exports);
+  Deque::Init(exports);
+  DistinctCounter::Init(exports);
+  ExpiringMap::Init(exports);
+  IntSet::Init(exports);
+  LruMap::Init(exports);
   Map::Init(exports);
   MapEntry::Init(exports);
+  MultiMap::Init(exports);
+  MultiSet::Init(exports);
+  PriorityQueue::Init(exports);
+  QuantileSketch::Init(exports);
   Set::Init(exports);
+  SortedVector::Init(exports);
+  StringMap::Init(exports);
+  StringSet::Init(exports);
   Vector::Init(exports);
   VectorModifier::Init(exports);
 }
@@ -0,0 +1,102 @@
+#include "Pool.h"
+
+using namespace std;
+
+
+/*
+ * class NodePool
+ */
+
+NodePool::NodePool() : blockSize(0), slabBlocks(MIN_SLAB_BLOCKS), live(0), cursor(NULL), limit(NULL), freeList(NULL),
+    refs(1) {
+}
+
+NodePool::~NodePool() {
+  Release(false);
+}
+
+void* NodePool::Allocate(size_t size) {
+  if (blockSize == 0) {
+    blockSize = RoundUp(size);
+  }
+  if (RoundUp(size) != blockSize) {
+    return ::operator new(size);
+  }
+
+  live++;
+  if (freeList != NULL) {
+    FreeBlock* block = freeList;
+    freeList = block->next;
+    return block;
+  }
+  if (cursor == limit) {
+    AddSlab();
+  }
+  void* block = cursor;
+  cursor += blockSize;
+  return block;
+}
+
+void NodePool::Deallocate(void* block, size_t size) {
+  if (RoundUp(size) != blockSize) {
+    ::operator delete(block);
+    return;
+  }
+
+  FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+  freeBlock->next = freeList;
+  freeList = freeBlock;
+  if (--live == 0) {
+    Release(true);
+  }
+}
+
+void NodePool::Ref() {
+  refs++;
+}
+
+void NodePool::Unref() {
+  if (--refs == 0) {
+    delete this;
+  }
+}
+
+size_t NodePool::RoundUp(size_t size) {
+  if (size < sizeof(FreeBlock)) {
+    size = sizeof(FreeBlock);
+  }
+  return (size + 7) & ~((size_t) 7);
+}
+
+void NodePool::AddSlab() {
+  char* slab = static_cast<char*>(::operator new(blockSize * slabBlocks));
+  slabs.push_back(slab);
+  cursor = slab;
+  limit = slab + blockSize * slabBlocks;
+  if (slabBlocks < MAX_SLAB_BLOCKS) {
+    slabBlocks *= 2;
+  }
+}
+
+void NodePool::Release(bool keepFirst) {
+  vector<char*>::iterator it = slabs.begin();
+  if (keepFirst && it != slabs.end()) {
+    it++;
+  }
+  while (it != slabs.end()) {
+    ::operator delete(*it++);
+  }
+
+  freeList = NULL;
+  if (keepFirst && !slabs.empty()) {
+    slabs.resize(1);
+    cursor = slabs[0];
+    limit = slabs[0] + blockSize * MIN_SLAB_BLOCKS;
+    slabBlocks = MIN_SLAB_BLOCKS * 2;
+  } else {
+    slabs.clear();
+    cursor = NULL;
+    limit = NULL;
+    slabBlocks = MIN_SLAB_BLOCKS;
+  }
+}
@@ -0,0 +1,137 @@
+#ifndef COLLECTION_POOL_H
+#define COLLECTION_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * class NodePool
+ *
+ * Hands out fixed-size blocks carved from contiguous slabs. The block size is fixed by the first single-object
+ * allocation; requests of any other size are passed through to the global allocator. Returned blocks are kept on a
+ * free list, and slabs are released together once no block is in use (the first slab is kept for reuse until the
+ * pool itself is destroyed).
+ */
+
+class NodePool {
+  public:
+    NodePool();
+    ~NodePool();
+
+    void* Allocate(size_t size);
+    void Deallocate(void* block, size_t size);
+
+    void Ref();
+    void Unref();
+
+  private:
+    struct FreeBlock {
+      FreeBlock* next;
+    };
+
+    static const size_t MIN_SLAB_BLOCKS = 16;
+    static const size_t MAX_SLAB_BLOCKS = 65536;
+
+    static size_t RoundUp(size_t size);
+
+    void AddSlab();
+    void Release(bool keepFirst);
+
+    vector<char*> slabs;
+    size_t blockSize;
+    size_t slabBlocks;
+    size_t live;
+    char* cursor;
+    char* limit;
+    FreeBlock* freeList;
+    int refs;
+};
+
+
+/*
+ * class PoolAllocator
+ *
+ * STL allocator backed by a NodePool. A default-constructed allocator creates its own pool; copies and rebound
+ * copies share it, so every node of a container comes from the container's pool.
+ */
+
+template <class T> class PoolAllocator {
+  public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <class U> struct rebind {
+      typedef PoolAllocator<U> other;
+    };
+
+    PoolAllocator() : pool(new NodePool()) {
+    }
+
+    PoolAllocator(const PoolAllocator& other) : pool(other.pool) {
+      pool->Ref();
+    }
+
+    template <class U> PoolAllocator(const PoolAllocator<U>& other) : pool(other.pool) {
+      pool->Ref();
+    }
+
+    ~PoolAllocator() {
+      pool->Unref();
+    }
+
+    PoolAllocator& operator=(const PoolAllocator& other) {
+      other.pool->Ref();
+      pool->Unref();
+      pool = other.pool;
+      return *this;
+    }
+
+    inline pointer address(reference value) const {
+      return &value;
+    }
+
+    inline const_pointer address(const_reference value) const {
+      return &value;
+    }
+
+    inline pointer allocate(size_type n, const void* hint = 0) {
+      return static_cast<pointer>(pool->Allocate(n * sizeof(T)));
+    }
+
+    inline void deallocate(pointer p, size_type n) {
+      pool->Deallocate(p, n * sizeof(T));
+    }
+
+    inline size_type max_size() const {
+      return size_t(-1) / sizeof(T);
+    }
+
+    inline void construct(pointer p, const T& value) {
+      new(p) T(value);
+    }
+
+    inline void destroy(pointer p) {
+      p->~T();
+    }
+
+    NodePool* pool;
+};
+
+template <class T, class U> inline bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) {
+  return a.pool == b.pool;
+}
+
+template <class T, class U> inline bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) {
+  return a.pool != b.pool;
+}
+
+#endif
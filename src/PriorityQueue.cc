@@ -0,0 +1,303 @@
+#include <cmath>
+#include "PriorityQueue.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class PriorityQueue
+ */
+
+PriorityQueue::PriorityQueue() {
+}
+
+PriorityQueue::~PriorityQueue() {
+  if (!field.IsEmpty()) {
+    field.Dispose();
+  }
+}
+
+Handle<Value> PriorityQueue::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  return scope.Close(value.ToValue());
+}
+
+void PriorityQueue::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("PriorityQueue"));
+
+  exports->Set(String::NewSymbol("PriorityQueue"), constructor->GetFunction());
+}
+
+void PriorityQueue::InitializeFields(Handle<Object> thisObject) {
+  // Functions of Collection that take an index are left out, since indexes of a heap mean nothing to users.
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("has"), FunctionTemplate::New(Has)->GetFunction());
+  thisObject->Set(String::NewSymbol("heapify"), FunctionTemplate::New(Heapify)->GetFunction());
+  thisObject->Set(String::NewSymbol("isEmpty"), FunctionTemplate::New(IsEmpty)->GetFunction());
+  thisObject->Set(String::NewSymbol("peek"), FunctionTemplate::New(Peek)->GetFunction());
+  thisObject->Set(String::NewSymbol("pop"), FunctionTemplate::New(Pop)->GetFunction());
+  thisObject->Set(String::NewSymbol("profile"), FunctionTemplate::New(Profile)->GetFunction());
+  thisObject->Set(String::NewSymbol("push"), FunctionTemplate::New(Push)->GetFunction());
+  thisObject->Set(String::NewSymbol("pushPop"), FunctionTemplate::New(PushPop)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("size"), FunctionTemplate::New(Size)->GetFunction());
+  thisObject->Set(String::NewSymbol("toArray"), FunctionTemplate::New(ToArray)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+  thisObject->Set(String::NewSymbol("updatePriority"), FunctionTemplate::New(UpdatePriority)->GetFunction());
+
+  thisObject->Set(String::NewSymbol("each"), FunctionTemplate::New(Each)->GetFunction());
+  thisObject->Set(String::NewSymbol("filter"), FunctionTemplate::New(Filter)->GetFunction());
+  thisObject->Set(String::NewSymbol("find"), FunctionTemplate::New(Find)->GetFunction());
+  thisObject->Set(String::NewSymbol("reduce"), FunctionTemplate::New(Reduce)->GetFunction());
+}
+
+void PriorityQueue::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  // Initial values are pushed by New(), which needs to report values without a valid priority.
+}
+
+bool PriorityQueue::IsSupportedObject(Handle<Value> value) {
+  return false;
+}
+
+bool PriorityQueue::IsSupportedType(Handle<Value> value) {
+  return true;
+}
+
+/*
+ * Get the priority of a value to be pushed, which is given as `priority`, or else read from the priority field of the
+ * value. Return false if the queue orders by priority and there is no valid one, or if a priority is given to a queue
+ * that does not order by priority.
+ */
+bool PriorityQueue::GetPriority(Handle<Value> value, Handle<Value> priority, double& result) {
+  if (!storage.IsNumeric()) {
+    result = 0;
+    return priority->IsUndefined();
+  }
+  if (priority->IsUndefined() && !field.IsEmpty() && value->IsObject()) {
+    priority = Handle<Object>::Cast(value)->Get(field);
+  }
+  if (!(priority->IsNumber())) {
+    return false;
+  }
+  result = priority->NumberValue();
+  return !isnan(result);
+}
+
+/*
+ * Push all values of an array, and restore the order of the heap once at the end. Return false if a value has no
+ * valid priority, in which case the values before it are pushed.
+ */
+bool PriorityQueue::PushAll(Handle<Array> array) {
+  bool valid = true;
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Handle<Value> value = array->Get(i);
+    double priority;
+    if (!GetPriority(value, Undefined(), priority)) {
+      valid = false;
+      break;
+    }
+    storage.Push(Element::New(value, &backing), priority, false);
+  }
+  storage.Order();
+  return valid;
+}
+
+Handle<Value> PriorityQueue::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  int optionsIndex = args[0]->IsArray() ? 1 : 0;
+  bool argError = args.Length() > optionsIndex + 1;
+  Handle<Value> priority = Undefined();
+  if (!argError && args[optionsIndex]->IsObject() && !(args[optionsIndex]->IsArray())) {
+    priority = Handle<Object>::Cast(args[optionsIndex])->Get(String::NewSymbol("priority"));
+    argError = !(priority->IsUndefined()) && !(priority->IsString()) && !(priority->IsTrue());
+  } else if (!(args[optionsIndex]->IsUndefined())) {
+    argError = true;
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Arguments must be an optional array and optional options {priority: string or true}.")));
+  }
+
+  PriorityQueue* obj = new PriorityQueue();
+  obj->storage.SetNumeric(!(priority->IsUndefined()));
+  if (priority->IsString()) {
+    obj->field = Persistent<String>::New(priority->ToString());
+  }
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  if (optionsIndex == 1 && !obj->PushAll(Handle<Array>::Cast(args[0]))) {
+    return ThrowException(Exception::Error(String::New("Every value must have a numeric priority.")));
+  }
+
+  return args.This();
+}
+
+Handle<Value> PriorityQueue::Heapify(const Arguments& args) {
+  PROFILE_METHOD(heapify, args);
+  CHECK_ITERATING(heapify, args);
+  CHECK_WRITABLE(heapify, args);
+  if (args.Length() != 1 || !(args[0]->IsArray())) {
+    return ThrowException(Exception::Error(String::New("heapify(array) takes an array argument.")));
+  }
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  if (!obj->PushAll(Handle<Array>::Cast(args[0]))) {
+    return ThrowException(Exception::Error(String::New("heapify(array) takes values with numeric priorities.")));
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> PriorityQueue::Peek(const Arguments& args) {
+  PROFILE_METHOD(peek, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(peek, args);
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  if (obj->storage.empty()) {
+    return Undefined();
+  }
+  return scope.Close(obj->storage.Get(obj->storage.Top()).ToValue());
+}
+
+Handle<Value> PriorityQueue::Pop(const Arguments& args) {
+  PROFILE_METHOD(pop, args);
+  CHECK_ITERATING(pop, args);
+  CHECK_WRITABLE(pop, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(pop, args);
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  if (obj->storage.empty()) {
+    return Undefined();
+  }
+  Element element = obj->storage.Remove(obj->storage.Top());
+  Handle<Value> value = element.ToValue();
+  element.Dispose();
+  return scope.Close(value);
+}
+
+Handle<Value> PriorityQueue::Push(const Arguments& args) {
+  PROFILE_METHOD(push, args);
+  CHECK_ITERATING(push, args);
+  CHECK_WRITABLE(push, args);
+  if (args.Length() < 1 || args.Length() > 2) {
+    return ThrowException(Exception::Error(String::New("push(value, priority) takes a value and an optional priority.")));
+  }
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  double priority;
+  if (!obj->GetPriority(args[0], args[1], priority)) {
+    return ThrowException(Exception::Error(String::New("push(value, priority) takes a numeric priority only if the queue orders by priority.")));
+  }
+  uint32_t id = obj->storage.Push(Element::New(args[0], &obj->backing), priority);
+  return scope.Close(Number::New(obj->storage.ToHandle(id)));
+}
+
+Handle<Value> PriorityQueue::PushPop(const Arguments& args) {
+  PROFILE_METHOD(pushPop, args);
+  CHECK_ITERATING(pushPop, args);
+  CHECK_WRITABLE(pushPop, args);
+  if (args.Length() < 1 || args.Length() > 2) {
+    return ThrowException(Exception::Error(String::New("pushPop(value, priority) takes a value and an optional priority.")));
+  }
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  double priority;
+  if (!obj->GetPriority(args[0], args[1], priority)) {
+    return ThrowException(Exception::Error(String::New("pushPop(value, priority) takes a numeric priority only if the queue orders by priority.")));
+  }
+  if (obj->storage.empty()) {
+    return scope.Close(args[0]);
+  }
+  {
+    // The value would be popped right away, so the heap is not touched.
+    ElementProbe probe(args[0]);
+    if (!obj->storage.PrecedesTop(probe, priority)) {
+      Element element = obj->storage.ReplaceTop(Element::New(args[0], &obj->backing), priority);
+      Handle<Value> value = element.ToValue();
+      element.Dispose();
+      return scope.Close(value);
+    }
+  }
+  return scope.Close(args[0]);
+}
+
+Handle<Value> PriorityQueue::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() != 1 || !(args[0]->IsNumber())) {
+    return ThrowException(Exception::Error(String::New("remove(handle) takes a handle returned by push().")));
+  }
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  uint32_t id = obj->storage.FromHandle(args[0]->NumberValue());
+  if (id == Storage::NONE) {
+    return scope.Close(Boolean::New(false));
+  }
+  obj->storage.Remove(id).Dispose();
+  return scope.Close(Boolean::New(true));
+}
+
+Handle<Value> PriorityQueue::ToArray(const Arguments& args) {
+  PROFILE_METHOD(toArray, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toArray, args);
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  vector<uint32_t> ids;
+  obj->storage.Sort(ids);
+  Local<Array> array = Array::New((int) ids.size());
+  for (uint32_t i = 0; i < ids.size(); i++) {
+    array->Set(i, obj->storage.Get(ids[i]).ToValue());
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> PriorityQueue::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
+
+  HandleScope scope;
+  return scope.Close(CollectionUtil::Stringify(ToArray(args)));
+}
+
+Handle<Value> PriorityQueue::UpdatePriority(const Arguments& args) {
+  PROFILE_METHOD(updatePriority, args);
+  CHECK_ITERATING(updatePriority, args);
+  CHECK_WRITABLE(updatePriority, args);
+  if (args.Length() < 1 || args.Length() > 2 || !(args[0]->IsNumber())) {
+    return ThrowException(Exception::Error(String::New("updatePriority(handle, priority) takes a handle returned by push() and an optional priority.")));
+  }
+
+  HandleScope scope;
+  PriorityQueue* obj = ObjectWrap::Unwrap<PriorityQueue>(args.This());
+  uint32_t id = obj->storage.FromHandle(args[0]->NumberValue());
+  if (id == Storage::NONE) {
+    return scope.Close(Boolean::New(false));
+  }
+  if (obj->storage.IsNumeric()) {
+    double priority;
+    if (!obj->GetPriority(obj->storage.Get(id).ToValue(), args[1], priority)) {
+      return ThrowException(Exception::Error(String::New("updatePriority(handle, priority) takes a numeric priority, or a handle of a value with a numeric priority field.")));
+    }
+    obj->storage.Update(id, priority);
+  } else {
+    if (!(args[1]->IsUndefined())) {
+      return ThrowException(Exception::Error(String::New("updatePriority(handle, priority) takes a priority only if the queue orders by priority.")));
+    }
+    obj->storage.Restore(id);
+  }
+  return scope.Close(Boolean::New(true));
+}
@@ -0,0 +1,56 @@
+#ifndef COLLECTION_PRIORITY_QUEUE_H
+#define COLLECTION_PRIORITY_QUEUE_H
+
+#include <node.h>
+#include "common.h"
+#include "Heap.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class PriorityQueue
+ *
+ * A queue from which values are taken out smallest first. Values are ordered by ValueComparator, or by a numeric
+ * priority that is read from a field of each value, or given with it, and kept natively, so that pushing and popping
+ * take logarithmic time without calling into V8.
+ */
+
+class PriorityQueue : public Collection<Heap> {
+  public:
+    typedef Heap Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    PriorityQueue();
+    virtual ~PriorityQueue();
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    bool GetPriority(Handle<Value> value, Handle<Value> priority, double& result);
+    bool PushAll(Handle<Array> array);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Heapify(const Arguments& args);
+    static Handle<Value> Peek(const Arguments& args);
+    static Handle<Value> Pop(const Arguments& args);
+    static Handle<Value> Push(const Arguments& args);
+    static Handle<Value> PushPop(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> ToArray(const Arguments& args);
+    static Handle<Value> ToString(const Arguments& args);
+    static Handle<Value> UpdatePriority(const Arguments& args);
+
+  private:
+    Persistent<String> field;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include <cstdlib>
+#include "Profile.h"
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+#ifdef COLLECTION_PROFILE
+
+
+/*
+ * class Profiler
+ */
+
+Profiler* Profiler::current = NULL;
+
+bool Profiler::enabledByDefault = getenv("COLLECTION_PROFILE") != NULL;
+
+Profiler::Profiler() {
+  Reset();
+}
+
+void Profiler::Reset() {
+  methods.clear();
+  comparisons = 0;
+  lookups = 0;
+  lookupStart = 0;
+  visits = 0;
+  depth = 0;
+}
+
+Handle<Object> Profiler::ToObject() const {
+  HandleScope scope;
+  Local<Object> result = Object::New();
+  Local<Object> calls = Object::New();
+  Local<Object> latency = Object::New();
+  map<string, MethodStats>::const_iterator it = methods.begin();
+  while (it != methods.end()) {
+    Local<String> name = String::New(it->first.c_str());
+    calls->Set(name, Number::New((double) it->second.calls));
+
+    int buckets = HISTOGRAM_BUCKETS;
+    while (buckets > 0 && it->second.histogram[buckets - 1] == 0) {
+      buckets--;
+    }
+    Local<Array> histogram = Array::New(buckets);
+    for (int i = 0; i < buckets; i++) {
+      histogram->Set(i, Number::New((double) it->second.histogram[i]));
+    }
+    Local<Object> stats = Object::New();
+    stats->Set(String::NewSymbol("total"), Number::New((double) it->second.totalTime));
+    stats->Set(String::NewSymbol("histogram"), histogram);
+    latency->Set(name, stats);
+    it++;
+  }
+  result->Set(String::NewSymbol("calls"), calls);
+  result->Set(String::NewSymbol("latency"), latency);
+  result->Set(String::NewSymbol("comparisons"), Number::New((double) comparisons));
+  result->Set(String::NewSymbol("lookups"), Number::New((double) lookups));
+  result->Set(String::NewSymbol("visits"), Number::New((double) visits));
+  result->Set(String::NewSymbol("depth"), Number::New((double) depth));
+  return scope.Close(result);
+}
+
+void Profiler::EndLookup() {
+  uint64_t lookupComparisons = comparisons - lookupStart;
+  if (lookupComparisons > depth) {
+    depth = lookupComparisons;
+  }
+  lookupStart = comparisons;
+}
+
+
+/*
+ * class Profiler::Scope
+ */
+
+Profiler::Scope::Scope(Profiler* profiler, const char* method) : profiler(NULL), previous(current), method(method) {
+  if (profiler != NULL && profiler != current) {
+    this->profiler = profiler;
+    current = profiler;
+    lookups = profiler->lookups;
+    profiler->lookupStart = profiler->comparisons;
+    start = uv_hrtime();
+  }
+}
+
+Profiler::Scope::~Scope() {
+  if (profiler == NULL) {
+    return;
+  }
+
+  uint64_t elapsed = uv_hrtime() - start;
+  if (profiler->lookups != lookups) {
+    profiler->EndLookup();
+  }
+
+  Profiler::MethodStats& stats = profiler->methods[method];
+  int bucket = 0;
+  while (bucket < HISTOGRAM_BUCKETS - 1 && (elapsed >> (bucket + 1)) > 0) {
+    bucket++;
+  }
+  stats.calls++;
+  stats.totalTime += elapsed;
+  stats.histogram[bucket]++;
+
+  current = previous;
+}
+
+#endif
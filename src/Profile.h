@@ -0,0 +1,117 @@
+#ifndef COLLECTION_PROFILE_H
+#define COLLECTION_PROFILE_H
+
+#include <map>
+#include <string>
+#include <node.h>
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * Macros
+ *
+ * Instrumentation is compiled in only when COLLECTION_PROFILE is defined (see binding.gyp). Otherwise all the macros
+ * below expand to nothing, so the hot paths do not pay for it.
+ */
+
+#ifdef COLLECTION_PROFILE
+
+#define PROFILE_METHOD(method, args) \
+  Profiler::Scope profileScope(ObjectWrap::Unwrap< Collection<Storage> >(args.This())->profiler, #method)
+
+#define PROFILE_COMPARISON() Profiler::Comparison()
+#define PROFILE_LOOKUP() Profiler::Lookup()
+#define PROFILE_VISITS(count) Profiler::Visits(count)
+
+#else
+
+#define PROFILE_METHOD(method, args) do {} while (false)
+#define PROFILE_COMPARISON() do {} while (false)
+#define PROFILE_LOOKUP() do {} while (false)
+#define PROFILE_VISITS(count) do {} while (false)
+
+#endif
+
+
+#ifdef COLLECTION_PROFILE
+
+/*
+ * class Profiler
+ */
+
+class Profiler {
+  public:
+    static const int HISTOGRAM_BUCKETS = 40;
+
+    Profiler();
+
+    void Reset();
+    Handle<Object> ToObject() const;
+
+    static inline void Comparison() {
+      if (current != NULL) {
+        current->comparisons++;
+      }
+    }
+
+    static inline void Lookup() {
+      if (current != NULL) {
+        current->EndLookup();
+        current->lookups++;
+        current->lookupStart = current->comparisons;
+      }
+    }
+
+    static inline void Visits(size_t count) {
+      if (current != NULL) {
+        current->visits += count;
+      }
+    }
+
+    static bool enabledByDefault;
+
+    /*
+     * class Profiler::Scope
+     *
+     * Records one call of a collection method. Only the outermost call on a collection is recorded, so that methods
+     * implemented in terms of others (such as toString() calling toArray()) are counted once.
+     */
+
+    class Scope {
+      public:
+        Scope(Profiler* profiler, const char* method);
+        ~Scope();
+
+      private:
+        Profiler* profiler;
+        Profiler* previous;
+        const char* method;
+        uint64_t start;
+        uint64_t lookups;
+    };
+
+  private:
+    struct MethodStats {
+      uint64_t calls;
+      uint64_t totalTime;
+      uint64_t histogram[HISTOGRAM_BUCKETS];
+    };
+
+    void EndLookup();
+
+    map<string, MethodStats> methods;
+    uint64_t comparisons;
+    uint64_t lookups;
+    uint64_t lookupStart;
+    uint64_t visits;
+    uint64_t depth;
+
+    static Profiler* current;
+};
+
+#endif
+
+#endif
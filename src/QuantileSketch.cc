@@ -0,0 +1,203 @@
+#include <cmath>
+#include <node_buffer.h>
+#include "QuantileSketch.h"
+#include "common.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class QuantileSketch
+ */
+
+Persistent<FunctionTemplate> QuantileSketch::constructor;
+
+QuantileSketch::QuantileSketch(double compression) : digest(compression) {
+}
+
+void QuantileSketch::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("QuantileSketch"));
+
+  exports->Set(String::NewSymbol("QuantileSketch"), constructor->GetFunction());
+}
+
+/*
+ * Finite numbers and valid dates.
+ */
+bool QuantileSketch::IsSupportedType(Handle<Value> value) {
+  return (value->IsNumber() || value->IsDate()) && IsFinite(value->NumberValue());
+}
+
+Handle<Value> QuantileSketch::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool isBuffer = args.Length() == 1 && Buffer::HasInstance(args[0]);
+  if (!isBuffer && (args.Length() > 1 || !(args[0]->IsUndefined() || (args[0]->IsNumber() &&
+      args[0]->NumberValue() >= TDigest::MIN_COMPRESSION && args[0]->NumberValue() <= TDigest::MAX_COMPRESSION)))) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional compression between 20 and 1000, or a buffer.")));
+  }
+
+  double compression = DEFAULT_COMPRESSION;
+  if (args[0]->IsNumber()) {
+    compression = args[0]->NumberValue();
+  }
+  QuantileSketch* obj = new QuantileSketch(compression);
+  obj->Wrap(args.This());
+
+  Handle<Object> thisObject = args.This();
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("cdf"), FunctionTemplate::New(Cdf)->GetFunction());
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("merge"), FunctionTemplate::New(Merge)->GetFunction());
+  thisObject->Set(String::NewSymbol("quantile"), FunctionTemplate::New(Quantile)->GetFunction());
+  thisObject->Set(String::NewSymbol("size"), FunctionTemplate::New(Size)->GetFunction());
+  thisObject->Set(String::NewSymbol("toBuffer"), FunctionTemplate::New(ToBuffer)->GetFunction());
+
+  if (isBuffer && !obj->digest.Deserialize(Buffer::Data(args[0]), Buffer::Length(args[0]))) {
+    return ThrowException(Exception::Error(String::New("Buffer does not hold a serialized quantile sketch.")));
+  }
+
+  return args.This();
+}
+
+Handle<Value> QuantileSketch::Add(const Arguments& args) {
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!IsSupportedType(args[i])) {
+      return ThrowException(Exception::Error(String::New("add(value, ...) takes only finite numbers and valid dates.")));
+    }
+  }
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    obj->digest.Add(args[i]->NumberValue());
+  }
+  return scope.Close(args.This());
+}
+
+/*
+ * Add the values of an array, or the numbers of a Float64Array, which are read directly from its memory.
+ */
+Handle<Value> QuantileSketch::AddAll(const Arguments& args) {
+  size_t length;
+  const double* numbers = args.Length() == 1 ? CollectionUtil::GetDoubles(args[0], length) : NULL;
+  if (args.Length() != 1 || !(numbers != NULL || args[0]->IsArray())) {
+    return ThrowException(Exception::Error(String::New("addAll(array) takes an array or a Float64Array.")));
+  }
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  if (numbers != NULL) {
+    for (size_t i = 0; i < length; i++) {
+      if (!IsFinite(numbers[i])) {
+        return ThrowException(Exception::Error(String::New("addAll(array) takes only finite numbers.")));
+      }
+    }
+    for (size_t i = 0; i < length; i++) {
+      obj->digest.Add(numbers[i]);
+    }
+  } else {
+    Handle<Array> array = Handle<Array>::Cast(args[0]);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      if (!IsSupportedType(array->Get(i))) {
+        return ThrowException(Exception::Error(String::New("addAll(array) takes only finite numbers and valid dates.")));
+      }
+    }
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      HandleScope scope;
+      obj->digest.Add(array->Get(i)->NumberValue());
+    }
+  }
+  return scope.Close(args.This());
+}
+
+/*
+ * Estimate the fraction of values that are less than or equal to a value.
+ */
+Handle<Value> QuantileSketch::Cdf(const Arguments& args) {
+  if (args.Length() != 1 || !IsSupportedType(args[0])) {
+    return ThrowException(Exception::Error(String::New("cdf(value) takes a finite number or a valid date.")));
+  }
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  if (obj->digest.Count() == 0) {
+    return Undefined();
+  }
+  return scope.Close(Number::New(obj->digest.Cdf(args[0]->NumberValue())));
+}
+
+Handle<Value> QuantileSketch::Clear(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  obj->digest.Clear();
+  return scope.Close(args.This());
+}
+
+Handle<Value> QuantileSketch::Merge(const Arguments& args) {
+  if (args.Length() != 1 || !constructor->HasInstance(args[0])) {
+    return ThrowException(Exception::Error(String::New("merge(sketch) takes a quantile sketch.")));
+  }
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  QuantileSketch* other = ObjectWrap::Unwrap<QuantileSketch>(Handle<Object>::Cast(args[0]));
+  obj->digest.Merge(other->digest);
+  return scope.Close(args.This());
+}
+
+Handle<Value> QuantileSketch::Quantile(const Arguments& args) {
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("quantile(q, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!(args[i]->IsNumber()) || !(args[i]->NumberValue() >= 0 && args[i]->NumberValue() <= 1)) {
+      return ThrowException(Exception::Error(String::New("quantile(q, ...) takes only numbers between 0 and 1.")));
+    }
+  }
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  if (obj->digest.Count() == 0) {
+    return Undefined();
+  }
+  if (args.Length() == 1) {
+    return scope.Close(Number::New(obj->digest.Quantile(args[0]->NumberValue())));
+  } else {
+    Handle<Array> array = Array::New(args.Length());
+    for (int i = 0; i < args.Length(); i++) {
+      array->Set(i, Number::New(obj->digest.Quantile(args[i]->NumberValue())));
+    }
+    return scope.Close(array);
+  }
+}
+
+Handle<Value> QuantileSketch::Size(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(size, args);
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  return scope.Close(Number::New(obj->digest.Count()));
+}
+
+Handle<Value> QuantileSketch::ToBuffer(const Arguments& args) {
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toBuffer, args);
+
+  HandleScope scope;
+  QuantileSketch* obj = ObjectWrap::Unwrap<QuantileSketch>(args.This());
+  Buffer* buffer = Buffer::New(obj->digest.SerializedSize());
+  obj->digest.Serialize(Buffer::Data(buffer->handle_));
+  return scope.Close(buffer->handle_);
+}
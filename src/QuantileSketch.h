@@ -0,0 +1,51 @@
+#ifndef COLLECTION_QUANTILE_SKETCH_H
+#define COLLECTION_QUANTILE_SKETCH_H
+
+#include <node.h>
+#include "TDigest.h"
+
+using namespace node;
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class QuantileSketch
+ *
+ * Estimates quantiles of a stream of numbers or dates in a bounded amount of memory, with a t-digest. Dates are
+ * added as their times, and quantiles are returned as numbers.
+ */
+
+class QuantileSketch : public ObjectWrap {
+  public:
+    static void Init(Handle<Object> exports);
+
+    static Persistent<FunctionTemplate> constructor;
+
+  protected:
+    static const uint32_t DEFAULT_COMPRESSION = 100;
+
+    explicit QuantileSketch(double compression);
+
+    static bool IsSupportedType(Handle<Value> value);
+
+    // False for NaN and infinities.
+    static inline bool IsFinite(double number) {
+      return number - number == 0;
+    }
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> Cdf(const Arguments& args);
+    static Handle<Value> Clear(const Arguments& args);
+    static Handle<Value> Merge(const Arguments& args);
+    static Handle<Value> Quantile(const Arguments& args);
+    static Handle<Value> Size(const Arguments& args);
+    static Handle<Value> ToBuffer(const Arguments& args);
+
+    TDigest digest;
+};
+
+#endif
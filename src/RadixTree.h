@@ -0,0 +1,1013 @@
+#ifndef COLLECTION_RADIX_TREE_H
+#define COLLECTION_RADIX_TREE_H
+
+#include <stdint.h>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "Element.h"
+
+using namespace std;
+
+
+/*
+ * class KeyValue
+ *
+ * An entry of a RadixTree, with its key rebuilt from the tree.
+ */
+
+template <class Mapped> struct KeyValue {
+  KeyValue(const string& first, const Mapped& second) : first(first), second(second) {
+  }
+
+  string first;
+  Mapped second;
+};
+
+
+/*
+ * class RadixEntry
+ *
+ * What iterating a RadixTree yields: the key of each entry, along with its value unless the tree holds keys only.
+ */
+
+struct NoValue {
+};
+
+template <class Mapped> struct RadixEntry {
+  typedef KeyValue<Mapped> type;
+
+  static inline type Make(const string& key, const Mapped& value) {
+    return type(key, value);
+  }
+};
+
+template <> struct RadixEntry<NoValue> {
+  typedef string type;
+
+  static inline type Make(const string& key, const NoValue& value) {
+    return key;
+  }
+};
+
+
+/*
+ * class RadixTree
+ *
+ * An adaptive radix tree of byte strings, such as the UTF-8 bytes of JavaScript strings. Each inner node branches on
+ * one byte and grows from 4 to 16, 48 and 256 children as needed, so that it takes little more memory than the
+ * children it has. Bytes that all keys below a node have in common are kept once, in the node, and a leaf keeps only
+ * the bytes of its key that no other key shares. A key that ends at an inner node, because it is a prefix of other
+ * keys, is kept in a leaf of its own before the children.
+ *
+ * Looking up a key takes time proportional to its length, whatever the number of keys. Entries are iterated in the
+ * order of the bytes of their keys, with a key before the keys it is a prefix of, which is the order ValueComparator
+ * gives strings. An iterator rebuilds the key of each entry as it goes.
+ */
+
+template <class Mapped> class RadixTree {
+  private:
+    struct Node;
+    struct Leaf;
+    struct Inner;
+
+  public:
+    typedef typename RadixEntry<Mapped>::type value_type;
+    typedef size_t size_type;
+
+    class Iterator : public std::iterator<bidirectional_iterator_tag, const value_type, ptrdiff_t, const value_type*,
+        value_type> {
+      public:
+        Iterator() : tree(NULL), leaf(NULL) {
+        }
+
+        explicit Iterator(const RadixTree* tree) : tree(tree), leaf(NULL) {
+        }
+
+        inline value_type operator*() const {
+          return RadixEntry<Mapped>::Make(key, leaf->value);
+        }
+
+        inline const string& Key() const {
+          return key;
+        }
+
+        inline Mapped& Value() const {
+          return leaf->value;
+        }
+
+        inline Iterator& operator++() {
+          tree->Next(*this);
+          return *this;
+        }
+
+        inline Iterator operator++(int) {
+          Iterator result = *this;
+          tree->Next(*this);
+          return result;
+        }
+
+        inline Iterator& operator--() {
+          tree->Previous(*this);
+          return *this;
+        }
+
+        inline Iterator operator--(int) {
+          Iterator result = *this;
+          tree->Previous(*this);
+          return result;
+        }
+
+        inline bool operator==(const Iterator& other) const {
+          return leaf == other.leaf;
+        }
+
+        inline bool operator!=(const Iterator& other) const {
+          return leaf != other.leaf;
+        }
+
+      private:
+        // An inner node on the path to the current leaf, the slot taken from it, and the length of the key up to
+        // the byte of that slot.
+        struct Frame {
+          const Inner* node;
+          int slot;
+          size_t base;
+        };
+
+        const RadixTree* tree;
+        vector<Frame> frames;
+        string key;
+        Leaf* leaf;
+
+        friend class RadixTree;
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    RadixTree() : root(NULL), count(0) {
+    }
+
+    ~RadixTree() {
+      clear();
+    }
+
+    inline iterator begin() const {
+      iterator it(this);
+      if (root != NULL) {
+        Descend(it, root, true);
+      }
+      return it;
+    }
+
+    inline iterator end() const {
+      return iterator(this);
+    }
+
+    inline size_type size() const {
+      return count;
+    }
+
+    inline bool empty() const {
+      return count == 0;
+    }
+
+    iterator find(const Element& element) const {
+      if (!element.IsString()) {
+        return end();
+      }
+      const Atom* atom = element.StringValue();
+      return Seek(atom->data, atom->length, true);
+    }
+
+    void erase(iterator it) {
+      Mapped value;
+      Erase(it.key.data(), it.key.size(), value);
+    }
+
+    void erase(iterator first, iterator last) {
+      // Erasing changes the nodes iterators go through, so the keys are collected first.
+      vector<string> keys;
+      while (first != last) {
+        keys.push_back(first.key);
+        ++first;
+      }
+      Mapped value;
+      for (size_t i = 0; i < keys.size(); i++) {
+        Erase(keys[i].data(), keys[i].size(), value);
+      }
+    }
+
+    void clear() {
+      vector<Node*> nodes;
+      if (root != NULL) {
+        nodes.push_back(root);
+      }
+      while (!nodes.empty()) {
+        Node* node = nodes.back();
+        nodes.pop_back();
+        if (node->type != LEAF) {
+          const Inner* inner = static_cast<const Inner*>(node);
+          for (int slot = NextSlot(inner, BEFORE); slot != AFTER; slot = NextSlot(inner, slot)) {
+            nodes.push_back(Child(inner, slot));
+          }
+        }
+        free(node->prefix);
+        Delete(node);
+      }
+      root = NULL;
+      count = 0;
+    }
+
+    /*
+     * Get the value of a key, or NULL if the tree does not have the key.
+     */
+    Mapped* Get(const char* key, size_t length) const {
+      Node* node = root;
+      size_t depth = 0;
+      while (node != NULL && MatchPrefix(node, key + depth, length - depth) == node->prefixLength) {
+        depth += node->prefixLength;
+        if (node->type == LEAF) {
+          return depth == length ? &static_cast<Leaf*>(node)->value : NULL;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        if (depth == length) {
+          return inner->terminal == NULL ? NULL : &inner->terminal->value;
+        }
+        Node** child = FindChild(inner, (uint8_t) key[depth++]);
+        node = child == NULL ? NULL : *child;
+      }
+      return NULL;
+    }
+
+    /*
+     * Get the value of a key, adding the key with a default value if the tree does not have it yet.
+     */
+    Mapped* Insert(const char* key, size_t length, bool& inserted) {
+      Node** ref = &root;
+      size_t depth = 0;
+      inserted = false;
+      while (true) {
+        Node* node = *ref;
+        if (node == NULL) {
+          inserted = true;
+          count++;
+          Leaf* leaf = NewLeaf(key + depth, length - depth);
+          *ref = leaf;
+          return &leaf->value;
+        }
+
+        size_t matched = MatchPrefix(node, key + depth, length - depth);
+        if (matched < node->prefixLength) {
+          // The key leaves the prefix of the node, or ends within it: the node is split where they part.
+          inserted = true;
+          count++;
+          Node4* split = new Node4();
+          SetPrefix(split, node->prefix, matched);
+          uint8_t byte = (uint8_t) node->prefix[matched];
+          SetPrefix(node, node->prefix + matched + 1, node->prefixLength - matched - 1);
+          Node* splitNode = split;
+          AddChild(&splitNode, byte, node);
+          Leaf* leaf;
+          if (depth + matched == length) {
+            leaf = NewLeaf(NULL, 0);
+            split->terminal = leaf;
+          } else {
+            leaf = NewLeaf(key + depth + matched + 1, length - depth - matched - 1);
+            AddChild(&splitNode, (uint8_t) key[depth + matched], leaf);
+          }
+          *ref = splitNode;
+          return &leaf->value;
+        }
+
+        depth += node->prefixLength;
+        if (node->type == LEAF) {
+          if (depth == length) {
+            return &static_cast<Leaf*>(node)->value;
+          }
+          // The key of the leaf is a prefix of the new key, so the leaf becomes the terminal of a new inner node.
+          inserted = true;
+          count++;
+          Node4* inner = new Node4();
+          SetPrefix(inner, node->prefix, node->prefixLength);
+          SetPrefix(node, NULL, 0);
+          inner->terminal = static_cast<Leaf*>(node);
+          Leaf* leaf = NewLeaf(key + depth + 1, length - depth - 1);
+          Node* innerNode = inner;
+          AddChild(&innerNode, (uint8_t) key[depth], leaf);
+          *ref = innerNode;
+          return &leaf->value;
+        }
+
+        Inner* inner = static_cast<Inner*>(node);
+        if (depth == length) {
+          if (inner->terminal == NULL) {
+            inserted = true;
+            count++;
+            inner->terminal = NewLeaf(NULL, 0);
+          }
+          return &inner->terminal->value;
+        }
+        Node** child = FindChild(inner, (uint8_t) key[depth]);
+        if (child == NULL) {
+          inserted = true;
+          count++;
+          Leaf* leaf = NewLeaf(key + depth + 1, length - depth - 1);
+          AddChild(ref, (uint8_t) key[depth], leaf);
+          return &leaf->value;
+        }
+        ref = child;
+        depth++;
+      }
+    }
+
+    /*
+     * Remove a key. Returns false if the tree does not have the key; otherwise, its value is copied to `value`.
+     */
+    bool Erase(const char* key, size_t length, Mapped& value) {
+      Node** parent = NULL;
+      Node** ref = &root;
+      size_t depth = 0;
+      uint8_t byte = 0;
+      while (*ref != NULL) {
+        Node* node = *ref;
+        if (MatchPrefix(node, key + depth, length - depth) < node->prefixLength) {
+          return false;
+        }
+        depth += node->prefixLength;
+        if (node->type == LEAF) {
+          if (depth != length) {
+            return false;
+          }
+          value = static_cast<Leaf*>(node)->value;
+          free(node->prefix);
+          Delete(node);
+          if (parent == NULL) {
+            root = NULL;
+          } else {
+            RemoveChild(parent, byte);
+          }
+          count--;
+          return true;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        if (depth == length) {
+          if (inner->terminal == NULL) {
+            return false;
+          }
+          value = inner->terminal->value;
+          Delete(inner->terminal);
+          inner->terminal = NULL;
+          Collapse(ref);
+          count--;
+          return true;
+        }
+        byte = (uint8_t) key[depth++];
+        parent = ref;
+        ref = FindChild(inner, byte);
+        if (ref == NULL) {
+          return false;
+        }
+      }
+      return false;
+    }
+
+    /*
+     * Whether any key starts with the given bytes.
+     */
+    bool HasPrefix(const char* prefix, size_t length) const {
+      Node* node = root;
+      size_t depth = 0;
+      while (node != NULL) {
+        size_t rest = length - depth;
+        size_t matched = MatchPrefix(node, prefix + depth, rest);
+        if (matched == rest) {
+          return true;
+        } else if (matched < node->prefixLength || node->type == LEAF) {
+          return false;
+        }
+        depth += node->prefixLength;
+        Node** child = FindChild(static_cast<Inner*>(node), (uint8_t) prefix[depth++]);
+        node = child == NULL ? NULL : *child;
+      }
+      return false;
+    }
+
+    /*
+     * Get an iterator to the first key that starts with the given bytes, or end() if there is none. The keys that
+     * start with them follow it.
+     */
+    inline iterator PrefixBegin(const char* prefix, size_t length) const {
+      return Seek(prefix, length, false);
+    }
+
+    /*
+     * Find the longest key that the given bytes start with. Returns false if there is none; otherwise, the length of
+     * the key is set to `result`.
+     */
+    bool LongestPrefix(const char* key, size_t length, size_t& result) const {
+      Node* node = root;
+      size_t depth = 0;
+      bool found = false;
+      while (node != NULL && MatchPrefix(node, key + depth, length - depth) == node->prefixLength) {
+        depth += node->prefixLength;
+        if (node->type == LEAF) {
+          result = depth;
+          return true;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        if (inner->terminal != NULL) {
+          result = depth;
+          found = true;
+        }
+        if (depth == length) {
+          break;
+        }
+        Node** child = FindChild(inner, (uint8_t) key[depth++]);
+        node = child == NULL ? NULL : *child;
+      }
+      return found;
+    }
+
+  private:
+    RadixTree(const RadixTree& other);
+    RadixTree& operator=(const RadixTree& other);
+
+    enum NodeType {
+      LEAF,
+      NODE4,
+      NODE16,
+      NODE48,
+      NODE256
+    };
+
+    // Slots of an inner node, in order: its terminal leaf, then its children by ascending byte. A child is in the
+    // slot of its index in a node of 4 or 16 children, and in the slot of its byte in a larger node.
+    enum {
+      BEFORE = -2,
+      TERMINAL = -1,
+      AFTER = 256
+    };
+
+    struct Node {
+      explicit Node(uint8_t type) : type(type), children(0), prefixLength(0), prefix(NULL) {
+      }
+
+      uint8_t type;
+      uint16_t children;
+      uint32_t prefixLength;
+      char* prefix;
+    };
+
+    struct Leaf : public Node {
+      Leaf() : Node(LEAF) {
+      }
+
+      Mapped value;
+    };
+
+    struct Inner : public Node {
+      explicit Inner(uint8_t type) : Node(type), terminal(NULL) {
+      }
+
+      Leaf* terminal;
+    };
+
+    struct Node4 : public Inner {
+      Node4() : Inner(NODE4) {
+      }
+
+      uint8_t keys[4];
+      Node* child[4];
+    };
+
+    struct Node16 : public Inner {
+      Node16() : Inner(NODE16) {
+      }
+
+      uint8_t keys[16];
+      Node* child[16];
+    };
+
+    struct Node48 : public Inner {
+      Node48() : Inner(NODE48) {
+        memset(index, 0, sizeof(index));
+        memset(child, 0, sizeof(child));
+      }
+
+      // One more than the index in `child` of the child of each byte, or 0.
+      uint8_t index[256];
+      Node* child[48];
+    };
+
+    struct Node256 : public Inner {
+      Node256() : Inner(NODE256) {
+        memset(child, 0, sizeof(child));
+      }
+
+      Node* child[256];
+    };
+
+    static Leaf* NewLeaf(const char* suffix, size_t length) {
+      Leaf* leaf = new Leaf();
+      SetPrefix(leaf, suffix, length);
+      return leaf;
+    }
+
+    /*
+     * Delete a node, but not its prefix or its children.
+     */
+    static void Delete(Node* node) {
+      switch (node->type) {
+        case LEAF:
+          delete static_cast<Leaf*>(node);
+          break;
+        case NODE4:
+          delete static_cast<Node4*>(node);
+          break;
+        case NODE16:
+          delete static_cast<Node16*>(node);
+          break;
+        case NODE48:
+          delete static_cast<Node48*>(node);
+          break;
+        default:
+          delete static_cast<Node256*>(node);
+          break;
+      }
+    }
+
+    /*
+     * Replace the prefix of a node. The new prefix may be part of the old one.
+     */
+    static void SetPrefix(Node* node, const char* data, size_t length) {
+      char* prefix = NULL;
+      if (length > 0) {
+        prefix = static_cast<char*>(malloc(length));
+        memcpy(prefix, data, length);
+      }
+      free(node->prefix);
+      node->prefix = prefix;
+      node->prefixLength = (uint32_t) length;
+    }
+
+    /*
+     * Count the leading bytes of the prefix of a node that match a key, up to the length of either.
+     */
+    static inline size_t MatchPrefix(const Node* node, const char* key, size_t length) {
+      size_t limit = node->prefixLength < length ? node->prefixLength : length;
+      size_t matched = 0;
+      while (matched < limit && node->prefix[matched] == key[matched]) {
+        matched++;
+      }
+      return matched;
+    }
+
+    static int FindSlot(const Inner* node, uint8_t byte) {
+      switch (node->type) {
+        case NODE4: {
+          const Node4* n = static_cast<const Node4*>(node);
+          for (int i = 0; i < n->children; i++) {
+            if (n->keys[i] == byte) {
+              return i;
+            }
+          }
+          return AFTER;
+        }
+        case NODE16: {
+          const Node16* n = static_cast<const Node16*>(node);
+          for (int i = 0; i < n->children; i++) {
+            if (n->keys[i] == byte) {
+              return i;
+            }
+          }
+          return AFTER;
+        }
+        case NODE48:
+          return static_cast<const Node48*>(node)->index[byte] == 0 ? (int) AFTER : byte;
+        default:
+          return static_cast<const Node256*>(node)->child[byte] == NULL ? (int) AFTER : byte;
+      }
+    }
+
+    static inline Node** FindChild(Inner* node, uint8_t byte) {
+      int slot = FindSlot(node, byte);
+      return slot == AFTER ? NULL : ChildRef(node, slot);
+    }
+
+    static Node** ChildRef(Inner* node, int slot) {
+      switch (node->type) {
+        case NODE4:
+          return &static_cast<Node4*>(node)->child[slot];
+        case NODE16:
+          return &static_cast<Node16*>(node)->child[slot];
+        case NODE48: {
+          Node48* n = static_cast<Node48*>(node);
+          return &n->child[n->index[slot] - 1];
+        }
+        default:
+          return &static_cast<Node256*>(node)->child[slot];
+      }
+    }
+
+    static inline Node* Child(const Inner* node, int slot) {
+      if (slot == TERMINAL) {
+        return node->terminal;
+      }
+      return *ChildRef(const_cast<Inner*>(node), slot);
+    }
+
+    static inline uint8_t Byte(const Inner* node, int slot) {
+      switch (node->type) {
+        case NODE4:
+          return static_cast<const Node4*>(node)->keys[slot];
+        case NODE16:
+          return static_cast<const Node16*>(node)->keys[slot];
+        default:
+          return (uint8_t) slot;
+      }
+    }
+
+    /*
+     * The first slot after a slot that is taken, or AFTER.
+     */
+    static int NextSlot(const Inner* node, int slot) {
+      if (slot == BEFORE && node->terminal != NULL) {
+        return TERMINAL;
+      }
+      int next = slot < 0 ? 0 : slot + 1;
+      switch (node->type) {
+        case NODE4:
+        case NODE16:
+          return next < node->children ? next : AFTER;
+        case NODE48: {
+          const Node48* n = static_cast<const Node48*>(node);
+          while (next < 256 && n->index[next] == 0) {
+            next++;
+          }
+          return next;
+        }
+        default: {
+          const Node256* n = static_cast<const Node256*>(node);
+          while (next < 256 && n->child[next] == NULL) {
+            next++;
+          }
+          return next;
+        }
+      }
+    }
+
+    /*
+     * The last slot before a slot that is taken, or BEFORE.
+     */
+    static int PreviousSlot(const Inner* node, int slot) {
+      if (slot == TERMINAL) {
+        return BEFORE;
+      }
+      int previous;
+      switch (node->type) {
+        case NODE4:
+        case NODE16:
+          previous = slot == AFTER ? node->children - 1 : slot - 1;
+          break;
+        case NODE48: {
+          const Node48* n = static_cast<const Node48*>(node);
+          previous = slot - 1;
+          while (previous >= 0 && n->index[previous] == 0) {
+            previous--;
+          }
+          break;
+        }
+        default: {
+          const Node256* n = static_cast<const Node256*>(node);
+          previous = slot - 1;
+          while (previous >= 0 && n->child[previous] == NULL) {
+            previous--;
+          }
+          break;
+        }
+      }
+      if (previous >= 0) {
+        return previous;
+      }
+      return node->terminal != NULL ? TERMINAL : BEFORE;
+    }
+
+    static void CopyHeader(Inner* to, const Inner* from) {
+      to->children = from->children;
+      to->prefixLength = from->prefixLength;
+      to->prefix = from->prefix;
+      to->terminal = from->terminal;
+    }
+
+    /*
+     * Add a child to the inner node at `ref`, which is replaced with a larger node if it is full.
+     */
+    static void AddChild(Node** ref, uint8_t byte, Node* child) {
+      Inner* node = static_cast<Inner*>(*ref);
+      switch (node->type) {
+        case NODE4: {
+          Node4* n = static_cast<Node4*>(node);
+          if (n->children < 4) {
+            InsertSorted(n->keys, n->child, n->children, byte, child);
+            return;
+          }
+          Node16* larger = new Node16();
+          CopyHeader(larger, n);
+          memcpy(larger->keys, n->keys, sizeof(n->keys));
+          memcpy(larger->child, n->child, sizeof(n->child));
+          delete n;
+          *ref = larger;
+          InsertSorted(larger->keys, larger->child, larger->children, byte, child);
+          return;
+        }
+        case NODE16: {
+          Node16* n = static_cast<Node16*>(node);
+          if (n->children < 16) {
+            InsertSorted(n->keys, n->child, n->children, byte, child);
+            return;
+          }
+          Node48* larger = new Node48();
+          CopyHeader(larger, n);
+          for (int i = 0; i < 16; i++) {
+            larger->child[i] = n->child[i];
+            larger->index[n->keys[i]] = (uint8_t) (i + 1);
+          }
+          delete n;
+          *ref = larger;
+          larger->child[16] = child;
+          larger->index[byte] = 17;
+          larger->children++;
+          return;
+        }
+        case NODE48: {
+          Node48* n = static_cast<Node48*>(node);
+          if (n->children < 48) {
+            int i = 0;
+            while (n->child[i] != NULL) {
+              i++;
+            }
+            n->child[i] = child;
+            n->index[byte] = (uint8_t) (i + 1);
+            n->children++;
+            return;
+          }
+          Node256* larger = new Node256();
+          CopyHeader(larger, n);
+          for (int b = 0; b < 256; b++) {
+            if (n->index[b] != 0) {
+              larger->child[b] = n->child[n->index[b] - 1];
+            }
+          }
+          delete n;
+          *ref = larger;
+          larger->child[byte] = child;
+          larger->children++;
+          return;
+        }
+        default: {
+          Node256* n = static_cast<Node256*>(node);
+          n->child[byte] = child;
+          n->children++;
+          return;
+        }
+      }
+    }
+
+    static void InsertSorted(uint8_t* keys, Node** child, uint16_t& children, uint8_t byte, Node* node) {
+      int i = children;
+      while (i > 0 && keys[i - 1] > byte) {
+        keys[i] = keys[i - 1];
+        child[i] = child[i - 1];
+        i--;
+      }
+      keys[i] = byte;
+      child[i] = node;
+      children++;
+    }
+
+    /*
+     * Remove the child of a byte from the inner node at `ref`, which is replaced with a smaller node once it has
+     * few enough children, or with its remaining entry once it has only one.
+     */
+    static void RemoveChild(Node** ref, uint8_t byte) {
+      Inner* node = static_cast<Inner*>(*ref);
+      switch (node->type) {
+        case NODE4:
+        case NODE16: {
+          uint8_t* keys = node->type == NODE4 ? static_cast<Node4*>(node)->keys : static_cast<Node16*>(node)->keys;
+          Node** child = node->type == NODE4 ? static_cast<Node4*>(node)->child : static_cast<Node16*>(node)->child;
+          int i = FindSlot(node, byte);
+          for (node->children--; i < node->children; i++) {
+            keys[i] = keys[i + 1];
+            child[i] = child[i + 1];
+          }
+          if (node->type == NODE16 && node->children <= 3) {
+            Node16* n = static_cast<Node16*>(node);
+            Node4* smaller = new Node4();
+            CopyHeader(smaller, n);
+            memcpy(smaller->keys, n->keys, n->children);
+            memcpy(smaller->child, n->child, n->children * sizeof(Node*));
+            delete n;
+            *ref = smaller;
+          }
+          break;
+        }
+        case NODE48: {
+          Node48* n = static_cast<Node48*>(node);
+          n->child[n->index[byte] - 1] = NULL;
+          n->index[byte] = 0;
+          n->children--;
+          if (n->children <= 12) {
+            Node16* smaller = new Node16();
+            CopyHeader(smaller, n);
+            smaller->children = 0;
+            for (int b = 0; b < 256; b++) {
+              if (n->index[b] != 0) {
+                smaller->keys[smaller->children] = (uint8_t) b;
+                smaller->child[smaller->children++] = n->child[n->index[b] - 1];
+              }
+            }
+            delete n;
+            *ref = smaller;
+          }
+          break;
+        }
+        default: {
+          Node256* n = static_cast<Node256*>(node);
+          n->child[byte] = NULL;
+          n->children--;
+          if (n->children <= 37) {
+            Node48* smaller = new Node48();
+            CopyHeader(smaller, n);
+            smaller->children = 0;
+            for (int b = 0; b < 256; b++) {
+              if (n->child[b] != NULL) {
+                smaller->child[smaller->children] = n->child[b];
+                smaller->index[b] = (uint8_t) ++smaller->children;
+              }
+            }
+            delete n;
+            *ref = smaller;
+          }
+          break;
+        }
+      }
+      Collapse(ref);
+    }
+
+    /*
+     * Replace the inner node at `ref` with its only entry, if it has one, so that no inner node holds fewer than two
+     * entries. The bytes of the node are moved into the prefix of the entry.
+     */
+    static void Collapse(Node** ref) {
+      Inner* node = static_cast<Inner*>(*ref);
+      if (node->children + (node->terminal != NULL ? 1 : 0) != 1) {
+        return;
+      }
+      Node* entry;
+      if (node->terminal != NULL) {
+        entry = node->terminal;
+        entry->prefix = node->prefix;
+        entry->prefixLength = node->prefixLength;
+      } else {
+        int slot = NextSlot(node, BEFORE);
+        entry = Child(node, slot);
+        size_t length = node->prefixLength + 1 + entry->prefixLength;
+        char* prefix = static_cast<char*>(malloc(length));
+        if (node->prefixLength > 0) {
+          memcpy(prefix, node->prefix, node->prefixLength);
+        }
+        prefix[node->prefixLength] = (char) Byte(node, slot);
+        if (entry->prefixLength > 0) {
+          memcpy(prefix + node->prefixLength + 1, entry->prefix, entry->prefixLength);
+        }
+        free(entry->prefix);
+        free(node->prefix);
+        entry->prefix = prefix;
+        entry->prefixLength = (uint32_t) length;
+      }
+      Delete(node);
+      *ref = entry;
+    }
+
+    /*
+     * Move an iterator to the first or the last leaf below a node, appending the bytes on the way to its key.
+     */
+    void Descend(iterator& it, Node* node, bool first) const {
+      while (true) {
+        it.key.append(node->prefix, node->prefixLength);
+        if (node->type == LEAF) {
+          it.leaf = static_cast<Leaf*>(node);
+          return;
+        }
+        const Inner* inner = static_cast<const Inner*>(node);
+        typename iterator::Frame frame = { inner, first ? NextSlot(inner, BEFORE) : PreviousSlot(inner, AFTER),
+            it.key.size() };
+        it.frames.push_back(frame);
+        node = Enter(it, inner, frame.slot);
+      }
+    }
+
+    static inline Node* Enter(iterator& it, const Inner* node, int slot) {
+      if (slot != TERMINAL) {
+        it.key.push_back((char) Byte(node, slot));
+      }
+      return Child(node, slot);
+    }
+
+    void Next(iterator& it) const {
+      while (!it.frames.empty()) {
+        typename iterator::Frame& frame = it.frames.back();
+        frame.slot = NextSlot(frame.node, frame.slot);
+        if (frame.slot != AFTER) {
+          it.key.resize(frame.base);
+          Node* child = Enter(it, frame.node, frame.slot);
+          Descend(it, child, true);
+          return;
+        }
+        it.frames.pop_back();
+      }
+      it.key.clear();
+      it.leaf = NULL;
+    }
+
+    void Previous(iterator& it) const {
+      if (it.leaf == NULL) {
+        it.key.clear();
+        it.frames.clear();
+        if (root != NULL) {
+          Descend(it, root, false);
+        }
+        return;
+      }
+      while (!it.frames.empty()) {
+        typename iterator::Frame& frame = it.frames.back();
+        frame.slot = PreviousSlot(frame.node, frame.slot);
+        if (frame.slot != BEFORE) {
+          it.key.resize(frame.base);
+          Node* child = Enter(it, frame.node, frame.slot);
+          Descend(it, child, false);
+          return;
+        }
+        it.frames.pop_back();
+      }
+      it.key.clear();
+      it.leaf = NULL;
+    }
+
+    /*
+     * Get an iterator to a key, or, unless `exact`, to the first key that starts with it.
+     */
+    iterator Seek(const char* key, size_t length, bool exact) const {
+      iterator it(this);
+      Node* node = root;
+      size_t depth = 0;
+      while (node != NULL) {
+        size_t rest = length - depth;
+        size_t matched = MatchPrefix(node, key + depth, rest);
+        if (matched == rest && (!exact || rest == node->prefixLength)) {
+          if (!exact) {
+            Descend(it, node, true);
+            return it;
+          }
+          it.key.append(node->prefix, node->prefixLength);
+          if (node->type == LEAF) {
+            it.leaf = static_cast<Leaf*>(node);
+            return it;
+          }
+          const Inner* inner = static_cast<const Inner*>(node);
+          if (inner->terminal == NULL) {
+            break;
+          }
+          typename iterator::Frame frame = { inner, TERMINAL, it.key.size() };
+          it.frames.push_back(frame);
+          it.leaf = inner->terminal;
+          return it;
+        } else if (matched < node->prefixLength || node->type == LEAF) {
+          break;
+        }
+        it.key.append(node->prefix, node->prefixLength);
+        depth += node->prefixLength;
+        const Inner* inner = static_cast<const Inner*>(node);
+        int slot = FindSlot(inner, (uint8_t) key[depth++]);
+        if (slot == AFTER) {
+          break;
+        }
+        typename iterator::Frame frame = { inner, slot, it.key.size() };
+        it.frames.push_back(frame);
+        node = Enter(it, inner, slot);
+      }
+      return end();
+    }
+
+    Node* root;
+    size_t count;
+
+    friend class Iterator;
+};
+
+#endif
@@ -0,0 +1,915 @@
+#include <algorithm>
+#include "RoaringBitmap.h"
+#include "Profile.h"
+
+using namespace std;
+
+
+/*
+ * class RoaringBitmap
+ */
+
+RoaringBitmap::RoaringBitmap() : cardinality(0) {
+}
+
+RoaringBitmap::~RoaringBitmap() {
+  clear();
+}
+
+RoaringBitmap::iterator RoaringBitmap::find(const Element& element) const {
+  if (!element.IsUint32()) {
+    return end();
+  }
+  uint32_t value = element.Uint32Value();
+  size_t i = FindContainer((uint16_t) (value >> 16));
+  uint32_t index, offset;
+  if (i < containers.size() && containers[i]->key == (value >> 16) &&
+      Locate(containers[i], (uint16_t) value, index, offset)) {
+    return iterator(this, i, index, offset);
+  }
+  return end();
+}
+
+void RoaringBitmap::erase(iterator it) {
+  Remove(it.Get());
+}
+
+void RoaringBitmap::erase(iterator first, iterator last) {
+  vector<uint32_t> values;
+  while (first != last) {
+    values.push_back((first++).Get());
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    Remove(values[i]);
+  }
+}
+
+void RoaringBitmap::clear() {
+  for (size_t i = 0; i < containers.size(); i++) {
+    delete containers[i];
+  }
+  containers.clear();
+  cardinality = 0;
+}
+
+void RoaringBitmap::swap(RoaringBitmap& other) {
+  containers.swap(other.containers);
+  std::swap(cardinality, other.cardinality);
+}
+
+bool RoaringBitmap::Has(uint32_t value) const {
+  size_t i = FindContainer((uint16_t) (value >> 16));
+  return i < containers.size() && containers[i]->key == (value >> 16) && Has(containers[i], (uint16_t) value);
+}
+
+bool RoaringBitmap::Add(uint32_t value) {
+  uint16_t key = (uint16_t) (value >> 16);
+  size_t i = FindContainer(key);
+  if (i == containers.size() || containers[i]->key != key) {
+    containers.insert(containers.begin() + i, new Container(key, ARRAY));
+  }
+  if (Add(containers[i], (uint16_t) value)) {
+    cardinality++;
+    return true;
+  }
+  return false;
+}
+
+bool RoaringBitmap::Remove(uint32_t value) {
+  uint16_t key = (uint16_t) (value >> 16);
+  size_t i = FindContainer(key);
+  if (i == containers.size() || containers[i]->key != key || !Remove(containers[i], (uint16_t) value)) {
+    return false;
+  }
+  cardinality--;
+  if (containers[i]->cardinality == 0) {
+    delete containers[i];
+    containers.erase(containers.begin() + i);
+  }
+  return true;
+}
+
+uint64_t RoaringBitmap::Rank(uint32_t value) const {
+  uint16_t key = (uint16_t) (value >> 16);
+  uint64_t rank = 0;
+  for (size_t i = 0; i < containers.size() && containers[i]->key <= key; i++) {
+    PROFILE_VISITS(1);
+    if (containers[i]->key < key) {
+      rank += containers[i]->cardinality;
+    } else {
+      rank += Rank(containers[i], (uint16_t) value);
+    }
+  }
+  return rank;
+}
+
+bool RoaringBitmap::Select(uint64_t rank, uint32_t& value) const {
+  for (size_t i = 0; i < containers.size(); i++) {
+    PROFILE_VISITS(1);
+    if (rank < containers[i]->cardinality) {
+      value = ((uint32_t) containers[i]->key << 16) | Select(containers[i], (uint32_t) rank);
+      return true;
+    }
+    rank -= containers[i]->cardinality;
+  }
+  return false;
+}
+
+bool RoaringBitmap::Equals(const RoaringBitmap& other) const {
+  if (cardinality != other.cardinality || containers.size() != other.containers.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < containers.size(); i++) {
+    const Container* c1 = containers[i];
+    const Container* c2 = other.containers[i];
+    if (c1->key != c2->key || c1->cardinality != c2->cardinality) {
+      return false;
+    }
+    if (c1->type == c2->type) {
+      if (c1->values != c2->values || c1->words != c2->words) {
+        return false;
+      }
+    } else {
+      vector<uint64_t> words1(WORDS), words2(WORDS);
+      FillWords(c1, &words1[0]);
+      FillWords(c2, &words2[0]);
+      if (words1 != words2) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void RoaringBitmap::Combine(const RoaringBitmap& bitmap1, const RoaringBitmap& bitmap2, Operation operation,
+    RoaringBitmap& result) {
+  result.clear();
+  size_t i = 0, j = 0;
+  while (i < bitmap1.containers.size() || j < bitmap2.containers.size()) {
+    PROFILE_VISITS(1);
+    const Container* c1 = i < bitmap1.containers.size() ? bitmap1.containers[i] : NULL;
+    const Container* c2 = j < bitmap2.containers.size() ? bitmap2.containers[j] : NULL;
+    Container* c = NULL;
+    if (c1 != NULL && (c2 == NULL || c1->key < c2->key)) {
+      if (operation != AND) {
+        c = Copy(c1);
+      }
+      i++;
+    } else if (c2 != NULL && (c1 == NULL || c2->key < c1->key)) {
+      if (operation == OR || operation == XOR) {
+        c = Copy(c2);
+      }
+      j++;
+    } else {
+      c = Combine(c1, c2, operation);
+      i++;
+      j++;
+    }
+    if (c != NULL) {
+      result.containers.push_back(c);
+      result.cardinality += c->cardinality;
+    }
+  }
+}
+
+void RoaringBitmap::RunOptimize() {
+  for (size_t i = 0; i < containers.size(); i++) {
+    Container* c = containers[i];
+    size_t runBytes = 2 + 4 * (size_t) CountRuns(c);
+    size_t memberBytes = c->cardinality <= ARRAY_MAX ? 2 * (size_t) c->cardinality : 8 * WORDS;
+    if (c->type == RUN) {
+      if (runBytes > memberBytes) {
+        ToMembers(c);
+      }
+    } else if (runBytes < memberBytes) {
+      ToRuns(c);
+    }
+  }
+}
+
+size_t RoaringBitmap::SerializedSize() const {
+  bool hasRuns = false;
+  size_t size = 0;
+  for (size_t i = 0; i < containers.size(); i++) {
+    const Container* c = containers[i];
+    if (c->type == RUN) {
+      hasRuns = true;
+      size += 2 + 2 * c->values.size();
+    } else if (c->type == ARRAY) {
+      size += 2 * c->values.size();
+    } else {
+      size += 8 * WORDS;
+    }
+  }
+  size_t count = containers.size();
+  size += hasRuns ? 4 + (count + 7) / 8 : 8;
+  size += 4 * count;
+  if (!hasRuns || count >= NO_OFFSET_THRESHOLD) {
+    size += 4 * count;
+  }
+  return size;
+}
+
+void RoaringBitmap::Serialize(char* data) const {
+  char* start = data;
+  size_t count = containers.size();
+  bool hasRuns = false;
+  for (size_t i = 0; i < count; i++) {
+    hasRuns = hasRuns || containers[i]->type == RUN;
+  }
+
+  if (hasRuns) {
+    Write32(data, SERIAL_COOKIE | ((uint32_t) (count - 1) << 16));
+    for (size_t i = 0; i < count; i += 8) {
+      uint8_t flags = 0;
+      for (size_t j = i; j < i + 8 && j < count; j++) {
+        if (containers[j]->type == RUN) {
+          flags |= (uint8_t) (1 << (j - i));
+        }
+      }
+      *data++ = (char) flags;
+    }
+  } else {
+    Write32(data, SERIAL_COOKIE_NO_RUNCONTAINER);
+    Write32(data, (uint32_t) count);
+  }
+  for (size_t i = 0; i < count; i++) {
+    Write16(data, containers[i]->key);
+    Write16(data, (uint16_t) (containers[i]->cardinality - 1));
+  }
+  if (!hasRuns || count >= NO_OFFSET_THRESHOLD) {
+    uint32_t offset = (uint32_t) (data - start + 4 * count);
+    for (size_t i = 0; i < count; i++) {
+      const Container* c = containers[i];
+      Write32(data, offset);
+      offset += (uint32_t) (c->type == RUN ? 2 + 2 * c->values.size() :
+          c->type == ARRAY ? 2 * c->values.size() : 8 * WORDS);
+    }
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const Container* c = containers[i];
+    if (c->type == RUN) {
+      Write16(data, (uint16_t) (c->values.size() / 2));
+    }
+    if (c->type == BITMAP) {
+      for (size_t w = 0; w < WORDS; w++) {
+        Write32(data, (uint32_t) c->words[w]);
+        Write32(data, (uint32_t) (c->words[w] >> 32));
+      }
+    } else {
+      for (size_t v = 0; v < c->values.size(); v++) {
+        Write16(data, c->values[v]);
+      }
+    }
+  }
+}
+
+bool RoaringBitmap::Deserialize(const char* data, size_t length) {
+  clear();
+  const char* end = data + length;
+  if (length < 4) {
+    return false;
+  }
+  uint32_t cookie = Read32(data);
+  data += 4;
+  size_t count;
+  const char* runFlags = NULL;
+  if ((cookie & 0xffff) == SERIAL_COOKIE) {
+    count = (cookie >> 16) + 1;
+    if ((size_t) (end - data) < (count + 7) / 8) {
+      return false;
+    }
+    runFlags = data;
+    data += (count + 7) / 8;
+  } else if (cookie == SERIAL_COOKIE_NO_RUNCONTAINER) {
+    if (end - data < 4) {
+      return false;
+    }
+    count = Read32(data);
+    data += 4;
+    if (count > 65536) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  if ((size_t) (end - data) < 4 * count) {
+    return false;
+  }
+  const char* headers = data;
+  data += 4 * count;
+  if (runFlags == NULL || count >= NO_OFFSET_THRESHOLD) {
+    if ((size_t) (end - data) < 4 * count) {
+      return false;
+    }
+    data += 4 * count;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    uint16_t key = Read16(headers + 4 * i);
+    uint32_t expected = (uint32_t) Read16(headers + 4 * i + 2) + 1;
+    if (i > 0 && key <= containers.back()->key) {
+      clear();
+      return false;
+    }
+    bool valid = true;
+    Container* c;
+    if (runFlags != NULL && (runFlags[i / 8] & (1 << (i % 8)))) {
+      c = new Container(key, RUN);
+      size_t runs = end - data >= 2 ? Read16(data) : 0;
+      valid = end - data >= 2 && (size_t) (end - data - 2) >= 4 * runs;
+      if (valid) {
+        data += 2;
+        c->values.resize(2 * runs);
+        uint32_t next = 0;
+        for (size_t r = 0; r < runs && valid; r++) {
+          uint32_t start = Read16(data);
+          uint32_t last = start + Read16(data + 2);
+          data += 4;
+          valid = start >= next && last <= 0xffff;
+          c->values[2 * r] = (uint16_t) start;
+          c->values[2 * r + 1] = (uint16_t) (last - start);
+          c->cardinality += last - start + 1;
+          next = last + 1;
+        }
+      }
+    } else if (expected <= ARRAY_MAX) {
+      c = new Container(key, ARRAY);
+      valid = (size_t) (end - data) >= 2 * (size_t) expected;
+      if (valid) {
+        c->values.resize(expected);
+        for (size_t v = 0; v < expected && valid; v++) {
+          c->values[v] = Read16(data);
+          data += 2;
+          valid = v == 0 || c->values[v] > c->values[v - 1];
+        }
+        c->cardinality = expected;
+      }
+    } else {
+      c = new Container(key, BITMAP);
+      valid = (size_t) (end - data) >= 8 * WORDS;
+      if (valid) {
+        c->words.resize(WORDS);
+        for (size_t w = 0; w < WORDS; w++) {
+          c->words[w] = (uint64_t) Read32(data) | ((uint64_t) Read32(data + 4) << 32);
+          c->cardinality += PopCount(c->words[w]);
+          data += 8;
+        }
+      }
+    }
+    containers.push_back(c);
+    cardinality += c->cardinality;
+    if (!valid || c->cardinality != expected) {
+      clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Find the index of the container of a key, or of the first container of a greater key.
+ */
+size_t RoaringBitmap::FindContainer(uint16_t key) const {
+  size_t low = 0, high = containers.size();
+  while (low < high) {
+    size_t middle = (low + high) / 2;
+    PROFILE_VISITS(1);
+    if (containers[middle]->key < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/*
+ * Positions of members in containers. The index of a member of an array container is its index in the array, and
+ * that of a bitmap container is the member itself. The index of a member of a run container is the index of its run,
+ * and the offset is its distance from the start of the run.
+ */
+
+void RoaringBitmap::First(const Container* c, uint32_t& index, uint32_t& offset) {
+  offset = 0;
+  if (c->type == BITMAP) {
+    size_t w = 0;
+    while (c->words[w] == 0) {
+      w++;
+    }
+    index = (uint32_t) (w * 64 + LowestBit(c->words[w]));
+  } else {
+    index = 0;
+  }
+}
+
+void RoaringBitmap::Last(const Container* c, uint32_t& index, uint32_t& offset) {
+  offset = 0;
+  if (c->type == ARRAY) {
+    index = c->cardinality - 1;
+  } else if (c->type == BITMAP) {
+    size_t w = WORDS - 1;
+    while (c->words[w] == 0) {
+      w--;
+    }
+    index = (uint32_t) (w * 64 + HighestBit(c->words[w]));
+  } else {
+    index = (uint32_t) (c->values.size() / 2 - 1);
+    offset = c->values[2 * index + 1];
+  }
+}
+
+bool RoaringBitmap::Next(const Container* c, uint32_t& index, uint32_t& offset) {
+  if (c->type == ARRAY) {
+    if (index + 1 < c->cardinality) {
+      index++;
+      return true;
+    }
+  } else if (c->type == BITMAP) {
+    if (index % 64 != 63) {
+      uint64_t word = c->words[index / 64] & (~(uint64_t) 0 << (index % 64 + 1));
+      if (word != 0) {
+        index = (index / 64) * 64 + LowestBit(word);
+        return true;
+      }
+    }
+    for (size_t w = index / 64 + 1; w < WORDS; w++) {
+      if (c->words[w] != 0) {
+        index = (uint32_t) (w * 64 + LowestBit(c->words[w]));
+        return true;
+      }
+    }
+  } else {
+    if (offset < c->values[2 * index + 1]) {
+      offset++;
+      return true;
+    } else if (2 * (index + 1) < c->values.size()) {
+      index++;
+      offset = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RoaringBitmap::Previous(const Container* c, uint32_t& index, uint32_t& offset) {
+  if (c->type == ARRAY) {
+    if (index > 0) {
+      index--;
+      return true;
+    }
+  } else if (c->type == BITMAP) {
+    if (index % 64 != 0) {
+      uint64_t word = c->words[index / 64] & ((((uint64_t) 1) << (index % 64)) - 1);
+      if (word != 0) {
+        index = (index / 64) * 64 + HighestBit(word);
+        return true;
+      }
+    }
+    for (size_t w = index / 64; w > 0; w--) {
+      if (c->words[w - 1] != 0) {
+        index = (uint32_t) ((w - 1) * 64 + HighestBit(c->words[w - 1]));
+        return true;
+      }
+    }
+  } else {
+    if (offset > 0) {
+      offset--;
+      return true;
+    } else if (index > 0) {
+      index--;
+      offset = c->values[2 * index + 1];
+      return true;
+    }
+  }
+  return false;
+}
+
+uint16_t RoaringBitmap::Low(const Container* c, uint32_t index, uint32_t offset) {
+  if (c->type == ARRAY) {
+    return c->values[index];
+  } else if (c->type == BITMAP) {
+    return (uint16_t) index;
+  } else {
+    return (uint16_t) (c->values[2 * index] + offset);
+  }
+}
+
+bool RoaringBitmap::Locate(const Container* c, uint16_t low, uint32_t& index, uint32_t& offset) {
+  offset = 0;
+  if (c->type == ARRAY) {
+    vector<uint16_t>::const_iterator it = lower_bound(c->values.begin(), c->values.end(), low);
+    index = (uint32_t) (it - c->values.begin());
+    return it != c->values.end() && *it == low;
+  } else if (c->type == BITMAP) {
+    index = low;
+    return (c->words[low / 64] >> (low % 64)) & 1;
+  } else {
+    // Find the last run that starts at or before the value.
+    size_t first = 0, last = c->values.size() / 2;
+    while (first < last) {
+      size_t middle = (first + last) / 2;
+      if (c->values[2 * middle] <= low) {
+        first = middle + 1;
+      } else {
+        last = middle;
+      }
+    }
+    if (first == 0) {
+      return false;
+    }
+    index = (uint32_t) (first - 1);
+    offset = (uint32_t) (low - c->values[2 * index]);
+    return offset <= c->values[2 * index + 1];
+  }
+}
+
+bool RoaringBitmap::Has(const Container* c, uint16_t low) {
+  uint32_t index, offset;
+  return Locate(c, low, index, offset);
+}
+
+bool RoaringBitmap::Add(Container* c, uint16_t low) {
+  if (c->type == RUN) {
+    if (Has(c, low)) {
+      return false;
+    }
+    ToMembers(c);
+  }
+  if (c->type == ARRAY) {
+    vector<uint16_t>::iterator it = lower_bound(c->values.begin(), c->values.end(), low);
+    if (it != c->values.end() && *it == low) {
+      return false;
+    }
+    if (c->cardinality < ARRAY_MAX) {
+      c->values.insert(it, low);
+      c->cardinality++;
+      return true;
+    }
+    ToBitmap(c);
+  }
+  uint64_t bit = (uint64_t) 1 << (low % 64);
+  if (c->words[low / 64] & bit) {
+    return false;
+  }
+  c->words[low / 64] |= bit;
+  c->cardinality++;
+  return true;
+}
+
+bool RoaringBitmap::Remove(Container* c, uint16_t low) {
+  if (c->type == RUN) {
+    if (!Has(c, low)) {
+      return false;
+    }
+    ToMembers(c);
+  }
+  if (c->type == ARRAY) {
+    vector<uint16_t>::iterator it = lower_bound(c->values.begin(), c->values.end(), low);
+    if (it == c->values.end() || *it != low) {
+      return false;
+    }
+    c->values.erase(it);
+    c->cardinality--;
+    return true;
+  }
+  uint64_t bit = (uint64_t) 1 << (low % 64);
+  if (!(c->words[low / 64] & bit)) {
+    return false;
+  }
+  c->words[low / 64] &= ~bit;
+  c->cardinality--;
+  if (c->cardinality <= ARRAY_MAX) {
+    ToArray(c);
+  }
+  return true;
+}
+
+uint32_t RoaringBitmap::Rank(const Container* c, uint16_t low) {
+  if (c->type == ARRAY) {
+    return (uint32_t) (upper_bound(c->values.begin(), c->values.end(), low) - c->values.begin());
+  } else if (c->type == BITMAP) {
+    uint32_t rank = 0;
+    for (size_t w = 0; w < low / 64; w++) {
+      rank += PopCount(c->words[w]);
+    }
+    uint64_t mask = low % 64 == 63 ? ~(uint64_t) 0 : (((uint64_t) 1) << (low % 64 + 1)) - 1;
+    return rank + PopCount(c->words[low / 64] & mask);
+  } else {
+    uint32_t rank = 0;
+    for (size_t r = 0; r < c->values.size() && c->values[r] <= low; r += 2) {
+      uint32_t last = (uint32_t) c->values[r] + c->values[r + 1];
+      rank += (last < low ? last : low) - c->values[r] + 1;
+    }
+    return rank;
+  }
+}
+
+uint16_t RoaringBitmap::Select(const Container* c, uint32_t rank) {
+  if (c->type == ARRAY) {
+    return c->values[rank];
+  } else if (c->type == BITMAP) {
+    for (size_t w = 0; ; w++) {
+      uint32_t count = PopCount(c->words[w]);
+      if (rank < count) {
+        uint64_t word = c->words[w];
+        while (rank-- > 0) {
+          word &= word - 1;
+        }
+        return (uint16_t) (w * 64 + LowestBit(word));
+      }
+      rank -= count;
+    }
+  } else {
+    for (size_t r = 0; ; r += 2) {
+      uint32_t length = (uint32_t) c->values[r + 1] + 1;
+      if (rank < length) {
+        return (uint16_t) (c->values[r] + rank);
+      }
+      rank -= length;
+    }
+  }
+}
+
+void RoaringBitmap::ToArray(Container* c) {
+  vector<uint16_t> values;
+  values.reserve(c->cardinality);
+  if (c->type == BITMAP) {
+    for (size_t w = 0; w < WORDS; w++) {
+      uint64_t word = c->words[w];
+      while (word != 0) {
+        values.push_back((uint16_t) (w * 64 + LowestBit(word)));
+        word &= word - 1;
+      }
+    }
+    vector<uint64_t>().swap(c->words);
+  } else if (c->type == RUN) {
+    for (size_t r = 0; r < c->values.size(); r += 2) {
+      uint32_t last = (uint32_t) c->values[r] + c->values[r + 1];
+      for (uint32_t v = c->values[r]; v <= last; v++) {
+        values.push_back((uint16_t) v);
+      }
+    }
+  } else {
+    return;
+  }
+  c->values.swap(values);
+  c->type = ARRAY;
+}
+
+void RoaringBitmap::ToBitmap(Container* c) {
+  if (c->type == BITMAP) {
+    return;
+  }
+  c->words.assign(WORDS, 0);
+  FillWords(c, &c->words[0]);
+  vector<uint16_t>().swap(c->values);
+  c->type = BITMAP;
+}
+
+void RoaringBitmap::ToRuns(Container* c) {
+  vector<uint16_t> runs;
+  uint32_t index, offset;
+  First(c, index, offset);
+  do {
+    uint16_t low = Low(c, index, offset);
+    if (!runs.empty() && (uint32_t) runs[runs.size() - 2] + runs.back() + 1 == low) {
+      runs.back()++;
+    } else {
+      runs.push_back(low);
+      runs.push_back(0);
+    }
+  } while (Next(c, index, offset));
+  c->values.swap(runs);
+  vector<uint64_t>().swap(c->words);
+  c->type = RUN;
+}
+
+/*
+ * Turn a run container into an array or a bitmap, whichever its cardinality calls for.
+ */
+void RoaringBitmap::ToMembers(Container* c) {
+  if (c->type != RUN) {
+    return;
+  }
+  if (c->cardinality <= ARRAY_MAX) {
+    ToArray(c);
+  } else {
+    ToBitmap(c);
+  }
+}
+
+void RoaringBitmap::FillWords(const Container* c, uint64_t* words) {
+  if (c->type == BITMAP) {
+    copy(c->words.begin(), c->words.end(), words);
+    return;
+  }
+  fill(words, words + WORDS, 0);
+  if (c->type == ARRAY) {
+    for (size_t v = 0; v < c->values.size(); v++) {
+      words[c->values[v] / 64] |= (uint64_t) 1 << (c->values[v] % 64);
+    }
+  } else {
+    for (size_t r = 0; r < c->values.size(); r += 2) {
+      SetBits(words, c->values[r], (uint32_t) c->values[r] + c->values[r + 1]);
+    }
+  }
+}
+
+uint32_t RoaringBitmap::CountRuns(const Container* c) {
+  if (c->type == RUN) {
+    return (uint32_t) (c->values.size() / 2);
+  }
+  uint32_t runs = 0;
+  if (c->type == ARRAY) {
+    for (size_t v = 0; v < c->values.size(); v++) {
+      if (v == 0 || c->values[v] != c->values[v - 1] + 1) {
+        runs++;
+      }
+    }
+  } else {
+    // A run starts at every set bit whose preceding bit is clear.
+    uint64_t carry = 0;
+    for (size_t w = 0; w < WORDS; w++) {
+      uint64_t word = c->words[w];
+      runs += PopCount(word & ~((word << 1) | carry));
+      carry = word >> 63;
+    }
+  }
+  return runs;
+}
+
+/*
+ * Combine two containers of the same key, returning NULL if the result is empty.
+ */
+RoaringBitmap::Container* RoaringBitmap::Combine(const Container* c1, const Container* c2, Operation operation) {
+  Container* members1 = NULL;
+  Container* members2 = NULL;
+  if (c1->type == RUN) {
+    c1 = members1 = Copy(c1);
+    ToMembers(members1);
+  }
+  if (c2->type == RUN) {
+    c2 = members2 = Copy(c2);
+    ToMembers(members2);
+  }
+
+  Container* result;
+  if (c1->type == ARRAY && c2->type == ARRAY) {
+    result = Merge(c1, c2, operation);
+  } else if (operation == AND && c1->type == ARRAY) {
+    result = Filter(c1, c2, true);
+  } else if (operation == AND && c2->type == ARRAY) {
+    result = Filter(c2, c1, true);
+  } else if (operation == AND_NOT && c1->type == ARRAY) {
+    result = Filter(c1, c2, false);
+  } else {
+    vector<uint64_t> buffer1, buffer2;
+    const uint64_t* words1;
+    const uint64_t* words2;
+    if (c1->type == BITMAP) {
+      words1 = &c1->words[0];
+    } else {
+      buffer1.resize(WORDS);
+      FillWords(c1, &buffer1[0]);
+      words1 = &buffer1[0];
+    }
+    if (c2->type == BITMAP) {
+      words2 = &c2->words[0];
+    } else {
+      buffer2.resize(WORDS);
+      FillWords(c2, &buffer2[0]);
+      words2 = &buffer2[0];
+    }
+
+    result = new Container(c1->key, BITMAP);
+    result->words.resize(WORDS);
+    uint64_t* words = &result->words[0];
+    // One loop per operation, so that each is a plain word-wise loop that the compiler can vectorize.
+    switch (operation) {
+      case AND:
+        for (size_t w = 0; w < WORDS; w++) {
+          words[w] = words1[w] & words2[w];
+        }
+        break;
+      case OR:
+        for (size_t w = 0; w < WORDS; w++) {
+          words[w] = words1[w] | words2[w];
+        }
+        break;
+      case AND_NOT:
+        for (size_t w = 0; w < WORDS; w++) {
+          words[w] = words1[w] & ~words2[w];
+        }
+        break;
+      case XOR:
+        for (size_t w = 0; w < WORDS; w++) {
+          words[w] = words1[w] ^ words2[w];
+        }
+        break;
+    }
+    uint32_t count = 0;
+    for (size_t w = 0; w < WORDS; w++) {
+      count += PopCount(words[w]);
+    }
+    result->cardinality = count;
+    if (count <= ARRAY_MAX) {
+      ToArray(result);
+    }
+  }
+
+  delete members1;
+  delete members2;
+  if (result->cardinality == 0) {
+    delete result;
+    return NULL;
+  }
+  return result;
+}
+
+/*
+ * Keep the members of an array container that are (or, if `keep` is false, that are not) in a bitmap container.
+ */
+RoaringBitmap::Container* RoaringBitmap::Filter(const Container* array, const Container* bitmap, bool keep) {
+  Container* result = new Container(array->key, ARRAY);
+  for (size_t v = 0; v < array->values.size(); v++) {
+    uint16_t low = array->values[v];
+    if ((((bitmap->words[low / 64] >> (low % 64)) & 1) != 0) == keep) {
+      result->values.push_back(low);
+    }
+  }
+  result->cardinality = (uint32_t) result->values.size();
+  return result;
+}
+
+RoaringBitmap::Container* RoaringBitmap::Merge(const Container* c1, const Container* c2, Operation operation) {
+  Container* result = new Container(c1->key, ARRAY);
+  back_insert_iterator< vector<uint16_t> > out = back_inserter(result->values);
+  const vector<uint16_t>& values1 = c1->values;
+  const vector<uint16_t>& values2 = c2->values;
+  switch (operation) {
+    case AND:
+      set_intersection(values1.begin(), values1.end(), values2.begin(), values2.end(), out);
+      break;
+    case OR:
+      set_union(values1.begin(), values1.end(), values2.begin(), values2.end(), out);
+      break;
+    case AND_NOT:
+      set_difference(values1.begin(), values1.end(), values2.begin(), values2.end(), out);
+      break;
+    case XOR:
+      set_symmetric_difference(values1.begin(), values1.end(), values2.begin(), values2.end(), out);
+      break;
+  }
+  result->cardinality = (uint32_t) result->values.size();
+  if (result->cardinality > ARRAY_MAX) {
+    ToBitmap(result);
+  }
+  return result;
+}
+
+RoaringBitmap::Container* RoaringBitmap::Copy(const Container* c) {
+  return new Container(*c);
+}
+
+/*
+ * Set the bits from `first` to `last`, inclusive.
+ */
+void RoaringBitmap::SetBits(uint64_t* words, uint32_t first, uint32_t last) {
+  size_t firstWord = first / 64, lastWord = last / 64;
+  uint64_t firstMask = ~(uint64_t) 0 << (first % 64);
+  uint64_t lastMask = last % 64 == 63 ? ~(uint64_t) 0 : (((uint64_t) 1) << (last % 64 + 1)) - 1;
+  if (firstWord == lastWord) {
+    words[firstWord] |= firstMask & lastMask;
+    return;
+  }
+  words[firstWord] |= firstMask;
+  for (size_t w = firstWord + 1; w < lastWord; w++) {
+    words[w] = ~(uint64_t) 0;
+  }
+  words[lastWord] |= lastMask;
+}
+
+/*
+ * Serialized integers are little-endian, whatever the byte order of the machine.
+ */
+
+void RoaringBitmap::Write16(char*& data, uint16_t value) {
+  *data++ = (char) (value & 0xff);
+  *data++ = (char) (value >> 8);
+}
+
+void RoaringBitmap::Write32(char*& data, uint32_t value) {
+  Write16(data, (uint16_t) (value & 0xffff));
+  Write16(data, (uint16_t) (value >> 16));
+}
+
+uint16_t RoaringBitmap::Read16(const char* data) {
+  return (uint16_t) ((uint8_t) data[0] | ((uint8_t) data[1] << 8));
+}
+
+uint32_t RoaringBitmap::Read32(const char* data) {
+  return (uint32_t) Read16(data) | ((uint32_t) Read16(data + 2) << 16);
+}
@@ -0,0 +1,280 @@
+#ifndef COLLECTION_ROARING_BITMAP_H
+#define COLLECTION_ROARING_BITMAP_H
+
+#include <stdint.h>
+#include <iterator>
+#include <vector>
+#include "Element.h"
+
+using namespace std;
+
+
+/*
+ * class RoaringBitmap
+ *
+ * A compressed set of unsigned 32-bit integers. Members are split by their high 16 bits into containers of up to
+ * 65536 members, kept in the order of their keys. A container holds its members in a sorted array while there are at
+ * most 4096 of them, and in a bitmap of 65536 bits otherwise, so that no container takes more than 8 kB and a dense
+ * set takes about one bit per member. RunOptimize() turns containers that mostly consist of consecutive members into
+ * arrays of runs; a run container is turned back into an array or a bitmap when it is modified.
+ *
+ * Set operations combine the containers of equal keys. Bitmaps are combined 64 bits at a time in loops that compilers
+ * vectorize, and arrays are merged or filtered without being expanded.
+ *
+ * Members are iterated in ascending order, as elements of number type, so that a bitmap can be the storage of a
+ * Collection.
+ */
+
+class RoaringBitmap {
+  private:
+    struct Container;
+
+  public:
+    typedef Element value_type;
+    typedef size_t size_type;
+
+    enum Operation {
+      AND,
+      OR,
+      AND_NOT,
+      XOR
+    };
+
+    class Iterator : public std::iterator<bidirectional_iterator_tag, const Element, ptrdiff_t, const Element*, Element> {
+      public:
+        Iterator() : bitmap(NULL), container(0), index(0), offset(0) {
+        }
+
+        Iterator(const RoaringBitmap* bitmap, size_t container) : bitmap(bitmap), container(container), index(0),
+            offset(0) {
+          if (container < bitmap->containers.size()) {
+            First(bitmap->containers[container], index, offset);
+          }
+        }
+
+        Iterator(const RoaringBitmap* bitmap, size_t container, uint32_t index, uint32_t offset) : bitmap(bitmap),
+            container(container), index(index), offset(offset) {
+        }
+
+        inline Element operator*() const {
+          return Element::New(Get());
+        }
+
+        inline uint32_t Get() const {
+          const Container* c = bitmap->containers[container];
+          return ((uint32_t) c->key << 16) | Low(c, index, offset);
+        }
+
+        Iterator& operator++() {
+          if (!Next(bitmap->containers[container], index, offset)) {
+            container++;
+            index = offset = 0;
+            if (container < bitmap->containers.size()) {
+              First(bitmap->containers[container], index, offset);
+            }
+          }
+          return *this;
+        }
+
+        inline Iterator operator++(int) {
+          Iterator result = *this;
+          ++*this;
+          return result;
+        }
+
+        Iterator& operator--() {
+          if (container == bitmap->containers.size() || !Previous(bitmap->containers[container], index, offset)) {
+            container--;
+            Last(bitmap->containers[container], index, offset);
+          }
+          return *this;
+        }
+
+        inline Iterator operator--(int) {
+          Iterator result = *this;
+          --*this;
+          return result;
+        }
+
+        inline bool operator==(const Iterator& other) const {
+          return container == other.container && index == other.index && offset == other.offset;
+        }
+
+        inline bool operator!=(const Iterator& other) const {
+          return !(*this == other);
+        }
+
+      private:
+        const RoaringBitmap* bitmap;
+        size_t container;
+        uint32_t index;
+        uint32_t offset;
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    RoaringBitmap();
+    ~RoaringBitmap();
+
+    inline iterator begin() const {
+      return iterator(this, 0);
+    }
+
+    inline iterator end() const {
+      return iterator(this, containers.size(), 0, 0);
+    }
+
+    inline size_type size() const {
+      return (size_type) cardinality;
+    }
+
+    inline bool empty() const {
+      return cardinality == 0;
+    }
+
+    iterator find(const Element& element) const;
+    void erase(iterator it);
+    void erase(iterator first, iterator last);
+    void clear();
+    void swap(RoaringBitmap& other);
+
+    inline uint64_t Cardinality() const {
+      return cardinality;
+    }
+
+    bool Has(uint32_t value) const;
+    bool Add(uint32_t value);
+    bool Remove(uint32_t value);
+
+    /*
+     * Count the members that are less than or equal to a value.
+     */
+    uint64_t Rank(uint32_t value) const;
+
+    /*
+     * Get the member of the given rank, counting from 0. Returns false if there are not that many members.
+     */
+    bool Select(uint64_t rank, uint32_t& value) const;
+
+    bool Equals(const RoaringBitmap& other) const;
+
+    static void Combine(const RoaringBitmap& bitmap1, const RoaringBitmap& bitmap2, Operation operation,
+        RoaringBitmap& result);
+
+    /*
+     * Turn each container into whichever of an array, a bitmap or runs takes the least memory.
+     */
+    void RunOptimize();
+
+    /*
+     * Serialize in the portable format of Roaring bitmaps, which other Roaring implementations can read.
+     */
+    size_t SerializedSize() const;
+    void Serialize(char* data) const;
+    bool Deserialize(const char* data, size_t length);
+
+  private:
+    RoaringBitmap(const RoaringBitmap& other);
+    RoaringBitmap& operator=(const RoaringBitmap& other);
+
+    enum ContainerType {
+      ARRAY,
+      BITMAP,
+      RUN
+    };
+
+    static const uint32_t ARRAY_MAX = 4096;
+    static const size_t WORDS = 1024;
+
+    // Cookies that start a serialized bitmap with and without run containers. A serialized bitmap with run
+    // containers has a header of container offsets only if it has at least NO_OFFSET_THRESHOLD containers.
+    static const uint32_t SERIAL_COOKIE = 12347;
+    static const uint32_t SERIAL_COOKIE_NO_RUNCONTAINER = 12346;
+    static const size_t NO_OFFSET_THRESHOLD = 4;
+
+    struct Container {
+      Container(uint16_t key, ContainerType type) : key(key), type(type), cardinality(0) {
+      }
+
+      uint16_t key;
+      ContainerType type;
+      uint32_t cardinality;
+      // Members of an array container, or the start and the length minus one of each run of a run container.
+      vector<uint16_t> values;
+      // Bits of a bitmap container.
+      vector<uint64_t> words;
+    };
+
+    size_t FindContainer(uint16_t key) const;
+
+    static void First(const Container* c, uint32_t& index, uint32_t& offset);
+    static void Last(const Container* c, uint32_t& index, uint32_t& offset);
+    static bool Next(const Container* c, uint32_t& index, uint32_t& offset);
+    static bool Previous(const Container* c, uint32_t& index, uint32_t& offset);
+    static uint16_t Low(const Container* c, uint32_t index, uint32_t offset);
+    static bool Locate(const Container* c, uint16_t low, uint32_t& index, uint32_t& offset);
+
+    static bool Has(const Container* c, uint16_t low);
+    static bool Add(Container* c, uint16_t low);
+    static bool Remove(Container* c, uint16_t low);
+    static uint32_t Rank(const Container* c, uint16_t low);
+    static uint16_t Select(const Container* c, uint32_t rank);
+
+    static void ToArray(Container* c);
+    static void ToBitmap(Container* c);
+    static void ToRuns(Container* c);
+    static void ToMembers(Container* c);
+    static void FillWords(const Container* c, uint64_t* words);
+    static uint32_t CountRuns(const Container* c);
+    static Container* Combine(const Container* c1, const Container* c2, Operation operation);
+    static Container* Filter(const Container* array, const Container* bitmap, bool keep);
+    static Container* Merge(const Container* c1, const Container* c2, Operation operation);
+    static Container* Copy(const Container* c);
+    static void SetBits(uint64_t* words, uint32_t first, uint32_t last);
+
+    static void Write16(char*& data, uint16_t value);
+    static void Write32(char*& data, uint32_t value);
+    static uint16_t Read16(const char* data);
+    static uint32_t Read32(const char* data);
+
+    static inline uint32_t PopCount(uint64_t word) {
+#ifdef __GNUC__
+      return (uint32_t) __builtin_popcountll(word);
+#else
+      word = word - ((word >> 1) & 0x5555555555555555ULL);
+      word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+      word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+      return (uint32_t) ((word * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    // Index of the lowest set bit of a word that is not 0.
+    static inline uint32_t LowestBit(uint64_t word) {
+#ifdef __GNUC__
+      return (uint32_t) __builtin_ctzll(word);
+#else
+      return PopCount((word & (~word + 1)) - 1);
+#endif
+    }
+
+    // Index of the highest set bit of a word that is not 0.
+    static inline uint32_t HighestBit(uint64_t word) {
+#ifdef __GNUC__
+      return 63 - (uint32_t) __builtin_clzll(word);
+#else
+      uint32_t bit = 0;
+      while (word >>= 1) {
+        bit++;
+      }
+      return bit;
+#endif
+    }
+
+    vector<Container*> containers;
+    uint64_t cardinality;
+
+    friend class Iterator;
+};
+
+#endif
@@ -10,7 +10,7 @@ using namespace v8;
 
 Handle<Value> Set::GetValue(const Storage::value_type& value) const {
   HandleScope scope;
-  return scope.Close(Local<Value>::New(value));
+  return scope.Close(value.ToValue());
 }
 
 void Set::Init(Handle<Object> exports) {
@@ -26,7 +26,24 @@ void Set::Init(Handle<Object> exports) {
 void Set::InitializeFields(Handle<Object> thisObject) {
   IndexedCollection<Storage>::InitializeFields(thisObject);
 
+  thisObject->Set(String::NewSymbol("clone"), FunctionTemplate::New(Clone)->GetFunction());
+  thisObject->Set(String::NewSymbol("hasMany"), FunctionTemplate::New(HasMany)->GetFunction());
   thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("snapshot"), FunctionTemplate::New(Snapshot)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSON"), FunctionTemplate::New(ToJSON)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSONBuffer"), FunctionTemplate::New(ToJSONBuffer)->GetFunction());
+  thisObject->Set(String::NewSymbol("writeJSON"), FunctionTemplate::New(WriteJSON)->GetFunction());
+}
+
+void Set::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (Set::constructor->HasInstance(argument)) {
+    Set* init = ObjectWrap::Unwrap<Set>(Handle<Object>::Cast(argument));
+    if (storage.empty() && init->backing.IsEmpty()) {
+      storage.Share(init->storage);
+      return;
+    }
+  }
+  IndexedCollection<Storage>::InitializeValues(thisObject, argument);
 }
 
 Handle<Value> Set::New(const Arguments& args) {
@@ -57,8 +74,29 @@ Handle<Value> Set::New(const Arguments& args) {
   return args.This();
 }
 
+Handle<Value> Set::Clone(const Arguments& args) {
+  PROFILE_METHOD(clone, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clone, args);
+
+  return CollectionUtil::Clone<Set>(args.This(), false);
+}
+
+Handle<Value> Set::HasMany(const Arguments& args) {
+  PROFILE_METHOD(hasMany, args);
+  uint32_t length;
+  if (args.Length() != 1 || !CollectionUtil::GetArrayLength(args[0], length)) {
+    return ThrowException(Exception::Error(String::New("hasMany(values) takes an array or a typed array.")));
+  }
+
+  HandleScope scope;
+  Set* obj = ObjectWrap::Unwrap<Set>(args.This());
+  return scope.Close(CollectionUtil::HasMany(obj->storage, Handle<Object>::Cast(args[0]), length));
+}
+
 Handle<Value> Set::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
   CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("remove(value, ...) takes at least one argument.")));
   }
@@ -66,11 +104,21 @@ Handle<Value> Set::Remove(const Arguments& args) {
   HandleScope scope;
   Set* obj = ObjectWrap::Unwrap<Set>(args.This());
   for (int i = 0; i < args.Length(); i++) {
-    Handle<Value> arg = args[i];
-    Storage::const_iterator it = obj->storage.find((Persistent<Value>) arg);
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.find(probe);
     if (it != obj->storage.end()) {
+      Element value = *it;
       obj->storage.erase(it);
+      value.Dispose();
     }
   }
   return args.This();
 }
+
+Handle<Value> Set::Snapshot(const Arguments& args) {
+  PROFILE_METHOD(snapshot, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(snapshot, args);
+
+  return CollectionUtil::Clone<Set>(args.This(), true);
+}
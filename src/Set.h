@@ -4,6 +4,7 @@
 #include <set>
 #include <node.h>
 #include "common.h"
+#include "Pool.h"
 
 using namespace std;
 using namespace v8;
@@ -13,9 +14,9 @@ using namespace v8;
  * class Set
  */
 
-class Set : public IndexedCollection< set<Persistent<Value>, ValueComparator> > {
+class Set : public IndexedCollection< SharedStorage< set<Element, ValueComparator, PoolAllocator<Element> > > > {
   public:
-    typedef set<Persistent<Value>, ValueComparator> Storage;
+    typedef SharedStorage< set<Element, ValueComparator, PoolAllocator<Element> > > Storage;
 
     virtual Handle<Value> GetValue(const Storage::value_type& value) const;
 
@@ -23,10 +24,14 @@ class Set : public IndexedCollection< set<Persistent<Value>, ValueComparator> >
 
   protected:
     virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
 
     static Handle<Value> New(const Arguments& args);
 
+    static Handle<Value> Clone(const Arguments& args);
+    static Handle<Value> HasMany(const Arguments& args);
     static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> Snapshot(const Arguments& args);
 
     static Handle<Value> Each(const Arguments& args);
     static Handle<Value> _Each(const Arguments& args);
@@ -0,0 +1,167 @@
+#ifndef COLLECTION_SHARED_STORAGE_H
+#define COLLECTION_SHARED_STORAGE_H
+
+#include <utility>
+#include "Element.h"
+
+using namespace std;
+
+
+/*
+ * class SharedStorage
+ *
+ * A sorted container that can be shared by several collections, so that a collection is cloned in constant time.
+ * The container is reference counted, and a collection that shares it makes its own copy with Unshare() before it is
+ * modified. Only containers of primitive values are shared, since the other values are kept in the backing store of
+ * the collection that created them; a collection holding other values is copied right away instead.
+ *
+ * Iterators are those of the container, so a collection must call Unshare() before it takes an iterator that it
+ * writes through or passes to insert() or erase().
+ */
+
+template <class Container> class SharedStorage {
+  public:
+    typedef typename Container::key_type key_type;
+    typedef typename Container::value_type value_type;
+    typedef typename Container::size_type size_type;
+    typedef typename Container::iterator iterator;
+    typedef typename Container::const_iterator const_iterator;
+
+    SharedStorage() : body(new Body()) {
+    }
+
+    ~SharedStorage() {
+      Unref();
+    }
+
+    inline iterator begin() const {
+      return body->container.begin();
+    }
+
+    inline iterator end() const {
+      return body->container.end();
+    }
+
+    inline size_type size() const {
+      return body->container.size();
+    }
+
+    inline bool empty() const {
+      return body->container.empty();
+    }
+
+    inline iterator find(const key_type& key) const {
+      return body->container.find(key);
+    }
+
+    inline iterator lower_bound(const key_type& key) const {
+      return body->container.lower_bound(key);
+    }
+
+    inline iterator insert(iterator position, const value_type& value) {
+      return body->container.insert(position, value);
+    }
+
+    inline void erase(iterator position) {
+      body->container.erase(position);
+    }
+
+    inline void erase(iterator first, iterator last) {
+      body->container.erase(first, last);
+    }
+
+    inline void clear() {
+      body->container.clear();
+    }
+
+    inline void swap(SharedStorage& other) {
+      Body* swapped = body;
+      body = other.body;
+      other.body = swapped;
+    }
+
+    inline bool IsShared() const {
+      return body->refs > 1;
+    }
+
+    /*
+     * Share the container of another storage, which must hold only primitive values, in place of this storage's own.
+     * The values of this storage must have been disposed.
+     */
+    void Share(const SharedStorage& other) {
+      if (body != other.body) {
+        other.body->refs++;
+        Unref();
+        body = other.body;
+      }
+    }
+
+    /*
+     * Insert copies of the values of another storage, which must not be shared with this one. Values that are not
+     * primitive are copied into the backing store.
+     */
+    void Copy(const SharedStorage& other, BackingStore* backing) {
+      iterator end = body->container.end();
+      for (const_iterator it = other.begin(); it != other.end(); ++it) {
+        end = body->container.insert(end, CopyValue(*it, backing));
+        ++end;
+      }
+    }
+
+    /*
+     * Replace a shared container by a copy that belongs to this storage alone.
+     */
+    void Unshare() {
+      if (IsShared()) {
+        Body* shared = body;
+        body = new Body();
+        shared->refs--;
+        iterator end = body->container.end();
+        for (const_iterator it = shared->container.begin(); it != shared->container.end(); ++it) {
+          end = body->container.insert(end, CopyValue(*it, NULL));
+          ++end;
+        }
+      }
+    }
+
+    /*
+     * Let go of a shared container, leaving this storage empty. The values stay with the other storages sharing it.
+     */
+    void Release() {
+      if (IsShared()) {
+        body->refs--;
+        body = new Body();
+      }
+    }
+
+  private:
+    struct Body {
+      Body() : refs(1) {
+      }
+
+      Container container;
+      int refs;
+    };
+
+    SharedStorage(const SharedStorage& other);
+    SharedStorage& operator=(const SharedStorage& other);
+
+    static inline Element CopyValue(const Element& element, BackingStore* backing) {
+      return element.Copy(backing);
+    }
+
+    static inline pair<const Element, Element> CopyValue(const pair<const Element, Element>& entry,
+        BackingStore* backing) {
+      return pair<const Element, Element>(entry.first.Copy(backing), entry.second.Copy(backing));
+    }
+
+    void Unref() {
+      if (--body->refs == 0) {
+        delete body;
+      }
+    }
+
+    Body* body;
+};
+
+#endif
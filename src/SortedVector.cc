@@ -0,0 +1,272 @@
+#include "Set.h"
+#include "SortedVector.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class SortedVector
+ */
+
+Handle<Value> SortedVector::GetValue(const Element& value) const {
+  HandleScope scope;
+  return scope.Close(value.ToValue());
+}
+
+void SortedVector::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("SortedVector"));
+
+  exports->Set(String::NewSymbol("SortedVector"), constructor->GetFunction());
+}
+
+void SortedVector::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("binarySearch"), FunctionTemplate::New(BinarySearch)->GetFunction());
+  thisObject->Set(String::NewSymbol("equalRange"), FunctionTemplate::New(EqualRange)->GetFunction());
+  thisObject->Set(String::NewSymbol("index"), FunctionTemplate::New(Index)->GetFunction());
+  thisObject->Set(String::NewSymbol("lowerBound"), FunctionTemplate::New(LowerBound)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("sortedInsert"), FunctionTemplate::New(SortedInsert)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSON"), FunctionTemplate::New(ToJSON)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSONBuffer"), FunctionTemplate::New(ToJSONBuffer)->GetFunction());
+  thisObject->Set(String::NewSymbol("upperBound"), FunctionTemplate::New(UpperBound)->GetFunction());
+  thisObject->Set(String::NewSymbol("writeJSON"), FunctionTemplate::New(WriteJSON)->GetFunction());
+}
+
+void SortedVector::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (IsSupportedObject(argument)) {
+    AddValues(argument);
+  }
+}
+
+bool SortedVector::IsSupportedObject(Handle<Value> value) {
+  return value->IsArray() || Set::constructor->HasInstance(value) || Vector::constructor->HasInstance(value) ||
+      constructor->HasInstance(value);
+}
+
+bool SortedVector::IsSupportedType(Handle<Value> value) {
+  return true;
+}
+
+/*
+ * Add the values of an array, set or vector. They are appended and sorted together, and then merged with the
+ * elements of this vector, instead of being inserted one at a time.
+ */
+void SortedVector::AddValues(Handle<Value> values) {
+  size_t from = storage.size();
+  if (values->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(values);
+    storage.Grow(array->Length());
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      storage.push_back(Element::New(array->Get(i), &backing));
+    }
+  } else if (Set::constructor->HasInstance(values)) {
+    Set* set = ObjectWrap::Unwrap<Set>(Handle<Object>::Cast(values));
+    storage.Grow(set->storage.size());
+    for (Set::Storage::iterator it = set->storage.begin(); it != set->storage.end(); it++) {
+      storage.push_back(it->Copy(&backing));
+    }
+  } else if (Vector::constructor->HasInstance(values)) {
+    Vector* vector = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(values));
+    storage.Grow(vector->storage.size());
+    for (Vector::Storage::iterator it = vector->storage.begin(); it != vector->storage.end(); it++) {
+      storage.push_back(it->Copy(&backing));
+    }
+  } else {
+    // Elements are read by index, since this vector may be adding its own elements.
+    SortedVector* other = ObjectWrap::Unwrap<SortedVector>(Handle<Object>::Cast(values));
+    size_t size = other->storage.size();
+    storage.Grow(size);
+    for (size_t i = 0; i < size; i++) {
+      storage.push_back(other->storage[i].Copy(&backing));
+    }
+  }
+  storage.Merge(from);
+}
+
+Handle<Value> SortedVector::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool argError = true;
+  if (args.Length() <= 1) {
+    if (args[0]->IsUndefined()) {
+      argError = false;
+    } else if (args[0]->IsArray() || Set::constructor->HasInstance(args[0]) ||
+        Vector::constructor->HasInstance(args[0]) || constructor->HasInstance(args[0])) {
+      argError = false;
+    }
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional array, set or vector.")));
+  }
+
+  SortedVector* obj = new SortedVector();
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+
+  return args.This();
+}
+
+Handle<Value> SortedVector::Add(const Arguments& args) {
+  PROFILE_METHOD(add, args);
+  CHECK_ITERATING(add, args);
+  CHECK_WRITABLE(add, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  obj->storage.Grow(args.Length());
+  for (int i = 0; i < args.Length(); i++) {
+    PROFILE_LOOKUP();
+    obj->storage.insert(obj->storage.end(), Element::New(args[i], &obj->backing));
+  }
+  return args.This();
+}
+
+Handle<Value> SortedVector::AddAll(const Arguments& args) {
+  PROFILE_METHOD(addAll, args);
+  CHECK_ITERATING(addAll, args);
+  CHECK_WRITABLE(addAll, args);
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  if (args.Length() != 1 || !obj->IsSupportedObject(args[0])) {
+    return ThrowException(Exception::Error(String::New("addAll(object) takes one array, set or vector argument.")));
+  }
+
+  HandleScope scope;
+  obj->AddValues(args[0]);
+  return args.This();
+}
+
+Handle<Value> SortedVector::BinarySearch(const Arguments& args) {
+  PROFILE_METHOD(binarySearch, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("binarySearch(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.lower_bound(probe);
+  double index = (double) (it - obj->storage.begin());
+  if (it == obj->storage.end() || ValueComparator()(probe, *it)) {
+    index = -index - 1;
+  }
+  return scope.Close(Number::New(index));
+}
+
+Handle<Value> SortedVector::EqualRange(const Arguments& args) {
+  PROFILE_METHOD(equalRange, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("equalRange(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  pair<Storage::iterator, Storage::iterator> range = equal_range(obj->storage.begin(), obj->storage.end(),
+      (const Element&) probe, ValueComparator());
+  Local<Array> array = Array::New(2);
+  array->Set(0, Number::New((double) (range.first - obj->storage.begin())));
+  array->Set(1, Number::New((double) (range.second - obj->storage.begin())));
+  return scope.Close(array);
+}
+
+Handle<Value> SortedVector::Index(const Arguments& args) {
+  PROFILE_METHOD(index, args);
+  if (args.Length() < 1) {
+    return ThrowException(Exception::Error(String::New("index(value) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  Handle<Array> array = Array::New(args.Length());
+  for (int i = 0; i < args.Length(); i++) {
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::const_iterator it = obj->storage.find(probe);
+    if (args.Length() == 1) {
+      return it == obj->storage.end() ? Undefined() : scope.Close(Number::New((double) (it - obj->storage.begin())));
+    } else if (it != obj->storage.end()) {
+      array->Set(i, Number::New((double) (it - obj->storage.begin())));
+    }
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> SortedVector::LowerBound(const Arguments& args) {
+  PROFILE_METHOD(lowerBound, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("lowerBound(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  return scope.Close(Number::New((double) (obj->storage.lower_bound(probe) - obj->storage.begin())));
+}
+
+Handle<Value> SortedVector::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    ElementProbe probe(args[i]);
+    PROFILE_LOOKUP();
+    Storage::iterator it = obj->storage.lower_bound(probe);
+    if (it != obj->storage.end() && !ValueComparator()(probe, *it)) {
+      it->Dispose();
+      obj->storage.erase(it);
+    }
+  }
+  return args.This();
+}
+
+Handle<Value> SortedVector::SortedInsert(const Arguments& args) {
+  PROFILE_METHOD(sortedInsert, args);
+  CHECK_ITERATING(sortedInsert, args);
+  CHECK_WRITABLE(sortedInsert, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("sortedInsert(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.insert(obj->storage.end(), Element::New(args[0], &obj->backing));
+  return scope.Close(Number::New((double) (it - obj->storage.begin())));
+}
+
+Handle<Value> SortedVector::UpperBound(const Arguments& args) {
+  PROFILE_METHOD(upperBound, args);
+  if (args.Length() != 1) {
+    return ThrowException(Exception::Error(String::New("upperBound(value) takes one argument.")));
+  }
+
+  HandleScope scope;
+  SortedVector* obj = ObjectWrap::Unwrap<SortedVector>(args.This());
+  ElementProbe probe(args[0]);
+  PROFILE_LOOKUP();
+  return scope.Close(Number::New((double) (obj->storage.upper_bound(probe) - obj->storage.begin())));
+}
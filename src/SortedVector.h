@@ -0,0 +1,108 @@
+#ifndef COLLECTION_SORTED_VECTOR_H
+#define COLLECTION_SORTED_VECTOR_H
+
+#include <algorithm>
+#include <node.h>
+#include "common.h"
+#include "Vector.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class SortedStorage
+ *
+ * A vector whose elements are kept in the order of ValueComparator, so that elements are found by binary search.
+ * Equal elements stay in the order they were inserted.
+ */
+
+class SortedStorage : public InternalVector<Element, ValueComparator> {
+  public:
+    typedef InternalVector<Element, ValueComparator>::iterator iterator;
+    typedef InternalVector<Element, ValueComparator>::const_iterator const_iterator;
+
+    inline iterator lower_bound(const Element& value) {
+      return std::lower_bound(begin(), end(), value, ValueComparator());
+    }
+
+    inline iterator upper_bound(const Element& value) {
+      return std::upper_bound(begin(), end(), value, ValueComparator());
+    }
+
+    inline const_iterator find(const Element& value) const {
+      ValueComparator comparator;
+      const_iterator it = std::lower_bound(begin(), end(), value, comparator);
+      return it != end() && !comparator(value, *it) ? it : end();
+    }
+
+    /*
+     * Insert a value after the elements equal to it. `position` is a hint, which is taken if the value belongs there,
+     * so that values added in order are appended without a search.
+     */
+    inline iterator insert(iterator position, const Element& value) {
+      ValueComparator comparator;
+      if ((position != begin() && comparator(value, *(position - 1))) ||
+          (position != end() && !comparator(value, *position))) {
+        position = upper_bound(value);
+      }
+      return InternalVector<Element, ValueComparator>::insert(position, value);
+    }
+
+    /*
+     * Restore the order after values were appended with push_back(), starting at index `from`. The appended values
+     * are sorted unless they are already, and merged with the others unless they all come after them.
+     */
+    inline void Merge(size_t from) {
+      ValueComparator comparator;
+      iterator middle = begin() + from;
+      for (iterator it = middle; it != end() && it + 1 != end(); it++) {
+        if (comparator(*(it + 1), *it)) {
+          stable_sort(middle, end(), comparator);
+          break;
+        }
+      }
+      if (middle != begin() && middle != end() && comparator(*middle, *(middle - 1))) {
+        inplace_merge(begin(), middle, end(), comparator);
+      }
+    }
+};
+
+
+/*
+ * class SortedVector
+ *
+ * A vector whose elements are kept sorted, so that they are looked up by binary search while they are still stored
+ * contiguously.
+ */
+
+class SortedVector : public Collection<SortedStorage> {
+  public:
+    typedef SortedStorage Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    void AddValues(Handle<Value> values);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> BinarySearch(const Arguments& args);
+    static Handle<Value> EqualRange(const Arguments& args);
+    static Handle<Value> Index(const Arguments& args);
+    static Handle<Value> LowerBound(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> SortedInsert(const Arguments& args);
+    static Handle<Value> UpperBound(const Arguments& args);
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include "Map.h"
+#include "StringMap.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class StringMap
+ */
+
+Handle<Value> StringMap::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  Handle<Value> parameters[2];
+  parameters[0] = String::New(value.first.data(), (int) value.first.size());
+  parameters[1] = value.second.ToValue();
+  Local<Object> object = MapEntry::constructor->GetFunction()->NewInstance(2, parameters);
+  return scope.Close(object);
+}
+
+void StringMap::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("StringMap"));
+
+  exports->Set(String::NewSymbol("StringMap"), constructor->GetFunction());
+}
+
+void StringMap::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("get"), FunctionTemplate::New(Get)->GetFunction());
+  thisObject->Set(String::NewSymbol("getAt"), FunctionTemplate::New(GetAt)->GetFunction());
+  thisObject->Set(String::NewSymbol("hasPrefix"), FunctionTemplate::New(HasPrefix)->GetFunction());
+  thisObject->Set(String::NewSymbol("keys"), FunctionTemplate::New(Keys)->GetFunction());
+  thisObject->Set(String::NewSymbol("keysWithPrefix"), FunctionTemplate::New(KeysWithPrefix)->GetFunction());
+  thisObject->Set(String::NewSymbol("longestPrefixMatch"), FunctionTemplate::New(LongestPrefixMatch)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("set"), FunctionTemplate::New(Set)->GetFunction());
+  thisObject->Set(String::NewSymbol("setAll"), FunctionTemplate::New(SetAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("toObject"), FunctionTemplate::New(ToObject)->GetFunction());
+  thisObject->Set(String::NewSymbol("toString"), FunctionTemplate::New(ToString)->GetFunction());
+}
+
+/*
+ * Set the entries of a string map, or the properties of any other object.
+ */
+void StringMap::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  if (!IsSupportedObject(argument)) {
+    return;
+  }
+  Handle<Object> initObject = Handle<Object>::Cast(argument);
+  if (constructor->HasInstance(argument)) {
+    StringMap* init = ObjectWrap::Unwrap<StringMap>(initObject);
+    Storage::iterator it = init->storage.begin();
+    while (it != init->storage.end()) {
+      Set(it.Key().data(), it.Key().size(), it.Value().Copy(&backing));
+      ++it;
+    }
+  } else {
+    Local<Array> propertyNames = initObject->GetPropertyNames();
+    for (uint32_t i = 0; i < propertyNames->Length(); i++) {
+      Local<Value> key = propertyNames->Get(i)->ToString();
+      String::Utf8Value utf8(key);
+      Set(*utf8, utf8.length(), Element::New(initObject->Get(key), &backing));
+    }
+  }
+}
+
+bool StringMap::IsSupportedObject(Handle<Value> value) {
+  return value->IsObject();
+}
+
+bool StringMap::IsSupportedType(Handle<Value> value) {
+  return IsSupportedObject(value);
+}
+
+/*
+ * Set the value of a key to an element owned by the caller.
+ */
+void StringMap::Set(const char* key, size_t length, const Element& value) {
+  bool inserted;
+  PROFILE_LOOKUP();
+  Element* existing = storage.Insert(key, length, inserted);
+  if (!inserted) {
+    existing->Dispose();
+  }
+  *existing = value;
+}
+
+Handle<Value> StringMap::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  if (args.Length() > 1 || !(args[0]->IsUndefined() || args[0]->IsObject())) {
+    return ThrowException(Exception::Error(String::New("Argument must be an object or omitted.")));
+  }
+
+  StringMap* obj = new StringMap();
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+
+  return args.This();
+}
+
+Handle<Value> StringMap::Get(const Arguments& args) {
+  PROFILE_METHOD(get, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("get(key, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  if (args.Length() == 1) {
+    if (args[0]->IsString()) {
+      String::Utf8Value utf8(args[0]);
+      PROFILE_LOOKUP();
+      Element* value = obj->storage.Get(*utf8, utf8.length());
+      if (value != NULL) {
+        return scope.Close(value->ToValue());
+      }
+    }
+  } else {
+    Handle<Array> array = Array::New();
+    for (int i = 0; i < args.Length(); i++) {
+      if (args[i]->IsString()) {
+        String::Utf8Value utf8(args[i]);
+        PROFILE_LOOKUP();
+        Element* value = obj->storage.Get(*utf8, utf8.length());
+        if (value != NULL) {
+          array->Set(i, value->ToValue());
+        }
+      }
+    }
+    return scope.Close(array);
+  }
+  return Undefined();
+}
+
+Handle<Value> StringMap::GetAt(const Arguments& args) {
+  PROFILE_METHOD(getAt, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("getAt(index, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    Handle<Value> arg = args[i];
+    if (!(arg->IsUndefined()) && !(arg->IsNull()) && !(arg->IsUint32())) {
+      return ThrowException(Exception::Error(String::New("getAt(index, ...) takes only integer arguments.")));
+    }
+  }
+
+  return Collection<Storage>::Get(args);
+}
+
+Handle<Value> StringMap::HasPrefix(const Arguments& args) {
+  PROFILE_METHOD(hasPrefix, args);
+  if (args.Length() != 1 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("hasPrefix(prefix) takes a string argument.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  String::Utf8Value prefix(args[0]);
+  PROFILE_LOOKUP();
+  return scope.Close(Boolean::New(obj->storage.HasPrefix(*prefix, prefix.length())));
+}
+
+Handle<Value> StringMap::Keys(const Arguments& args) {
+  PROFILE_METHOD(keys, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(keys, args);
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  Local<Array> array = Array::New((uint32_t) obj->storage.size());
+  Storage::iterator it = obj->storage.begin();
+  for (uint32_t i = 0; it != obj->storage.end(); ++it, i++) {
+    array->Set(i, String::New(it.Key().data(), (int) it.Key().size()));
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> StringMap::KeysWithPrefix(const Arguments& args) {
+  PROFILE_METHOD(keysWithPrefix, args);
+  if (args.Length() != 1 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("keysWithPrefix(prefix) takes a string argument.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  String::Utf8Value prefix(args[0]);
+  size_t length = prefix.length();
+  Local<Array> array = Array::New();
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.PrefixBegin(*prefix, length);
+  for (uint32_t i = 0; it != obj->storage.end() && it.Key().compare(0, length, *prefix, length) == 0; ++it, i++) {
+    PROFILE_VISITS(1);
+    array->Set(i, String::New(it.Key().data(), (int) it.Key().size()));
+  }
+  return scope.Close(array);
+}
+
+/*
+ * Find the entry with the longest key that a string starts with, as routing tables do.
+ */
+Handle<Value> StringMap::LongestPrefixMatch(const Arguments& args) {
+  PROFILE_METHOD(longestPrefixMatch, args);
+  if (args.Length() != 1 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("longestPrefixMatch(value) takes a string argument.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  String::Utf8Value utf8(args[0]);
+  size_t length;
+  PROFILE_LOOKUP();
+  if (!obj->storage.LongestPrefix(*utf8, utf8.length(), length)) {
+    return Undefined();
+  }
+  Element* value = obj->storage.Get(*utf8, length);
+  return scope.Close(obj->GetValue(Storage::value_type(string(*utf8, length), *value)));
+}
+
+Handle<Value> StringMap::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(key, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  for (int i = 0; i < args.Length(); i++) {
+    if (args[i]->IsString()) {
+      String::Utf8Value utf8(args[i]);
+      Element value;
+      PROFILE_LOOKUP();
+      if (obj->storage.Erase(*utf8, utf8.length(), value)) {
+        value.Dispose();
+      }
+    }
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> StringMap::Set(const Arguments& args) {
+  PROFILE_METHOD(set, args);
+  CHECK_ITERATING(set, args);
+  CHECK_WRITABLE(set, args);
+  if (args.Length() != 2 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("set(key, value) takes a string key and a value.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  String::Utf8Value utf8(args[0]);
+  obj->Set(*utf8, utf8.length(), Element::New(args[1], &obj->backing));
+  return args.This();
+}
+
+Handle<Value> StringMap::SetAll(const Arguments& args) {
+  PROFILE_METHOD(setAll, args);
+  CHECK_ITERATING(setAll, args);
+  CHECK_WRITABLE(setAll, args);
+  if (args.Length() != 1 || !args[0]->IsObject()) {
+    return ThrowException(Exception::Error(String::New("setAll(object) takes one object argument.")));
+  }
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+  return args.This();
+}
+
+Handle<Value> StringMap::ToObject(const Arguments& args) {
+  PROFILE_METHOD(toObject, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toObject, args);
+
+  HandleScope scope;
+  StringMap* obj = ObjectWrap::Unwrap<StringMap>(args.This());
+  Local<Object> result = Object::New();
+  Storage::iterator it = obj->storage.begin();
+  while (it != obj->storage.end()) {
+    result->Set(String::New(it.Key().data(), (int) it.Key().size()), it.Value().ToValue());
+    ++it;
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> StringMap::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
+
+  HandleScope scope;
+  return scope.Close(CollectionUtil::Stringify(ToObject(args)));
+}
@@ -0,0 +1,50 @@
+#ifndef COLLECTION_STRING_MAP_H
+#define COLLECTION_STRING_MAP_H
+
+#include <node.h>
+#include "common.h"
+#include "RadixTree.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class StringMap
+ *
+ * A map with string keys, kept in a radix tree of their UTF-8 bytes so that keys with a common prefix share its
+ * bytes. Entries are iterated in the order of a Map with string keys, and can be looked up by prefix.
+ */
+
+class StringMap : public Collection< RadixTree<Element> > {
+  public:
+    typedef RadixTree<Element> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    void Set(const char* key, size_t length, const Element& value);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Get(const Arguments& args);
+    static Handle<Value> GetAt(const Arguments& args);
+    static Handle<Value> HasPrefix(const Arguments& args);
+    static Handle<Value> Keys(const Arguments& args);
+    static Handle<Value> KeysWithPrefix(const Arguments& args);
+    static Handle<Value> LongestPrefixMatch(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> Set(const Arguments& args);
+    static Handle<Value> SetAll(const Arguments& args);
+    static Handle<Value> ToObject(const Arguments& args);
+    static Handle<Value> ToString(const Arguments& args);
+};
+
+#endif
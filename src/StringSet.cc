@@ -0,0 +1,229 @@
+#include "StringSet.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class StringSet
+ */
+
+StringSet::~StringSet() {
+  // Strings hold nothing to dispose, so the tree is cleared without visiting them.
+  storage.clear();
+}
+
+Handle<Value> StringSet::GetValue(const Storage::value_type& value) const {
+  HandleScope scope;
+  return scope.Close(String::New(value.data(), (int) value.size()));
+}
+
+void StringSet::Init(Handle<Object> exports) {
+  HandleScope scope;
+
+  constructor = Persistent<FunctionTemplate>::New(FunctionTemplate::New(New));
+  constructor->InstanceTemplate()->SetInternalFieldCount(1); // for constructors
+  constructor->SetClassName(String::NewSymbol("StringSet"));
+
+  exports->Set(String::NewSymbol("StringSet"), constructor->GetFunction());
+}
+
+void StringSet::InitializeFields(Handle<Object> thisObject) {
+  Collection<Storage>::InitializeFields(thisObject);
+
+  thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
+  thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("clear"), FunctionTemplate::New(Clear)->GetFunction());
+  thisObject->Set(String::NewSymbol("hasPrefix"), FunctionTemplate::New(HasPrefix)->GetFunction());
+  thisObject->Set(String::NewSymbol("keysWithPrefix"), FunctionTemplate::New(KeysWithPrefix)->GetFunction());
+  thisObject->Set(String::NewSymbol("longestPrefixMatch"), FunctionTemplate::New(LongestPrefixMatch)->GetFunction());
+  thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+}
+
+/*
+ * Add the strings of an array or of a string set. Values of an array must already be checked with IsStringArray().
+ */
+void StringSet::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
+  bool inserted;
+  if (argument->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(argument);
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      String::Utf8Value utf8(array->Get(i));
+      PROFILE_LOOKUP();
+      storage.Insert(*utf8, utf8.length(), inserted);
+    }
+  } else if (constructor->HasInstance(argument)) {
+    StringSet* other = ObjectWrap::Unwrap<StringSet>(Handle<Object>::Cast(argument));
+    Storage::iterator it = other->storage.begin();
+    while (it != other->storage.end()) {
+      PROFILE_LOOKUP();
+      storage.Insert(it.Key().data(), it.Key().size(), inserted);
+      ++it;
+    }
+  }
+}
+
+bool StringSet::IsSupportedObject(Handle<Value> value) {
+  return constructor->HasInstance(value);
+}
+
+bool StringSet::IsSupportedType(Handle<Value> value) {
+  return value->IsString();
+}
+
+bool StringSet::IsStringArray(Handle<Value> value) {
+  if (!(value->IsArray())) {
+    return false;
+  }
+  Handle<Array> array = Handle<Array>::Cast(value);
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    if (!(array->Get(i)->IsString())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Handle<Value> StringSet::New(const Arguments& args) {
+  if (!args.IsConstructCall()) {
+    return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
+  }
+  bool argError = args.Length() > 1;
+  if (!argError && !(args[0]->IsUndefined()) && !(constructor->HasInstance(args[0]))) {
+    argError = !IsStringArray(args[0]);
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("Argument must be an optional array of strings or string set.")));
+  }
+
+  StringSet* obj = new StringSet();
+  obj->Wrap(args.This());
+
+  obj->InitializeFields(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+
+  return args.This();
+}
+
+Handle<Value> StringSet::Add(const Arguments& args) {
+  PROFILE_METHOD(add, args);
+  CHECK_ITERATING(add, args);
+  CHECK_WRITABLE(add, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!(args[i]->IsString())) {
+      return ThrowException(Exception::Error(String::New("add(value, ...) takes only strings.")));
+    }
+  }
+
+  HandleScope scope;
+  StringSet* obj = ObjectWrap::Unwrap<StringSet>(args.This());
+  bool inserted;
+  for (int i = 0; i < args.Length(); i++) {
+    String::Utf8Value utf8(args[i]);
+    PROFILE_LOOKUP();
+    obj->storage.Insert(*utf8, utf8.length(), inserted);
+  }
+  return scope.Close(args.This());
+}
+
+Handle<Value> StringSet::AddAll(const Arguments& args) {
+  PROFILE_METHOD(addAll, args);
+  CHECK_ITERATING(addAll, args);
+  CHECK_WRITABLE(addAll, args);
+  if (args.Length() != 1 || !(IsStringArray(args[0]) || constructor->HasInstance(args[0]))) {
+    return ThrowException(Exception::Error(String::New("addAll(object) takes an array of strings or a string set.")));
+  }
+
+  HandleScope scope;
+  StringSet* obj = ObjectWrap::Unwrap<StringSet>(args.This());
+  obj->InitializeValues(args.This(), args[0]);
+  return scope.Close(args.This());
+}
+
+Handle<Value> StringSet::Clear(const Arguments& args) {
+  PROFILE_METHOD(clear, args);
+  CHECK_ITERATING(clear, args);
+  CHECK_WRITABLE(clear, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
+
+  HandleScope scope;
+  ObjectWrap::Unwrap<StringSet>(args.This())->storage.clear();
+  return scope.Close(args.This());
+}
+
+Handle<Value> StringSet::HasPrefix(const Arguments& args) {
+  PROFILE_METHOD(hasPrefix, args);
+  if (args.Length() != 1 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("hasPrefix(prefix) takes a string argument.")));
+  }
+
+  HandleScope scope;
+  StringSet* obj = ObjectWrap::Unwrap<StringSet>(args.This());
+  String::Utf8Value prefix(args[0]);
+  PROFILE_LOOKUP();
+  return scope.Close(Boolean::New(obj->storage.HasPrefix(*prefix, prefix.length())));
+}
+
+Handle<Value> StringSet::KeysWithPrefix(const Arguments& args) {
+  PROFILE_METHOD(keysWithPrefix, args);
+  if (args.Length() != 1 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("keysWithPrefix(prefix) takes a string argument.")));
+  }
+
+  HandleScope scope;
+  StringSet* obj = ObjectWrap::Unwrap<StringSet>(args.This());
+  String::Utf8Value prefix(args[0]);
+  size_t length = prefix.length();
+  Local<Array> array = Array::New();
+  PROFILE_LOOKUP();
+  Storage::iterator it = obj->storage.PrefixBegin(*prefix, length);
+  for (uint32_t i = 0; it != obj->storage.end() && it.Key().compare(0, length, *prefix, length) == 0; ++it, i++) {
+    PROFILE_VISITS(1);
+    array->Set(i, String::New(it.Key().data(), (int) it.Key().size()));
+  }
+  return scope.Close(array);
+}
+
+/*
+ * Find the longest string of this set that a string starts with.
+ */
+Handle<Value> StringSet::LongestPrefixMatch(const Arguments& args) {
+  PROFILE_METHOD(longestPrefixMatch, args);
+  if (args.Length() != 1 || !(args[0]->IsString())) {
+    return ThrowException(Exception::Error(String::New("longestPrefixMatch(value) takes a string argument.")));
+  }
+
+  HandleScope scope;
+  StringSet* obj = ObjectWrap::Unwrap<StringSet>(args.This());
+  String::Utf8Value utf8(args[0]);
+  size_t length;
+  PROFILE_LOOKUP();
+  if (!obj->storage.LongestPrefix(*utf8, utf8.length(), length)) {
+    return Undefined();
+  }
+  return scope.Close(String::New(*utf8, (int) length));
+}
+
+Handle<Value> StringSet::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
+  CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("remove(value, ...) takes at least one argument.")));
+  }
+
+  HandleScope scope;
+  StringSet* obj = ObjectWrap::Unwrap<StringSet>(args.This());
+  NoValue value;
+  for (int i = 0; i < args.Length(); i++) {
+    if (args[i]->IsString()) {
+      String::Utf8Value utf8(args[i]);
+      PROFILE_LOOKUP();
+      obj->storage.Erase(*utf8, utf8.length(), value);
+    }
+  }
+  return scope.Close(args.This());
+}
@@ -0,0 +1,48 @@
+#ifndef COLLECTION_STRING_SET_H
+#define COLLECTION_STRING_SET_H
+
+#include <node.h>
+#include "common.h"
+#include "RadixTree.h"
+
+using namespace std;
+using namespace v8;
+
+
+/*
+ * class StringSet
+ *
+ * A set of strings, kept in a radix tree of their UTF-8 bytes so that strings with a common prefix share its bytes.
+ * Strings are iterated in the order of a Set of strings, and can be looked up by prefix.
+ */
+
+class StringSet : public Collection< RadixTree<NoValue> > {
+  public:
+    typedef RadixTree<NoValue> Storage;
+
+    virtual Handle<Value> GetValue(const Storage::value_type& value) const;
+
+    static void Init(Handle<Object> exports);
+
+  protected:
+    virtual ~StringSet();
+
+    virtual void InitializeFields(Handle<Object> thisObject);
+    virtual void InitializeValues(Handle<Object> thisObject, Handle<Value> argument);
+    virtual bool IsSupportedObject(Handle<Value> value);
+    virtual bool IsSupportedType(Handle<Value> value);
+
+    static bool IsStringArray(Handle<Value> value);
+
+    static Handle<Value> New(const Arguments& args);
+
+    static Handle<Value> Add(const Arguments& args);
+    static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> Clear(const Arguments& args);
+    static Handle<Value> HasPrefix(const Arguments& args);
+    static Handle<Value> KeysWithPrefix(const Arguments& args);
+    static Handle<Value> LongestPrefixMatch(const Arguments& args);
+    static Handle<Value> Remove(const Arguments& args);
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "TDigest.h"
+
+using namespace std;
+
+
+/*
+ * class TDigest
+ */
+
+TDigest::TDigest(double compression) : compression(compression), count(0), min(0), max(0) {
+}
+
+void TDigest::Add(double value) {
+  if (count == 0 || value < min) {
+    min = value;
+  }
+  if (count == 0 || value > max) {
+    max = value;
+  }
+  count++;
+  buffer.push_back(Centroid(value, 1));
+  if (buffer.size() >= (size_t) (5 * compression)) {
+    Compress();
+  }
+}
+
+void TDigest::Clear() {
+  count = 0;
+  min = max = 0;
+  centroids.clear();
+  buffer.clear();
+}
+
+void TDigest::Merge(const TDigest& other) {
+  if (other.count == 0) {
+    return;
+  }
+  if (count == 0 || other.min < min) {
+    min = other.min;
+  }
+  if (count == 0 || other.max > max) {
+    max = other.max;
+  }
+  count += other.count;
+  // Copied first, in case the other digest is this one.
+  vector<Centroid> added(other.centroids);
+  added.insert(added.end(), other.buffer.begin(), other.buffer.end());
+  buffer.insert(buffer.end(), added.begin(), added.end());
+  if (buffer.size() >= (size_t) (5 * compression)) {
+    Compress();
+  }
+}
+
+/*
+ * Centroids are treated as spreading their weight evenly around their means, so that a quantile is interpolated
+ * between the means of the two centroids around it, or between a centroid and the smallest or largest value.
+ */
+double TDigest::Quantile(double q) {
+  Compress();
+  if (q <= 0) {
+    return min;
+  }
+  if (q >= 1) {
+    return max;
+  }
+
+  double index = q * count;
+  const Centroid& first = centroids[0];
+  if (index < first.weight / 2) {
+    return min + (first.mean - min) * index / (first.weight / 2);
+  }
+  double weightSoFar = first.weight / 2;
+  for (size_t i = 0; i + 1 < centroids.size(); i++) {
+    double delta = (centroids[i].weight + centroids[i + 1].weight) / 2;
+    if (weightSoFar + delta > index) {
+      return centroids[i].mean + (centroids[i + 1].mean - centroids[i].mean) * (index - weightSoFar) / delta;
+    }
+    weightSoFar += delta;
+  }
+  const Centroid& last = centroids.back();
+  double z = (index - weightSoFar) / (last.weight / 2);
+  return last.mean + (max - last.mean) * (z < 1 ? z : 1);
+}
+
+double TDigest::Cdf(double value) {
+  Compress();
+  if (value < min) {
+    return 0;
+  }
+  if (value >= max) {
+    return 1;
+  }
+  const Centroid& first = centroids[0];
+  if (value < first.mean) {
+    return first.weight / 2 * (value - min) / (first.mean - min) / count;
+  }
+  double weightSoFar = first.weight / 2;
+  for (size_t i = 0; i + 1 < centroids.size(); i++) {
+    double delta = (centroids[i].weight + centroids[i + 1].weight) / 2;
+    if (value < centroids[i + 1].mean) {
+      return (weightSoFar + delta * (value - centroids[i].mean) / (centroids[i + 1].mean - centroids[i].mean)) / count;
+    }
+    weightSoFar += delta;
+  }
+  const Centroid& last = centroids.back();
+  return (weightSoFar + last.weight / 2 * (value - last.mean) / (max - last.mean)) / count;
+}
+
+/*
+ * A serialized digest is a cookie, the number of centroids, the compression, the count, the smallest and the largest
+ * value, followed by the mean and the weight of each centroid, all little-endian.
+ */
+size_t TDigest::SerializedSize() {
+  Compress();
+  return HEADER_SIZE + 16 * centroids.size();
+}
+
+void TDigest::Serialize(char* data) {
+  Compress();
+  Write32(data, SERIAL_COOKIE);
+  Write32(data, (uint32_t) centroids.size());
+  WriteDouble(data, compression);
+  WriteDouble(data, count);
+  WriteDouble(data, min);
+  WriteDouble(data, max);
+  for (size_t i = 0; i < centroids.size(); i++) {
+    WriteDouble(data, centroids[i].mean);
+    WriteDouble(data, centroids[i].weight);
+  }
+}
+
+bool TDigest::Deserialize(const char* data, size_t length) {
+  if (length < HEADER_SIZE || Read32(data) != SERIAL_COOKIE || length != HEADER_SIZE + 16 * (size_t) Read32(data + 4)) {
+    return false;
+  }
+  size_t size = Read32(data + 4);
+  double compression = ReadDouble(data + 8);
+  double count = ReadDouble(data + 16);
+  double min = ReadDouble(data + 24);
+  double max = ReadDouble(data + 32);
+  if (!(compression >= MIN_COMPRESSION && compression <= MAX_COMPRESSION) || (size == 0) != (count == 0) ||
+      !(min <= max)) {
+    return false;
+  }
+  vector<Centroid> centroids;
+  double total = 0;
+  for (size_t i = 0; i < size; i++) {
+    double mean = ReadDouble(data + HEADER_SIZE + 16 * i);
+    double weight = ReadDouble(data + HEADER_SIZE + 16 * i + 8);
+    if (!(weight > 0) || !(mean >= min && mean <= max) || (i > 0 && mean < centroids.back().mean)) {
+      return false;
+    }
+    centroids.push_back(Centroid(mean, weight));
+    total += weight;
+  }
+  if (fabs(total - count) > 1e-9 * count) {
+    return false;
+  }
+  this->compression = compression;
+  this->count = count;
+  this->min = size == 0 ? 0 : min;
+  this->max = size == 0 ? 0 : max;
+  this->centroids.swap(centroids);
+  buffer.clear();
+  return true;
+}
+
+/*
+ * Merge the buffer into the centroids. Neighbouring centroids, in order of their means, are combined as long as the
+ * combined centroid stays within the weight limit of where it starts.
+ */
+void TDigest::Compress() {
+  if (buffer.empty()) {
+    return;
+  }
+  buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+  sort(buffer.begin(), buffer.end());
+
+  vector<Centroid> result;
+  Centroid current = buffer[0];
+  double weightSoFar = 0;
+  double limit = WeightLimit(0);
+  for (size_t i = 1; i < buffer.size(); i++) {
+    const Centroid& next = buffer[i];
+    if (weightSoFar + current.weight + next.weight <= limit) {
+      current.weight += next.weight;
+      current.mean += (next.mean - current.mean) * next.weight / current.weight;
+    } else {
+      weightSoFar += current.weight;
+      result.push_back(current);
+      limit = WeightLimit(weightSoFar / count);
+      current = next;
+    }
+  }
+  result.push_back(current);
+
+  centroids.swap(result);
+  buffer.clear();
+}
+
+/*
+ * With the scale function k(q) = compression / z * log(q / (1 - q)), where z = 4 * log(count / compression) + 24, a
+ * centroid starting at quantile q may extend to the quantile at which k has grown by 1. Centroids thus shrink in
+ * proportion to q * (1 - q) towards both ends, and their number stays bounded by about the compression.
+ */
+double TDigest::WeightLimit(double q) const {
+  double normalizer = compression / (4 * log(count > compression ? count / compression : 1) + 24);
+  double k = log(q / (1 - q)) + 1 / normalizer;
+  return count / (1 + exp(-k));
+}
+
+void TDigest::Write32(char*& data, uint32_t value) {
+  *data++ = (char) (value & 0xff);
+  *data++ = (char) ((value >> 8) & 0xff);
+  *data++ = (char) ((value >> 16) & 0xff);
+  *data++ = (char) ((value >> 24) & 0xff);
+}
+
+void TDigest::WriteDouble(char*& data, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  Write32(data, (uint32_t) bits);
+  Write32(data, (uint32_t) (bits >> 32));
+}
+
+uint32_t TDigest::Read32(const char* data) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+double TDigest::ReadDouble(const char* data) {
+  uint64_t bits = (uint64_t) Read32(data) | ((uint64_t) Read32(data + 4) << 32);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
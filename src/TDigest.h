@@ -0,0 +1,90 @@
+#ifndef COLLECTION_T_DIGEST_H
+#define COLLECTION_T_DIGEST_H
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * class TDigest
+ *
+ * A merging t-digest, which summarizes a stream of numbers in a bounded number of weighted centroids so that
+ * quantiles can be estimated from it. Centroids are small near both ends of the distribution and large in the
+ * middle, following a logarithmic scale function, so that extreme quantiles such as the 99.9th percentile are
+ * estimated most accurately. The number of centroids is bounded by about the compression; larger compressions are
+ * more accurate.
+ *
+ * Added values are buffered, and merged into the centroids in a single sorted pass once the buffer is full or the
+ * digest is queried. The smallest and largest values are kept exactly.
+ */
+
+class TDigest {
+  public:
+    static const uint32_t MIN_COMPRESSION = 20;
+    static const uint32_t MAX_COMPRESSION = 1000;
+
+    explicit TDigest(double compression);
+
+    inline double Count() const {
+      return count;
+    }
+
+    inline double Min() const {
+      return min;
+    }
+
+    inline double Max() const {
+      return max;
+    }
+
+    void Add(double value);
+    void Clear();
+    void Merge(const TDigest& other);
+
+    /*
+     * Estimate the value at a quantile between 0 and 1, and the fraction of values that are less than or equal to a
+     * value. Neither may be called on an empty digest.
+     */
+    double Quantile(double q);
+    double Cdf(double value);
+
+    size_t SerializedSize();
+    void Serialize(char* data);
+    bool Deserialize(const char* data, size_t length);
+
+  private:
+    static const uint32_t SERIAL_COOKIE = 0x31474454; // "TDG1"
+    static const size_t HEADER_SIZE = 40;
+
+    struct Centroid {
+      Centroid(double mean, double weight) : mean(mean), weight(weight) {
+      }
+
+      inline bool operator<(const Centroid& other) const {
+        return mean < other.mean;
+      }
+
+      double mean;
+      double weight;
+    };
+
+    void Compress();
+    // Total weight of the centroids that may precede a centroid starting at quantile q.
+    double WeightLimit(double q) const;
+
+    static void Write32(char*& data, uint32_t value);
+    static void WriteDouble(char*& data, double value);
+    static uint32_t Read32(const char* data);
+    static double ReadDouble(const char* data);
+
+    double compression;
+    double count;
+    double min;
+    double max;
+    vector<Centroid> centroids;
+    vector<Centroid> buffer;
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef COLLECTION_TIMER_WHEEL_H
+#define COLLECTION_TIMER_WHEEL_H
+
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * class TimerLink
+ *
+ * Intrusive link of a node into the slot of a TimerWheel where it is scheduled. A node is removed from the wheel
+ * when its link is destroyed.
+ */
+
+template <class Node> struct TimerLink {
+  TimerLink() : tick(0), prev(NULL), next(NULL), slot(NULL), count(NULL) {
+  }
+
+  ~TimerLink() {
+    Unlink();
+  }
+
+  inline bool IsLinked() const {
+    return slot != NULL;
+  }
+
+  void Unlink() {
+    if (slot == NULL) {
+      return;
+    }
+    if (prev == NULL) {
+      *slot = next;
+    } else {
+      prev->link.next = next;
+    }
+    if (next != NULL) {
+      next->link.prev = prev;
+    }
+    (*count)--;
+    prev = next = NULL;
+    slot = NULL;
+    count = NULL;
+  }
+
+  uint64_t tick;
+  Node* prev;
+  Node* next;
+  Node** slot;
+  size_t* count;
+};
+
+
+/*
+ * class TimerWheel
+ *
+ * Hierarchical timing wheel in the style of the Linux kernel timers. Nodes are scheduled at an absolute tick, and are
+ * handed back by Advance() once that tick is reached. The first level has a slot for each of the next 256 ticks; each
+ * further level has 64 slots, each covering 64 times the span of a slot of the level below. Scheduling and removing a
+ * node take constant time, and a node is moved down at most four times before it is due. Nodes due more than 2^32
+ * ticks ahead wait in the last level and are rescheduled when it comes around.
+ *
+ * Node must have a TimerLink<Node> member named `link`.
+ */
+
+template <class Node> class TimerWheel {
+  public:
+    TimerWheel() : current(0) {
+      memset(slots, 0, sizeof(slots));
+      memset(counts, 0, sizeof(counts));
+    }
+
+    /*
+     * The last tick that has been processed. Nodes scheduled at or before it are due at the next tick.
+     */
+    inline uint64_t Current() const {
+      return current;
+    }
+
+    void Schedule(Node* node, uint64_t tick) {
+      node->link.Unlink();
+      node->link.tick = tick;
+      Link(node);
+    }
+
+    /*
+     * Process all ticks up to and including `tick`, appending nodes that become due to `expired`. Expired nodes are
+     * unlinked from the wheel.
+     */
+    void Advance(uint64_t tick, vector<Node*>& expired) {
+      while (current < tick) {
+        if (counts[0] == 0) {
+          if (IsEmpty()) {
+            current = tick;
+            break;
+          }
+          // Nothing is due before the first level wraps around.
+          uint64_t last = current | (ROOT_SLOTS - 1);
+          if (last > current) {
+            current = last < tick ? last : tick;
+            continue;
+          }
+        }
+
+        uint64_t next = current + 1;
+        if ((next & (ROOT_SLOTS - 1)) == 0) {
+          Cascade(next);
+        }
+        Node** slot = &slots[next & (ROOT_SLOTS - 1)];
+        while (*slot != NULL) {
+          Node* node = *slot;
+          node->link.Unlink();
+          expired.push_back(node);
+        }
+        current = next;
+      }
+    }
+
+  private:
+    static const int ROOT_BITS = 8;
+    static const int LEVEL_BITS = 6;
+    static const int LEVELS = 4;
+    static const size_t ROOT_SLOTS = 1 << ROOT_BITS;
+    static const size_t LEVEL_SLOTS = 1 << LEVEL_BITS;
+    static const size_t SLOT_COUNT = ROOT_SLOTS + LEVELS * LEVEL_SLOTS;
+
+    void Link(Node* node) {
+      uint64_t base = current + 1;
+      uint64_t tick = node->link.tick < base ? base : node->link.tick;
+      uint64_t delta = tick - base;
+      size_t index;
+      int level = 0;
+      if (delta < ROOT_SLOTS) {
+        index = tick & (ROOT_SLOTS - 1);
+      } else {
+        while (level < LEVELS - 1 && delta >= ((uint64_t) 1 << (ROOT_BITS + (level + 1) * LEVEL_BITS))) {
+          level++;
+        }
+        uint64_t limit = (uint64_t) 1 << (ROOT_BITS + LEVELS * LEVEL_BITS);
+        if (delta >= limit) {
+          tick = base + limit - 1;
+        }
+        index = ROOT_SLOTS + level * LEVEL_SLOTS +
+            ((tick >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SLOTS - 1));
+        level++;
+      }
+
+      Node** slot = &slots[index];
+      node->link.slot = slot;
+      node->link.count = &counts[level];
+      counts[level]++;
+      node->link.prev = NULL;
+      node->link.next = *slot;
+      if (*slot != NULL) {
+        (*slot)->link.prev = node;
+      }
+      *slot = node;
+    }
+
+    /*
+     * Move nodes of the slots that `next` enters in the upper levels down to the levels below.
+     */
+    void Cascade(uint64_t next) {
+      for (int level = 0; level < LEVELS; level++) {
+        size_t position = (next >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SLOTS - 1);
+        Node** slot = &slots[ROOT_SLOTS + level * LEVEL_SLOTS + position];
+        Node* node = *slot;
+        *slot = NULL;
+        while (node != NULL) {
+          Node* following = node->link.next;
+          (*node->link.count)--;
+          node->link.slot = NULL;
+          node->link.count = NULL;
+          node->link.prev = node->link.next = NULL;
+          Link(node);
+          node = following;
+        }
+        if (position != 0) {
+          break;
+        }
+      }
+    }
+
+    bool IsEmpty() const {
+      for (int level = 0; level <= LEVELS; level++) {
+        if (counts[level] > 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    uint64_t current;
+    Node* slots[SLOT_COUNT];
+    size_t counts[LEVELS + 1];
+};
+
+#endif
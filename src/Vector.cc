@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include "Set.h"
 #include "Vector.h"
 
 using namespace std;
@@ -9,9 +12,9 @@ using namespace v8;
  * class Vector
  */
 
-Handle<Value> Vector::GetValue(const Persistent<Value>& value) const {
+Handle<Value> Vector::GetValue(const Element& value) const {
   HandleScope scope;
-  return scope.Close(Local<Value>::New(value));
+  return scope.Close(value.ToValue());
 }
 
 void Vector::Init(Handle<Object> exports) {
@@ -27,25 +30,190 @@ void Vector::Init(Handle<Object> exports) {
 void Vector::InitializeFields(Handle<Object> thisObject) {
   IndexedCollection<Storage>::InitializeFields(thisObject);
 
+  thisObject->Set(String::NewSymbol("abs"), FunctionTemplate::New(Abs)->GetFunction());
+  thisObject->Set(String::NewSymbol("capacity"), FunctionTemplate::New(Capacity)->GetFunction());
+  thisObject->Set(String::NewSymbol("clamp"), FunctionTemplate::New(Clamp)->GetFunction());
+  thisObject->Set(String::NewSymbol("cumsum"), FunctionTemplate::New(Cumsum)->GetFunction());
+  thisObject->Set(String::NewSymbol("diff"), FunctionTemplate::New(Diff)->GetFunction());
+  thisObject->Set(String::NewSymbol("div"), FunctionTemplate::New(Div)->GetFunction());
+  thisObject->Set(String::NewSymbol("eq"), FunctionTemplate::New(Eq)->GetFunction());
+  thisObject->Set(String::NewSymbol("fill"), FunctionTemplate::New(Fill)->GetFunction());
+  thisObject->Set(String::NewSymbol("ge"), FunctionTemplate::New(Ge)->GetFunction());
+  thisObject->Set(String::NewSymbol("gt"), FunctionTemplate::New(Gt)->GetFunction());
+  thisObject->Set(String::NewSymbol("histogram"), FunctionTemplate::New(Histogram)->GetFunction());
+  thisObject->Set(String::NewSymbol("insertAll"), FunctionTemplate::New(InsertAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("insertAt"), FunctionTemplate::New(InsertAt)->GetFunction());
+  thisObject->Set(String::NewSymbol("le"), FunctionTemplate::New(Le)->GetFunction());
+  thisObject->Set(String::NewSymbol("lt"), FunctionTemplate::New(Lt)->GetFunction());
+  thisObject->Set(String::NewSymbol("minus"), FunctionTemplate::New(Minus)->GetFunction());
+  thisObject->Set(String::NewSymbol("ne"), FunctionTemplate::New(Ne)->GetFunction());
+  thisObject->Set(String::NewSymbol("plus"), FunctionTemplate::New(Plus)->GetFunction());
+  thisObject->Set(String::NewSymbol("quantile"), FunctionTemplate::New(Quantile)->GetFunction());
   thisObject->Set(String::NewSymbol("remove"), FunctionTemplate::New(Remove)->GetFunction());
+  thisObject->Set(String::NewSymbol("reserve"), FunctionTemplate::New(Reserve)->GetFunction());
   thisObject->Set(String::NewSymbol("reverse"), FunctionTemplate::New(Reverse)->GetFunction());
   thisObject->Set(String::NewSymbol("set"), FunctionTemplate::New(Set)->GetFunction());
+  thisObject->Set(String::NewSymbol("shrinkToFit"), FunctionTemplate::New(ShrinkToFit)->GetFunction());
+  thisObject->Set(String::NewSymbol("splice"), FunctionTemplate::New(Splice)->GetFunction());
+  thisObject->Set(String::NewSymbol("swap"), FunctionTemplate::New(Swap)->GetFunction());
+  thisObject->Set(String::NewSymbol("times"), FunctionTemplate::New(Times)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSON"), FunctionTemplate::New(ToJSON)->GetFunction());
+  thisObject->Set(String::NewSymbol("toJSONBuffer"), FunctionTemplate::New(ToJSONBuffer)->GetFunction());
+  thisObject->Set(String::NewSymbol("topK"), FunctionTemplate::New(TopK)->GetFunction());
+  thisObject->Set(String::NewSymbol("writeJSON"), FunctionTemplate::New(WriteJSON)->GetFunction());
   thisObject->Set(String::NewSymbol("each"), FunctionTemplate::New(Each)->GetFunction());
   thisObject->Set(String::NewSymbol("map"), FunctionTemplate::New(Map)->GetFunction());
 }
 
+/*
+ * Returns false if the memory cannot be allocated.
+ */
+bool Vector::ReserveCapacity(Storage& storage, size_t capacity) {
+  try {
+    storage.reserve(capacity);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+bool Vector::IsNumeric(const Storage& storage) {
+  for (Storage::const_iterator it = storage.begin(); it != storage.end(); it++) {
+    if (!it->IsNumber()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Copy the elements into an array of numbers, leaving out NaN, which has no order. Returns false if an element is not a
+ * number.
+ */
+bool Vector::GetNumbers(const Storage& storage, vector<double>& numbers) {
+  numbers.clear();
+  numbers.reserve(storage.size());
+  for (Storage::const_iterator it = storage.begin(); it != storage.end(); it++) {
+    if (!it->IsNumber()) {
+      return false;
+    }
+    double number = it->NumberValue();
+    if (number == number) {
+      numbers.push_back(number);
+    }
+  }
+  return true;
+}
+
+/*
+ * Select the first k numbers in the order of `comparator` into `heap`, sorted in that order. The heap keeps its last
+ * number on top, so that any other number is compared with that one alone unless it displaces it. NaN is left out.
+ */
+template <class Comparator> void Vector::TopNumbers(const Storage& storage, size_t k, Comparator comparator,
+    vector<double>& heap) {
+  if (k == 0) {
+    return;
+  }
+  for (Storage::const_iterator it = storage.begin(); it != storage.end(); it++) {
+    double number = it->NumberValue();
+    if (number != number) {
+      continue;
+    } else if (heap.size() < k) {
+      heap.push_back(number);
+      push_heap(heap.begin(), heap.end(), comparator);
+    } else if (comparator(number, heap.front())) {
+      pop_heap(heap.begin(), heap.end(), comparator);
+      heap.back() = number;
+      push_heap(heap.begin(), heap.end(), comparator);
+    }
+  }
+  sort_heap(heap.begin(), heap.end(), comparator);
+}
+
+/*
+ * Get the vector that an elementwise operation writes to: a new vector if `value` is undefined, or else the vector
+ * `value`, which may be the operand or this vector itself. Returns NULL if `value` is not a vector that can be written.
+ */
+Vector* Vector::GetTarget(Handle<Value> value, Handle<Object>& result) {
+  if (value->IsUndefined()) {
+    result = constructor->GetFunction()->NewInstance();
+  } else if (constructor->HasInstance(value)) {
+    result = Handle<Object>::Cast(value);
+  } else {
+    return NULL;
+  }
+  Vector* target = ObjectWrap::Unwrap<Vector>(result);
+  if (target->IsIterating() || !target->BeginWrite()) {
+    return NULL;
+  }
+  return target;
+}
+
+/*
+ * Make a target hold `length` elements. Elements that are added are empty until they are written.
+ */
+void Vector::Resize(Vector* target, size_t length) {
+  Storage& storage = target->storage;
+  if (storage.size() > length) {
+    for (Storage::iterator it = storage.begin() + length; it != storage.end(); it++) {
+      it->Dispose();
+    }
+    storage.erase(storage.begin() + length, storage.end());
+  } else {
+    storage.Grow(length - storage.size());
+    storage.resize(length);
+  }
+}
+
+/*
+ * Apply an operation to each element and the corresponding number of the operand. Every element of the result is
+ * computed from elements that are read before it is written, so that the target may be this vector or the operand.
+ */
+template <class Operation> Handle<Value> Vector::Combine(const Arguments& args, const char* usage) {
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  size_t length = obj->storage.size();
+  NumericOperand operand;
+  if (args.Length() < 1 || args.Length() > 2 || !operand.Set(args[0], length)) {
+    return ThrowException(Exception::Error(String::New(usage)));
+  }
+  if (!IsNumeric(obj->storage)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+  Handle<Object> result;
+  Vector* target = GetTarget(args[1], result);
+  if (target == NULL) {
+    return ThrowException(Exception::Error(String::New("Target must be a vector that is not being iterated.")));
+  }
+
+  Resize(target, length);
+  PROFILE_VISITS(length);
+  for (size_t i = 0; i < length; i++) {
+    Element element = Operation::Apply(obj->storage[i].NumberValue(), operand[i]);
+    target->storage[i].Dispose();
+    target->storage[i] = element;
+  }
+  return scope.Close(result);
+}
+
 Handle<Value> Vector::New(const Arguments& args) {
   if (!args.IsConstructCall()) {
     return ThrowException(Exception::Error(String::New("Use the new operator to create instances of this object.")));
   }
   Vector* obj = new Vector();
+  Handle<Value> values = args[0];
+  Handle<Value> options = args[1];
+  if (args.Length() == 1 && values->IsObject() && !(values->IsArray()) && !obj->IsSupportedObject(values)) {
+    values = Undefined();
+    options = args[0];
+  }
   bool argError = true;
-  if (args.Length() <= 1) {
-    if (args[0]->IsUndefined()) {
+  if (args.Length() <= 2) {
+    if (values->IsUndefined()) {
       argError = false;
-    } else if (args[0]->IsArray()) {
+    } else if (values->IsArray()) {
       argError = false;
-    } else if (obj->IsSupportedObject(args[0])) {
+    } else if (obj->IsSupportedObject(values)) {
       argError = false;
     }
   }
@@ -54,16 +222,412 @@ Handle<Value> Vector::New(const Arguments& args) {
     return ThrowException(Exception::Error(String::New("Argument must be an array, an object, or omitted.")));
   }
 
+  uint32_t capacity = 0;
+  if (!(options->IsUndefined())) {
+    bool optionError = !(options->IsObject());
+    if (!optionError) {
+      Handle<Value> capacityValue = Handle<Object>::Cast(options)->Get(String::NewSymbol("capacity"));
+      Handle<Value> growthFactor = Handle<Object>::Cast(options)->Get(String::NewSymbol("growthFactor"));
+      if (capacityValue->IsUint32()) {
+        capacity = capacityValue->Uint32Value();
+      } else if (!(capacityValue->IsUndefined())) {
+        optionError = true;
+      }
+      if (growthFactor->IsNumber() && growthFactor->NumberValue() > 1 && growthFactor->NumberValue() <= 16) {
+        obj->storage.growthFactor = growthFactor->NumberValue();
+      } else if (!(growthFactor->IsUndefined())) {
+        optionError = true;
+      }
+    }
+    if (optionError) {
+      delete obj;
+      return ThrowException(Exception::Error(String::New("Options must be {capacity: integer, growthFactor: number greater than 1 and at most 16}.")));
+    }
+  }
+  if (!ReserveCapacity(obj->storage, capacity)) {
+    delete obj;
+    return ThrowException(Exception::Error(String::New("Capacity is too large.")));
+  }
+
   obj->Wrap(args.This());
 
   obj->InitializeFields(args.This());
-  obj->InitializeValues(args.This(), args[0]);
+  obj->InitializeValues(args.This(), values);
+
+  return args.This();
+}
+
+Handle<Value> Vector::Abs(const Arguments& args) {
+  PROFILE_METHOD(abs, args);
+  if (args.Length() > 1) {
+    return ThrowException(Exception::Error(String::New("abs(target) takes an optional vector argument.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (!IsNumeric(obj->storage)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+  Handle<Object> result;
+  Vector* target = GetTarget(args[0], result);
+  if (target == NULL) {
+    return ThrowException(Exception::Error(String::New("Target must be a vector that is not being iterated.")));
+  }
+
+  size_t length = obj->storage.size();
+  Resize(target, length);
+  PROFILE_VISITS(length);
+  for (size_t i = 0; i < length; i++) {
+    double value = fabs(obj->storage[i].NumberValue());
+    target->storage[i].Dispose();
+    target->storage[i] = Element::NewNumber(value);
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> Vector::Capacity(const Arguments& args) {
+  PROFILE_METHOD(capacity, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(capacity, args);
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  return scope.Close(Number::New((double) obj->storage.capacity()));
+}
+
+Handle<Value> Vector::Clamp(const Arguments& args) {
+  PROFILE_METHOD(clamp, args);
+  if (args.Length() < 2 || args.Length() > 3 || !args[0]->IsNumber() || !args[1]->IsNumber() ||
+      !(args[0]->NumberValue() <= args[1]->NumberValue())) {
+    return ThrowException(Exception::Error(String::New("clamp(min, max, target) takes two numbers in order and an optional vector.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (!IsNumeric(obj->storage)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+  Handle<Object> result;
+  Vector* target = GetTarget(args[2], result);
+  if (target == NULL) {
+    return ThrowException(Exception::Error(String::New("Target must be a vector that is not being iterated.")));
+  }
+
+  double min = args[0]->NumberValue();
+  double max = args[1]->NumberValue();
+  size_t length = obj->storage.size();
+  Resize(target, length);
+  PROFILE_VISITS(length);
+  for (size_t i = 0; i < length; i++) {
+    double value = obj->storage[i].NumberValue();
+    value = value < min ? min : (value > max ? max : value);
+    target->storage[i].Dispose();
+    target->storage[i] = Element::NewNumber(value);
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> Vector::Cumsum(const Arguments& args) {
+  PROFILE_METHOD(cumsum, args);
+  if (args.Length() > 1) {
+    return ThrowException(Exception::Error(String::New("cumsum(target) takes an optional vector argument.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (!IsNumeric(obj->storage)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+  Handle<Object> result;
+  Vector* target = GetTarget(args[0], result);
+  if (target == NULL) {
+    return ThrowException(Exception::Error(String::New("Target must be a vector that is not being iterated.")));
+  }
+
+  size_t length = obj->storage.size();
+  Resize(target, length);
+  PROFILE_VISITS(length);
+  double sum = 0;
+  for (size_t i = 0; i < length; i++) {
+    sum += obj->storage[i].NumberValue();
+    target->storage[i].Dispose();
+    target->storage[i] = Element::NewNumber(sum);
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> Vector::Diff(const Arguments& args) {
+  PROFILE_METHOD(diff, args);
+  if (args.Length() > 1) {
+    return ThrowException(Exception::Error(String::New("diff(target) takes an optional vector argument.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (!IsNumeric(obj->storage)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+  Handle<Object> result;
+  Vector* target = GetTarget(args[0], result);
+  if (target == NULL) {
+    return ThrowException(Exception::Error(String::New("Target must be a vector that is not being iterated.")));
+  }
+
+  // The target keeps the last element until the end, since it may be this vector.
+  size_t length = obj->storage.size();
+  Resize(target, length);
+  PROFILE_VISITS(length);
+  for (size_t i = 0; i + 1 < length; i++) {
+    double value = obj->storage[i + 1].NumberValue() - obj->storage[i].NumberValue();
+    target->storage[i].Dispose();
+    target->storage[i] = Element::NewNumber(value);
+  }
+  Resize(target, length > 0 ? length - 1 : 0);
+  return scope.Close(result);
+}
+
+Handle<Value> Vector::Div(const Arguments& args) {
+  PROFILE_METHOD(div, args);
+  return Combine<DivOperation>(args, "div(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Eq(const Arguments& args) {
+  PROFILE_METHOD(eq, args);
+  return Combine<EqOperation>(args, "eq(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Fill(const Arguments& args) {
+  PROFILE_METHOD(fill, args);
+  CHECK_ITERATING(fill, args);
+  CHECK_WRITABLE(fill, args);
+  if (args.Length() < 1 || args.Length() > 3 || (args.Length() >= 2 && !args[1]->IsUint32()) ||
+      (args.Length() == 3 && !args[2]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("fill(value, start, end) takes a value and optional integers.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  size_t start = args.Length() >= 2 ? args[1]->Uint32Value() : 0;
+  size_t end = args.Length() == 3 ? args[2]->Uint32Value() : obj->storage.size();
+  if (end > obj->storage.size()) {
+    end = obj->storage.size();
+  }
+  if (start >= end) {
+    return args.This();
+  }
+  Element element = Element::New(args[0], &obj->backing);
+  PROFILE_VISITS(end - start);
+  for (size_t i = start; i < end; i++) {
+    obj->storage[i].Dispose();
+    obj->storage[i] = i == start ? element : element.Copy(&obj->backing);
+  }
+  return args.This();
+}
+
+Handle<Value> Vector::Ge(const Arguments& args) {
+  PROFILE_METHOD(ge, args);
+  return Combine<GeOperation>(args, "ge(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Gt(const Arguments& args) {
+  PROFILE_METHOD(gt, args);
+  return Combine<GtOperation>(args, "gt(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Histogram(const Arguments& args) {
+  PROFILE_METHOD(histogram, args);
+  bool argError = args.Length() != 1;
+  vector<double> bounds;
+  if (!argError && args[0]->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(args[0]);
+    bounds.resize(array->Length());
+    for (uint32_t i = 0; i < array->Length() && !argError; i++) {
+      Local<Value> bound = array->Get(i);
+      bounds[i] = bound->NumberValue();
+      argError = !bound->IsNumber() || (i > 0 && !(bounds[i - 1] < bounds[i]));
+    }
+  } else if (!argError) {
+    argError = !args[0]->IsUint32() || args[0]->Uint32Value() == 0 || args[0]->Uint32Value() > MAX_HISTOGRAM_BUCKETS;
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("histogram(bounds) takes an array of ascending numbers or a number of buckets from 1 to 1048576.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  vector<double> numbers;
+  if (!GetNumbers(obj->storage, numbers)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+
+  // With bounds, bucket i counts the numbers from bound i - 1 up to, but excluding, bound i.
+  size_t count = args[0]->IsArray() ? bounds.size() + 1 : args[0]->Uint32Value();
+  vector<double> counts(count, 0);
+  PROFILE_VISITS(numbers.size());
+  if (args[0]->IsArray()) {
+    for (size_t i = 0; i < numbers.size(); i++) {
+      counts[upper_bound(bounds.begin(), bounds.end(), numbers[i]) - bounds.begin()]++;
+    }
+  } else if (!numbers.empty()) {
+    // The range from the least to the greatest number is split into buckets of equal width; the greatest number is
+    // counted in the last bucket.
+    double min = *min_element(numbers.begin(), numbers.end());
+    double range = *max_element(numbers.begin(), numbers.end()) - min;
+    for (size_t i = 0; i < numbers.size(); i++) {
+      double position = range > 0 ? (numbers[i] - min) / range * count : 0;
+      counts[position > 0 ? (position < count ? (size_t) position : count - 1) : 0]++;
+    }
+  }
 
+  Handle<Array> array = Array::New(count);
+  for (size_t i = 0; i < count; i++) {
+    array->Set(i, Number::New(counts[i]));
+  }
+  return scope.Close(array);
+}
+
+Handle<Value> Vector::InsertAll(const Arguments& args) {
+  PROFILE_METHOD(insertAll, args);
+  CHECK_ITERATING(insertAll, args);
+  CHECK_WRITABLE(insertAll, args);
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (args.Length() != 2 || !(args[0]->IsUint32()) || (!(args[1]->IsArray()) && !obj->IsSupportedObject(args[1]))) {
+    return ThrowException(Exception::Error(String::New("insertAll(index, object) takes an integer index and one array or object argument.")));
+  }
+  if (args[0]->Uint32Value() > obj->storage.size()) {
+    return ThrowException(Exception::Error(String::New("Index is greater than size of this vector.")));
+  }
+
+  // The values are gathered first, so that the tail of the vector is shifted once.
+  HandleScope scope;
+  Storage values;
+  if (args[1]->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(args[1]);
+    values.reserve(array->Length());
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      values.push_back(Element::New(array->Get(i), &obj->backing));
+    }
+  } else if (::Set::constructor->HasInstance(args[1])) {
+    ::Set* set = ObjectWrap::Unwrap< ::Set>(Handle<Object>::Cast(args[1]));
+    values.reserve(set->storage.size());
+    ::Set::Storage::iterator it = set->storage.begin();
+    while (it != set->storage.end()) {
+      values.push_back((it++)->Copy(&obj->backing));
+    }
+  } else {
+    Vector* vector = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(args[1]));
+    values.reserve(vector->storage.size());
+    Storage::iterator it = vector->storage.begin();
+    while (it != vector->storage.end()) {
+      values.push_back((it++)->Copy(&obj->backing));
+    }
+  }
+  obj->storage.insert(obj->storage.begin() + args[0]->Uint32Value(), values.begin(), values.end());
+  return args.This();
+}
+
+Handle<Value> Vector::InsertAt(const Arguments& args) {
+  PROFILE_METHOD(insertAt, args);
+  CHECK_ITERATING(insertAt, args);
+  CHECK_WRITABLE(insertAt, args);
+  if (args.Length() < 2 || !(args[0]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("insertAt(index, value, ...) takes an integer index and at least one value.")));
+  }
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (args[0]->Uint32Value() > obj->storage.size()) {
+    return ThrowException(Exception::Error(String::New("Index is greater than size of this vector.")));
+  }
+
+  HandleScope scope;
+  Storage values;
+  values.reserve(args.Length() - 1);
+  for (int i = 1; i < args.Length(); i++) {
+    values.push_back(Element::New(args[i], &obj->backing));
+  }
+  obj->storage.insert(obj->storage.begin() + args[0]->Uint32Value(), values.begin(), values.end());
   return args.This();
 }
 
+Handle<Value> Vector::Le(const Arguments& args) {
+  PROFILE_METHOD(le, args);
+  return Combine<LeOperation>(args, "le(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Lt(const Arguments& args) {
+  PROFILE_METHOD(lt, args);
+  return Combine<LtOperation>(args, "lt(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Minus(const Arguments& args) {
+  PROFILE_METHOD(minus, args);
+  return Combine<MinusOperation>(args, "minus(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Ne(const Arguments& args) {
+  PROFILE_METHOD(ne, args);
+  return Combine<NeOperation>(args, "ne(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::Plus(const Arguments& args) {
+  PROFILE_METHOD(plus, args);
+  return Combine<PlusOperation>(args, "plus(operand, target) takes a number or numbers and an optional vector.");
+}
+
+/*
+ * The quantiles are the numbers of rank floor(q * size) in sorted order. They are selected from the ranks in
+ * ascending order, each within the numbers after the rank before it, so that the numbers are never fully sorted.
+ */
+Handle<Value> Vector::Quantile(const Arguments& args) {
+  PROFILE_METHOD(quantile, args);
+  if (args.Length() == 0) {
+    return ThrowException(Exception::Error(String::New("quantile(q, ...) takes at least one argument.")));
+  }
+  for (int i = 0; i < args.Length(); i++) {
+    if (!(args[i]->IsNumber()) || !(args[i]->NumberValue() >= 0 && args[i]->NumberValue() <= 1)) {
+      return ThrowException(Exception::Error(String::New("quantile(q, ...) takes only numbers between 0 and 1.")));
+    }
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  vector<double> numbers;
+  if (!GetNumbers(obj->storage, numbers)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+  if (numbers.empty()) {
+    return Undefined();
+  }
+
+  size_t size = numbers.size();
+  vector< pair<size_t, int> > ranks(args.Length());
+  for (int i = 0; i < args.Length(); i++) {
+    ranks[i] = pair<size_t, int>(min(size - 1, (size_t) (args[i]->NumberValue() * size)), i);
+  }
+  sort(ranks.begin(), ranks.end());
+  PROFILE_VISITS(size);
+  vector<double>::iterator first = numbers.begin();
+  for (size_t i = 0; i < ranks.size(); i++) {
+    vector<double>::iterator nth = numbers.begin() + ranks[i].first;
+    if (nth >= first) {
+      nth_element(first, nth, numbers.end());
+      first = nth + 1;
+    }
+  }
+
+  if (args.Length() == 1) {
+    return scope.Close(Number::New(numbers[ranks[0].first]));
+  } else {
+    Handle<Array> array = Array::New(args.Length());
+    for (size_t i = 0; i < ranks.size(); i++) {
+      array->Set(ranks[i].second, Number::New(numbers[ranks[i].first]));
+    }
+    return scope.Close(array);
+  }
+}
+
 Handle<Value> Vector::Remove(const Arguments& args) {
+  PROFILE_METHOD(remove, args);
   CHECK_ITERATING(remove, args);
+  CHECK_WRITABLE(remove, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("remove(value, ...) takes at least one argument.")));
   }
@@ -72,10 +636,12 @@ Handle<Value> Vector::Remove(const Arguments& args) {
   IndexedCollection<Storage>* obj = ObjectWrap::Unwrap< IndexedCollection<Storage> >(args.This());
   ValueComparator comparator;
   for (int i = 0; i < args.Length(); i++) {
-    Handle<Value> arg = args[i];
+    ElementProbe probe(args[i]);
     Storage::iterator it = obj->storage.begin();
+    PROFILE_LOOKUP();
     while (it != obj->storage.end()) {
-      if (!comparator(*it, arg) && !comparator(arg, *it)) {
+      PROFILE_VISITS(1);
+      if (!comparator(*it, probe) && !comparator(probe, *it)) {
         it->Dispose();
         it = obj->storage.erase(it);
         break;
@@ -87,8 +653,24 @@ Handle<Value> Vector::Remove(const Arguments& args) {
   return args.This();
 }
 
+Handle<Value> Vector::Reserve(const Arguments& args) {
+  PROFILE_METHOD(reserve, args);
+  CHECK_ITERATING(reserve, args);
+  if (args.Length() != 1 || !(args[0]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("reserve(capacity) takes an integer argument.")));
+  }
+
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (!ReserveCapacity(obj->storage, args[0]->Uint32Value())) {
+    return ThrowException(Exception::Error(String::New("Capacity is too large.")));
+  }
+  return args.This();
+}
+
 Handle<Value> Vector::Reverse(const Arguments& args) {
+  PROFILE_METHOD(reverse, args);
   CHECK_ITERATING(reverse, args);
+  CHECK_WRITABLE(reverse, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(reverse, args);
 
   HandleScope scope;
@@ -106,7 +688,9 @@ Handle<Value> Vector::Reverse(const Arguments& args) {
 }
 
 Handle<Value> Vector::Set(const Arguments& args) {
+  PROFILE_METHOD(set, args);
   CHECK_ITERATING(set, args);
+  CHECK_WRITABLE(set, args);
   if (args.Length() != 2 || !(args[0]->IsUint32())) {
     return ThrowException(Exception::Error(String::New("set(index, value) takes an integer index and a value.")));
   }
@@ -121,15 +705,146 @@ Handle<Value> Vector::Set(const Arguments& args) {
     if (index < obj->storage.size()) {
       Storage::iterator it = obj->storage.begin() + index;
       it->Dispose();
-      *it = Persistent<Value>::New(args[1]);
+      *it = Element::New(args[1], &obj->backing);
     } else {
-      obj->storage.push_back(Persistent<Value>::New(args[1]));
+      obj->storage.push_back(Element::New(args[1], &obj->backing));
     }
   }
   return args.This();
 }
 
+Handle<Value> Vector::ShrinkToFit(const Arguments& args) {
+  PROFILE_METHOD(shrinkToFit, args);
+  CHECK_ITERATING(shrinkToFit, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(shrinkToFit, args);
+
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  obj->storage.ShrinkToFit();
+  return args.This();
+}
+
+Handle<Value> Vector::Splice(const Arguments& args) {
+  PROFILE_METHOD(splice, args);
+  CHECK_ITERATING(splice, args);
+  CHECK_WRITABLE(splice, args);
+  if (args.Length() == 0 || !(args[0]->IsUint32()) ||
+      (args.Length() > 1 && !(args[1]->IsUndefined()) && !(args[1]->IsUint32()))) {
+    return ThrowException(Exception::Error(String::New("splice(start, count, value, ...) takes an integer start, an optional integer count and values to insert.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  size_t size = obj->storage.size();
+  size_t start = args[0]->Uint32Value();
+  if (start > size) {
+    start = size;
+  }
+  size_t count = size - start;
+  if (args.Length() > 1 && args[1]->IsUint32() && args[1]->Uint32Value() < count) {
+    count = args[1]->Uint32Value();
+  }
+
+  Local<Object> result = constructor->GetFunction()->NewInstance();
+  Vector* removed = ObjectWrap::Unwrap<Vector>(result);
+  removed->storage.reserve(count);
+  Storage::iterator it = obj->storage.begin() + start;
+  for (size_t i = 0; i < count; i++, it++) {
+    removed->storage.push_back(it->Move(&removed->backing));
+    if (!it->IsPrimitive()) {
+      it->Dispose();
+    }
+  }
+
+  // Removed elements are overwritten by the inserted ones, so the tail is shifted at most once.
+  size_t inserted = args.Length() > 2 ? args.Length() - 2 : 0;
+  size_t overwritten = inserted < count ? inserted : count;
+  it = obj->storage.begin() + start;
+  for (size_t i = 0; i < overwritten; i++) {
+    *it++ = Element::New(args[(int) (i + 2)], &obj->backing);
+  }
+  if (inserted < count) {
+    obj->storage.erase(it, it + (count - inserted));
+  } else if (inserted > count) {
+    Storage values;
+    values.reserve(inserted - count);
+    for (size_t i = count; i < inserted; i++) {
+      values.push_back(Element::New(args[(int) (i + 2)], &obj->backing));
+    }
+    obj->storage.insert(it, values.begin(), values.end());
+  }
+  return scope.Close(result);
+}
+
+Handle<Value> Vector::Swap(const Arguments& args) {
+  PROFILE_METHOD(swap, args);
+  CHECK_ITERATING(swap, args);
+  CHECK_WRITABLE(swap, args);
+  if (args.Length() != 2 || !(args[0]->IsUint32()) || !(args[1]->IsUint32())) {
+    return ThrowException(Exception::Error(String::New("swap(index1, index2) takes two integer arguments.")));
+  }
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  uint32_t index1 = args[0]->Uint32Value();
+  uint32_t index2 = args[1]->Uint32Value();
+  if (index1 >= obj->storage.size() || index2 >= obj->storage.size()) {
+    return ThrowException(Exception::Error(String::New("Index is not less than size of this vector.")));
+  }
+
+  swap(obj->storage[index1], obj->storage[index2]);
+  return args.This();
+}
+
+Handle<Value> Vector::Times(const Arguments& args) {
+  PROFILE_METHOD(times, args);
+  return Combine<TimesOperation>(args, "times(operand, target) takes a number or numbers and an optional vector.");
+}
+
+Handle<Value> Vector::TopK(const Arguments& args) {
+  PROFILE_METHOD(topK, args);
+  bool argError = args.Length() < 1 || args.Length() > 2 || !args[0]->IsUint32();
+  bool descending = true;
+  if (!argError && args.Length() == 2) {
+    if (args[1]->IsObject() && !args[1]->IsArray()) {
+      Handle<Value> desc = Handle<Object>::Cast(args[1])->Get(String::NewSymbol("desc"));
+      if (desc->IsBoolean()) {
+        descending = desc->BooleanValue();
+      } else {
+        argError = !desc->IsUndefined();
+      }
+    } else {
+      argError = true;
+    }
+  }
+  if (argError) {
+    return ThrowException(Exception::Error(String::New("topK(k, options) takes an integer and optionally {desc: boolean}.")));
+  }
+
+  HandleScope scope;
+  Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  if (!IsNumeric(obj->storage)) {
+    return ThrowException(Exception::Error(String::New("Elements of the vectors must be numbers.")));
+  }
+
+  size_t k = min((size_t) args[0]->Uint32Value(), obj->storage.size());
+  vector<double> heap;
+  heap.reserve(k);
+  PROFILE_VISITS(obj->storage.size());
+  if (descending) {
+    TopNumbers(obj->storage, k, greater<double>(), heap);
+  } else {
+    TopNumbers(obj->storage, k, less<double>(), heap);
+  }
+
+  Handle<Object> result = constructor->GetFunction()->NewInstance();
+  Vector* top = ObjectWrap::Unwrap<Vector>(result);
+  top->storage.Grow(heap.size());
+  for (size_t i = 0; i < heap.size(); i++) {
+    top->storage.push_back(Element::NewNumber(heap[i]));
+  }
+  return scope.Close(result);
+}
+
 Handle<Value> Vector::Each(const Arguments& args) {
+  PROFILE_METHOD(each, args);
   return ObjectWrap::Unwrap<Vector>(args.This())->Iterate(_Each, args);
 }
 
@@ -144,24 +859,26 @@ Handle<Value> Vector::_Each(const Arguments& args) {
   TryCatch tryCatch;
   Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
   Local<Object> modifierValue = VectorModifier::constructor->GetFunction()->NewInstance(0, NULL);
+  ObjectWrap::Unwrap<VectorModifier>(modifierValue)->backing = &obj->backing;
   Storage::iterator it = obj->storage.begin();
   size_t i = 0;
   bool isFirst = true;
   while (it != obj->storage.end()) {
-    Persistent<Value> value = *it;
     VectorModifier* modifier = ObjectWrap::Unwrap<VectorModifier>(modifierValue);
     modifier->isFirst = isFirst;
     modifier->isLast = it + 1 == obj->storage.end();
     modifier->index = i;
     isFirst = false;
     Handle<Value> parameters[2];
-    parameters[0] = value;
+    parameters[0] = it->ToValue();
     parameters[1] = modifierValue;
     Handle<Value> result = function->Call(global, 2, parameters);
     if (result.IsEmpty()) {
       modifier->clear(true);
+      modifier->backing = NULL;
       return ThrowException(tryCatch.Exception());
     }
+    obj->version++;
     if (!modifier->replace.IsEmpty()) {
       it->Dispose();
       *it = modifier->replace;
@@ -188,10 +905,12 @@ Handle<Value> Vector::_Each(const Arguments& args) {
       break;
     }
   }
+  ObjectWrap::Unwrap<VectorModifier>(modifierValue)->backing = NULL;
   return args.This();
 }
 
 Handle<Value> Vector::Map(const Arguments& args) {
+  PROFILE_METHOD(map, args);
   return ObjectWrap::Unwrap<Vector>(args.This())->Iterate(_Map, args);
 }
 
@@ -205,21 +924,59 @@ Handle<Value> Vector::_Map(const Arguments& args) {
   Local<Function> function = Local<Function>::Cast(args[0]);
   TryCatch tryCatch;
   Vector* obj = ObjectWrap::Unwrap<Vector>(args.This());
+  obj->version++;
   Storage::iterator it = obj->storage.begin();
   while (it != obj->storage.end()) {
-    Persistent<Value> parameters[1];
-    parameters[0] = *it;
+    Handle<Value> parameters[1];
+    parameters[0] = it->ToValue();
     Handle<Value> result = function->Call(global, 1, parameters);
     if (result.IsEmpty()) {
       return ThrowException(tryCatch.Exception());
     }
     it->Dispose();
-    *it++ = Persistent<Value>::New(result);
+    *it++ = Element::New(result, &obj->backing);
   }
   return args.This();
 }
 
 
+/*
+ * class NumericOperand
+ */
+
+bool NumericOperand::Set(Handle<Value> value, size_t length) {
+  size_t doublesLength;
+  if (value->IsNumber()) {
+    scalar = value->NumberValue();
+  } else if (Vector::constructor->HasInstance(value)) {
+    Vector* vector = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(value));
+    if (vector->storage.size() != length || !Vector::IsNumeric(vector->storage)) {
+      return false;
+    }
+    elements = &vector->storage;
+  } else if ((doubles = CollectionUtil::GetDoubles(value, doublesLength)) != NULL) {
+    return doublesLength == length;
+  } else if (value->IsArray()) {
+    Handle<Array> array = Handle<Array>::Cast(value);
+    if (array->Length() != length) {
+      return false;
+    }
+    copied.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> number = array->Get(i);
+      if (!number->IsNumber()) {
+        return false;
+      }
+      copied[i] = number->NumberValue();
+    }
+    doubles = length > 0 ? &copied[0] : NULL;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+
 /*
  * class VectorModifier
  */
@@ -249,18 +1006,18 @@ void VectorModifier::clear(bool dispose) {
     }
   }
 
-  replace = Persistent<Value>();
+  replace = Element();
   removed = false;
   insertedBefore.clear();
   insertedAfter.clear();
 }
 
-VectorModifier::VectorModifier() {
+VectorModifier::VectorModifier() : backing(NULL) {
   clear(false);
 }
 
 VectorModifier::~VectorModifier() {
-  // Do not dispose the persistent handles, because they are being used by the vector.
+  // Do not dispose the elements, because they are being used by the vector.
 }
 
 Handle<Value> VectorModifier::New(const Arguments& args) {
@@ -314,7 +1071,11 @@ Handle<Value> VectorModifier::Set(const Arguments& args) {
 
   HandleScope scope;
   VectorModifier* obj = ObjectWrap::Unwrap<VectorModifier>(args.This());
-  obj->replace = Persistent<Value>::New(args[0]);
+  if (obj->backing == NULL) {
+    return ThrowException(Exception::Error(String::New("set(value) can only be called during each().")));
+  }
+  obj->replace.Dispose();
+  obj->replace = Element::New(args[0], obj->backing);
   obj->removed = false;
   return args.This();
 }
@@ -327,7 +1088,7 @@ Handle<Value> VectorModifier::Remove(const Arguments& args) {
   obj->removed = true;
   if (!obj->replace.IsEmpty()) {
     obj->replace.Dispose();
-    obj->replace = Persistent<Value>();
+    obj->replace = Element();
   }
   return args.This();
 }
@@ -339,8 +1100,11 @@ Handle<Value> VectorModifier::InsertBefore(const Arguments& args) {
 
   HandleScope scope;
   VectorModifier* obj = ObjectWrap::Unwrap<VectorModifier>(args.This());
+  if (obj->backing == NULL) {
+    return ThrowException(Exception::Error(String::New("insertBefore(value, ...) can only be called during each().")));
+  }
   for (int i = 0; i < args.Length(); i++) {
-    obj->insertedBefore.push_back(Persistent<Value>::New(args[i]));
+    obj->insertedBefore.push_back(Element::New(args[i], obj->backing));
   }
   return args.This();
 }
@@ -352,11 +1116,14 @@ Handle<Value> VectorModifier::InsertAfter(const Arguments& args) {
 
   HandleScope scope;
   VectorModifier* obj = ObjectWrap::Unwrap<VectorModifier>(args.This());
+  if (obj->backing == NULL) {
+    return ThrowException(Exception::Error(String::New("insertAfter(value, ...) can only be called during each().")));
+  }
   for (int i = 0; i < args.Length(); i++) {
-    obj->insertedAfter.push_back(Persistent<Value>::New(args[i]));
+    obj->insertedAfter.push_back(Element::New(args[i], obj->backing));
   }
   return args.This();
 }
 
 
-template class InternalVector<Persistent<Value>, ValueComparator>;
\ No newline at end of file
+template class InternalVector<Element, ValueComparator>;
\ No newline at end of file
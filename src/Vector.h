@@ -9,19 +9,64 @@ using namespace node;
 using namespace std;
 using namespace v8;
 
+class NumericOperand;
 class VectorModifier;
 
 
 /*
  * class InternalVector
+ *
+ * A vector whose capacity grows by a configurable factor, instead of by whatever the standard library chooses.
  */
 
 template < class T, class Comparator, class Alloc = allocator<T> > class InternalVector : public vector<T, Alloc> {
   public:
+    typedef typename vector<T, Alloc>::iterator iterator;
+
+    InternalVector() : growthFactor(2) {
+    }
+
+    /*
+     * Make room for `count` more elements. If the capacity has to grow, it is multiplied by at least the growth
+     * factor, so that elements are appended in amortized constant time however few are added at once.
+     */
+    inline void Grow(size_t count) {
+      size_t size = vector<T, Alloc>::size() + count;
+      if (size > vector<T, Alloc>::capacity()) {
+        size_t capacity = (size_t) (vector<T, Alloc>::capacity() * growthFactor);
+        vector<T, Alloc>::reserve(size > capacity ? size : capacity);
+      }
+    }
+
+    inline void push_back(const T& value) {
+      Grow(1);
+      vector<T, Alloc>::push_back(value);
+    }
+
+    inline iterator insert(iterator position, const T& value) {
+      size_t index = position - vector<T, Alloc>::begin();
+      Grow(1);
+      return vector<T, Alloc>::insert(vector<T, Alloc>::begin() + index, value);
+    }
+
+    template <class InputIterator> inline void insert(iterator position, InputIterator first, InputIterator last) {
+      size_t index = position - vector<T, Alloc>::begin();
+      Grow(distance(first, last));
+      vector<T, Alloc>::insert(vector<T, Alloc>::begin() + index, first, last);
+    }
+
+    /*
+     * Release the capacity that is not used.
+     */
+    inline void ShrinkToFit() {
+      vector<T, Alloc>(*this).swap(*this);
+    }
+
     inline typename vector<T, Alloc>::const_iterator find(const T& value) const {
       Comparator comparator;
       typename vector<T>::const_iterator it = vector<T, Alloc>::begin();
       while (it != vector<T>::end()) {
+        PROFILE_VISITS(1);
         if (!comparator(*it, value) && !comparator(value, *it)) {
           break;
         }
@@ -29,15 +74,19 @@ template < class T, class Comparator, class Alloc = allocator<T> > class Interna
       }
       return it;
     }
+
+    double growthFactor;
 };
 
 /*
  * class Vector
  */
 
-class Vector : public IndexedCollection< InternalVector<Persistent<Value>, ValueComparator> > {
+class Vector : public IndexedCollection< InternalVector<Element, ValueComparator> > {
   public:
-    typedef InternalVector<Persistent<Value>, ValueComparator> Storage;
+    typedef InternalVector<Element, ValueComparator> Storage;
+
+    static const uint32_t MAX_HISTOGRAM_BUCKETS = 1 << 20;
 
     virtual Handle<Value> GetValue(const Storage::value_type& value) const;
 
@@ -47,11 +96,107 @@ class Vector : public IndexedCollection< InternalVector<Persistent<Value>, Value
     virtual void InitializeFields(Handle<Object> thisObject);
 
   private:
+    static bool ReserveCapacity(Storage& storage, size_t capacity);
+
+    static bool IsNumeric(const Storage& storage);
+    static bool GetNumbers(const Storage& storage, vector<double>& numbers);
+    template <class Comparator> static void TopNumbers(const Storage& storage, size_t k, Comparator comparator,
+        vector<double>& heap);
+    static Vector* GetTarget(Handle<Value> value, Handle<Object>& result);
+    static void Resize(Vector* target, size_t length);
+    template <class Operation> static Handle<Value> Combine(const Arguments& args, const char* usage);
+
+    // Elementwise operations of Combine().
+    struct PlusOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewNumber(x + y);
+      }
+    };
+
+    struct MinusOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewNumber(x - y);
+      }
+    };
+
+    struct TimesOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewNumber(x * y);
+      }
+    };
+
+    struct DivOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewNumber(x / y);
+      }
+    };
+
+    struct LtOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewBoolean(x < y);
+      }
+    };
+
+    struct LeOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewBoolean(x <= y);
+      }
+    };
+
+    struct GtOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewBoolean(x > y);
+      }
+    };
+
+    struct GeOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewBoolean(x >= y);
+      }
+    };
+
+    struct EqOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewBoolean(x == y);
+      }
+    };
+
+    struct NeOperation {
+      static inline Element Apply(double x, double y) {
+        return Element::NewBoolean(x != y);
+      }
+    };
+
     static Handle<Value> New(const Arguments& args);
 
+    static Handle<Value> Abs(const Arguments& args);
+    static Handle<Value> Capacity(const Arguments& args);
+    static Handle<Value> Clamp(const Arguments& args);
+    static Handle<Value> Cumsum(const Arguments& args);
+    static Handle<Value> Diff(const Arguments& args);
+    static Handle<Value> Div(const Arguments& args);
+    static Handle<Value> Eq(const Arguments& args);
+    static Handle<Value> Fill(const Arguments& args);
+    static Handle<Value> Ge(const Arguments& args);
+    static Handle<Value> Gt(const Arguments& args);
+    static Handle<Value> Histogram(const Arguments& args);
+    static Handle<Value> InsertAll(const Arguments& args);
+    static Handle<Value> InsertAt(const Arguments& args);
+    static Handle<Value> Le(const Arguments& args);
+    static Handle<Value> Lt(const Arguments& args);
+    static Handle<Value> Minus(const Arguments& args);
+    static Handle<Value> Ne(const Arguments& args);
+    static Handle<Value> Plus(const Arguments& args);
+    static Handle<Value> Quantile(const Arguments& args);
     static Handle<Value> Remove(const Arguments& args);
+    static Handle<Value> Reserve(const Arguments& args);
     static Handle<Value> Reverse(const Arguments& args);
     static Handle<Value> Set(const Arguments& args);
+    static Handle<Value> ShrinkToFit(const Arguments& args);
+    static Handle<Value> Splice(const Arguments& args);
+    static Handle<Value> Swap(const Arguments& args);
+    static Handle<Value> Times(const Arguments& args);
+    static Handle<Value> TopK(const Arguments& args);
 
     static Handle<Value> Each(const Arguments& args);
     static Handle<Value> _Each(const Arguments& args);
@@ -59,10 +204,46 @@ class Vector : public IndexedCollection< InternalVector<Persistent<Value>, Value
     static Handle<Value> _Map(const Arguments& args);
 
     friend class ValueComparator;
+    friend class NumericOperand;
     friend class VectorModifier;
 };
 
 
+/*
+ * class NumericOperand
+ *
+ * The right-hand operand of an elementwise operation on a vector of numbers: a number, which applies to every element,
+ * or a vector, array or Float64Array of numbers as long as the vector.
+ */
+
+class NumericOperand {
+  public:
+    NumericOperand() : scalar(0), elements(NULL), doubles(NULL) {
+    }
+
+    /*
+     * Returns false if the value is not a suitable operand for a vector of `length` elements.
+     */
+    bool Set(Handle<Value> value, size_t length);
+
+    inline double operator[](size_t i) const {
+      if (elements != NULL) {
+        return (*elements)[i].NumberValue();
+      } else if (doubles != NULL) {
+        return doubles[i];
+      }
+      return scalar;
+    }
+
+  private:
+    double scalar;
+    // The elements are read through the storage, which may be the target of the operation.
+    const Vector::Storage* elements;
+    const double* doubles;
+    vector<double> copied;
+};
+
+
 /*
  * class VectorModifier
  */
@@ -94,7 +275,8 @@ class VectorModifier : public ObjectWrap {
     bool isFirst;
     bool isLast;
     size_t index;
-    Persistent<Value> replace;
+    BackingStore* backing;
+    Element replace;
     bool removed;
     Vector::Storage insertedBefore;
     Vector::Storage insertedAfter;
@@ -1,7 +1,19 @@
+#include <algorithm>
 #include <cstring>
 #include "common.h"
+#include "Deque.h"
+#include "ExpiringMap.h"
+#include "IntSet.h"
+#include "JsonWriter.h"
+#include "LruMap.h"
 #include "Map.h"
+#include "MultiMap.h"
+#include "MultiSet.h"
+#include "PriorityQueue.h"
 #include "Set.h"
+#include "SortedVector.h"
+#include "StringMap.h"
+#include "StringSet.h"
 #include "Vector.h"
 
 using namespace node;
@@ -14,6 +26,8 @@ using namespace v8;
  */
 
 bool ValueComparator::operator()(const Handle<Value>& value1, const Handle<Value>& value2) const {
+  PROFILE_COMPARISON();
+
   if (GetTypeScore(value1) < GetTypeScore(value2)) {
     return true;
   } else if (GetTypeScore(value1) > GetTypeScore(value2)) {
@@ -113,11 +127,50 @@ bool ValueComparator::operator()(const Handle<Value>& value1, const Handle<Value
   return false;
 }
 
-bool ValueComparator::operator()(const pair< Handle<Value>, Handle<Value> >& pair1, const pair< Handle<Value>, Handle<Value> >& pair2) const {
+bool ValueComparator::operator()(const Element& element1, const Element& element2) const {
+  if (element1.type != element2.type) {
+    PROFILE_COMPARISON();
+    return element1.type < element2.type;
+  }
+
+  if (!element1.IsPrimitive()) {
+    HandleScope scope;
+    return (*this)(element1.ToValue(), element2.ToValue());
+  }
+
+  PROFILE_COMPARISON();
+  switch (element1.type) {
+    case 4:
+      return element1.data.boolean < element2.data.boolean;
+    case 5:
+    case 6:
+    case 8:
+    case 9:
+      return element1.data.number < element2.data.number;
+    case 11:
+      return element1.data.string->Compare(element2.data.string) < 0;
+    default:
+      return false;
+  }
+}
+
+bool ValueComparator::operator()(const pair<Element, Element>& pair1, const pair<Element, Element>& pair2) const {
   return (*this)(pair1.first, pair2.first) || (!(*this)(pair2.first, pair1.first) && (*this)(pair1.second, pair2.second));
 }
 
-int ValueComparator::GetTypeScore(const Handle<Value>& value) const {
+/*
+ * Compare the UTF-8 bytes of string keys, in the same order as strings held by elements.
+ */
+bool ValueComparator::operator()(const string& key1, const string& key2) const {
+  PROFILE_COMPARISON();
+  return key1 < key2;
+}
+
+bool ValueComparator::operator()(const KeyValue<Element>& entry1, const KeyValue<Element>& entry2) const {
+  return (*this)(entry1.first, entry2.first) || (entry1.first == entry2.first && (*this)(entry1.second, entry2.second));
+}
+
+int ValueComparator::GetTypeScore(const Handle<Value>& value) {
   if (value.IsEmpty()) {
     return 0;
   } else if (value->IsUndefined()) {
@@ -154,6 +207,187 @@ int ValueComparator::GetTypeScore(const Handle<Value>& value) const {
 }
 
 
+/*
+ * class ValueHasher
+ */
+
+uint32_t ValueHasher::operator()(const Handle<Value>& value) const {
+  int type = ValueComparator::GetTypeScore(value);
+  uint32_t hash = (uint32_t) (type + 1);
+  switch (type) {
+    case 3:
+      return Combine(hash, value->ToBoolean()->Value() ? 1 : 0);
+    case 4:
+      return Combine(hash, value->BooleanValue() ? 1 : 0);
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+      return Combine(hash, HashNumber(value->NumberValue()));
+    case 9:
+      return Combine(hash, HashNumber(Handle<Date>::Cast(value)->NumberValue()));
+    case 10:
+    case 11: {
+      String::Utf8Value utf8(value);
+      return Combine(hash, Atom::Hash(*utf8, utf8.length()));
+    }
+    case 12: {
+      Handle<Array> array = Handle<Array>::Cast(value);
+      for (uint32_t i = 0; i < array->Length(); i++) {
+        hash = Combine(hash, (*this)(array->Get(i)));
+      }
+      return hash;
+    }
+    case 13:
+      return Combine(hash, ObjectWrap::Unwrap<Set>(Handle<Object>::Cast(value))->Hash());
+    case 14:
+      return Combine(hash, ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(value))->Hash());
+    default:
+      return hash;
+  }
+}
+
+uint32_t ValueHasher::operator()(const Element& element) const {
+  uint32_t hash = (uint32_t) (element.type + 1);
+  switch (element.type) {
+    case 0:
+    case 1:
+    case 2:
+      return hash;
+    case 4:
+      return Combine(hash, element.data.boolean ? 1 : 0);
+    case 5:
+    case 6:
+    case 8:
+    case 9:
+      return Combine(hash, HashNumber(element.data.number));
+    case 11:
+      return Combine(hash, element.data.string->hash);
+    default: {
+      HandleScope scope;
+      return (*this)(element.ToValue());
+    }
+  }
+}
+
+uint32_t ValueHasher::operator()(const pair<Element, Element>& pair) const {
+  return Combine((*this)(pair.first), (*this)(pair.second));
+}
+
+/*
+ * String keys hash like the strings held by elements.
+ */
+uint32_t ValueHasher::operator()(const string& key) const {
+  return Combine(12, Atom::Hash(key.data(), key.size()));
+}
+
+uint32_t ValueHasher::operator()(const KeyValue<Element>& entry) const {
+  return Combine((*this)(entry.first), (*this)(entry.second));
+}
+
+uint64_t ValueHasher::Hash64(const Handle<Value>& value) const {
+  int type = ValueComparator::GetTypeScore(value);
+  uint64_t hash = Mix64((uint64_t) (type + 1));
+  switch (type) {
+    case 3:
+      return Mix64(Combine64(hash, value->ToBoolean()->Value() ? 1 : 0));
+    case 4:
+      return Mix64(Combine64(hash, value->BooleanValue() ? 1 : 0));
+    case 5:
+    case 6:
+    case 7:
+    case 8:
+      return Hash64(value->NumberValue());
+    case 9:
+      return Mix64(Combine64(hash, HashNumber64(value->NumberValue())));
+    case 10:
+    case 11: {
+      // FNV-1a
+      String::Utf8Value utf8(value);
+      uint64_t bytes = 14695981039346656037ULL;
+      for (int i = 0; i < utf8.length(); i++) {
+        bytes ^= (unsigned char) (*utf8)[i];
+        bytes *= 1099511628211ULL;
+      }
+      return Mix64(Combine64(hash, bytes));
+    }
+    case 12: {
+      Handle<Array> array = Handle<Array>::Cast(value);
+      for (uint32_t i = 0; i < array->Length(); i++) {
+        hash = Combine64(hash, Hash64(array->Get(i)));
+      }
+      return Mix64(hash);
+    }
+    case 13: {
+      HandleScope scope;
+      Set* object = ObjectWrap::Unwrap<Set>(Handle<Object>::Cast(value));
+      Set::Storage::const_iterator it = object->storage.begin();
+      while (it != object->storage.end()) {
+        hash = Combine64(hash, Hash64((it++)->ToValue()));
+      }
+      return Mix64(hash);
+    }
+    case 14: {
+      HandleScope scope;
+      Vector* object = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(value));
+      Vector::Storage::const_iterator it = object->storage.begin();
+      while (it != object->storage.end()) {
+        hash = Combine64(hash, Hash64((it++)->ToValue()));
+      }
+      return Mix64(hash);
+    }
+    default:
+      return hash;
+  }
+}
+
+/*
+ * Numbers of all types hash alike, so that numbers can be hashed without being converted into values first.
+ */
+uint64_t ValueHasher::Hash64(double number) const {
+  return Mix64(Combine64(Mix64(9), HashNumber64(number)));
+}
+
+uint32_t ValueHasher::HashNumber(double number) {
+  if (number == 0) {
+    number = 0; // -0 and 0 are equal.
+  }
+  uint64_t bits;
+  memcpy(&bits, &number, sizeof(bits));
+  bits ^= bits >> 33;
+  bits *= 0xff51afd7ed558ccdULL;
+  bits ^= bits >> 33;
+  return (uint32_t) bits;
+}
+
+uint32_t ValueHasher::Combine(uint32_t hash, uint32_t value) {
+  return hash ^ (value + 0x9e3779b9u + (hash << 6) + (hash >> 2));
+}
+
+uint64_t ValueHasher::HashNumber64(double number) {
+  if (number == 0) {
+    number = 0; // -0 and 0 are equal.
+  }
+  uint64_t bits;
+  memcpy(&bits, &number, sizeof(bits));
+  return Mix64(bits);
+}
+
+uint64_t ValueHasher::Mix64(uint64_t bits) {
+  // Finalizer of MurmurHash3
+  bits ^= bits >> 33;
+  bits *= 0xff51afd7ed558ccdULL;
+  bits ^= bits >> 33;
+  bits *= 0xc4ceb9fe1a85ec53ULL;
+  bits ^= bits >> 33;
+  return bits;
+}
+
+uint64_t ValueHasher::Combine64(uint64_t hash, uint64_t value) {
+  return hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
+
 /*
  * class Collection
  */
@@ -166,14 +400,45 @@ template <class Storage> bool Collection<Storage>::IsIterating() const {
   return iterationLevel > 0;
 }
 
-template <class Storage> Collection<Storage>::Collection() : iterationLevel(0) {
+template <class Storage> bool Collection<Storage>::BeginWrite() {
+  if (readOnly) {
+    return false;
+  }
+  CollectionUtil::Unshare(storage);
+  version++;
+  return true;
+}
+
+template <class Storage> uint32_t Collection<Storage>::Hash() {
+  if (hashVersion != version) {
+    ValueHasher hasher;
+    hash = 0;
+    typename Storage::const_iterator it = storage.begin();
+    while (it != storage.end()) {
+      hash = ValueHasher::Combine(hash, hasher(*it++));
+    }
+    // Arrays and collections held by this collection may change without it knowing, so their hash is not kept.
+    hashVersion = backing.IsEmpty() ? version : 0;
+  }
+  return hash;
+}
+
+template <class Storage> Collection<Storage>::Collection() : iterationLevel(0), readOnly(false), version(1), hashVersion(0), hash(0) {
+#ifdef COLLECTION_PROFILE
+  profiler = Profiler::enabledByDefault ? new Profiler() : NULL;
+#endif
 }
 
 template <class Storage> Collection<Storage>::~Collection() {
+  backing.Clear();
+  CollectionUtil::Release(storage);
   typename Storage::const_iterator it = storage.begin();
   while (it != storage.end()) {
     CollectionUtil::Dispose(*it++);
   }
+#ifdef COLLECTION_PROFILE
+  delete profiler;
+#endif
 }
 
 template <class Storage> void Collection<Storage>::InitializeFields(Handle<Object> thisObject) {
@@ -182,6 +447,7 @@ template <class Storage> void Collection<Storage>::InitializeFields(Handle<Objec
   thisObject->Set(String::NewSymbol("get"), FunctionTemplate::New(Get)->GetFunction());
   thisObject->Set(String::NewSymbol("has"), FunctionTemplate::New(Has)->GetFunction());
   thisObject->Set(String::NewSymbol("isEmpty"), FunctionTemplate::New(IsEmpty)->GetFunction());
+  thisObject->Set(String::NewSymbol("profile"), FunctionTemplate::New(Profile)->GetFunction());
   thisObject->Set(String::NewSymbol("removeAt"), FunctionTemplate::New(RemoveAt)->GetFunction());
   thisObject->Set(String::NewSymbol("removeLast"), FunctionTemplate::New(RemoveLast)->GetFunction());
   thisObject->Set(String::NewSymbol("removeRange"), FunctionTemplate::New(RemoveRange)->GetFunction());
@@ -213,6 +479,9 @@ template <class Storage> Handle<Value> Collection<Storage>::New(const Arguments&
 }
 
 template <class Storage> bool Collection<Storage>::operator<(const Collection<Storage>& other) const {
+  if (this == &other) {
+    return false;
+  }
   ValueComparator comparator;
   typename Storage::const_iterator it1 = storage.begin();
   typename Storage::const_iterator it2 = other.storage.begin();
@@ -229,12 +498,20 @@ template <class Storage> bool Collection<Storage>::operator<(const Collection<St
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Clear(const Arguments& args) {
+  PROFILE_METHOD(clear, args);
   CHECK_ITERATING(clear, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(clear, args);
 
-  HandleScope scope;
+  // Storage shared with a clone is let go of, rather than copied only to be disposed.
   Collection<Storage>* obj = ObjectWrap::Unwrap< Collection<Storage> >(args.This());
+  if (!obj->readOnly) {
+    CollectionUtil::Release(obj->storage);
+  }
+  CHECK_WRITABLE(clear, args);
 
+  HandleScope scope;
+
+  obj->backing.Clear();
   typename Storage::iterator it = obj->storage.begin();
   while (it != obj->storage.end()) {
     CollectionUtil::Dispose(*it++);
@@ -245,6 +522,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Clear(const Argument
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Equals(const Arguments& args) {
+  PROFILE_METHOD(equals, args);
   if (args.Length() != 1) {
     return ThrowException(Exception::Error(String::New("equals(value) takes one argument.")));
   }
@@ -252,8 +530,17 @@ template <class Storage> Handle<Value> Collection<Storage>::Equals(const Argumen
   HandleScope scope;
   if (HasInstance(args[0])) {
     Collection<Storage>* obj1 = ObjectWrap::Unwrap< Collection<Storage> >(args.This());
-    typename Storage::iterator it1 = obj1->storage.begin();
     Collection<Storage>* obj2 = ObjectWrap::Unwrap< Collection<Storage> >(Handle<Object>::Cast(args[0]));
+    if (obj1 == obj2) {
+      return scope.Close(Boolean::New(true));
+    }
+    if (obj1->storage.size() != obj2->storage.size()) {
+      return scope.Close(Boolean::New(false));
+    }
+    if (obj1->backing.IsEmpty() && obj2->backing.IsEmpty() && obj1->Hash() != obj2->Hash()) {
+      return scope.Close(Boolean::New(false));
+    }
+    typename Storage::iterator it1 = obj1->storage.begin();
     typename Storage::iterator it2 = obj2->storage.begin();
     ValueComparator comparator;
     while (it1 != obj1->storage.end() && it2 != obj2->storage.end()) {
@@ -274,6 +561,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Equals(const Argumen
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Get(const Arguments& args) {
+  PROFILE_METHOD(get, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("get(index, ...) takes at least one argument.")));
   }
@@ -291,6 +579,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Get(const Arguments&
       uint32_t index = args[0]->Uint32Value();
       if (index < obj->storage.size()) {
         typename Storage::const_iterator it = obj->storage.begin();
+        PROFILE_VISITS(index);
         advance(it, index);
         return scope.Close(Local<Value>::New(obj->GetValue(*it)));
       }
@@ -303,6 +592,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Get(const Arguments&
         uint32_t index = arg->Uint32Value();
         if (index < obj->storage.size()) {
           typename Storage::const_iterator it = obj->storage.begin();
+          PROFILE_VISITS(index);
           advance(it, index);
           array->Set(i, Local<Value>::New(obj->GetValue(*it)));
         }
@@ -314,6 +604,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Get(const Arguments&
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Has(const Arguments& args) {
+  PROFILE_METHOD(has, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("has(value, ...) takes at least one argument.")));
   }
@@ -321,13 +612,16 @@ template <class Storage> Handle<Value> Collection<Storage>::Has(const Arguments&
   HandleScope scope;
   Collection<Storage>* obj = ObjectWrap::Unwrap< Collection<Storage> >(args.This());
   if (args.Length() == 1) {
-    typename Storage::const_iterator it = obj->storage.find((Persistent<Value>) args[0]);
+    PROFILE_LOOKUP();
+    ElementProbe probe(args[0]);
+    typename Storage::const_iterator it = obj->storage.find(probe);
     return scope.Close(Boolean::New(it != obj->storage.end()));
   } else {
     Handle<Array> array = Array::New();
     for (int i = 0; i < args.Length(); i++) {
-      Handle<Value> arg = args[i];
-      typename Storage::const_iterator it = obj->storage.find((Persistent<Value>) arg);
+      PROFILE_LOOKUP();
+      ElementProbe probe(args[i]);
+      typename Storage::const_iterator it = obj->storage.find(probe);
       array->Set(i, Boolean::New(it != obj->storage.end()));
     }
     return scope.Close(array);
@@ -335,6 +629,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Has(const Arguments&
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::IsEmpty(const Arguments& args) {
+  PROFILE_METHOD(isEmpty, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(isEmpty, args);
 
   HandleScope scope;
@@ -342,8 +637,31 @@ template <class Storage> Handle<Value> Collection<Storage>::IsEmpty(const Argume
   return scope.Close(Boolean::New(obj->storage.empty()));
 }
 
+template <class Storage> Handle<Value> Collection<Storage>::Profile(const Arguments& args) {
+  if (args.Length() > 1 || (args.Length() == 1 && !(args[0]->IsBoolean()))) {
+    return ThrowException(Exception::Error(String::New("profile(reset) takes an optional boolean argument.")));
+  }
+
+#ifdef COLLECTION_PROFILE
+  HandleScope scope;
+  Collection<Storage>* obj = ObjectWrap::Unwrap< Collection<Storage> >(args.This());
+  if (obj->profiler == NULL) {
+    obj->profiler = new Profiler();
+  }
+  Handle<Object> result = obj->profiler->ToObject();
+  if (args[0]->IsTrue()) {
+    obj->profiler->Reset();
+  }
+  return scope.Close(result);
+#else
+  return Undefined();
+#endif
+}
+
 template <class Storage> Handle<Value> Collection<Storage>::RemoveAt(const Arguments& args) {
+  PROFILE_METHOD(removeAt, args);
   CHECK_ITERATING(removeAt, args);
+  CHECK_WRITABLE(removeAt, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("removeAt(index, ...) takes at least one argument.")));
   }
@@ -362,6 +680,7 @@ template <class Storage> Handle<Value> Collection<Storage>::RemoveAt(const Argum
       uint32_t index = arg->Uint32Value() - removed;
       if (index < obj->storage.size()) {
         typename Storage::iterator it = obj->storage.begin();
+        PROFILE_VISITS(index);
         advance(it,  index);
         CollectionUtil::Dispose(*it);
         obj->storage.erase(it);
@@ -373,7 +692,9 @@ template <class Storage> Handle<Value> Collection<Storage>::RemoveAt(const Argum
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::RemoveLast(const Arguments& args) {
+  PROFILE_METHOD(removeLast, args);
   CHECK_ITERATING(removeLast, args);
+  CHECK_WRITABLE(removeLast, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(removeLast, args);
 
   HandleScope scope;
@@ -388,7 +709,9 @@ template <class Storage> Handle<Value> Collection<Storage>::RemoveLast(const Arg
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::RemoveRange(const Arguments& args) {
+  PROFILE_METHOD(removeRange, args);
   CHECK_ITERATING(removeRange, args);
+  CHECK_WRITABLE(removeRange, args);
   if (args.Length() != 2) {
     return ThrowException(Exception::Error(String::New("removeRange(start, end) takes two arguments.")));
   }
@@ -408,6 +731,7 @@ template <class Storage> Handle<Value> Collection<Storage>::RemoveRange(const Ar
   }
 
   typename Storage::iterator beginIt = obj->storage.begin();
+  PROFILE_VISITS(end);
   advance(beginIt, start);
   typename Storage::iterator endIt = obj->storage.begin();
   advance(endIt, end);
@@ -421,6 +745,7 @@ template <class Storage> Handle<Value> Collection<Storage>::RemoveRange(const Ar
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Size(const Arguments& args) {
+  PROFILE_METHOD(size, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(size, args);
 
   HandleScope scope;
@@ -429,6 +754,7 @@ template <class Storage> Handle<Value> Collection<Storage>::Size(const Arguments
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::ToArray(const Arguments& args) {
+  PROFILE_METHOD(toArray, args);
   HandleScope scope;
   Collection<Storage>* obj = ObjectWrap::Unwrap< Collection<Storage> >(args.This());
   Local<Array> array = Array::New((uint32_t) obj->storage.size());
@@ -439,14 +765,97 @@ template <class Storage> Handle<Value> Collection<Storage>::ToArray(const Argume
   return scope.Close(array);
 }
 
+template <class Storage> Handle<Value> Collection<Storage>::ToJSON(const Arguments& args) {
+  PROFILE_METHOD(toJSON, args);
+  // JSON.stringify() passes the key of the collection, which is ignored.
+  return ToArray(args);
+}
+
+template <class Storage> Handle<Value> Collection<Storage>::ToJSONBuffer(const Arguments& args) {
+  PROFILE_METHOD(toJSONBuffer, args);
+  CHECK_DOES_NOT_TAKE_ARGUMENT(toJSONBuffer, args);
+
+  HandleScope scope;
+  TryCatch tryCatch;
+  JsonWriter writer;
+  ObjectWrap::Unwrap< Collection<Storage> >(args.This())->WriteJson(writer);
+  if (writer.HasFailed()) {
+    return ThrowException(tryCatch.Exception());
+  }
+  return scope.Close(writer.ToBuffer());
+}
+
 template <class Storage> Handle<Value> Collection<Storage>::ToString(const Arguments& args) {
+  PROFILE_METHOD(toString, args);
   CHECK_DOES_NOT_TAKE_ARGUMENT(toString, args);
 
   HandleScope scope;
-  return scope.Close(CollectionUtil::Stringify(ToArray(args)));
+  TryCatch tryCatch;
+  JsonWriter writer;
+  ObjectWrap::Unwrap< Collection<Storage> >(args.This())->WriteJson(writer);
+  if (writer.HasFailed()) {
+    return ThrowException(tryCatch.Exception());
+  }
+  return scope.Close(writer.ToString());
+}
+
+template <class Storage> Handle<Value> Collection<Storage>::WriteJSON(const Arguments& args) {
+  PROFILE_METHOD(writeJSON, args);
+  if (args.Length() != 1 || !(args[0]->IsFunction())) {
+    return ThrowException(Exception::Error(String::New("writeJSON(function) takes a function argument.")));
+  }
+
+  HandleScope scope;
+  TryCatch tryCatch;
+  JsonWriter writer(Local<Function>::Cast(args[0]));
+  ObjectWrap::Unwrap< Collection<Storage> >(args.This())->WriteJson(writer);
+  writer.Flush();
+  if (writer.HasFailed()) {
+    return ThrowException(tryCatch.Exception());
+  }
+  return scope.Close(Number::New((double) writer.Size()));
+}
+
+template <class Storage> void Collection<Storage>::WriteJson(JsonWriter& writer) {
+  if (!writer.Enter(this)) {
+    return;
+  }
+  // The values must stay as they are while JavaScript code, such as toJSON() of a value, is called.
+  iterationLevel++;
+  writer.Put('[');
+  typename Storage::iterator it = storage.begin();
+  for (bool first = true; it != storage.end() && !writer.HasFailed(); it++, first = false) {
+    if (!first) {
+      writer.Put(',');
+    }
+    PROFILE_VISITS(1);
+    if (!WriteJsonValue(writer, *it)) {
+      writer.WriteRaw("null", 4);
+    }
+    writer.Checkpoint();
+  }
+  writer.Put(']');
+  iterationLevel--;
+  writer.Leave();
+}
+
+template <class Storage> bool Collection<Storage>::WriteJsonValue(JsonWriter& writer, const Element& value) const {
+  return writer.Write(value);
+}
+
+template <class Storage> bool Collection<Storage>::WriteJsonValue(JsonWriter& writer, const string& value) const {
+  writer.WriteString(value.data(), value.size());
+  return true;
+}
+
+template <class Storage> template <class T> bool Collection<Storage>::WriteJsonValue(JsonWriter& writer,
+    const T& value) const {
+  HandleScope scope;
+  return writer.Write(GetValue(value));
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Each(const Arguments& args) {
+  PROFILE_METHOD(each, args);
   return ObjectWrap::Unwrap< Collection<Storage> >(args.This())->Iterate(_Each, args);
 }
 
@@ -463,6 +872,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Each(const Argument
   typename Storage::const_iterator it = obj->storage.begin();
   while (it != obj->storage.end()) {
     Handle<Value> parameters[1];
+    PROFILE_VISITS(1);
     parameters[0] = obj->GetValue(*it++);
     Handle<Value> result = function->Call(global, 1, parameters);
     if (result.IsEmpty()) {
@@ -476,6 +886,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Each(const Argument
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Filter(const Arguments& args) {
+  PROFILE_METHOD(filter, args);
   return ObjectWrap::Unwrap< Collection<Storage> >(args.This())->Iterate(_Filter, args);
 }
 
@@ -494,6 +905,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Filter(const Argume
   int i = 0;
   while (it != obj->storage.end()) {
     Handle<Value> parameters[1];
+    PROFILE_VISITS(1);
     parameters[0] = obj->GetValue(*it++);
     Handle<Value> result = function->Call(global, 1, parameters);
     if (result.IsEmpty()) {
@@ -506,6 +918,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Filter(const Argume
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Find(const Arguments& args) {
+  PROFILE_METHOD(find, args);
   return ObjectWrap::Unwrap< Collection<Storage> >(args.This())->Iterate(_Find, args);
 }
 
@@ -522,6 +935,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Find(const Argument
   typename Storage::iterator it = obj->storage.begin();
   while (it != obj->storage.end()) {
     Handle<Value> parameters[1];
+    PROFILE_VISITS(1);
     parameters[0] = obj->GetValue(*it++);
     Handle<Value> result = function->Call(global, 1, parameters);
     if (result.IsEmpty()) {
@@ -534,6 +948,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Find(const Argument
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::Reduce(const Arguments& args) {
+  PROFILE_METHOD(reduce, args);
   return ObjectWrap::Unwrap< Collection<Storage> >(args.This())->Iterate(_Reduce, args);
 }
 
@@ -551,6 +966,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Reduce(const Argume
   typename Storage::iterator it = obj->storage.begin();
   while (it != obj->storage.end()) {
     Handle<Value> parameters[2];
+    PROFILE_VISITS(1);
     parameters[0] = memo;
     parameters[1] = obj->GetValue(*it++);
     memo = function->Call(global, 2, parameters);
@@ -562,6 +978,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_Reduce(const Argume
 }
 
 template <class Storage> Handle<Value> Collection<Storage>::ReduceRight(const Arguments& args) {
+  PROFILE_METHOD(reduceRight, args);
   return ObjectWrap::Unwrap< Collection<Storage> >(args.This())->Iterate(_ReduceRight, args);
 }
 
@@ -579,6 +996,7 @@ template <class Storage> Handle<Value> Collection<Storage>::_ReduceRight(const A
   typename Storage::iterator it = obj->storage.end();
   while (it != obj->storage.begin()) {
     Handle<Value> parameters[2];
+    PROFILE_VISITS(1);
     parameters[0] = memo;
     parameters[1] = obj->GetValue(*--it);
     memo = function->Call(global, 2, parameters);
@@ -599,7 +1017,9 @@ template <class Storage> void IndexedCollection<Storage>::InitializeFields(Handl
 
   thisObject->Set(String::NewSymbol("add"), FunctionTemplate::New(Add)->GetFunction());
   thisObject->Set(String::NewSymbol("addAll"), FunctionTemplate::New(AddAll)->GetFunction());
+  thisObject->Set(String::NewSymbol("drainTo"), FunctionTemplate::New(DrainTo)->GetFunction());
   thisObject->Set(String::NewSymbol("index"), FunctionTemplate::New(Index)->GetFunction());
+  thisObject->Set(String::NewSymbol("moveFrom"), FunctionTemplate::New(MoveFrom)->GetFunction());
 }
 
 template <class Storage> void IndexedCollection<Storage>::InitializeValues(Handle<Object> thisObject, Handle<Value> argument) {
@@ -615,18 +1035,20 @@ template <class Storage> bool IndexedCollection<Storage>::IsSupportedObject(Hand
     Set* object = ObjectWrap::Unwrap<Set>(Handle<Object>::Cast(value));
     Set::Storage::const_iterator it = object->storage.begin();
     while (it != object->storage.end()) {
-      if (!IsSupportedType(*it++)) {
+      if (!it->IsPrimitive() && !IsSupportedType(it->ToValue())) {
         return false;
       }
+      it++;
     }
     return true;
   } else if (Vector::constructor->HasInstance(value)) {
     Vector* object = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(value));
     Vector::Storage::const_iterator it = object->storage.begin();
     while (it != object->storage.end()) {
-      if (!IsSupportedType(*it++)) {
+      if (!it->IsPrimitive() && !IsSupportedType(it->ToValue())) {
         return false;
       }
+      it++;
     }
     return true;
   }
@@ -659,13 +1081,13 @@ template <class Storage> bool IndexedCollection<Storage>::IsSupportedType(Handle
   return IsSupportedObject(value);
 }
 
-template <class Storage> void IndexedCollection<Storage>::AddValue(Handle<Object> collection, Handle<Value> value) {
+template <class Storage> void IndexedCollection<Storage>::AddValue(Handle<Object> collection, const Element& element) {
   if (Set::constructor->HasInstance(collection)) {
     Set* object = ObjectWrap::Unwrap<Set>(collection);
-    object->storage.insert(Persistent<Value>::New(value));
+    CollectionUtil::Insert(object->storage, object->storage.end(), element.Copy(&object->backing));
   } else if (Vector::constructor->HasInstance(collection)) {
     Vector* object = ObjectWrap::Unwrap<Vector>(collection);
-    object->storage.push_back(Persistent<Value>::New(value));
+    object->storage.push_back(element.Copy(&object->backing));
   }
 }
 
@@ -673,42 +1095,78 @@ template <class Storage> void IndexedCollection<Storage>::AddValues(Handle<Objec
   if (Set::constructor->HasInstance(collection)) {
     Set* object = ObjectWrap::Unwrap<Set>(collection);
     for (uint32_t i = 0; i < array->Length(); i++) {
-      object->storage.insert(Persistent<Value>::New(array->Get(i)));
+      CollectionUtil::Insert(object->storage, object->storage.end(), Element::New(array->Get(i), &object->backing));
     }
   } else if (Vector::constructor->HasInstance(collection)) {
     Vector* object = ObjectWrap::Unwrap<Vector>(collection);
+    object->storage.Grow(array->Length());
     for (uint32_t i = 0; i < array->Length(); i++) {
-      object->storage.push_back(Persistent<Value>::New(array->Get(i)));
+      object->storage.push_back(Element::New(array->Get(i), &object->backing));
     }
   }
 }
 
 template <class Storage> void IndexedCollection<Storage>::AddValues(Handle<Object> collection, Handle<Object> other) {
   IndexedCollection<Storage>* object = ObjectWrap::Unwrap< IndexedCollection<Storage> >(other);
+  if (Vector::constructor->HasInstance(collection)) {
+    ObjectWrap::Unwrap<Vector>(collection)->storage.Grow(object->storage.size());
+  }
   typename Storage::iterator it = object->storage.begin();
   while (it != object->storage.end()) {
     AddValue(collection, *it++);
   }
 }
 
+template <class Storage> template <class TargetStorage, class SourceStorage>
+void IndexedCollection<Storage>::MoveValues(IndexedCollection<TargetStorage>* target,
+    IndexedCollection<SourceStorage>* source) {
+  CollectionUtil::Reserve(target->storage, source->storage.size());
+  typename TargetStorage::iterator end = target->storage.end();
+  typename SourceStorage::iterator it = source->storage.begin();
+  while (it != source->storage.end()) {
+    end = CollectionUtil::Insert(target->storage, end, (it++)->Move(&target->backing));
+    end++;
+  }
+  source->storage.clear();
+  source->backing.Clear();
+}
+
+/*
+ * Between collections of the same type, an empty collection takes over the storage of one holding only primitive
+ * values.
+ */
+template <class Storage> void IndexedCollection<Storage>::MoveValues(IndexedCollection<Storage>* target,
+    IndexedCollection<Storage>* source) {
+  if (target->storage.empty() && source->backing.IsEmpty()) {
+    target->storage.swap(source->storage);
+  } else {
+    MoveValues<Storage, Storage>(target, source);
+  }
+}
+
 template <class Storage> Handle<Value> IndexedCollection<Storage>::Add(const Arguments& args) {
+  PROFILE_METHOD(add, args);
   CHECK_ITERATING(add, args);
+  CHECK_WRITABLE(add, args);
   if (args.Length() == 0) {
     return ThrowException(Exception::Error(String::New("add(value, ...) takes at least one argument.")));
   }
 
   HandleScope scope;
   IndexedCollection<Storage>* obj = ObjectWrap::Unwrap< IndexedCollection<Storage> >(args.This());
+  CollectionUtil::Reserve(obj->storage, args.Length());
   typename Storage::iterator end = obj->storage.end();
   for (int i = 0; i < args.Length(); i++) {
-    end = obj->storage.insert(end, Persistent<Value>::New(args[i]));
+    end = CollectionUtil::Insert(obj->storage, end, Element::New(args[i], &obj->backing));
     end++;
   }
   return args.This();
 }
 
 template <class Storage> Handle<Value> IndexedCollection<Storage>::AddAll(const Arguments& args) {
+  PROFILE_METHOD(addAll, args);
   CHECK_ITERATING(addAll, args);
+  CHECK_WRITABLE(addAll, args);
   IndexedCollection<Storage>* obj = ObjectWrap::Unwrap< IndexedCollection<Storage> >(args.This());
   if (args.Length() != 1 || (!(args[0]->IsArray()) && !obj->IsSupportedObject(args[0]))) {
     return ThrowException(Exception::Error(String::New("addAll(object) takes one array or object argument.")));
@@ -717,32 +1175,70 @@ template <class Storage> Handle<Value> IndexedCollection<Storage>::AddAll(const
   HandleScope scope;
   if (args[0]->IsArray()) {
     Handle<Array> array = Handle<Array>::Cast(args[0]);
+    CollectionUtil::Reserve(obj->storage, array->Length());
     typename Storage::iterator end = obj->storage.end();
     for (uint32_t i = 0; i < array->Length(); i++) {
-      end = obj->storage.insert(end, Persistent<Value>::New(array->Get(i)));
+      end = CollectionUtil::Insert(obj->storage, end, Element::New(array->Get(i), &obj->backing));
       end++;
     }
   } else if (Set::constructor->HasInstance(args[0])) {
     Set* set = ObjectWrap::Unwrap<Set>(Handle<Object>::Cast(args[0]));
     Set::Storage::iterator it = set->storage.begin();
+    CollectionUtil::Reserve(obj->storage, set->storage.size());
     typename Storage::iterator end = obj->storage.end();
     while (it != set->storage.end()) {
-      end = obj->storage.insert(end, Persistent<Value>::New(*it++));
+      end = CollectionUtil::Insert(obj->storage, end, (it++)->Copy(&obj->backing));
       end++;
     }
   } else if (Vector::constructor->HasInstance(args[0])) {
     Vector* set = ObjectWrap::Unwrap<Vector>(Handle<Object>::Cast(args[0]));
     Vector::Storage::iterator it = set->storage.begin();
+    CollectionUtil::Reserve(obj->storage, set->storage.size());
     typename Storage::iterator end = obj->storage.end();
     while (it != set->storage.end()) {
-      end = obj->storage.insert(end, Persistent<Value>::New(*it++));
+      end = CollectionUtil::Insert(obj->storage, end, (it++)->Copy(&obj->backing));
       end++;
     }
   }
   return args.This();
 }
 
+template <class Storage> Handle<Value> IndexedCollection<Storage>::DrainTo(const Arguments& args) {
+  PROFILE_METHOD(drainTo, args);
+  CHECK_ITERATING(drainTo, args);
+  CHECK_WRITABLE(drainTo, args);
+  if (args.Length() != 1 || !(Set::constructor->HasInstance(args[0]) || Vector::constructor->HasInstance(args[0]))) {
+    return ThrowException(Exception::Error(String::New("drainTo(object) takes one set or vector argument.")));
+  }
+
+  HandleScope scope;
+  IndexedCollection<Storage>* obj = ObjectWrap::Unwrap< IndexedCollection<Storage> >(args.This());
+  Handle<Object> other = Handle<Object>::Cast(args[0]);
+  if (other->StrictEquals(args.This())) {
+    return args.This();
+  }
+  if (Set::constructor->HasInstance(other)) {
+    Set* set = ObjectWrap::Unwrap<Set>(other);
+    if (set->IsIterating()) {
+      return ThrowException(Exception::Error(String::New("drainTo() cannot be called while the target is being iterated.")));
+    }
+    if (!set->BeginWrite()) {
+      return ThrowException(Exception::Error(String::New("drainTo() cannot be called with a snapshot.")));
+    }
+    MoveValues(set, obj);
+  } else {
+    Vector* vector = ObjectWrap::Unwrap<Vector>(other);
+    if (vector->IsIterating()) {
+      return ThrowException(Exception::Error(String::New("drainTo() cannot be called while the target is being iterated.")));
+    }
+    vector->BeginWrite();
+    MoveValues(vector, obj);
+  }
+  return args.This();
+}
+
 template <class Storage> Handle<Value> IndexedCollection<Storage>::Index(const Arguments& args) {
+  PROFILE_METHOD(index, args);
   if (args.Length() < 1) {
     return ThrowException(Exception::Error(String::New("index(value) takes at least one argument.")));
   }
@@ -754,8 +1250,11 @@ template <class Storage> Handle<Value> IndexedCollection<Storage>::Index(const A
   for (int i = 0; i < args.Length(); i++) {
     typename Storage::iterator it = obj->storage.begin();
     int j = 0, index = -1;
+    PROFILE_LOOKUP();
+    ElementProbe probe(args[i]);
     while (it != obj->storage.end()) {
-      if (!comparator(*it, args[i]) && !comparator(args[i], *it)) {
+      PROFILE_VISITS(1);
+      if (!comparator(*it, probe) && !comparator(probe, *it)) {
         index = j;
         break;
       } else {
@@ -772,30 +1271,148 @@ template <class Storage> Handle<Value> IndexedCollection<Storage>::Index(const A
   return scope.Close(array);
 }
 
+template <class Storage> Handle<Value> IndexedCollection<Storage>::MoveFrom(const Arguments& args) {
+  PROFILE_METHOD(moveFrom, args);
+  CHECK_ITERATING(moveFrom, args);
+  CHECK_WRITABLE(moveFrom, args);
+  if (args.Length() != 1 || !(Set::constructor->HasInstance(args[0]) || Vector::constructor->HasInstance(args[0]))) {
+    return ThrowException(Exception::Error(String::New("moveFrom(object) takes one set or vector argument.")));
+  }
+
+  HandleScope scope;
+  IndexedCollection<Storage>* obj = ObjectWrap::Unwrap< IndexedCollection<Storage> >(args.This());
+  Handle<Object> other = Handle<Object>::Cast(args[0]);
+  if (other->StrictEquals(args.This())) {
+    return args.This();
+  }
+  if (Set::constructor->HasInstance(other)) {
+    Set* set = ObjectWrap::Unwrap<Set>(other);
+    if (set->IsIterating()) {
+      return ThrowException(Exception::Error(String::New("moveFrom() cannot be called while the source is being iterated.")));
+    }
+    if (!set->BeginWrite()) {
+      return ThrowException(Exception::Error(String::New("moveFrom() cannot be called with a snapshot.")));
+    }
+    MoveValues(obj, set);
+  } else {
+    Vector* vector = ObjectWrap::Unwrap<Vector>(other);
+    if (vector->IsIterating()) {
+      return ThrowException(Exception::Error(String::New("moveFrom() cannot be called while the source is being iterated.")));
+    }
+    vector->BeginWrite();
+    MoveValues(obj, vector);
+  }
+  return args.This();
+}
+
+
+/*
+ * class SortedProbes
+ */
+
+SortedProbes::SortedProbes(Handle<Object> keys, uint32_t length) : keys(length), probes(length), order(length) {
+  for (uint32_t i = 0; i < length; i++) {
+    this->keys[i] = keys->Get(i);
+    probes[i] = new ElementProbe(this->keys[i]);
+    order[i] = i;
+  }
+  stable_sort(order.begin(), order.end(), Less(probes));
+}
+
+SortedProbes::~SortedProbes() {
+  for (size_t i = 0; i < probes.size(); i++) {
+    delete probes[i];
+  }
+}
+
 
 /*
  * class CollectionUtil
  */
 
-void CollectionUtil::Dispose(Persistent<Value> value) {
-  value.Dispose();
+void CollectionUtil::Dispose(Element element) {
+  element.Dispose();
 }
 
-void CollectionUtil::Dispose(pair< Persistent<Value>, Persistent<Value> > pair) {
+void CollectionUtil::Dispose(pair<Element, Element> pair) {
   pair.first.Dispose();
   pair.second.Dispose();
 }
 
+void CollectionUtil::Dispose(const string& key) {
+}
+
+void CollectionUtil::Dispose(const KeyValue<Element>& entry) {
+  Element value = entry.second;
+  value.Dispose();
+}
+
 Handle<Value> CollectionUtil::Stringify(Handle<Value> value) {
+  // JSON.stringify() is looked up once, rather than through the global object on every call.
+  static Persistent<Function> stringify;
+
   HandleScope scope;
   Local<Object> global = Context::GetCurrent()->Global();
-  Local<Object> JSON = global->Get(String::New("JSON"))->ToObject();
-  Handle<Function> stringify = Handle<Function>::Cast(JSON->Get(String::New("stringify")));
+  if (stringify.IsEmpty()) {
+    Local<Object> JSON = global->Get(String::New("JSON"))->ToObject();
+    stringify = Persistent<Function>::New(Handle<Function>::Cast(JSON->Get(String::New("stringify"))));
+  }
   Handle<Value> parameters[1];
   parameters[0] = value;
   return scope.Close(stringify->Call(global, 1, parameters));
 }
 
+bool CollectionUtil::WriteJson(JsonWriter& writer, Handle<Object> object) {
+  if (Vector::constructor->HasInstance(object)) {
+    ObjectWrap::Unwrap<Vector>(object)->WriteJson(writer);
+  } else if (Map::constructor->HasInstance(object)) {
+    ObjectWrap::Unwrap<Map>(object)->WriteJson(writer);
+  } else if (Set::constructor->HasInstance(object)) {
+    ObjectWrap::Unwrap<Set>(object)->WriteJson(writer);
+  } else if (SortedVector::constructor->HasInstance(object)) {
+    ObjectWrap::Unwrap<SortedVector>(object)->WriteJson(writer);
+  } else if (Deque::constructor->HasInstance(object)) {
+    ObjectWrap::Unwrap<Deque>(object)->WriteJson(writer);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const double* CollectionUtil::GetDoubles(Handle<Value> value, size_t& length) {
+  if (!value->IsObject()) {
+    return NULL;
+  }
+  Handle<Object> object = Handle<Object>::Cast(value);
+  if (!object->HasIndexedPropertiesInExternalArrayData() ||
+      object->GetIndexedPropertiesExternalArrayDataType() != kExternalDoubleArray) {
+    return NULL;
+  }
+  length = (size_t) object->GetIndexedPropertiesExternalArrayDataLength();
+  return static_cast<const double*>(object->GetIndexedPropertiesExternalArrayData());
+}
+
+bool CollectionUtil::GetArrayLength(Handle<Value> value, uint32_t& length) {
+  if (value->IsArray()) {
+    length = Handle<Array>::Cast(value)->Length();
+    return true;
+  }
+  if (!value->IsObject() || !Handle<Object>::Cast(value)->HasIndexedPropertiesInExternalArrayData()) {
+    return false;
+  }
+  length = (uint32_t) Handle<Object>::Cast(value)->GetIndexedPropertiesExternalArrayDataLength();
+  return true;
+}
+
+Local<Object> CollectionUtil::NewUint8Array(uint32_t length, uint8_t*& data) {
+  Local<Function> constructor = Local<Function>::Cast(Context::GetCurrent()->Global()->Get(String::NewSymbol("Uint8Array")));
+  Handle<Value> parameters[1];
+  parameters[0] = Integer::NewFromUnsigned(length);
+  Local<Object> array = constructor->NewInstance(1, parameters);
+  data = static_cast<uint8_t*>(array->GetIndexedPropertiesExternalArrayData());
+  return array;
+}
+
 
 /*
  * Templated classes
@@ -803,8 +1420,18 @@ Handle<Value> CollectionUtil::Stringify(Handle<Value> value) {
 
 template<class Storage> Persistent<FunctionTemplate> Collection<Storage>::constructor;
 
+template class Collection<Deque::Storage>;
+template class Collection<ExpiringMap::Storage>;
+template class Collection<IntSet::Storage>;
+template class Collection<LruMap::Storage>;
 template class Collection<Map::Storage>;
+template class Collection<MultiMap::Storage>;
+template class Collection<MultiSet::Storage>;
+template class Collection<PriorityQueue::Storage>;
 template class Collection<Set::Storage>;
+template class Collection<SortedVector::Storage>;
+template class Collection<StringMap::Storage>;
+template class Collection<StringSet::Storage>;
 template class Collection<Vector::Storage>;
 template class IndexedCollection<Set::Storage>;
 template class IndexedCollection<Vector::Storage>;
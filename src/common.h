@@ -2,13 +2,20 @@
 #define COLLECTION_COMMON_H
 
 #include <string>
+#include <vector>
 #include <node.h>
+#include "Element.h"
+#include "Profile.h"
+#include "SharedStorage.h"
 
 using namespace node;
 using namespace std;
 using namespace v8;
 
 class CollectionUtil;
+class JsonWriter;
+template <class Mapped> struct KeyValue;
+template <class T, class Comparator, class Alloc> class InternalVector;
 
 
 /*
@@ -29,6 +36,13 @@ do { \
   } \
 } while (false)
 
+#define CHECK_WRITABLE(method, args) \
+do { \
+  if (!ObjectWrap::Unwrap< Collection<Storage> >(args.This())->BeginWrite()) { \
+    return ThrowException(Exception::Error(String::New(#method "() cannot be called on a snapshot."))); \
+  } \
+} while (false)
+
 
 /*
  * class SetComparator
@@ -37,12 +51,46 @@ do { \
 class ValueComparator {
   public:
     bool operator()(const Handle<Value>& value1, const Handle<Value>& value2) const;
-    bool operator()(const pair< Handle<Value>, Handle<Value> >& pair1, const pair< Handle<Value>, Handle<Value> >& pair2) const;
+    bool operator()(const Element& element1, const Element& element2) const;
+    bool operator()(const pair<Element, Element>& pair1, const pair<Element, Element>& pair2) const;
+    bool operator()(const string& key1, const string& key2) const;
+    bool operator()(const KeyValue<Element>& entry1, const KeyValue<Element>& entry2) const;
     bool Equals(const Handle<Value>& value1, const Handle<Value>& value2) const;
     bool Equals(const pair< Handle<Value>, Handle<Value> >& pair1, const pair< Handle<Value>, Handle<Value> >& pair2) const;
 
+    static int GetTypeScore(const Handle<Value>& value);
+};
+
+
+/*
+ * class ValueHasher
+ *
+ * Hash function that is consistent with ValueComparator: values that the comparator considers equal have the same
+ * hash.
+ */
+
+class ValueHasher {
+  public:
+    uint32_t operator()(const Handle<Value>& value) const;
+    uint32_t operator()(const Element& element) const;
+    uint32_t operator()(const pair<Element, Element>& pair) const;
+    uint32_t operator()(const string& key) const;
+    uint32_t operator()(const KeyValue<Element>& entry) const;
+
+    /*
+     * A 64-bit hash for structures that need more bits than a hash table, such as Bloom filters. It is consistent
+     * with ValueComparator in the same way, and its bits are well mixed.
+     */
+    uint64_t Hash64(const Handle<Value>& value) const;
+    uint64_t Hash64(double number) const;
+
+    static uint32_t Combine(uint32_t hash, uint32_t value);
+
   private:
-    int GetTypeScore(const Handle<Value>& value1) const;
+    static uint32_t HashNumber(double number);
+    static uint64_t HashNumber64(double number);
+    static uint64_t Mix64(uint64_t bits);
+    static uint64_t Combine64(uint64_t hash, uint64_t value);
 };
 
 
@@ -60,7 +108,30 @@ template <class Storage> class Collection : public ObjectWrap  {
 
     bool IsIterating() const;
 
+    /*
+     * Make the storage private to this collection before it is modified. Returns false if the collection is a
+     * read-only snapshot.
+     */
+    bool BeginWrite();
+
+    /*
+     * Hash of the values in storage order, consistent with equals(). If all the values are primitive, it is kept
+     * until the collection is modified.
+     */
+    uint32_t Hash();
+
+    /*
+     * Write the values as the JSON text of an array, the same as JSON.stringify() gives for toArray(), without
+     * creating the array.
+     */
+    virtual void WriteJson(JsonWriter& writer);
+
     Storage storage;
+    BackingStore backing;
+
+#ifdef COLLECTION_PROFILE
+    Profiler* profiler;
+#endif
 
   protected:
     Collection();
@@ -80,12 +151,16 @@ template <class Storage> class Collection : public ObjectWrap  {
     static Handle<Value> Get(const Arguments& args);
     static Handle<Value> Has(const Arguments& args);
     static Handle<Value> IsEmpty(const Arguments& args);
+    static Handle<Value> Profile(const Arguments& args);
     static Handle<Value> RemoveAt(const Arguments& args);
     static Handle<Value> RemoveLast(const Arguments& args);
     static Handle<Value> RemoveRange(const Arguments& args);
     static Handle<Value> Size(const Arguments& args);
     static Handle<Value> ToArray(const Arguments& args);
+    static Handle<Value> ToJSON(const Arguments& args);
+    static Handle<Value> ToJSONBuffer(const Arguments& args);
     static Handle<Value> ToString(const Arguments& args);
+    static Handle<Value> WriteJSON(const Arguments& args);
 
     static Handle<Value> Each(const Arguments& args);
     static Handle<Value> _Each(const Arguments& args);
@@ -99,6 +174,18 @@ template <class Storage> class Collection : public ObjectWrap  {
     static Handle<Value> _ReduceRight(const Arguments& args);
 
     int iterationLevel;
+    bool readOnly;
+    // Incremented whenever the values or their order may have changed.
+    uint64_t version;
+
+  private:
+    // A value of the storage in JSON, written natively unless GetValue() is needed to tell what it is.
+    bool WriteJsonValue(JsonWriter& writer, const Element& value) const;
+    bool WriteJsonValue(JsonWriter& writer, const string& value) const;
+    template <class T> bool WriteJsonValue(JsonWriter& writer, const T& value) const;
+
+    uint64_t hashVersion;
+    uint32_t hash;
 
     friend class CollectionUtil;
     friend class ValueComparator;
@@ -116,13 +203,106 @@ template <class Storage> class IndexedCollection : public Collection<Storage> {
     virtual bool IsSupportedObject(Handle<Value> value);
     virtual bool IsSupportedType(Handle<Value> value);
 
-    static void AddValue(Handle<Object> collection, Handle<Value> value);
+    static void AddValue(Handle<Object> collection, const Element& element);
     static void AddValues(Handle<Object> collection, Handle<Array> array);
     static void AddValues(Handle<Object> collection, Handle<Object> other);
 
+    /*
+     * Hand the values of a set or vector over to another, leaving the source empty. The values keep what they own,
+     * so strings and numbers are neither copied nor released.
+     */
+    template <class TargetStorage, class SourceStorage> static void MoveValues(IndexedCollection<TargetStorage>* target,
+        IndexedCollection<SourceStorage>* source);
+    static void MoveValues(IndexedCollection<Storage>* target, IndexedCollection<Storage>* source);
+
     static Handle<Value> Add(const Arguments& args);
     static Handle<Value> AddAll(const Arguments& args);
+    static Handle<Value> DrainTo(const Arguments& args);
     static Handle<Value> Index(const Arguments& args);
+    static Handle<Value> MoveFrom(const Arguments& args);
+};
+
+
+/*
+ * class SortedProbes
+ *
+ * Probes for the keys of an array or a typed array, sorted so that a sorted collection can look them all up in one
+ * pass. Each lookup steps forward from where the previous one ended, and descends from the root only if the key is
+ * more than a few entries away. Equal keys keep their order in the array.
+ */
+
+class SortedProbes {
+  public:
+    static const uint32_t MAX_STEPS = 8;
+
+    SortedProbes(Handle<Object> keys, uint32_t length);
+    ~SortedProbes();
+
+    inline uint32_t Size() const {
+      return (uint32_t) order.size();
+    }
+
+    /*
+     * The index in the array of the i-th smallest key.
+     */
+    inline uint32_t Index(uint32_t i) const {
+      return order[i];
+    }
+
+    inline Handle<Value> Key(uint32_t i) const {
+      return keys[order[i]];
+    }
+
+    /*
+     * Look up the i-th smallest key, starting from `finger`, which is the position returned for the previous key or
+     * the beginning of the storage. Returns the position of the key, or of the first greater key if it is not found.
+     */
+    template <class Storage> typename Storage::iterator Seek(Storage& storage, uint32_t i,
+        typename Storage::iterator finger, bool& found) const {
+      ValueComparator comparator;
+      const Element& probe = *probes[order[i]];
+      typename Storage::iterator end = storage.end();
+      uint32_t steps = 0;
+      PROFILE_LOOKUP();
+      while (finger != end && comparator(KeyOf(*finger), probe)) {
+        if (steps == MAX_STEPS) {
+          finger = storage.lower_bound(probe);
+          break;
+        }
+        ++finger;
+        steps++;
+      }
+      PROFILE_VISITS(steps);
+      found = finger != end && !comparator(probe, KeyOf(*finger));
+      return finger;
+    }
+
+  private:
+    struct Less {
+      explicit Less(const vector<ElementProbe*>& probes) : probes(probes) {
+      }
+
+      bool operator()(uint32_t index1, uint32_t index2) const {
+        return ValueComparator()(*probes[index1], *probes[index2]);
+      }
+
+      const vector<ElementProbe*>& probes;
+    };
+
+    SortedProbes(const SortedProbes& other);
+    SortedProbes& operator=(const SortedProbes& other);
+
+    static inline const Element& KeyOf(const Element& value) {
+      return value;
+    }
+
+    static inline const Element& KeyOf(const pair<const Element, Element>& entry) {
+      return entry.first;
+    }
+
+    vector< Local<Value> > keys;
+    vector<ElementProbe*> probes;
+    vector<uint32_t> order;
 };
 
 
@@ -132,9 +312,112 @@ template <class Storage> class IndexedCollection : public Collection<Storage> {
 
 class CollectionUtil {
   public:
-    static void Dispose(Persistent<Value> value);
-    static void Dispose(pair< Persistent<Value>, Persistent<Value> > pair);
+    static void Dispose(Element element);
+    static void Dispose(pair<Element, Element> pair);
+    static void Dispose(const string& key);
+    static void Dispose(const KeyValue<Element>& entry);
     static Handle<Value> Stringify(Handle<Value> value);
+
+    /*
+     * Write a collection that supports toJSON() with the writer. Returns false if the object is not such a collection.
+     */
+    static bool WriteJson(JsonWriter& writer, Handle<Object> object);
+
+    /*
+     * Get the numbers of a Float64Array, which are kept outside of the JavaScript heap and can be read without
+     * creating a value for each. Returns NULL if the value is not a Float64Array.
+     */
+    static const double* GetDoubles(Handle<Value> value, size_t& length);
+
+    /*
+     * Get the length of an array or a typed array, whose elements can be read with Get(). Returns false if the value
+     * is neither.
+     */
+    static bool GetArrayLength(Handle<Value> value, uint32_t& length);
+
+    /*
+     * Create a Uint8Array of `length` zeros, and get its bytes, which are kept outside of the JavaScript heap.
+     */
+    static Local<Object> NewUint8Array(uint32_t length, uint8_t*& data);
+
+    /*
+     * Test whether the keys of an array or a typed array are in a sorted storage. Returns a Uint8Array of 1 for each
+     * key found and 0 for each other.
+     */
+    template <class Storage> static Local<Object> HasMany(Storage& storage, Handle<Object> keys, uint32_t length) {
+      uint8_t* data;
+      Local<Object> result = NewUint8Array(length, data);
+      SortedProbes probes(keys, length);
+      typename Storage::iterator finger = storage.begin();
+      for (uint32_t i = 0; i < probes.Size(); i++) {
+        bool found;
+        finger = probes.Seek(storage, i, finger, found);
+        data[probes.Index(i)] = found ? 1 : 0;
+      }
+      return result;
+    }
+
+    /*
+     * Insert an element that is owned by the caller. If the storage already contains an equal element, the new one
+     * is disposed.
+     */
+    template <class Storage> static typename Storage::iterator Insert(Storage& storage,
+        typename Storage::iterator position, const Element& element) {
+      size_t size = storage.size();
+      typename Storage::iterator it = storage.insert(position, element);
+      if (storage.size() == size) {
+        Dispose(element);
+      }
+      return it;
+    }
+
+    /*
+     * Give up storage shared with other collections before the values of a collection are disposed, or make it
+     * private before they are modified. Storage that cannot be shared is left alone.
+     */
+    template <class Storage> static void Release(Storage& storage) {
+    }
+
+    template <class Container> static void Release(SharedStorage<Container>& storage) {
+      storage.Release();
+    }
+
+    /*
+     * Make room for `count` more values before they are added one by one. Storage that has no capacity is left
+     * alone.
+     */
+    template <class Storage> static void Reserve(Storage& storage, size_t count) {
+    }
+
+    template <class T, class Comparator, class Alloc> static void Reserve(InternalVector<T, Comparator, Alloc>& storage,
+        size_t count) {
+      storage.Grow(count);
+    }
+
+    template <class Storage> static void Unshare(Storage& storage) {
+    }
+
+    template <class Container> static void Unshare(SharedStorage<Container>& storage) {
+      storage.Unshare();
+    }
+
+    /*
+     * Create a collection of type T with the values of another. The new collection shares the storage when all the
+     * values are primitive, and copies it otherwise.
+     */
+    template <class T> static Handle<Value> Clone(Handle<Object> thisObject, bool readOnly) {
+      HandleScope scope;
+      T* obj = ObjectWrap::Unwrap<T>(thisObject);
+      Local<Object> result = T::constructor->GetFunction()->NewInstance();
+      T* clone = ObjectWrap::Unwrap<T>(result);
+      if (obj->backing.IsEmpty()) {
+        clone->storage.Share(obj->storage);
+      } else {
+        clone->storage.Copy(obj->storage, &clone->backing);
+      }
+      clone->readOnly = readOnly;
+      return scope.Close(result);
+    }
 };
 
 #endif
@@ -0,0 +1,198 @@
+"use strict";
+
+var assert = require("assert"),
+    BloomFilter = require("../lib/collection").BloomFilter,
+    CountingBloomFilter = require("../lib/collection").CountingBloomFilter,
+    Set = require("../lib/collection").Set,
+    Vector = require("../lib/collection").Vector;
+
+describe('BloomFilter', function() {
+  var f1;
+
+  beforeEach(function() {
+    f1 = new BloomFilter(1000);
+    f1.add("a", 1, [2, "b"], new Date(3), null);
+  });
+
+  describe("#new", function() {
+    it("should create filters", function() {
+      assert(!new BloomFilter(10).mightHave("a"));
+      assert(!new BloomFilter(10, 0.5).mightHave("a"));
+      assert.deepEqual(new BloomFilter(f1.toBuffer()).toBuffer(), f1.toBuffer());
+    });
+
+    it("should size filters by capacity and false positive rate", function() {
+      var bytes = new BloomFilter(100000, 0.01).toBuffer().length;
+      assert(bytes > 110000 && bytes < 130000);
+      assert(new BloomFilter(100000, 0.001).toBuffer().length > bytes);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new BloomFilter();
+      }, Error);
+      assert.throws(function() {
+        new BloomFilter(0);
+      }, Error);
+      assert.throws(function() {
+        new BloomFilter(10, 1);
+      }, Error);
+      assert.throws(function() {
+        new BloomFilter(new Buffer([1, 2, 3]));
+      }, Error);
+      assert.throws(function() {
+        new BloomFilter(new CountingBloomFilter(10).toBuffer());
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should add values", function() {
+      assert.deepEqual(f1.mightHave("a", 1, [2, "b"], new Date(3), null), [true, true, true, true, true]);
+    });
+
+    it("should compare arrays, sets and vectors by content", function() {
+      var f = new BloomFilter(1000);
+      f.add(new Vector([1, 2]));
+      assert(f.mightHave([1, 2]) === false);
+      assert(f.mightHave(new Vector([1, 2])));
+      f.add(new Set(["x", "y"]));
+      assert(f.mightHave(new Set(["y", "x"])));
+    });
+
+    it("should throw error if values are not supported", function() {
+      assert.throws(function() {
+        f1.add({});
+      }, Error);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should add values of arrays", function() {
+      var f = new BloomFilter(100).addAll(["x", "y", ["z"]]);
+      assert.deepEqual(f.mightHave("x", "y", ["z"]), [true, true, true]);
+    });
+  });
+
+  describe("#clear", function() {
+    it("should remove all values", function() {
+      assert(!f1.clear().mightHave("a"));
+      assert.equal(f1.estimatedSize(), 0);
+    });
+  });
+
+  describe("#estimatedSize", function() {
+    it("should estimate the number of values added", function() {
+      var f = new BloomFilter(10000);
+      for (var i = 0; i < 5000; i++) {
+        f.add(i);
+      }
+      assert(Math.abs(f.estimatedSize() - 5000) < 250);
+    });
+  });
+
+  describe("#falsePositiveRate", function() {
+    it("should estimate the false positive rate", function() {
+      var f = new BloomFilter(10000, 0.01);
+      assert.equal(f.falsePositiveRate(), 0);
+      for (var i = 0; i < 10000; i++) {
+        f.add("key" + i);
+      }
+      var rate = f.falsePositiveRate();
+      assert(rate > 0.005 && rate < 0.02);
+    });
+
+    it("should keep to the false positive rate at capacity", function() {
+      var f = new BloomFilter(20000, 0.01), i, positives = 0;
+      for (i = 0; i < 20000; i++) {
+        f.add(i);
+      }
+      for (i = 20000; i < 120000; i++) {
+        positives += f.mightHave(i) ? 1 : 0;
+      }
+      assert(positives / 100000 < 0.015);
+    });
+  });
+
+  describe("#merge", function() {
+    it("should merge filters", function() {
+      var f2 = new BloomFilter(1000).add("c");
+      assert.deepEqual(f1.merge(f2).mightHave("a", "c"), [true, true]);
+    });
+
+    it("should throw error if filters differ", function() {
+      assert.throws(function() {
+        f1.merge(new BloomFilter(2000));
+      }, Error);
+      assert.throws(function() {
+        f1.merge(new CountingBloomFilter(1000));
+      }, Error);
+    });
+  });
+
+  describe("#mightHave", function() {
+    it("should not have values that were not added", function() {
+      assert.deepEqual(f1.mightHave("c", 2, {}), [false, false, false]);
+    });
+
+    it("should treat 0 and -0 as equal", function() {
+      assert(new BloomFilter(10).add(0).mightHave(-0));
+    });
+  });
+
+  describe("#mightHaveEach", function() {
+    it("should test each value of an array", function() {
+      assert.deepEqual(f1.mightHaveEach(["a", [2, "b"], "c"]), [true, true, false]);
+    });
+
+    it("should throw error if argument is not an array", function() {
+      assert.throws(function() {
+        f1.mightHaveEach("a");
+      }, Error);
+    });
+  });
+});
+
+describe('CountingBloomFilter', function() {
+  var f1;
+
+  beforeEach(function() {
+    f1 = new CountingBloomFilter(1000);
+    f1.add("a", "b", "b");
+  });
+
+  describe("#new", function() {
+    it("should create filters", function() {
+      var f2 = new CountingBloomFilter(f1.toBuffer());
+      assert.deepEqual(f2.mightHave("a", "b", "c"), [true, true, false]);
+      assert.throws(function() {
+        new CountingBloomFilter(new BloomFilter(1000).toBuffer());
+      }, Error);
+    });
+  });
+
+  describe("#merge", function() {
+    it("should add counts of filters", function() {
+      var f2 = new CountingBloomFilter(1000).add("a", "c");
+      f1.merge(f2).remove("a");
+      assert.deepEqual(f1.mightHave("a", "b", "c"), [true, true, true]);
+      f1.remove("a");
+      assert.deepEqual(f1.mightHave("a", "b", "c"), [false, true, true]);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove values", function() {
+      f1.remove("a", "b");
+      assert.deepEqual(f1.mightHave("a", "b"), [false, true]);
+      f1.remove("b");
+      assert(!f1.mightHave("b"));
+      assert.equal(f1.estimatedSize(), 0);
+    });
+
+    it("should ignore values that were not added", function() {
+      f1.remove("c", {});
+      assert.deepEqual(f1.mightHave("a", "b"), [true, true]);
+    });
+  });
+});
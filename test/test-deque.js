@@ -0,0 +1,136 @@
+"use strict";
+
+var assert = require("assert"),
+    Deque = require("../lib/collection").Deque,
+    Vector = require("../lib/collection").Vector;
+
+describe('Deque', function() {
+  var d1, d2;
+
+  beforeEach(function() {
+    d1 = new Deque([1, 2, 3, 4]);
+    d2 = new Deque({capacity: 3});
+  });
+
+  describe("#new", function() {
+    it("should create deques from arrays, vectors and deques", function() {
+      assert.equal(new Deque().size(), 0);
+      assert.deepEqual(new Deque(new Vector([1, "a"])).toArray(), [1, "a"]);
+      assert.deepEqual(new Deque(d1).toArray(), [1, 2, 3, 4]);
+      assert.deepEqual(new Deque([1, 2, 3, 4], {capacity: 2}).toArray(), [3, 4]);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new Deque(1);
+      }, Error);
+      assert.throws(function() {
+        new Deque({capacity: 0});
+      }, Error);
+      assert.throws(function() {
+        new Deque([], [], []);
+      }, Error);
+    });
+  });
+
+  describe("#pushBack", function() {
+    it("should add values to the back", function() {
+      assert.deepEqual(d1.pushBack(5, [6]).toArray(), [1, 2, 3, 4, 5, [6]]);
+    });
+
+    it("should drop values from the front when full", function() {
+      assert.deepEqual(d2.pushBack(1, 2, 3, 4, 5).toArray(), [3, 4, 5]);
+      assert.equal(d2.capacity(), 3);
+    });
+  });
+
+  describe("#pushFront", function() {
+    it("should add values to the front", function() {
+      assert.deepEqual(d1.pushFront(0, -1).toArray(), [-1, 0, 1, 2, 3, 4]);
+    });
+
+    it("should drop values from the back when full", function() {
+      assert.deepEqual(d2.pushFront(1, 2, 3, 4).toArray(), [4, 3, 2]);
+    });
+  });
+
+  describe("#popFront", function() {
+    it("should remove values from the front", function() {
+      assert.equal(d1.popFront(), 1);
+      assert.equal(d1.popFront(), 2);
+      assert.deepEqual(d1.toArray(), [3, 4]);
+      assert.equal(d2.popFront(), undefined);
+    });
+
+    it("should not allow modification during iteration", function() {
+      assert.throws(function() {
+        d1.each(function() {
+          d1.popFront();
+        });
+      }, Error);
+    });
+  });
+
+  describe("#popBack", function() {
+    it("should remove values from the back", function() {
+      assert.equal(d1.popBack(), 4);
+      assert.deepEqual(d1.toArray(), [1, 2, 3]);
+      assert.equal(d2.popBack(), undefined);
+    });
+  });
+
+  describe("#peek", function() {
+    it("should get values at both ends", function() {
+      assert.equal(d1.peek(), 1);
+      assert.equal(d1.peekBack(), 4);
+      assert.equal(d1.size(), 4);
+      assert.equal(d2.peek(), undefined);
+    });
+  });
+
+  describe("#get", function() {
+    it("should get values by index after pushing at both ends", function() {
+      d1.pushFront(0).pushBack(5).popFront();
+      assert.deepEqual(d1.get(0, 4), [1, 5]);
+      assert.equal(d1.get(5), undefined);
+    });
+  });
+
+  describe("#set", function() {
+    it("should replace values by index", function() {
+      assert.deepEqual(d1.set(0, "a").set(4, "e").toArray(), ["a", 2, 3, 4, "e"]);
+      assert.throws(function() {
+        d1.set(10, 1);
+      }, Error);
+    });
+  });
+
+  describe("#removeAt", function() {
+    it("should remove values by index", function() {
+      assert.deepEqual(d1.removeAt(0, 2).toArray(), [2, 3]);
+    });
+  });
+
+  describe("queue", function() {
+    it("should hold many values", function() {
+      var d = new Deque();
+      for (var i = 0; i < 10000; i++) {
+        d.pushBack(i);
+        if (i % 2 === 0) {
+          d.popFront();
+        }
+      }
+      assert.equal(d.size(), 5000);
+      assert.equal(d.peek(), 5000);
+      assert.equal(d.get(4999), 9999);
+    });
+  });
+
+  describe("#reduce", function() {
+    it("should go through values from the front", function() {
+      assert.equal(d1.reduce(function(memo, v) { return memo + v; }, ""), "1234");
+      assert.equal(d1.reduceRight(function(memo, v) { return memo + v; }, ""), "4321");
+      assert.deepEqual(d1.filter(function(v) { return v % 2 === 0; }), [2, 4]);
+    });
+  });
+});
@@ -0,0 +1,126 @@
+"use strict";
+
+var assert = require("assert"),
+    DistinctCounter = require("../lib/collection").DistinctCounter,
+    Vector = require("../lib/collection").Vector;
+
+describe('DistinctCounter', function() {
+  var c1;
+
+  beforeEach(function() {
+    c1 = new DistinctCounter();
+    c1.add("a", "b", "a", 1, [1, 2], [1, 2]);
+  });
+
+  describe("#new", function() {
+    it("should create counters", function() {
+      assert.equal(new DistinctCounter().size(), 0);
+      assert.equal(new DistinctCounter(4).size(), 0);
+      assert.equal(new DistinctCounter(c1.toBuffer()).size(), 4);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new DistinctCounter(3);
+      }, Error);
+      assert.throws(function() {
+        new DistinctCounter(19);
+      }, Error);
+      assert.throws(function() {
+        new DistinctCounter(new Buffer([1, 2, 3, 4, 5, 6, 7, 8]));
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should count equal values once", function() {
+      assert.equal(c1.size(), 4);
+      c1.add(new Vector([1]), new Vector([1]), new Date(5), new Date(5), -0, 0);
+      assert.equal(c1.size(), 7);
+    });
+
+    it("should throw error if values are not supported", function() {
+      assert.throws(function() {
+        c1.add({});
+      }, Error);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should add values of arrays", function() {
+      assert.equal(c1.addAll(["a", "c", [1, 2]]).size(), 5);
+    });
+
+    it("should add numbers of Float64Arrays as numbers", function() {
+      var numbers = new Float64Array([1, 2.5, 3, 2.5]);
+      assert.equal(c1.addAll(numbers).size(), 6);
+      assert.equal(c1.add(2.5, 3).size(), 6);
+    });
+
+    it("should throw error if argument is not an array", function() {
+      assert.throws(function() {
+        c1.addAll("a");
+      }, Error);
+    });
+  });
+
+  describe("#clear", function() {
+    it("should forget all values", function() {
+      assert.equal(c1.clear().size(), 0);
+    });
+  });
+
+  describe("#merge", function() {
+    it("should count values of both counters", function() {
+      var c2 = new DistinctCounter().add("a", "c");
+      assert.equal(c1.merge(c2).size(), 5);
+    });
+
+    it("should merge large counters", function() {
+      var c2 = new DistinctCounter(), c3 = new DistinctCounter(), i;
+      for (i = 0; i < 60000; i++) {
+        c2.add(i);
+      }
+      for (i = 30000; i < 90000; i++) {
+        c3.add(i);
+      }
+      assert(Math.abs(c2.merge(c3).size() - 90000) < 90000 * 0.03);
+    });
+
+    it("should throw error if precisions differ", function() {
+      assert.throws(function() {
+        c1.merge(new DistinctCounter(10));
+      }, Error);
+    });
+  });
+
+  describe("#size", function() {
+    it("should count small sets almost exactly", function() {
+      var c = new DistinctCounter();
+      for (var i = 0; i < 1000; i++) {
+        c.add("key" + i);
+      }
+      assert(Math.abs(c.size() - 1000) <= 1);
+    });
+
+    it("should estimate large sets within a few percent", function() {
+      var c = new DistinctCounter(), numbers = new Float64Array(200000);
+      for (var i = 0; i < numbers.length; i++) {
+        numbers[i] = i * 1.5;
+      }
+      c.addAll(numbers).addAll(numbers);
+      assert(Math.abs(c.size() - 200000) < 200000 * 0.03);
+    });
+  });
+
+  describe("#toBuffer", function() {
+    it("should take a fixed amount of memory", function() {
+      var c = new DistinctCounter(12);
+      for (var i = 0; i < 100000; i++) {
+        c.add(i);
+      }
+      assert(c.toBuffer().length <= 4096 + 8);
+      assert.equal(new DistinctCounter(c.toBuffer()).size(), c.size());
+    });
+  });
+});
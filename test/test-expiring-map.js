@@ -0,0 +1,233 @@
+"use strict";
+
+var assert = require("assert"),
+    ExpiringMap = require("../lib/collection").ExpiringMap,
+    Vector = require("../lib/collection").Vector;
+
+describe('ExpiringMap', function() {
+  var c1, expired;
+
+  beforeEach(function() {
+    expired = [];
+    c1 = new ExpiringMap(60000, {onExpire: function(entries) { expired.push(entries.toString()); }});
+    c1.set(1, "a").set(2, "b").set(3, "c").set(4, "d");
+  });
+
+  describe("#new", function() {
+    it("should create empty maps", function() {
+      assert.equal(new ExpiringMap(10).size(), 0);
+      assert.equal(new ExpiringMap(Infinity).size(), 0);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new ExpiringMap();
+      }, Error);
+      assert.throws(function() {
+        new ExpiringMap(0);
+      }, Error);
+      assert.throws(function() {
+        new ExpiringMap("1");
+      }, Error);
+      assert.throws(function() {
+        new ExpiringMap(1, {onExpire: 1});
+      }, Error);
+      assert.throws(function() {
+        new ExpiringMap(1, {interval: 0});
+      }, Error);
+    });
+  });
+
+  describe("#clear", function() {
+    it("should erase all the entries without expiring them", function() {
+      assert.equal(c1.clear().size(), 0);
+      assert.deepEqual(expired, []);
+      assert.deepEqual(c1.set(5, "e").keys(), [5]);
+    });
+  });
+
+  describe("#each", function() {
+    it("should go through entries in the order they were set", function() {
+      var keys = [];
+      c1.set(1, "x").each(function(entry) {
+        keys.push(entry.key());
+      });
+      assert.deepEqual(keys, [1, 2, 3, 4]);
+    });
+
+    it("should not allow modification during iteration", function() {
+      assert.throws(function() {
+        c1.each(function() {
+          c1.set(5, "e");
+        });
+      }, Error);
+    });
+  });
+
+  describe("#expire", function() {
+    it("should pass entries that expire together in one batch", function(done) {
+      c1.set(5, "e", 5).set(6, "f", 5).set([7], new Vector([7]), 5);
+      setTimeout(function() {
+        c1.expire();
+        assert.deepEqual(expired, ['{"key":5,"value":"e"},{"key":6,"value":"f"},{"key":[7],"value":[7]}']);
+        assert.deepEqual(c1.keys(), [1, 2, 3, 4]);
+        done();
+      }, 30);
+    });
+
+    it("should propagate errors from the expiry callback", function(done) {
+      var c = new ExpiringMap(5, {onExpire: function() { throw new Error(); }});
+      c.set(1, 1);
+      setTimeout(function() {
+        assert.throws(function() {
+          c.expire();
+        }, Error);
+        assert.equal(c.size(), 0);
+        done();
+      }, 30);
+    });
+
+    it("should not allow the expiry callback to modify the map", function(done) {
+      var c = new ExpiringMap(5, {onExpire: function(entries) { c.set(entries[0].key(), 0); }});
+      c.set(1, 1);
+      setTimeout(function() {
+        assert.throws(function() {
+          c.expire();
+        }, Error);
+        done();
+      }, 30);
+    });
+  });
+
+  describe("#get", function() {
+    it("should get values until they expire", function(done) {
+      c1.set(5, "e", 5);
+      assert.equal(c1.get(1), "a");
+      assert.equal(c1.get("1"), undefined);
+      assert.equal(c1.get(5), "e");
+      setTimeout(function() {
+        assert.equal(c1.get(5), undefined);
+        assert.deepEqual(expired, ['{"key":5,"value":"e"}']);
+        done();
+      }, 30);
+    });
+
+    it("should find keys that are arrays and collections", function() {
+      c1.set([1, [2]], "x").set(new Vector(["y"]), "y");
+      assert.equal(c1.get([1, [2]]), "x");
+      assert.equal(c1.get(new Vector(["y"])), "y");
+      assert.equal(c1.get([1, 2]), undefined);
+    });
+
+    it("should throw error if not given one key", function() {
+      assert.throws(function() {
+        c1.get();
+      }, Error);
+      assert.throws(function() {
+        c1.get(1, 2);
+      }, Error);
+    });
+  });
+
+  describe("#getAt", function() {
+    it("should get entries in the order they were set", function() {
+      assert.deepEqual(c1.getAt(0).toObject(), {key: 1, value: "a"});
+      assert.deepEqual(c1.getAt(3).toObject(), {key: 4, value: "d"});
+    });
+  });
+
+  describe("#has", function() {
+    it("should not find expired keys", function(done) {
+      c1.set(5, "e", 5);
+      assert.deepEqual(c1.has(1, 5, 6), [true, true, false]);
+      setTimeout(function() {
+        assert(c1.has(5) === false);
+        assert.equal(c1.size(), 4);
+        done();
+      }, 30);
+    });
+  });
+
+  describe("#refresh", function() {
+    it("should restart the time to live of entries", function(done) {
+      c1.set(5, "e", 5);
+      assert(c1.refresh(5, 100000));
+      assert(!c1.refresh(6));
+      assert(c1.refresh(1, Infinity));
+      assert.equal(c1.ttl(1), Infinity);
+      setTimeout(function() {
+        assert.equal(c1.get(5), "e");
+        done();
+      }, 30);
+    });
+
+    it("should throw error if time to live is not positive", function() {
+      assert.throws(function() {
+        c1.refresh(1, 0);
+      }, Error);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove entries without expiring them", function() {
+      assert.deepEqual(c1.remove(3, 4, 5).keys(), [1, 2]);
+      assert.deepEqual(expired, []);
+    });
+  });
+
+  describe("#set", function() {
+    it("should replace values of existing keys and keep their positions", function() {
+      assert.deepEqual(c1.set(1, "x").keys(), [1, 2, 3, 4]);
+      assert.equal(c1.get(1), "x");
+    });
+
+    it("should add keys again after they expire", function(done) {
+      c1.set(1, "x", 5);
+      setTimeout(function() {
+        assert.deepEqual(c1.set(1, "y").keys(), [2, 3, 4, 1]);
+        assert.deepEqual(expired, ['{"key":1,"value":"x"}']);
+        done();
+      }, 30);
+    });
+
+    it("should throw error if time to live is not positive", function() {
+      assert.throws(function() {
+        c1.set(1, "a", -1);
+      }, Error);
+      assert.throws(function() {
+        c1.set(1);
+      }, Error);
+    });
+  });
+
+  describe("#toObject", function() {
+    it("should convert the maps into objects", function() {
+      assert.deepEqual(c1.toObject(), {1: "a", 2: "b", 3: "c", 4: "d"});
+      assert.equal(c1.toString(), '{"1":"a","2":"b","3":"c","4":"d"}');
+    });
+  });
+
+  describe("#ttl", function() {
+    it("should get the time left before entries expire", function() {
+      var ttl = c1.ttl(1);
+      assert(ttl > 59000 && ttl <= 60001);
+      assert.equal(c1.ttl(5), undefined);
+    });
+  });
+
+  describe("interval", function() {
+    it("should expire entries without access", function(done) {
+      var batches = [];
+      var c = new ExpiringMap(5, {interval: 5, onExpire: function(entries) { batches.push(entries.length); }});
+      for (var i = 0; i < 1000; i++) {
+        c.set(i, i);
+      }
+      setTimeout(function() {
+        assert(batches.length > 0);
+        assert.equal(batches.reduce(function(a, b) { return a + b; }), 1000);
+        assert.equal(c.size(), 0);
+        done();
+      }, 50);
+    });
+  });
+});
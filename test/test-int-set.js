@@ -0,0 +1,202 @@
+"use strict";
+
+var assert = require("assert"),
+    IntSet = require("../lib/collection").IntSet,
+    Set = require("../lib/collection").Set;
+
+describe('IntSet', function() {
+  var s1, dense;
+
+  beforeEach(function() {
+    s1 = new IntSet([7, 1, 4294967295, 65536, 3]);
+    dense = new IntSet();
+    for (var i = 0; i < 100000; i += 2) {
+      dense.add(i);
+    }
+  });
+
+  describe("#new", function() {
+    it("should create int sets", function() {
+      assert.equal(new IntSet().size(), 0);
+      assert(new IntSet(s1).equals(s1));
+      assert(new IntSet(s1.toBuffer()).equals(s1));
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new IntSet([1, -1]);
+      }, Error);
+      assert.throws(function() {
+        new IntSet([1.5]);
+      }, Error);
+      assert.throws(function() {
+        new IntSet(new Set([1]));
+      }, Error);
+      assert.throws(function() {
+        new IntSet(new Buffer([1, 2, 3, 4, 5]));
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should add integers in ascending order", function() {
+      assert.deepEqual(s1.add(2, 7).toArray(), [1, 2, 3, 7, 65536, 4294967295]);
+      assert.equal(s1.size(), 6);
+    });
+
+    it("should throw error if values are not unsigned 32-bit integers", function() {
+      assert.throws(function() {
+        s1.add(4294967296);
+      }, Error);
+      assert.throws(function() {
+        s1.add("1");
+      }, Error);
+      assert.equal(s1.size(), 5);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should add arrays and int sets", function() {
+      assert.deepEqual(s1.addAll([0, 1]).addAll(new IntSet([9])).toArray(), [0, 1, 3, 7, 9, 65536, 4294967295]);
+    });
+  });
+
+  describe("#and", function() {
+    it("should intersect int sets", function() {
+      var other = new IntSet([3, 5, 65536, 70000]);
+      assert.deepEqual(s1.and(other).toArray(), [3, 65536]);
+      assert.equal(dense.and(new IntSet([0, 1, 2, 99998, 100000])).size(), 3);
+    });
+
+    it("should throw error if not given an int set", function() {
+      assert.throws(function() {
+        s1.and([1]);
+      }, Error);
+    });
+  });
+
+  describe("#andNot", function() {
+    it("should subtract int sets", function() {
+      assert.deepEqual(s1.andNot(new IntSet([1, 7])).toArray(), [3, 65536, 4294967295]);
+      var odd = new IntSet();
+      for (var i = 1; i < 100000; i += 2) {
+        odd.add(i);
+      }
+      assert(dense.or(odd).andNot(odd).equals(dense));
+    });
+  });
+
+  describe("#clear", function() {
+    it("should remove all members", function() {
+      assert(dense.clear().isEmpty());
+    });
+  });
+
+  describe("#each", function() {
+    it("should go through members in ascending order", function() {
+      var values = [];
+      s1.each(function(v) {
+        values.push(v);
+      });
+      assert.deepEqual(values, [1, 3, 7, 65536, 4294967295]);
+    });
+
+    it("should not allow modification during iteration", function() {
+      assert.throws(function() {
+        s1.each(function() {
+          s1.add(2);
+        });
+      }, Error);
+    });
+  });
+
+  describe("#has", function() {
+    it("should find members", function() {
+      assert.deepEqual(s1.has(1, 2, 4294967295, -1, "1"), [true, false, true, false, false]);
+      assert(dense.has(99998));
+      assert(!dense.has(99999));
+    });
+  });
+
+  describe("#or", function() {
+    it("should unite int sets", function() {
+      assert.deepEqual(s1.or(new IntSet([2, 7])).toArray(), [1, 2, 3, 7, 65536, 4294967295]);
+      assert.equal(dense.or(s1).size(), 50004);
+    });
+  });
+
+  describe("#rank", function() {
+    it("should count members up to a value", function() {
+      assert.equal(s1.rank(0), 0);
+      assert.equal(s1.rank(7), 3);
+      assert.equal(s1.rank(4294967295), 5);
+      assert.equal(dense.rank(1001), 501);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove members", function() {
+      assert.deepEqual(s1.remove(1, 65536, 8, -1).toArray(), [3, 7, 4294967295]);
+      for (var i = 0; i < 100000; i += 4) {
+        dense.remove(i);
+      }
+      assert.equal(dense.size(), 25000);
+      assert.equal(dense.select(0), 2);
+    });
+  });
+
+  describe("#runOptimize", function() {
+    it("should compress consecutive members without changing the set", function() {
+      var range = new IntSet();
+      for (var i = 0; i < 200000; i++) {
+        range.add(i);
+      }
+      var before = range.toBuffer().length;
+      assert(range.runOptimize().toBuffer().length < before / 100);
+      assert.equal(range.size(), 200000);
+      assert(range.has(131072));
+      assert(new IntSet(range.toBuffer()).equals(range));
+      assert.equal(range.remove(5).rank(10), 10);
+    });
+
+    it("should throw error if the set is being iterated", function() {
+      assert.throws(function() {
+        s1.each(function() {
+          s1.runOptimize();
+        });
+      }, Error);
+    });
+  });
+
+  describe("#select", function() {
+    it("should get members by rank", function() {
+      assert.equal(s1.select(0), 1);
+      assert.equal(s1.select(4), 4294967295);
+      assert.equal(s1.select(5), undefined);
+      assert.equal(dense.select(1000), 2000);
+    });
+  });
+
+  describe("#toBuffer", function() {
+    it("should take about one bit per member of dense sets", function() {
+      assert(dense.toBuffer().length < 100000 / 8 + 100);
+    });
+
+    it("should serialize empty sets", function() {
+      assert.equal(new IntSet(new IntSet().toBuffer()).size(), 0);
+    });
+  });
+
+  describe("#xor", function() {
+    it("should get members of either set but not both", function() {
+      assert.deepEqual(s1.xor(new IntSet([1, 2])).toArray(), [2, 3, 7, 65536, 4294967295]);
+      assert(dense.xor(dense).isEmpty());
+    });
+  });
+
+  describe("#toString", function() {
+    it("should convert int sets into strings", function() {
+      assert.equal(s1.toString(), "[1,3,7,65536,4294967295]");
+    });
+  });
+});
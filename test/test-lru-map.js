@@ -0,0 +1,231 @@
+"use strict";
+
+var assert = require("assert"),
+    LruMap = require("../lib/collection").LruMap,
+    Vector = require("../lib/collection").Vector;
+
+describe('LruMap', function() {
+  var c1, c2, evicted;
+
+  beforeEach(function() {
+    evicted = [];
+    c1 = new LruMap(4, {onEvict: function(k, v) { evicted.push([k, v]); }});
+    c1.set(1, "a").set(2, "b").set(3, "c").set(4, "d");
+    c2 = new LruMap(1);
+  });
+
+  describe("#new", function() {
+    it("should create empty maps with the given capacity", function() {
+      assert.equal(new LruMap(10).size(), 0);
+      assert.equal(new LruMap(10).capacity(), 10);
+    });
+
+    it("should throw error if capacity is not a positive integer", function() {
+      assert.throws(function() {
+        new LruMap();
+      }, Error);
+      assert.throws(function() {
+        new LruMap(0);
+      }, Error);
+      assert.throws(function() {
+        new LruMap(1.5);
+      }, Error);
+      assert.throws(function() {
+        new LruMap(1, {onEvict: 1});
+      }, Error);
+    });
+  });
+
+  describe("#clear", function() {
+    it("should erase all the entries without evicting them", function() {
+      assert.equal(c1.clear().size(), 0);
+      assert.deepEqual(evicted, []);
+      assert.deepEqual(c1.set(5, "e").keys(), [5]);
+    });
+  });
+
+  describe("#each", function() {
+    it("should go through entries from the most recently used", function() {
+      var keys = [];
+      c1.each(function(entry) {
+        keys.push(entry.key());
+      });
+      assert.deepEqual(keys, [4, 3, 2, 1]);
+    });
+
+    it("should not reorder entries that are read during iteration", function() {
+      var keys = [];
+      c1.each(function(entry) {
+        c1.get(entry.key());
+        c1.touch(entry.key());
+        keys.push(entry.key());
+      });
+      assert.deepEqual(keys, [4, 3, 2, 1]);
+      assert.deepEqual(c1.keys(), [4, 3, 2, 1]);
+    });
+
+    it("should not allow modification during iteration", function() {
+      assert.throws(function() {
+        c1.each(function() {
+          c1.set(5, "e");
+        });
+      }, Error);
+    });
+  });
+
+  describe("#get", function() {
+    it("should get values and make them the most recently used", function() {
+      assert.equal(c1.get(1), "a");
+      assert.equal(c1.get("1"), undefined);
+      assert.deepEqual(c1.keys(), [1, 4, 3, 2]);
+      c1.set(5, "e");
+      assert.deepEqual(evicted, [[2, "b"]]);
+    });
+
+    it("should find keys that are arrays and collections", function() {
+      c1.set([1, [2]], "x").set(new Vector(["y"]), "y");
+      assert.equal(c1.get([1, [2]]), "x");
+      assert.equal(c1.get(new Vector(["y"])), "y");
+      assert.equal(c1.get([1, 2]), undefined);
+    });
+
+    it("should throw error if not given one key", function() {
+      assert.throws(function() {
+        c1.get();
+      }, Error);
+      assert.throws(function() {
+        c1.get(1, 2);
+      }, Error);
+    });
+  });
+
+  describe("#getAt", function() {
+    it("should get entries by recency", function() {
+      assert.deepEqual(c1.getAt(0).toObject(), {key: 4, value: "d"});
+      assert.deepEqual(c1.getAt(3).toObject(), {key: 1, value: "a"});
+      assert.deepEqual(c1.keys(), [4, 3, 2, 1]);
+    });
+  });
+
+  describe("#has", function() {
+    it("should test keys without reordering entries", function() {
+      assert.deepEqual(c1.has(1, 5), [true, false]);
+      assert(c1.has(new Date(0)) === false);
+      assert.deepEqual(c1.keys(), [4, 3, 2, 1]);
+    });
+  });
+
+  describe("#peek", function() {
+    it("should get values without reordering entries", function() {
+      assert.equal(c1.peek(1), "a");
+      assert.equal(c1.peek(5), undefined);
+      assert.deepEqual(c1.keys(), [4, 3, 2, 1]);
+      assert.deepEqual(c1.stats(), {hits: 0, misses: 0, evictions: 0});
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove entries without evicting them", function() {
+      assert.deepEqual(c1.remove(3, 4, 5).keys(), [2, 1]);
+      assert.deepEqual(evicted, []);
+    });
+  });
+
+  describe("#removeLast", function() {
+    it("should remove the least recently used entry", function() {
+      assert.deepEqual(c1.removeLast().keys(), [4, 3, 2]);
+    });
+  });
+
+  describe("#resize", function() {
+    it("should evict entries beyond the new capacity", function() {
+      assert.deepEqual(c1.resize(2).keys(), [4, 3]);
+      assert.deepEqual(evicted, [[1, "a"], [2, "b"]]);
+      assert.equal(c1.capacity(), 2);
+      assert.deepEqual(c1.resize(3).set(5, "e").keys(), [5, 4, 3]);
+    });
+
+    it("should throw error if capacity is not a positive integer", function() {
+      assert.throws(function() {
+        c1.resize(0);
+      }, Error);
+    });
+  });
+
+  describe("#set", function() {
+    it("should evict the least recently used entry when full", function() {
+      assert.deepEqual(c1.set(5, "e").keys(), [5, 4, 3, 2]);
+      assert.deepEqual(evicted, [[1, "a"]]);
+      assert.deepEqual(c2.set("x", 1).set("y", 2).toObject(), {y: 2});
+    });
+
+    it("should replace values of existing keys without evicting", function() {
+      assert.deepEqual(c1.set(1, "x").keys(), [1, 4, 3, 2]);
+      assert.equal(c1.get(1), "x");
+      assert.deepEqual(evicted, []);
+    });
+
+    it("should propagate errors from the eviction callback", function() {
+      var c = new LruMap(1, {onEvict: function() { throw new Error(); }});
+      c.set(1, 1);
+      assert.throws(function() {
+        c.set(2, 2);
+      }, Error);
+      assert.deepEqual(c.keys(), [2]);
+    });
+
+    it("should not allow the eviction callback to modify the map", function() {
+      var c = new LruMap(1, {onEvict: function(k) { c.set(k, 0); }});
+      c.set(1, 1);
+      assert.throws(function() {
+        c.set(2, 2);
+      }, Error);
+    });
+  });
+
+  describe("#stats", function() {
+    it("should count hits, misses and evictions", function() {
+      c1.get(1);
+      c1.get(2);
+      c1.get(5);
+      c1.set(5, "e");
+      assert.deepEqual(c1.stats(true), {hits: 2, misses: 1, evictions: 1});
+      assert.deepEqual(c1.stats(), {hits: 0, misses: 0, evictions: 0});
+    });
+
+    it("should throw error if argument is not a boolean", function() {
+      assert.throws(function() {
+        c1.stats(1);
+      }, Error);
+    });
+  });
+
+  describe("#touch", function() {
+    it("should make entries the most recently used", function() {
+      assert(c1.touch(2));
+      assert(!c1.touch(5));
+      assert.deepEqual(c1.keys(), [2, 4, 3, 1]);
+    });
+  });
+
+  describe("#toObject", function() {
+    it("should convert the maps into objects", function() {
+      assert.deepEqual(c1.toObject(), {1: "a", 2: "b", 3: "c", 4: "d"});
+      assert.equal(c1.toString(), '{"1":"a","2":"b","3":"c","4":"d"}');
+    });
+  });
+
+  describe("capacity", function() {
+    it("should hold many entries", function() {
+      var c = new LruMap(1000);
+      for (var i = 0; i < 10000; i++) {
+        c.set("key" + i, i);
+      }
+      assert.equal(c.size(), 1000);
+      assert.equal(c.get("key9999"), 9999);
+      assert.equal(c.get("key8999"), undefined);
+      assert.equal(c.get("key9000"), 9000);
+      assert.deepEqual(c.stats(), {hits: 2, misses: 1, evictions: 9000});
+    });
+  });
+});
@@ -1,7 +1,8 @@
 "use strict";
 
 var assert = require("assert"),
-    Map = require("../lib/collection").Map;
+    Map = require("../lib/collection").Map,
+    Vector = require("../lib/collection").Vector;
 
 describe('Map', function() {
   var o1, o2, o3, o4, m1, m2, m3, m4;
@@ -36,6 +37,111 @@ describe('Map', function() {
     });
   });
 
+  describe("#clone", function() {
+    it("should return a map with the same entries", function() {
+      assert.deepEqual(m1.clone().toObject(), o1);
+      assert.deepEqual(m4.clone().toObject(), o4);
+      assert(m2.clone().equals(m2));
+    });
+
+    it("should not be affected by changes to the original map", function() {
+      var clone = m1.clone();
+      m1.set("1", "z").remove("2").set("6", "f");
+      assert.deepEqual(clone.toObject(), o1);
+      m1.clear();
+      assert.deepEqual(clone.toObject(), o1);
+    });
+
+    it("should not affect the original map when changed", function() {
+      var clone = m1.clone();
+      clone.set("1", "z").remove("2").removeLast();
+      assert.deepEqual(clone.toObject(), {"1": "z", "3": "c", "4": "d"});
+      assert.deepEqual(m1.toObject(), o1);
+      assert(m1.clone().clear().isEmpty());
+      assert.deepEqual(m1.toObject(), o1);
+    });
+
+    it("should copy maps with object values", function() {
+      var map = new Map({"a": [1, 2], "b": {"c": 3}});
+      var clone = map.clone();
+      map.set("a", 1);
+      assert.deepEqual(clone.toObject(), {"a": [1, 2], "b": {"c": 3}});
+      assert.deepEqual(map.clone().toObject(), {"a": 1, "b": {"c": 3}});
+    });
+
+    it("should throw error if argument is provided", function() {
+      assert.throws(function() {
+        m1.clone(1);
+      }, Error);
+    });
+  });
+
+  describe("#compute", function() {
+    it("should set the value returned by the function", function() {
+      assert.equal(m1.compute("1", function(value, key) { return value + key; }), "a1");
+      assert.equal(m1.compute("6", function(value, key) { return value === undefined ? key : value; }), "6");
+      assert.deepEqual(m1.toObject(), {"1": "a1", "2": "b", "3": "c", "4": "d", "5": "e", "6": "6"});
+    });
+
+    it("should remove the key if the function returns undefined", function() {
+      assert.equal(m1.compute("1", function() {}), undefined);
+      assert.equal(m1.compute("6", function() {}), undefined);
+      assert.deepEqual(m1.toObject(), {"2": "b", "3": "c", "4": "d", "5": "e"});
+    });
+
+    it("should not affect a clone taken by the function", function() {
+      var clone;
+      m1.compute("1", function(value) {
+        clone = m1.clone();
+        return "z";
+      });
+      assert.deepEqual(clone.toObject(), o1);
+      assert.equal(m1.get("1"), "z");
+    });
+
+    it("should throw error if the function modifies the map", function() {
+      assert.throws(function() {
+        m1.compute("1", function() {
+          m1.set("2", "z");
+        });
+      }, Error);
+      assert.deepEqual(m1.toObject(), o1);
+    });
+
+    it("should throw error if the function throws", function() {
+      assert.throws(function() {
+        m1.compute("1", function() {
+          throw new Error();
+        });
+      }, Error);
+      assert.deepEqual(m1.toObject(), o1);
+    });
+
+    it("should throw error if not given a key and a function", function() {
+      assert.throws(function() {
+        m1.compute("1");
+      }, Error);
+      assert.throws(function() {
+        m1.compute("1", "a");
+      }, Error);
+    });
+  });
+
+  describe("#drainTo", function() {
+    it("should move all the entries to the target and leave the map empty", function() {
+      var target = new Map({"1": "z", "0": "y"});
+      m1.drainTo(target);
+      assert.deepEqual(target.toObject(), {"0": "y", "1": "a", "2": "b", "3": "c", "4": "d", "5": "e"});
+      assert(m1.isEmpty());
+    });
+
+    it("should throw error if the target is not a map", function() {
+      assert.throws(function() {
+        m1.drainTo({});
+      }, Error);
+    });
+  });
+
   describe("#each", function() {
     it("should go through all the entries in the maps", function() {
       var i = 0;
@@ -212,6 +318,15 @@ describe('Map', function() {
       assert.deepEqual(m3.get("x", "y", "z", "a", "b", "c"), ["a", "b", "c"]);
     });
 
+    it("should return dates and strings equal to those that were set", function() {
+      var date = new Date(1000), m = new Map();
+      m.set(date, "\u4e2d\u6587");
+      var key = m.keys()[0];
+      assert(key instanceof Date);
+      assert.equal(key.getTime(), date.getTime());
+      assert.equal(m.get(new Date(1000)), "\u4e2d\u6587");
+    });
+
     it("should throw error if no argument is given", function() {
       assert.throws(function() {
         m1.get();
@@ -249,6 +364,48 @@ describe('Map', function() {
     });
   });
 
+  describe("#getMany", function() {
+    it("should return the values of keys in the order of the keys", function() {
+      assert.equal(JSON.stringify(m2.getMany(["9", "1", 1, "5", "9"])), '["i","a",null,"e","i"]');
+      assert.equal(m4.getMany(["1"]).length, 1);
+      assert.equal(m1.getMany([]).length, 0);
+    });
+
+    it("should accept typed arrays", function() {
+      var map = new Map().set(1, "a").set(2, "b").set(3, "c");
+      assert.equal(JSON.stringify(map.getMany(new Uint32Array([3, 4, 1]))), '["c",null,"a"]');
+    });
+
+    it("should throw error if not given an array", function() {
+      assert.throws(function() {
+        m1.getMany("1");
+      }, Error);
+    });
+  });
+
+  describe("#getOrSet", function() {
+    it("should return the existing value of a key", function() {
+      assert.equal(m1.getOrSet("1", "z"), "a");
+      assert.equal(m1.getOrSet("1", function() { throw new Error(); }), "a");
+      assert.deepEqual(m1.toObject(), o1);
+    });
+
+    it("should set and return the value of a missing key", function() {
+      assert.equal(m1.getOrSet("6", "f"), "f");
+      assert.deepEqual(m1.getOrSet("7", function(key) { return [key]; }), ["7"]);
+      assert.deepEqual(m1.toObject(), {"1": "a", "2": "b", "3": "c", "4": "d", "5": "e", "6": "f", "7": ["7"]});
+    });
+
+    it("should throw error if not exactly two arguments are given", function() {
+      assert.throws(function() {
+        m1.getOrSet("1");
+      }, Error);
+      assert.throws(function() {
+        m1.getOrSet("1", "a", "b");
+      }, Error);
+    });
+  });
+
   describe("#has", function() {
     it("should return whether values exist in the maps", function() {
       Object.keys(o1).forEach(function(key) {
@@ -291,6 +448,57 @@ describe('Map', function() {
     });
   });
 
+  describe("#hasMany", function() {
+    it("should return a Uint8Array that tells which keys exist", function() {
+      var result = m2.hasMany(["9", "1", 1, "x", "9"]);
+      assert(result instanceof Uint8Array);
+      assert.deepEqual(Array.prototype.slice.call(result), [1, 1, 0, 0, 1]);
+    });
+
+    it("should throw error if not given an array", function() {
+      assert.throws(function() {
+        m1.hasMany();
+      }, Error);
+    });
+  });
+
+  describe("#increment", function() {
+    it("should add to the value of a key and return the result", function() {
+      var map = new Map({"a": 1, "b": 2.5});
+      assert.equal(map.increment("a"), 2);
+      assert.equal(map.increment("a", -3), -1);
+      assert.equal(map.increment("b", 0.5), 3);
+      assert.equal(map.increment("c", 4), 4);
+      assert.equal(map.increment("d"), 1);
+      assert.deepEqual(map.toObject(), {"a": -1, "b": 3, "c": 4, "d": 1});
+    });
+
+    it("should keep numbers equal to those set", function() {
+      var map = new Map({"a": 1});
+      map.increment("a", 0.5);
+      map.increment("a", 0.5);
+      assert(map.equals(new Map({"a": 2})));
+      map.increment("a", -2);
+      assert(map.equals(new Map({"a": 0})));
+    });
+
+    it("should throw error if the value is not a number", function() {
+      assert.throws(function() {
+        m1.increment("1");
+      }, Error);
+      assert.deepEqual(m1.toObject(), o1);
+    });
+
+    it("should throw error if the delta is not a number", function() {
+      assert.throws(function() {
+        m1.increment("6", "1");
+      }, Error);
+      assert.throws(function() {
+        m1.increment();
+      }, Error);
+    });
+  });
+
   describe("#isEmpty", function() {
     it("should return whether a map is empty", function() {
       assert.equal(m1.isEmpty(), false);
@@ -306,6 +514,70 @@ describe('Map', function() {
     });
   });
 
+  describe("#merge", function() {
+    it("should set the value of a missing key", function() {
+      assert.equal(m1.merge("6", "f", function() { throw new Error(); }), "f");
+      assert.equal(m1.get("6"), "f");
+    });
+
+    it("should set the value returned by the function for an existing key", function() {
+      assert.equal(m1.merge("1", "z", function(value, newValue) { return value + newValue; }), "az");
+      assert.equal(m1.get("1"), "az");
+    });
+
+    it("should remove the key if the function returns undefined", function() {
+      assert.equal(m1.merge("1", "z", function() {}), undefined);
+      assert.equal(m1.has("1"), false);
+    });
+
+    it("should throw error if not given a key, a value and a function", function() {
+      assert.throws(function() {
+        m1.merge("1", "z");
+      }, Error);
+      assert.throws(function() {
+        m1.merge("1", "z", "y");
+      }, Error);
+    });
+  });
+
+  describe("#moveFrom", function() {
+    it("should move all the entries of the source and leave it empty", function() {
+      var source = new Map(o1);
+      assert.deepEqual(m4.moveFrom(source).toObject(), o1);
+      assert(source.isEmpty());
+      source = new Map({"x": [1], "w": {"a": 2}});
+      assert.deepEqual(m3.moveFrom(source).toObject(), {"w": {"a": 2}, "x": [1], "y": "b", "z": "c"});
+      assert(source.isEmpty());
+    });
+
+    it("should throw error if the source is not a map", function() {
+      assert.throws(function() {
+        m1.moveFrom(o1);
+      }, Error);
+    });
+  });
+
+  describe("#profile", function() {
+    it("should return counters if profiling is compiled in", function() {
+      var profile = m1.profile();
+      if (profile === undefined) {
+        return;
+      }
+      m1.has("3");
+      profile = m1.profile(true);
+      assert.equal(profile.calls.has, 1);
+      assert.ok(profile.lookups >= 1);
+      assert.ok(profile.comparisons >= 1);
+      assert.equal(m1.profile().calls.has, undefined);
+    });
+
+    it("should throw error if argument is not a boolean", function() {
+      assert.throws(function() {
+        m1.profile("abc");
+      }, Error);
+    });
+  });
+
   describe("#reduce", function() {
     it("should reduce a map into a single value", function() {
       assert.equal(m1.reduce(function(memo, v) {
@@ -471,6 +743,38 @@ describe('Map', function() {
       assert.deepEqual(m1.setAll(m1).toObject(), o2);
       assert(m4.setAll(m1).equals(m1));
     });
+
+    it("should leave the map as it is when given itself", function() {
+      var array = [1], m = new Map().set("a", "x").set("b", array).set("c", new Vector([2]));
+      assert.equal(m.setAll(m).size(), 3);
+      assert.equal(m.get("a"), "x");
+      assert.equal(m.get("b"), array);
+      assert.deepEqual(m.get("c").toArray(), [2]);
+    });
+  });
+
+  describe("#setMany", function() {
+    it("should set the values of keys at the same indexes", function() {
+      assert.deepEqual(m1.setMany(["6", "1", "0"], ["f", "z", "y"]).toObject(), {"0": "y", "1": "z", "2": "b", "3": "c", "4": "d", "5": "e", "6": "f"});
+      assert.deepEqual(m4.setMany(new Float64Array([2, 1]), new Float64Array([0.5, 1.5])).keys(), [1, 2]);
+      assert.equal(m4.get(1), 1.5);
+    });
+
+    it("should keep the last value of a key given more than once", function() {
+      assert.deepEqual(m4.setMany(["a", "b", "a"], [1, 2, 3]).toObject(), {"a": 3, "b": 2});
+    });
+
+    it("should throw error if not given two arrays of the same length", function() {
+      assert.throws(function() {
+        m1.setMany(["1"]);
+      }, Error);
+      assert.throws(function() {
+        m1.setMany(["1", "2"], ["a"]);
+      }, Error);
+      assert.throws(function() {
+        m1.setMany("1", "a");
+      }, Error);
+    });
   });
 
   describe("#size", function() {
@@ -489,6 +793,51 @@ describe('Map', function() {
     });
   });
 
+  describe("#snapshot", function() {
+    it("should return a map with the same entries", function() {
+      assert.deepEqual(m1.snapshot().toObject(), o1);
+      assert.deepEqual(m4.snapshot().toObject(), o4);
+      assert.equal(m2.snapshot().get("9"), "i");
+    });
+
+    it("should not be affected by changes to the original map", function() {
+      var snapshot = m1.snapshot();
+      m1.set("1", "z").remove("3");
+      assert.deepEqual(snapshot.toObject(), o1);
+    });
+
+    it("should throw error if the snapshot is modified", function() {
+      var snapshot = m1.snapshot();
+      assert.throws(function() {
+        snapshot.set("1", "z");
+      }, Error);
+      assert.throws(function() {
+        snapshot.setAll({"6": "f"});
+      }, Error);
+      assert.throws(function() {
+        snapshot.remove("1");
+      }, Error);
+      assert.throws(function() {
+        snapshot.clear();
+      }, Error);
+      assert.throws(function() {
+        snapshot.removeAt(0);
+      }, Error);
+      assert.deepEqual(snapshot.toObject(), o1);
+    });
+
+    it("should return a map that can be modified when cloned", function() {
+      var clone = m1.snapshot().clone();
+      assert.deepEqual(clone.set("6", "f").size(), 6);
+    });
+
+    it("should throw error if argument is provided", function() {
+      assert.throws(function() {
+        m1.snapshot(1);
+      }, Error);
+    });
+  });
+
   describe("#toArray", function() {
     it("should convert a set into an array", function() {
       assert.equal(m1.toArray().toString(), '{"key":"1","value":"a"},{"key":"2","value":"b"},{"key":"3","value":"c"},{"key":"4","value":"d"},{"key":"5","value":"e"}');
@@ -498,6 +847,20 @@ describe('Map', function() {
     });
   });
 
+  describe("#toJSON", function() {
+    it("should let JSON.stringify() write the maps as objects", function() {
+      assert.equal(JSON.stringify([m1, m4]), '[{"1":"a","2":"b","3":"c","4":"d","5":"e"},{}]');
+      assert.deepEqual(m3.toJSON(), o3);
+    });
+  });
+
+  describe("#toJSONBuffer", function() {
+    it("should return the text of toString() in a buffer", function() {
+      assert(Buffer.isBuffer(m1.toJSONBuffer()));
+      assert.equal(m2.toJSONBuffer().toString(), m2.toString());
+    });
+  });
+
   describe("#toObject", function() {
     it("should return arrays for the sets", function() {
       assert.deepEqual(m1.toObject(), o1);
@@ -526,10 +889,34 @@ describe('Map', function() {
       assert.equal(m4.toString(), '{}');
     });
 
+    it("should write keys and values of every type as JSON.stringify() does with toObject()", function() {
+      var m = new Map();
+      m.set(20, "a").set("b", 1.5).set("10", [1]).set(1, undefined).set(-1, null).set(0.5, true).set("1", "e");
+      m.set(4294967295, "f").set(undefined, "g").set(null, "h").set("__proto__", "i").set("x", function() {});
+      m.set("\u0001\"", new Date(0)).set(NaN, Infinity);
+      assert.equal(m.toString(), JSON.stringify(m.toObject()));
+      assert.equal(new Map({k: new Vector([1]), m: new Map({a: 2})}).toString(), '{"k":[1],"m":{"a":2}}');
+    });
+
+    it("should write one property for keys of different types with the same name", function() {
+      var m = new Map().set(0, "a").set(-0, "b").set(true, "c").set(new Boolean(true), "d");
+      m.set(1, "e").set(new Number(1), "f");
+      assert.equal(m.toString(), JSON.stringify(m.toObject()));
+      assert.equal(JSON.stringify(m), m.toString());
+    });
+
     it("should throw error if argument is provided", function() {
       assert.throws(function() {
         m1.toString("abc");
       }, Error);
     });
   });
+
+  describe("#writeJSON", function() {
+    it("should hand the text of toString() to a function in chunks", function() {
+      var chunks = [];
+      assert.equal(m1.writeJSON(function(chunk) { chunks.push(chunk); }), m1.toString().length);
+      assert.equal(Buffer.concat(chunks).toString(), m1.toString());
+    });
+  });
 });
@@ -0,0 +1,128 @@
+"use strict";
+
+var assert = require("assert"),
+    MultiMap = require("../lib/collection").MultiMap,
+    Vector = require("../lib/collection").Vector;
+
+describe('MultiMap', function() {
+  var m1;
+
+  beforeEach(function() {
+    m1 = new MultiMap();
+    m1.add(1, "a", "b").add(2, "c").add(1, "d");
+  });
+
+  describe("#new", function() {
+    it("should copy multimaps", function() {
+      var m = new MultiMap(m1);
+      assert(m.equals(m1));
+      m.add(1, "e");
+      assert.equal(m1.count(1), 3);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new MultiMap({});
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should add values after existing ones", function() {
+      assert.deepEqual(m1.add(3, "e").add(2, "c").toObject(), {1: ["a", "b", "d"], 2: ["c", "c"], 3: ["e"]});
+    });
+
+    it("should throw error if no value is given", function() {
+      assert.throws(function() {
+        m1.add(1);
+      }, Error);
+    });
+
+    it("should not allow modification while values are iterated", function() {
+      assert.throws(function() {
+        m1.get(1).each(function() {
+          m1.add(1, "x");
+        });
+      }, Error);
+    });
+  });
+
+  describe("#count", function() {
+    it("should count values of keys", function() {
+      assert.equal(m1.count(1), 3);
+      assert.equal(m1.count(3), 0);
+    });
+  });
+
+  describe("#each", function() {
+    it("should pass entries with vectors of values", function() {
+      var sizes = [];
+      m1.each(function(entry) {
+        sizes.push([entry.key(), entry.value().size()]);
+      });
+      assert.deepEqual(sizes, [[1, 3], [2, 1]]);
+    });
+  });
+
+  describe("#get", function() {
+    it("should get the vector of values of a key", function() {
+      assert(m1.get(1) instanceof Vector);
+      assert.deepEqual(m1.get(1).toArray(), ["a", "b", "d"]);
+      assert.equal(m1.get(3), undefined);
+    });
+
+    it("should share the vector with the multimap", function() {
+      m1.get(2).add("x");
+      assert.deepEqual(m1.get(2).toArray(), ["c", "x"]);
+      assert.equal(m1.count(2), 2);
+    });
+
+    it("should compare the vector again after values of the key are added or removed", function() {
+      var values = m1.get(1);
+      assert(values.equals(new Vector(["a", "b", "d"])));
+      m1.add(1, "e");
+      assert(values.equals(new Vector(["a", "b", "d", "e"])));
+      m1.removeValue(1, "a");
+      assert(values.equals(new Vector(["b", "d", "e"])));
+    });
+
+    it("should find keys that are arrays", function() {
+      m1.add([1, 2], "x");
+      assert.deepEqual(m1.get([1, 2]).toArray(), ["x"]);
+    });
+  });
+
+  describe("#keys", function() {
+    it("should get keys in the order they were first added", function() {
+      assert.deepEqual(m1.keys(), [1, 2]);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove keys with all their values", function() {
+      assert.deepEqual(m1.remove(1, 3).keys(), [2]);
+    });
+  });
+
+  describe("#removeValue", function() {
+    it("should remove the first equal value", function() {
+      m1.add(1, "a");
+      assert(m1.removeValue(1, "a"));
+      assert.deepEqual(m1.get(1).toArray(), ["b", "d", "a"]);
+      assert(!m1.removeValue(1, "x"));
+      assert(!m1.removeValue(3, "a"));
+    });
+
+    it("should remove keys with their last value", function() {
+      assert(m1.removeValue(2, "c"));
+      assert.deepEqual(m1.keys(), [1]);
+    });
+  });
+
+  describe("#toObject", function() {
+    it("should convert the multimaps into objects", function() {
+      assert.deepEqual(m1.toObject(), {1: ["a", "b", "d"], 2: ["c"]});
+      assert.equal(m1.toString(), '{"1":["a","b","d"],"2":["c"]}');
+    });
+  });
+});
@@ -0,0 +1,140 @@
+"use strict";
+
+var assert = require("assert"),
+    MultiSet = require("../lib/collection").MultiSet,
+    Vector = require("../lib/collection").Vector;
+
+describe('MultiSet', function() {
+  var m1;
+
+  beforeEach(function() {
+    m1 = new MultiSet(["a", "b", "a", "c", "a", "b"]);
+  });
+
+  describe("#new", function() {
+    it("should create multisets", function() {
+      assert.equal(new MultiSet().size(), 0);
+      assert.deepEqual(new MultiSet(m1).toObject(), {a: 3, b: 2, c: 1});
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new MultiSet(1);
+      }, Error);
+      assert.throws(function() {
+        new MultiSet([], []);
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should count values", function() {
+      assert.deepEqual(m1.add("c").add("d", 5).toObject(), {a: 3, b: 2, c: 2, d: 5});
+      assert.equal(m1.size(), 13);
+      assert.equal(m1.distinctSize(), 4);
+    });
+
+    it("should count equal arrays and collections as one value", function() {
+      var m = new MultiSet();
+      m.add([1, [2]]).add([1, [2]], 2).add(new Vector([3])).add(new Vector([3]));
+      assert.equal(m.count([1, [2]]), 3);
+      assert.equal(m.count(new Vector([3])), 2);
+      assert.equal(m.distinctSize(), 2);
+    });
+
+    it("should throw error if count is not a positive integer", function() {
+      assert.throws(function() {
+        m1.add("a", 0);
+      }, Error);
+      assert.throws(function() {
+        m1.add("a", 1.5);
+      }, Error);
+      assert.throws(function() {
+        m1.add();
+      }, Error);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should count each value of an array once", function() {
+      assert.deepEqual(m1.addAll(["c", "d", "c"]).toObject(), {a: 3, b: 2, c: 3, d: 1});
+    });
+  });
+
+  describe("#clear", function() {
+    it("should remove all values", function() {
+      assert.equal(m1.clear().size(), 0);
+      assert.equal(m1.distinctSize(), 0);
+      assert.equal(m1.add("a").size(), 1);
+    });
+  });
+
+  describe("#count", function() {
+    it("should count occurrences", function() {
+      assert.equal(m1.count("a"), 3);
+      assert.equal(m1.count("x"), 0);
+      assert.equal(m1.count(1), 0);
+    });
+  });
+
+  describe("#each", function() {
+    it("should go through distinct values in the order they were first added", function() {
+      var values = [];
+      m1.each(function(v) {
+        values.push(v);
+      });
+      assert.deepEqual(values, ["a", "b", "c"]);
+    });
+
+    it("should not allow modification during iteration", function() {
+      assert.throws(function() {
+        m1.each(function() {
+          m1.add("d");
+        });
+      }, Error);
+    });
+  });
+
+  describe("#equals", function() {
+    it("should compare counts regardless of order", function() {
+      assert(m1.equals(new MultiSet(["c", "b", "b", "a", "a", "a"])));
+      assert(!m1.equals(new MultiSet(["a", "b", "c"])));
+      assert(!m1.equals(["a", "b", "c"]));
+    });
+  });
+
+  describe("#mostCommon", function() {
+    it("should get values in descending count", function() {
+      assert.deepEqual(m1.mostCommon(2), [["a", 3], ["b", 2]]);
+      assert.deepEqual(m1.mostCommon(), [["a", 3], ["b", 2], ["c", 1]]);
+      assert.deepEqual(m1.mostCommon(0), []);
+    });
+
+    it("should keep values of equal count in the order they were first added", function() {
+      var m = new MultiSet(["x", "y", "z", "y", "z", "w"]);
+      assert.deepEqual(m.mostCommon(3), [["y", 2], ["z", 2], ["x", 1]]);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove occurrences", function() {
+      assert.deepEqual(m1.remove("a").remove("b", 5).remove("x").toObject(), {a: 2, c: 1});
+      assert.equal(m1.size(), 3);
+      assert(!m1.has("b"));
+    });
+  });
+
+  describe("#size", function() {
+    it("should count all occurrences", function() {
+      assert.equal(m1.size(), 6);
+      assert.equal(m1.distinctSize(), 3);
+    });
+  });
+
+  describe("#toArray", function() {
+    it("should convert the multisets into arrays of distinct values", function() {
+      assert.deepEqual(m1.toArray(), ["a", "b", "c"]);
+      assert.equal(m1.toString(), '{"a":3,"b":2,"c":1}');
+    });
+  });
+});
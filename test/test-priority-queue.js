@@ -0,0 +1,171 @@
+"use strict";
+
+var assert = require("assert"),
+    PriorityQueue = require("../lib/collection").PriorityQueue;
+
+describe('PriorityQueue', function() {
+  var q1, q2, h;
+
+  beforeEach(function() {
+    q1 = new PriorityQueue([5, 3, "b", 8, 1, "a", 3]);
+    q2 = new PriorityQueue([{name: "b", p: 2}, {name: "c", p: 3}], {priority: "p"});
+    h = q2.push({name: "a", p: 1});
+  });
+
+  function drain(q) {
+    var result = [];
+    while (!q.isEmpty()) {
+      result.push(q.pop());
+    }
+    return result;
+  }
+
+  function names(q) {
+    return drain(q).map(function(v) { return v.name; });
+  }
+
+  describe("#new", function() {
+    it("should create queues", function() {
+      assert.equal(new PriorityQueue().size(), 0);
+      assert.equal(q1.size(), 7);
+      assert.equal(new PriorityQueue({priority: true}).size(), 0);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new PriorityQueue(1);
+      }, Error);
+      assert.throws(function() {
+        new PriorityQueue([], {priority: 1});
+      }, Error);
+      assert.throws(function() {
+        new PriorityQueue([{name: "x"}], {priority: "p"});
+      }, Error);
+    });
+  });
+
+  describe("#pop", function() {
+    it("should pop values smallest first", function() {
+      assert.deepEqual(drain(q1), [1, 3, 3, 5, 8, "a", "b"]);
+      assert.equal(q1.pop(), undefined);
+    });
+
+    it("should pop values of equal priority in the order they were pushed", function() {
+      var q = new PriorityQueue({priority: true});
+      q.push("x", 1);
+      q.push("y", 0);
+      q.push("z", 1);
+      q.push("w", 0);
+      assert.deepEqual(drain(q), ["y", "w", "x", "z"]);
+    });
+
+    it("should order many values", function() {
+      var q = new PriorityQueue({priority: true}), values = [];
+      for (var i = 0; i < 1000; i++) {
+        var p = (i * 7919) % 1000;
+        values.push(p);
+        q.push(p, p);
+      }
+      values.sort(function(a, b) { return a - b; });
+      assert.deepEqual(drain(q), values);
+    });
+
+    it("should not allow modification during iteration", function() {
+      assert.throws(function() {
+        q1.each(function() {
+          q1.pop();
+        });
+      }, Error);
+    });
+  });
+
+  describe("#peek", function() {
+    it("should get the smallest value without removing it", function() {
+      assert.equal(q1.peek(), 1);
+      assert.equal(q2.peek().name, "a");
+      assert.equal(q2.size(), 3);
+      assert.equal(new PriorityQueue().peek(), undefined);
+    });
+  });
+
+  describe("#push", function() {
+    it("should read priorities from fields or take them as arguments", function() {
+      q2.push({name: "z"}, 0);
+      q2.push({name: "y", p: 5});
+      assert.deepEqual(names(q2), ["z", "a", "b", "c", "y"]);
+    });
+
+    it("should throw error if a priority is missing or not expected", function() {
+      assert.throws(function() {
+        q2.push({name: "x"});
+      }, Error);
+      assert.throws(function() {
+        q2.push({name: "x"}, NaN);
+      }, Error);
+      assert.throws(function() {
+        q1.push(1, 1);
+      }, Error);
+    });
+  });
+
+  describe("#pushPop", function() {
+    it("should push then pop", function() {
+      assert.equal(q1.pushPop(0), 0);
+      assert.equal(q1.size(), 7);
+      assert.equal(q1.pushPop(4), 1);
+      assert.deepEqual(drain(q1), [3, 3, 4, 5, 8, "a", "b"]);
+      assert.equal(new PriorityQueue().pushPop(1), 1);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove values by handle", function() {
+      assert(q2.remove(h));
+      assert(!q2.remove(h));
+      var h2 = q2.push({name: "d", p: 4});
+      assert(!q2.remove(h));
+      assert.deepEqual(names(q2), ["b", "c", "d"]);
+      assert(!q2.remove(h2));
+    });
+  });
+
+  describe("#updatePriority", function() {
+    it("should move values to their new position", function() {
+      assert(q2.updatePriority(h, 10));
+      assert.deepEqual(names(q2), ["b", "c", "a"]);
+    });
+
+    it("should read priorities again from fields", function() {
+      var value = {name: "d", p: 4}, h2 = q2.push(value);
+      value.p = 0;
+      assert(q2.updatePriority(h2));
+      assert.equal(q2.peek().name, "d");
+    });
+
+    it("should return false for handles of removed values", function() {
+      q2.pop();
+      assert(!q2.updatePriority(h, 0));
+    });
+  });
+
+  describe("#heapify", function() {
+    it("should add values in bulk", function() {
+      q1.heapify([0, 9, 2]);
+      assert.deepEqual(drain(q1), [0, 1, 2, 3, 3, 5, 8, 9, "a", "b"]);
+    });
+  });
+
+  describe("#toArray", function() {
+    it("should convert the queues into sorted arrays", function() {
+      assert.deepEqual(q1.toArray(), [1, 3, 3, 5, 8, "a", "b"]);
+      assert.equal(q1.size(), 7);
+      assert.equal(q1.toString(), '[1,3,3,5,8,"a","b"]');
+    });
+  });
+
+  describe("#has", function() {
+    it("should find values", function() {
+      assert.deepEqual(q1.has(3, 4, "a"), [true, false, true]);
+    });
+  });
+});
@@ -0,0 +1,135 @@
+"use strict";
+
+var assert = require("assert"),
+    QuantileSketch = require("../lib/collection").QuantileSketch;
+
+describe('QuantileSketch', function() {
+  var s1, large;
+
+  beforeEach(function() {
+    s1 = new QuantileSketch();
+    s1.add(5, 1, 4, 2, 3);
+    large = new QuantileSketch();
+    var numbers = new Float64Array(100000);
+    for (var i = 0; i < numbers.length; i++) {
+      numbers[i] = (i * 7919) % 100000;
+    }
+    large.addAll(numbers);
+  });
+
+  describe("#new", function() {
+    it("should create sketches", function() {
+      assert.equal(new QuantileSketch().size(), 0);
+      assert.equal(new QuantileSketch(200).size(), 0);
+      var s2 = new QuantileSketch(s1.toBuffer());
+      assert.equal(s2.size(), 5);
+      assert.equal(s2.quantile(0.5), 3);
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new QuantileSketch(10);
+      }, Error);
+      assert.throws(function() {
+        new QuantileSketch("100");
+      }, Error);
+      assert.throws(function() {
+        new QuantileSketch(new Buffer([1, 2, 3]));
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should add numbers and dates", function() {
+      var s = new QuantileSketch().add(new Date(10), 20);
+      assert.equal(s.size(), 2);
+      assert.equal(s.quantile(0), 10);
+    });
+
+    it("should throw error if values are not finite numbers or dates", function() {
+      assert.throws(function() {
+        s1.add(NaN);
+      }, Error);
+      assert.throws(function() {
+        s1.add(Infinity);
+      }, Error);
+      assert.throws(function() {
+        s1.add("1");
+      }, Error);
+      assert.equal(s1.size(), 5);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should add arrays and Float64Arrays", function() {
+      s1.addAll([6, 7]).addAll(new Float64Array([8, 9]));
+      assert.equal(s1.size(), 9);
+      assert.equal(s1.quantile(1), 9);
+    });
+
+    it("should throw error if a number is not finite", function() {
+      assert.throws(function() {
+        s1.addAll(new Float64Array([1, NaN]));
+      }, Error);
+      assert.equal(s1.size(), 5);
+    });
+  });
+
+  describe("#cdf", function() {
+    it("should estimate the fraction of values up to a value", function() {
+      assert.equal(s1.cdf(0), 0);
+      assert.equal(s1.cdf(5), 1);
+      assert(Math.abs(large.cdf(25000) - 0.25) < 0.005);
+      assert.equal(new QuantileSketch().cdf(1), undefined);
+    });
+  });
+
+  describe("#clear", function() {
+    it("should remove all values", function() {
+      assert.equal(s1.clear().size(), 0);
+      assert.equal(s1.quantile(0.5), undefined);
+    });
+  });
+
+  describe("#merge", function() {
+    it("should merge sketches", function() {
+      var s2 = new QuantileSketch().add(6, 7, 8, 9, 10);
+      assert.equal(s1.merge(s2).size(), 10);
+      assert.deepEqual(s1.quantile(0, 1), [1, 10]);
+      assert(Math.abs(s1.quantile(0.5) - 5.5) < 0.5);
+    });
+
+    it("should throw error if argument is not a sketch", function() {
+      assert.throws(function() {
+        s1.merge([1]);
+      }, Error);
+    });
+  });
+
+  describe("#quantile", function() {
+    it("should get quantiles of small sketches exactly", function() {
+      assert.deepEqual(s1.quantile(0, 0.5, 1), [1, 3, 5]);
+    });
+
+    it("should estimate quantiles of large sketches", function() {
+      [0.001, 0.01, 0.5, 0.9, 0.99, 0.999].forEach(function(q) {
+        assert(Math.abs(large.quantile(q) - q * 100000) < 100000 * 0.005, "quantile " + q);
+      });
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        s1.quantile(1.5);
+      }, Error);
+      assert.throws(function() {
+        s1.quantile();
+      }, Error);
+    });
+  });
+
+  describe("#toBuffer", function() {
+    it("should take a bounded amount of memory", function() {
+      assert(large.toBuffer().length < 200 * 16);
+    });
+  });
+});
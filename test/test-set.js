@@ -96,6 +96,56 @@ describe('Set', function() {
     });
   });
 
+  describe("#clone", function() {
+    it("should return a set with the same elements", function() {
+      assert.deepEqual(s1.clone().toArray(), array1);
+      assert.deepEqual(s3.clone().toArray(), array3);
+      assert(s2.clone().equals(s2));
+    });
+
+    it("should not be affected by changes to the original set", function() {
+      var clone = s1.clone();
+      s1.add(11).remove(1).removeLast();
+      assert.deepEqual(clone.toArray(), array1);
+      s1.clear();
+      assert.deepEqual(clone.toArray(), array1);
+    });
+
+    it("should not affect the original set when changed", function() {
+      var clone = s2.clone();
+      clone.add("xyz").remove("abc");
+      assert.deepEqual(clone.toArray(), ["def","g","xyz"]);
+      assert.deepEqual(s2.toArray(), array2);
+    });
+
+    it("should throw error if argument is provided", function() {
+      assert.throws(function() {
+        s1.clone(1);
+      }, Error);
+    });
+  });
+
+  describe("#drainTo", function() {
+    it("should move all the elements to the target and leave the set empty", function() {
+      var target = new Set([0, 1]);
+      s1.drainTo(target);
+      assert.deepEqual(target.toArray(), [0].concat(array1));
+      assert(s1.isEmpty());
+      var vector = new Vector();
+      s2.drainTo(vector);
+      assert.deepEqual(vector.toArray(), array2);
+      assert(s2.isEmpty());
+    });
+
+    it("should throw error if the target is a snapshot", function() {
+      var snapshot = s3.snapshot();
+      assert.throws(function() {
+        s1.drainTo(snapshot);
+      }, Error);
+      assert.deepEqual(s1.toArray(), array1);
+    });
+  });
+
   describe("#each", function() {
     it("should go through all the elements in the sets", function() {
       var i1 = 0;
@@ -297,6 +347,40 @@ describe('Set', function() {
     it("should not equalize distinct double numbers", function() {
       assert(!(new Set([1.1]).has(1.2)));
     });
+
+    it("should find primitives by value", function() {
+      var s = new Set([new Date(1000), "caf\u00e9", "", null, undefined, false]);
+      assert(s.has(new Date(1000)));
+      assert(!s.has(new Date(1001)));
+      assert(s.has("caf" + "\u00e9"));
+      assert(s.has(""));
+      assert(s.has(null, undefined, false), [true, true, true]);
+      assert(!s.has(true));
+    });
+  });
+
+  describe("#hasMany", function() {
+    it("should return a Uint8Array that tells which values exist", function() {
+      var result = s1.hasMany([10, 0, 3, "3", 3, 11]);
+      assert(result instanceof Uint8Array);
+      assert.deepEqual(Array.prototype.slice.call(result), [1, 0, 1, 0, 1, 0]);
+      assert.equal(s3.hasMany([1, 2]).length, 2);
+      assert.equal(s1.hasMany([]).length, 0);
+    });
+
+    it("should accept typed arrays", function() {
+      var result = s1.hasMany(new Float64Array([2.5, 9, 1]));
+      assert.deepEqual(Array.prototype.slice.call(result), [0, 1, 1]);
+    });
+
+    it("should throw error if not given an array", function() {
+      assert.throws(function() {
+        s1.hasMany(1, 2);
+      }, Error);
+      assert.throws(function() {
+        s1.hasMany(s1);
+      }, Error);
+    });
   });
 
   describe("#index", function() {
@@ -327,6 +411,50 @@ describe('Set', function() {
     });
   });
 
+  describe("#moveFrom", function() {
+    it("should move all the elements of the source and leave it empty", function() {
+      var source = new Set(array1);
+      assert.deepEqual(s3.moveFrom(source).toArray(), array1);
+      assert(source.isEmpty());
+      assert.deepEqual(s1.moveFrom(new Vector([11, 1, [1]])).toArray(), array1.concat([11, [1]]));
+    });
+
+    it("should not affect clones of the source", function() {
+      var clone = s1.clone();
+      s3.moveFrom(s1);
+      assert.deepEqual(s3.toArray(), array1);
+      assert.deepEqual(clone.toArray(), array1);
+      assert(s1.isEmpty());
+    });
+
+    it("should throw error if the source is a snapshot", function() {
+      assert.throws(function() {
+        s3.moveFrom(s1.snapshot());
+      }, Error);
+    });
+  });
+
+  describe("#profile", function() {
+    it("should return counters if profiling is compiled in", function() {
+      var profile = s1.profile();
+      if (profile === undefined) {
+        return;
+      }
+      s1.has(3);
+      profile = s1.profile(true);
+      assert.equal(profile.calls.has, 1);
+      assert.ok(profile.lookups >= 1);
+      assert.ok(profile.comparisons >= 1);
+      assert.equal(s1.profile().calls.has, undefined);
+    });
+
+    it("should throw error if argument is not a boolean", function() {
+      assert.throws(function() {
+        s1.profile("abc");
+      }, Error);
+    });
+  });
+
   describe("#reduce", function() {
     it("should reduce a set into a single value", function() {
       assert.equal(s1.reduce(function(memo, v) {
@@ -482,6 +610,42 @@ describe('Set', function() {
     });
   });
 
+  describe("#snapshot", function() {
+    it("should return a set with the same elements", function() {
+      assert.deepEqual(s1.snapshot().toArray(), array1);
+      assert.deepEqual(s3.snapshot().toArray(), array3);
+    });
+
+    it("should not be affected by changes to the original set", function() {
+      var snapshot = s1.snapshot();
+      s1.add(11).removeRange(0, 5);
+      assert.deepEqual(snapshot.toArray(), array1);
+    });
+
+    it("should throw error if the snapshot is modified", function() {
+      var snapshot = s1.snapshot();
+      assert.throws(function() {
+        snapshot.add(11);
+      }, Error);
+      assert.throws(function() {
+        snapshot.addAll([11, 12]);
+      }, Error);
+      assert.throws(function() {
+        snapshot.remove(1);
+      }, Error);
+      assert.throws(function() {
+        snapshot.removeLast();
+      }, Error);
+      assert.deepEqual(snapshot.toArray(), array1);
+    });
+
+    it("should throw error if argument is provided", function() {
+      assert.throws(function() {
+        s1.snapshot(1);
+      }, Error);
+    });
+  });
+
   describe("#toArray", function() {
     it("should return arrays for the sets", function() {
       assert.deepEqual(s1.toArray(), array1);
@@ -0,0 +1,169 @@
+"use strict";
+
+var assert = require("assert"),
+    Set = require("../lib/collection").Set,
+    SortedVector = require("../lib/collection").SortedVector,
+    Vector = require("../lib/collection").Vector;
+
+describe('SortedVector', function() {
+  var v1, v2, v3;
+
+  beforeEach(function() {
+    v1 = new SortedVector([5,3,9,1,7,3]);
+    v2 = new SortedVector(["g","abc","def"]);
+    v3 = new SortedVector();
+  });
+
+  describe("#new", function() {
+    it("should sort the values it is created with", function() {
+      assert.deepEqual(v1.toArray(), [1,3,3,5,7,9]);
+      assert.deepEqual(v2.toArray(), ["abc","def","g"]);
+      assert.deepEqual(v3.toArray(), []);
+      assert.deepEqual(new SortedVector(new Vector([2,1,2])).toArray(), [1,2,2]);
+      assert.deepEqual(new SortedVector(new Set([2,1])).toArray(), [1,2]);
+      assert.deepEqual(new SortedVector(v1).toArray(), [1,3,3,5,7,9]);
+    });
+
+    it("should sort values of different types in the order of a set", function() {
+      assert.deepEqual(new SortedVector(["a",2,null,1,"b",undefined]).toArray(), new Set(["a",2,null,1,"b",undefined]).toArray());
+    });
+
+    it("should throw error if argument is not an array or a collection", function() {
+      assert.throws(function() {
+        new SortedVector(1);
+      }, Error);
+      assert.throws(function() {
+        new SortedVector([], []);
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should insert values in sorted order", function() {
+      assert.deepEqual(v1.add(4,0,10,3).toArray(), [0,1,3,3,3,4,5,7,9,10]);
+      assert.deepEqual(v3.add("b","a").add("c").toArray(), ["a","b","c"]);
+    });
+
+    it("should throw error if argument is not provided", function() {
+      assert.throws(function() {
+        v1.add();
+      }, Error);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should merge the values of an array or a collection", function() {
+      assert.deepEqual(v1.addAll([8,2,2]).toArray(), [1,2,2,3,3,5,7,8,9]);
+      assert.deepEqual(v1.addAll(new Set([10,11])).toArray(), [1,2,2,3,3,5,7,8,9,10,11]);
+      assert.deepEqual(v3.addAll(new Vector([3,1])).toArray(), [1,3]);
+      assert.deepEqual(v3.addAll(v3).toArray(), [1,1,3,3]);
+    });
+
+    it("should throw error if argument is not an array or a collection", function() {
+      assert.throws(function() {
+        v1.addAll(1);
+      }, Error);
+      assert.throws(function() {
+        v1.addAll();
+      }, Error);
+    });
+  });
+
+  describe("#binarySearch", function() {
+    it("should return the index of an equal element", function() {
+      assert.equal(v1.binarySearch(1), 0);
+      assert.equal(v1.binarySearch(9), 5);
+      assert.equal(v2.binarySearch("def"), 1);
+    });
+
+    it("should return -(insertion point) - 1 for a missing value", function() {
+      assert.equal(v1.binarySearch(0), -1);
+      assert.equal(v1.binarySearch(4), -4);
+      assert.equal(v1.binarySearch(10), -7);
+      assert.equal(v1.binarySearch("1"), -7);
+      assert.equal(v3.binarySearch(1), -1);
+    });
+
+    it("should throw error if not exactly one argument is given", function() {
+      assert.throws(function() {
+        v1.binarySearch();
+      }, Error);
+    });
+  });
+
+  describe("#equalRange", function() {
+    it("should return the range of equal elements", function() {
+      assert.deepEqual(v1.equalRange(3), [1,3]);
+      assert.deepEqual(v1.equalRange(4), [3,3]);
+      assert.deepEqual(v1.equalRange(10), [6,6]);
+    });
+  });
+
+  describe("#has", function() {
+    it("should tell whether values exist", function() {
+      assert(v1.has(7));
+      assert(!v1.has(8));
+      assert.deepEqual(v1.has(1, 2, 3), [true, false, true]);
+    });
+  });
+
+  describe("#index", function() {
+    it("should return the index of the first equal element", function() {
+      assert.equal(v1.index(3), 1);
+      assert.equal(v1.index(4), undefined);
+      assert.deepEqual(v1.index(9, 5), [5, 3]);
+    });
+  });
+
+  describe("#lowerBound", function() {
+    it("should return the index of the first element not less than the value", function() {
+      assert.equal(v1.lowerBound(3), 1);
+      assert.equal(v1.lowerBound(4), 3);
+      assert.equal(v1.lowerBound(0), 0);
+      assert.equal(v1.lowerBound(100), 6);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove one equal element for each value", function() {
+      assert.deepEqual(v1.remove(3, 4, 9).toArray(), [1,3,5,7]);
+      assert.deepEqual(v1.remove(3, 3).toArray(), [1,5,7]);
+    });
+
+    it("should throw error if argument is not provided", function() {
+      assert.throws(function() {
+        v1.remove();
+      }, Error);
+    });
+  });
+
+  describe("#removeAt", function() {
+    it("should keep the remaining elements sorted", function() {
+      assert.deepEqual(v1.removeAt(0, 1).toArray(), [3,5,7,9]);
+    });
+  });
+
+  describe("#sortedInsert", function() {
+    it("should insert a value after the equal elements and return its index", function() {
+      assert.equal(v1.sortedInsert(3), 3);
+      assert.equal(v1.sortedInsert(0), 0);
+      assert.equal(v1.sortedInsert(20), 8);
+      assert.deepEqual(v1.toArray(), [0,1,3,3,3,5,7,9,20]);
+    });
+
+    it("should throw error if not exactly one argument is given", function() {
+      assert.throws(function() {
+        v1.sortedInsert(1, 2);
+      }, Error);
+    });
+  });
+
+  describe("#upperBound", function() {
+    it("should return the index of the first element greater than the value", function() {
+      assert.equal(v1.upperBound(3), 3);
+      assert.equal(v1.upperBound(4), 3);
+      assert.equal(v1.upperBound(9), 6);
+      assert.equal(v1.upperBound(0), 0);
+    });
+  });
+});
@@ -0,0 +1,130 @@
+"use strict";
+
+var assert = require("assert"),
+    Map = require("../lib/collection").Map,
+    StringMap = require("../lib/collection").StringMap;
+
+describe('StringMap', function() {
+  var routes, m1;
+
+  beforeEach(function() {
+    routes = {"/": "root", "/api": "api", "/api/v1": "v1", "/api/v1/users": ["users"], "/static": 5};
+    m1 = new StringMap(routes);
+  });
+
+  describe("#new", function() {
+    it("should create string maps", function() {
+      assert.equal(new StringMap().size(), 0);
+      assert.equal(m1.size(), 5);
+      assert(new StringMap(m1).equals(m1));
+      assert.deepEqual(new StringMap(m1).toObject(), m1.toObject());
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new StringMap(1);
+      }, Error);
+    });
+  });
+
+  describe("#each", function() {
+    it("should go through entries in the order of a map", function() {
+      var keys = [];
+      m1.each(function(entry) {
+        keys.push(entry.key());
+        assert.deepEqual(entry.value(), routes[entry.key()]);
+      });
+      assert.deepEqual(keys, new Map(routes).keys());
+    });
+  });
+
+  describe("#get", function() {
+    it("should get the values of keys", function() {
+      assert.equal(m1.get("/api"), "api");
+      assert.deepEqual(m1.get("/api/v1/users"), ["users"]);
+      assert.equal(m1.get("/api/v"), undefined);
+      assert.equal(m1.get(1), undefined);
+      assert.deepEqual(m1.get("/", "/static"), ["root", 5]);
+    });
+  });
+
+  describe("#getAt", function() {
+    it("should get entries by index", function() {
+      assert.equal(m1.getAt(1).key(), "/api");
+      assert.equal(m1.getAt(5), undefined);
+    });
+  });
+
+  describe("#has", function() {
+    it("should check whether keys are in the map", function() {
+      assert(m1.has("/api/v1"));
+      assert(!m1.has("/api/v2"));
+    });
+  });
+
+  describe("#hasPrefix", function() {
+    it("should check whether any key starts with a prefix", function() {
+      assert(m1.hasPrefix("/api/v1/u"));
+      assert(!m1.hasPrefix("/api/v2"));
+    });
+  });
+
+  describe("#keys", function() {
+    it("should get keys in order", function() {
+      assert.deepEqual(m1.keys(), ["/", "/api", "/api/v1", "/api/v1/users", "/static"]);
+    });
+  });
+
+  describe("#keysWithPrefix", function() {
+    it("should get the keys that start with a prefix in order", function() {
+      assert.deepEqual(m1.keysWithPrefix("/api/"), ["/api/v1", "/api/v1/users"]);
+      assert.deepEqual(m1.keysWithPrefix("/b"), []);
+    });
+  });
+
+  describe("#longestPrefixMatch", function() {
+    it("should find the entry with the longest key that a string starts with", function() {
+      var entry = m1.longestPrefixMatch("/api/v1/orders/3");
+      assert.equal(entry.key(), "/api/v1");
+      assert.equal(entry.value(), "v1");
+      assert.equal(m1.longestPrefixMatch("/index.html").value(), "root");
+      assert.equal(m1.longestPrefixMatch("index.html"), undefined);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove keys and keep the others", function() {
+      m1.remove("/api", "/api/v1/users", "/nothing");
+      assert.deepEqual(m1.toObject(), {"/": "root", "/api/v1": "v1", "/static": 5});
+      assert.equal(m1.longestPrefixMatch("/api/v2").key(), "/");
+    });
+  });
+
+  describe("#set", function() {
+    it("should set values of keys", function() {
+      assert.equal(m1.set("/api", "API").set("/api/v2", 2).get("/api"), "API");
+      assert.equal(m1.size(), 6);
+      assert.equal(m1.get("/api/v2"), 2);
+    });
+
+    it("should throw error if key is not a string", function() {
+      assert.throws(function() {
+        m1.set(1, "a");
+      }, Error);
+    });
+  });
+
+  describe("#setAll", function() {
+    it("should set the entries of objects and string maps", function() {
+      m1.setAll({"/a": 1}).setAll(new StringMap({"/b": 2, "/": 3}));
+      assert.deepEqual(m1.get("/a", "/b", "/"), [1, 2, 3]);
+    });
+  });
+
+  describe("#toObject", function() {
+    it("should convert the map into an object", function() {
+      assert.deepEqual(m1.toObject(), routes);
+      assert.equal(m1.toString(), JSON.stringify(new Map(routes).toObject()));
+    });
+  });
+});
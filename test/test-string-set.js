@@ -0,0 +1,154 @@
+"use strict";
+
+var assert = require("assert"),
+    Set = require("../lib/collection").Set,
+    StringSet = require("../lib/collection").StringSet;
+
+describe('StringSet', function() {
+  var paths, s1;
+
+  beforeEach(function() {
+    paths = ["/api/v1/users", "/api/v1/users/42", "/api/v2/users", "/api", "/static/app.js", "/"];
+    s1 = new StringSet(paths);
+  });
+
+  describe("#new", function() {
+    it("should create string sets", function() {
+      assert.equal(new StringSet().size(), 0);
+      assert.equal(s1.size(), 6);
+      assert(new StringSet(s1).equals(s1));
+    });
+
+    it("should throw error if arguments are invalid", function() {
+      assert.throws(function() {
+        new StringSet(["a", 1]);
+      }, Error);
+      assert.throws(function() {
+        new StringSet(new Set(["a"]));
+      }, Error);
+    });
+  });
+
+  describe("#add", function() {
+    it("should add strings once", function() {
+      assert.equal(s1.add("/api", "/api/v3", "").size(), 8);
+      assert(s1.has("", "/api/v3"));
+    });
+
+    it("should keep strings that are prefixes of each other", function() {
+      var s = new StringSet(["abc", "ab", "a", "abcd", "b"]);
+      assert.deepEqual(s.toArray(), ["a", "ab", "abc", "abcd", "b"]);
+    });
+
+    it("should throw error if values are not strings", function() {
+      assert.throws(function() {
+        s1.add("a", 1);
+      }, Error);
+      assert.equal(s1.size(), 6);
+    });
+  });
+
+  describe("#addAll", function() {
+    it("should add arrays and string sets", function() {
+      assert.equal(s1.addAll(["x"]).addAll(new StringSet(["y", "x"])).size(), 8);
+    });
+  });
+
+  describe("#clear", function() {
+    it("should remove all strings", function() {
+      assert(s1.clear().isEmpty());
+      assert(!s1.hasPrefix(""));
+    });
+  });
+
+  describe("#each", function() {
+    it("should go through strings in the order of a set", function() {
+      var words = ["été", "zoo", "Zoo", "a\u0000b", "a", "😀", "￿", ""];
+      var result = [];
+      new StringSet(words).each(function(word) {
+        result.push(word);
+      });
+      assert.deepEqual(result, new Set(words).toArray());
+    });
+  });
+
+  describe("#has", function() {
+    it("should find strings only", function() {
+      assert(s1.has("/api"));
+      assert(!s1.has("/ap"));
+      assert(!s1.has("/api/v1"));
+      assert.deepEqual(s1.has("/", "/api/v2/users", 1), [true, true, false]);
+    });
+  });
+
+  describe("#hasPrefix", function() {
+    it("should check whether any string starts with a prefix", function() {
+      assert(s1.hasPrefix("/api/v1/u"));
+      assert(s1.hasPrefix("/api/v2/users"));
+      assert(s1.hasPrefix(""));
+      assert(!s1.hasPrefix("/api/v3"));
+      assert(!s1.hasPrefix("/api/v1/users/42/x"));
+    });
+  });
+
+  describe("#keysWithPrefix", function() {
+    it("should get the strings that start with a prefix in order", function() {
+      assert.deepEqual(s1.keysWithPrefix("/api/v"), ["/api/v1/users", "/api/v1/users/42", "/api/v2/users"]);
+      assert.deepEqual(s1.keysWithPrefix("/api/v1/users"), ["/api/v1/users", "/api/v1/users/42"]);
+      assert.deepEqual(s1.keysWithPrefix("/s"), ["/static/app.js"]);
+      assert.deepEqual(s1.keysWithPrefix("/x"), []);
+      assert.deepEqual(s1.keysWithPrefix(""), s1.toArray());
+    });
+
+    it("should throw error if prefix is not a string", function() {
+      assert.throws(function() {
+        s1.keysWithPrefix(1);
+      }, Error);
+    });
+  });
+
+  describe("#longestPrefixMatch", function() {
+    it("should find the longest string that a string starts with", function() {
+      assert.equal(s1.longestPrefixMatch("/api/v1/users/7"), "/api/v1/users");
+      assert.equal(s1.longestPrefixMatch("/api/v1/users/42"), "/api/v1/users/42");
+      assert.equal(s1.longestPrefixMatch("/api/v3"), "/api");
+      assert.equal(s1.longestPrefixMatch("/index.html"), "/");
+      assert.equal(s1.longestPrefixMatch("api"), undefined);
+    });
+  });
+
+  describe("#remove", function() {
+    it("should remove strings and keep the others", function() {
+      s1.remove("/api", "/api/v1/users", "/nothing", 1);
+      assert.deepEqual(s1.toArray(), ["/", "/api/v1/users/42", "/api/v2/users", "/static/app.js"]);
+      assert(s1.hasPrefix("/api/v1/users"));
+      assert.equal(s1.longestPrefixMatch("/api/v1"), "/");
+    });
+
+    it("should remove many strings", function() {
+      var s = new StringSet();
+      for (var i = 0; i < 10000; i++) {
+        s.add("key" + i);
+      }
+      for (var i = 0; i < 10000; i += 2) {
+        s.remove("key" + i);
+      }
+      assert.equal(s.size(), 5000);
+      assert.equal(s.keysWithPrefix("key99").length, 56);
+      assert(s.has("key9999") && !s.has("key9998"));
+    });
+  });
+
+  describe("#removeAt", function() {
+    it("should remove strings by index", function() {
+      assert.deepEqual(s1.removeAt(0, 1).toArray(), ["/api/v1/users", "/api/v1/users/42", "/api/v2/users", "/static/app.js"]);
+    });
+  });
+
+  describe("#toArray", function() {
+    it("should get strings in the order of a set", function() {
+      assert.deepEqual(s1.toArray(), new Set(paths).toArray());
+      assert.deepEqual(s1.reduceRight(function(memo, s) { return memo.concat([s]); }, []), s1.toArray().reverse());
+    });
+  });
+});
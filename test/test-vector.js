@@ -18,6 +18,26 @@ describe('Vector', function() {
     v3 = new Vector();
   });
 
+  describe("#abs", function() {
+    it("should return a new vector of absolute values", function() {
+      var v = new Vector([-1, 2, -3.5]);
+      assert.deepEqual(v.abs().toArray(), [1, 2, 3.5]);
+      assert.deepEqual(v.toArray(), [-1, 2, -3.5]);
+    });
+
+    it("should write into a target vector", function() {
+      var v = new Vector([-1, 2, -3.5]);
+      assert.strictEqual(v.abs(v), v);
+      assert.deepEqual(v.toArray(), [1, 2, 3.5]);
+    });
+
+    it("should throw error if an element is not a number", function() {
+      assert.throws(function() {
+        v2.abs();
+      }, Error);
+    });
+  });
+
   describe("#add", function() {
     it("should add new elements to the end of the vectors", function() {
       assert.deepEqual(v1.add(11, 12, 13, 14, 15).toArray(), [1,2,3,4,5,6,7,8,9,10,11,12,13,14,15]);
@@ -68,6 +88,61 @@ describe('Vector', function() {
     });
   });
 
+  describe("#capacity", function() {
+    it("should be at least the size of the vector", function() {
+      assert(v1.capacity() >= 10);
+      assert(v3.capacity() >= 0);
+      assert(v1.add(11).capacity() >= 11);
+    });
+
+    it("should grow by the growth factor", function() {
+      var vector = new Vector({capacity: 4, growthFactor: 4});
+      assert.equal(vector.capacity(), 4);
+      vector.add(1, 2, 3, 4, 5);
+      assert(vector.capacity() >= 16);
+    });
+
+    it("should be reserved by the constructor", function() {
+      assert(new Vector({capacity: 100}).capacity() >= 100);
+      assert(new Vector([1, 2], {capacity: 100}).capacity() >= 100);
+      assert.deepEqual(new Vector([1, 2], {capacity: 100}).toArray(), [1, 2]);
+    });
+
+    it("should throw error if the options are invalid", function() {
+      assert.throws(function() {
+        new Vector([], {capacity: -1});
+      }, Error);
+      assert.throws(function() {
+        new Vector({growthFactor: 1});
+      }, Error);
+      assert.throws(function() {
+        new Vector([], 1);
+      }, Error);
+    });
+
+    it("should throw error if argument is provided", function() {
+      assert.throws(function() {
+        v1.capacity(1);
+      }, Error);
+    });
+  });
+
+  describe("#clamp", function() {
+    it("should limit elements to a range", function() {
+      assert.deepEqual(v1.clamp(3, 7.5).toArray(), [3,3,3,4,5,6,7,7.5,7.5,7.5]);
+      assert.deepEqual(v3.clamp(0, 1).toArray(), []);
+    });
+
+    it("should throw error if the range is not given in order", function() {
+      assert.throws(function() {
+        v1.clamp(7, 3);
+      }, Error);
+      assert.throws(function() {
+        v1.clamp(3);
+      }, Error);
+    });
+  });
+
   describe("#clear", function() {
     it("should erase all the elements in the vectors", function() {
       assert.deepEqual(v1.clear().toArray(), []);
@@ -85,6 +160,58 @@ describe('Vector', function() {
     });
   });
 
+  describe("#cumsum", function() {
+    it("should return the running sums of the elements", function() {
+      assert.deepEqual(v1.cumsum().toArray(), [1,3,6,10,15,21,28,36,45,55]);
+      var target = new Vector(["a"]);
+      v1.cumsum(target);
+      assert.deepEqual(target.toArray(), [1,3,6,10,15,21,28,36,45,55]);
+    });
+  });
+
+  describe("#diff", function() {
+    it("should return the differences between consecutive elements", function() {
+      assert.deepEqual(new Vector([1, 4, 9, 16]).diff().toArray(), [3, 5, 7]);
+      assert.deepEqual(new Vector([1]).diff().toArray(), []);
+      assert.deepEqual(v3.diff().toArray(), []);
+    });
+
+    it("should work in place", function() {
+      var v = new Vector([1, 4, 9, 16]);
+      v.diff(v);
+      assert.deepEqual(v.toArray(), [3, 5, 7]);
+    });
+  });
+
+  describe("#div", function() {
+    it("should divide elements by a number or by the corresponding numbers", function() {
+      assert.deepEqual(new Vector([2, 4, 6]).div(2).toArray(), [1, 2, 3]);
+      assert.deepEqual(new Vector([2, 4, 6]).div([2, 4, 0]).toArray(), [1, 1, Infinity]);
+    });
+  });
+
+  describe("#drainTo", function() {
+    it("should move all the elements to the target and leave the vector empty", function() {
+      var target = new Vector([0]);
+      assert.equal(v1.drainTo(target), v1);
+      assert.deepEqual(target.toArray(), [0].concat(array1));
+      assert(v1.isEmpty());
+      var set = new Set([1,2]);
+      v2.add(2, [1]).drainTo(set);
+      assert.deepEqual(set.toArray(), [1,2,"abc","def","g",[1]]);
+      assert(v2.isEmpty());
+    });
+
+    it("should throw error if the target is not a set or a vector", function() {
+      assert.throws(function() {
+        v1.drainTo([]);
+      }, Error);
+      assert.throws(function() {
+        v1.drainTo(new Map());
+      }, Error);
+    });
+  });
+
   describe("#each", function() {
     it("should go through all the elements in the vectors", function() {
       var i1 = 0;
@@ -229,6 +356,40 @@ describe('Vector', function() {
       assert.deepEqual(v1.toArray(), [1,1,0,1,1,1,0,1,1,0,1,1,2,0,2,5,1,0,1,2,0,2,2,0,2,1,0,1,7,4,0,4,3,3,0,3,3,0,3,3,5,0,5]);
     });
 
+    it("should not allow the modifier to be used after the iteration", function() {
+      var modifier;
+      v1.each(function(v, m) {
+        modifier = m;
+        return false;
+      });
+      assert.throws(function() {
+        modifier.set([1]);
+      }, Error);
+      assert.throws(function() {
+        modifier.insertBefore([1]);
+      }, Error);
+      assert.throws(function() {
+        modifier.insertAfter([1]);
+      }, Error);
+      assert.deepEqual(v1.toArray(), [1,2,3,4,5,6,7,8,9,10]);
+    });
+
+    it("should keep objects alive while they are in the vectors", function() {
+      var v = new Vector();
+      for (var i = 0; i < 100; i++) {
+        v.add([i], {index: i});
+      }
+      v.removeRange(0, 100);
+      v.add([100]);
+      if (typeof global.gc === "function") {
+        global.gc();
+      }
+      assert.equal(v.size(), 101);
+      assert.deepEqual(v.get(0), [50]);
+      assert.deepEqual(v.get(1), {index: 50});
+      assert.deepEqual(v.get(100), [100]);
+    });
+
     it("should tolerate errors in the callback function", function() {
       assert.throws(function() {
         v1.each(function() {
@@ -298,6 +459,13 @@ describe('Vector', function() {
     });
   });
 
+  describe("#eq", function() {
+    it("should return a mask of the elements equal to the operand", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).eq(2).toArray(), [false, true, false]);
+      assert.deepEqual(new Vector([1, 2, 3]).eq(new Vector([1, 0, 3])).toArray(), [true, false, true]);
+    });
+  });
+
   describe("#equals", function() {
     it("should compare equality of this vector with another one", function() {
       assert(v1.equals(new Vector(array1)));
@@ -318,6 +486,38 @@ describe('Vector', function() {
       assert(v2.equals(new Vector(array2)));
     });
 
+    it("should compare again after either vector is modified", function() {
+      var other = new Vector(array1);
+      assert(v1.equals(other));
+      other.set(0, 0);
+      assert(!v1.equals(other));
+      v1.set(0, 0);
+      assert(v1.equals(other));
+      v1.reverse();
+      assert(!v1.equals(other));
+      v1.map(function(value) {
+        return 0;
+      });
+      other.map(function(value) {
+        return 0;
+      });
+      assert(v1.equals(other));
+      v1.each(function(value, modifier) {
+        modifier.remove();
+      });
+      assert(v1.equals(new Vector()));
+    });
+
+    it("should compare again after a nested collection is modified", function() {
+      var inner1 = new Vector([1,2]), inner2 = new Vector([1,2]);
+      var outer1 = new Vector([inner1]), outer2 = new Vector([inner2]);
+      assert(outer1.equals(outer2));
+      inner1.add(3);
+      assert(!outer1.equals(outer2));
+      inner2.add(3);
+      assert(outer1.equals(outer2));
+    });
+
     it("should throw error if not exactly one argument is provided", function() {
       assert.throws(function() {
         v1.equals();
@@ -328,6 +528,24 @@ describe('Vector', function() {
     });
   });
 
+  describe("#fill", function() {
+    it("should replace elements with a value", function() {
+      assert.deepEqual(v1.fill(0, 2, 4).toArray(), [1,2,0,0,5,6,7,8,9,10]);
+      assert.deepEqual(v1.fill("a", 8).toArray(), [1,2,0,0,5,6,7,8,"a","a"]);
+      assert.deepEqual(v2.fill([1]).toArray(), [[1],[1],[1]]);
+      assert.deepEqual(v3.fill(1).toArray(), []);
+    });
+
+    it("should throw error if the range is not given as integers", function() {
+      assert.throws(function() {
+        v1.fill(0, "a");
+      }, Error);
+      assert.throws(function() {
+        v1.fill();
+      }, Error);
+    });
+  });
+
   describe("#filter", function() {
     it("should return all the values in the vector that satisfy the requirement", function() {
       assert.deepEqual(v1.filter(function(v) {
@@ -380,6 +598,12 @@ describe('Vector', function() {
     });
   });
 
+  describe("#ge", function() {
+    it("should return a mask of the elements not less than the operand", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).ge(2).toArray(), [false, true, true]);
+    });
+  });
+
   describe("#get", function() {
     it("should get values in each vector one by one", function() {
       for (var i = 0; i < v1.size(); i++) {
@@ -413,6 +637,13 @@ describe('Vector', function() {
     });
   });
 
+  describe("#gt", function() {
+    it("should return a mask of the elements greater than the operand", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).gt(2).toArray(), [false, false, true]);
+      assert.deepEqual(new Vector([1, 2, 3]).gt(new Float64Array([0, 2, 4])).toArray(), [true, false, false]);
+    });
+  });
+
   describe("#has", function() {
     it("should return existence of values in a vector", function() {
       assert(v1.has(1));
@@ -430,6 +661,36 @@ describe('Vector', function() {
     });
   });
 
+  describe("#histogram", function() {
+    it("should count the elements between bounds", function() {
+      assert.deepEqual(v1.histogram([3, 5.5, 9]), [2, 3, 3, 2]);
+      assert.deepEqual(v1.histogram([0]), [0, 10]);
+      assert.deepEqual(v3.histogram([1, 2]), [0, 0, 0]);
+    });
+
+    it("should count the elements in buckets of equal width", function() {
+      assert.deepEqual(v1.histogram(3), [3, 3, 4]);
+      assert.deepEqual(v1.histogram(1), [10]);
+      assert.deepEqual(new Vector([2, 2, NaN]).histogram(2), [2, 0]);
+      assert.deepEqual(v3.histogram(2), [0, 0]);
+    });
+
+    it("should throw error if argument is not ascending bounds or a number of buckets up to the maximum", function() {
+      assert.throws(function() {
+        v1.histogram([2, 1]);
+      }, Error);
+      assert.throws(function() {
+        v1.histogram(0);
+      }, Error);
+      assert.throws(function() {
+        v1.histogram(4294967295);
+      }, Error);
+      assert.throws(function() {
+        v2.histogram(2);
+      }, Error);
+    });
+  });
+
   describe("#index", function() {
     it("should return indexes of elements in the vectors", function() {
       for (var i = 0; i < v1.size(); i++) {
@@ -450,6 +711,49 @@ describe('Vector', function() {
     });
   });
 
+  describe("#insertAll", function() {
+    it("should insert all the elements of the object at the index", function() {
+      assert.deepEqual(v2.insertAll(1, [1, 2]).toArray(), ["abc",1,2,"def","g"]);
+      assert.deepEqual(v2.insertAll(5, new Set([3])).toArray(), ["abc",1,2,"def","g",3]);
+      assert.deepEqual(v3.insertAll(0, new Vector(array1)).toArray(), array1);
+      assert.deepEqual(v3.insertAll(0, v3).size(), 20);
+      assert.deepEqual(v2.insertAll(0, []).size(), 6);
+    });
+
+    it("should throw error if the arguments are invalid", function() {
+      assert.throws(function() {
+        v1.insertAll(11, [1]);
+      }, Error);
+      assert.throws(function() {
+        v1.insertAll(0, 1);
+      }, Error);
+      assert.throws(function() {
+        v1.insertAll([1]);
+      }, Error);
+    });
+  });
+
+  describe("#insertAt", function() {
+    it("should insert the values at the index", function() {
+      assert.deepEqual(v1.insertAt(0, 0).toArray(), [0,1,2,3,4,5,6,7,8,9,10]);
+      assert.deepEqual(v1.insertAt(5, "a", "b", [1]).toArray(), [0,1,2,3,4,"a","b",[1],5,6,7,8,9,10]);
+      assert.deepEqual(v1.insertAt(14, 11).toArray(), [0,1,2,3,4,"a","b",[1],5,6,7,8,9,10,11]);
+      assert.deepEqual(v3.insertAt(0, 1, 2).toArray(), [1,2]);
+    });
+
+    it("should throw error if the arguments are invalid", function() {
+      assert.throws(function() {
+        v1.insertAt(11, 1);
+      }, Error);
+      assert.throws(function() {
+        v1.insertAt(0);
+      }, Error);
+      assert.throws(function() {
+        v1.insertAt(-1, 1);
+      }, Error);
+    });
+  });
+
   describe("#isEmpty", function() {
     it("should return whether a vector is empty", function() {
       assert.equal(v1.isEmpty(), false);
@@ -464,6 +768,18 @@ describe('Vector', function() {
     });
   });
 
+  describe("#le", function() {
+    it("should return a mask of the elements not greater than the operand", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).le(2).toArray(), [true, true, false]);
+    });
+  });
+
+  describe("#lt", function() {
+    it("should return a mask of the elements less than the operand", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).lt(2).toArray(), [true, false, false]);
+    });
+  });
+
   describe("#map", function() {
     it("should map values into new values in the vectors", function() {
       assert.deepEqual(v1.map(function(v) {
@@ -489,6 +805,127 @@ describe('Vector', function() {
     });
   });
 
+  describe("#minus", function() {
+    it("should subtract a number or the corresponding numbers from elements", function() {
+      assert.deepEqual(v1.minus(1).toArray(), [0,1,2,3,4,5,6,7,8,9]);
+      assert.deepEqual(v1.minus(v1).toArray(), [0,0,0,0,0,0,0,0,0,0]);
+    });
+  });
+
+  describe("#ne", function() {
+    it("should return a mask of the elements not equal to the operand", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).ne(2).toArray(), [true, false, true]);
+    });
+  });
+
+  describe("#moveFrom", function() {
+    it("should move all the elements of the source and leave it empty", function() {
+      var source = new Vector(array1);
+      assert.deepEqual(v3.moveFrom(source).toArray(), array1);
+      assert(source.isEmpty());
+      source = new Vector([{"a": 1}, [2]]);
+      assert.deepEqual(v2.moveFrom(source).toArray(), ["abc","def","g",{"a": 1},[2]]);
+      assert(source.isEmpty());
+      source.add(3);
+      assert.deepEqual(source.toArray(), [3]);
+      assert.deepEqual(v1.moveFrom(new Set([3,1])).toArray(), array1.concat([1,3]));
+    });
+
+    it("should leave the vector unchanged when moving from itself", function() {
+      assert.deepEqual(v1.moveFrom(v1).toArray(), array1);
+    });
+
+    it("should throw error if the source is not a set or a vector", function() {
+      assert.throws(function() {
+        v1.moveFrom([1]);
+      }, Error);
+    });
+  });
+
+  describe("#plus", function() {
+    it("should add a number or the corresponding numbers to elements", function() {
+      assert.deepEqual(v1.plus(0.5).toArray(), [1.5,2.5,3.5,4.5,5.5,6.5,7.5,8.5,9.5,10.5]);
+      assert.deepEqual(new Vector([1, 2]).plus([10, 20]).toArray(), [11, 22]);
+      assert.deepEqual(new Vector([1, 2]).plus(new Float64Array([10, 20])).toArray(), [11, 22]);
+      assert.deepEqual(v1.toArray(), array1);
+    });
+
+    it("should write into a target vector, which may be this vector or the operand", function() {
+      var v = new Vector([1, 2]), w = new Vector([10, 20]);
+      assert.strictEqual(v.plus(1, v), v);
+      assert.deepEqual(v.toArray(), [2, 3]);
+      v.plus(w, w);
+      assert.deepEqual(w.toArray(), [12, 23]);
+      var target = new Vector([[1], "a", 3, 4]);
+      v.plus(1, target);
+      assert.deepEqual(target.toArray(), [3, 4]);
+    });
+
+    it("should keep the results equal to the same numbers added", function() {
+      assert(new Vector([0.5, 1]).plus(0.5).equals(new Vector([1, 1.5])));
+      assert(new Vector([1]).plus(-1).equals(new Vector([0])));
+    });
+
+    it("should throw error if an element or the operand is not a number", function() {
+      assert.throws(function() {
+        v2.plus(1);
+      }, Error);
+      assert.throws(function() {
+        v1.plus("1");
+      }, Error);
+      assert.throws(function() {
+        v1.plus([1, 2]);
+      }, Error);
+      assert.throws(function() {
+        v1.plus(1, []);
+      }, Error);
+    });
+  });
+
+  describe("#profile", function() {
+    it("should return counters if profiling is compiled in", function() {
+      var profile = v1.profile();
+      if (profile === undefined) {
+        return;
+      }
+      v1.has(3);
+      profile = v1.profile(true);
+      assert.equal(profile.calls.has, 1);
+      assert.ok(profile.lookups >= 1);
+      assert.ok(profile.comparisons >= 1);
+      assert.equal(v1.profile().calls.has, undefined);
+    });
+
+    it("should throw error if argument is not a boolean", function() {
+      assert.throws(function() {
+        v1.profile("abc");
+      }, Error);
+    });
+  });
+
+  describe("#quantile", function() {
+    it("should return the element of a rank in sorted order", function() {
+      var v = new Vector([7, 3, 10, 1, 9, 2, 8, 4, 6, 5]);
+      assert.equal(v.quantile(0.5), 6);
+      assert.deepEqual(v.quantile(0.99, 0, 0.5, 1), [10, 1, 6, 10]);
+      assert.deepEqual(v.toArray(), [7, 3, 10, 1, 9, 2, 8, 4, 6, 5]);
+      assert.deepEqual(new Vector([1, 1, 2, 2]).quantile(0.25, 0.75), [1, 2]);
+      assert.equal(v3.quantile(0.5), undefined);
+    });
+
+    it("should throw error if argument is not a number between 0 and 1", function() {
+      assert.throws(function() {
+        v1.quantile();
+      }, Error);
+      assert.throws(function() {
+        v1.quantile(1.5);
+      }, Error);
+      assert.throws(function() {
+        v2.quantile(0.5);
+      }, Error);
+    });
+  });
+
   describe("#reduce", function() {
     it("should reduce a vector into a single value", function() {
       assert.equal(v1.reduce(function(memo, v) {
@@ -629,6 +1066,23 @@ describe('Vector', function() {
     });
   });
 
+  describe("#reserve", function() {
+    it("should make the capacity at least the given number", function() {
+      assert(v1.reserve(1000).capacity() >= 1000);
+      assert.deepEqual(v1.toArray(), array1);
+      assert(v3.reserve(0).capacity() >= 0);
+    });
+
+    it("should throw error if the argument is not an integer", function() {
+      assert.throws(function() {
+        v1.reserve(-1);
+      }, Error);
+      assert.throws(function() {
+        v1.reserve();
+      }, Error);
+    });
+  });
+
   describe("#reverse", function() {
     it("should reverse all the elements in the vectors", function() {
       assert.deepEqual(v1.reverse().toArray(), array1.reverse());
@@ -672,6 +1126,21 @@ describe('Vector', function() {
     });
   });
 
+  describe("#shrinkToFit", function() {
+    it("should release the unused capacity", function() {
+      v1.reserve(1000).removeRange(5, 10);
+      assert.equal(v1.shrinkToFit().capacity(), 5);
+      assert.deepEqual(v1.toArray(), [1,2,3,4,5]);
+      assert.equal(v1.clear().shrinkToFit().capacity(), 0);
+    });
+
+    it("should throw error if argument is provided", function() {
+      assert.throws(function() {
+        v1.shrinkToFit(1);
+      }, Error);
+    });
+  });
+
   describe("#size", function() {
     it("should return sizes of the vectors", function() {
       assert.equal(v1.size(), 10);
@@ -687,6 +1156,71 @@ describe('Vector', function() {
     });
   });
 
+  describe("#splice", function() {
+    it("should remove elements and return them as a vector", function() {
+      var removed = v1.splice(2, 3);
+      assert(removed instanceof Vector);
+      assert.deepEqual(removed.toArray(), [3,4,5]);
+      assert.deepEqual(v1.toArray(), [1,2,6,7,8,9,10]);
+      assert.deepEqual(v1.splice(5).toArray(), [9,10]);
+      assert.deepEqual(v1.toArray(), [1,2,6,7,8]);
+      assert.deepEqual(v1.splice(10, 2).toArray(), []);
+    });
+
+    it("should insert values in place of the removed elements", function() {
+      assert.deepEqual(v1.splice(1, 2, "a").toArray(), [2,3]);
+      assert.deepEqual(v1.toArray(), [1,"a",4,5,6,7,8,9,10]);
+      assert.deepEqual(v1.splice(1, 1, "b", "c", "d").toArray(), ["a"]);
+      assert.deepEqual(v1.toArray(), [1,"b","c","d",4,5,6,7,8,9,10]);
+      assert.deepEqual(v1.splice(0, 0, 0).toArray(), []);
+      assert.deepEqual(v1.toArray(), [0,1,"b","c","d",4,5,6,7,8,9,10]);
+      assert.deepEqual(v1.splice(0, undefined, 1).size(), 12);
+      assert.deepEqual(v1.toArray(), [1]);
+    });
+
+    it("should keep removed objects in the returned vector", function() {
+      v2.add([1], {"a": 1});
+      var removed = v2.splice(3, 2, "x");
+      assert.deepEqual(removed.toArray(), [[1], {"a": 1}]);
+      assert.deepEqual(v2.toArray(), ["abc","def","g","x"]);
+    });
+
+    it("should throw error if the arguments are invalid", function() {
+      assert.throws(function() {
+        v1.splice();
+      }, Error);
+      assert.throws(function() {
+        v1.splice("a");
+      }, Error);
+      assert.throws(function() {
+        v1.splice(0, -1);
+      }, Error);
+    });
+  });
+
+  describe("#swap", function() {
+    it("should swap the elements at the indexes", function() {
+      assert.deepEqual(v1.swap(0, 9).toArray(), [10,2,3,4,5,6,7,8,9,1]);
+      assert.deepEqual(v2.swap(1, 1).toArray(), array2);
+    });
+
+    it("should throw error if an index is out of range", function() {
+      assert.throws(function() {
+        v1.swap(0, 10);
+      }, Error);
+      assert.throws(function() {
+        v1.swap(0);
+      }, Error);
+    });
+  });
+
+  describe("#times", function() {
+    it("should multiply elements by a number or by the corresponding numbers", function() {
+      assert.deepEqual(new Vector([1, 2, 3]).times(2).toArray(), [2, 4, 6]);
+      assert.deepEqual(new Vector([1, 2, 3]).times([3, 2, 1]).toArray(), [3, 4, 3]);
+    });
+  });
+
   describe("#toArray", function() {
     it("should return arrays for the vectors", function() {
       assert.deepEqual(v1.toArray(), array1);
@@ -699,6 +1233,48 @@ describe('Vector', function() {
     });
   });
 
+  describe("#toJSON", function() {
+    it("should let JSON.stringify() write the vectors as arrays", function() {
+      assert.equal(JSON.stringify({v: v1}), '{"v":' + JSON.stringify(array1) + '}');
+      assert.deepEqual(v2.toJSON(), array2);
+    });
+  });
+
+  describe("#toJSONBuffer", function() {
+    it("should return the text of toString() in a buffer", function() {
+      assert(Buffer.isBuffer(v2.toJSONBuffer()));
+      assert.equal(v1.toJSONBuffer().toString(), v1.toString());
+      assert.equal(new Vector(["\u00e9"]).toJSONBuffer().toString(), '["\u00e9"]');
+    });
+  });
+
+  describe("#topK", function() {
+    it("should return the greatest elements in descending order", function() {
+      var v = new Vector([7, 3, 10, 1, 9, 2, 8, 4, 6, 5]);
+      assert.deepEqual(v.topK(3).toArray(), [10, 9, 8]);
+      assert.deepEqual(v.topK(3, {desc: true}).toArray(), [10, 9, 8]);
+      assert.deepEqual(v.topK(20).toArray(), [10, 9, 8, 7, 6, 5, 4, 3, 2, 1]);
+      assert.deepEqual(v.topK(0).toArray(), []);
+      assert.deepEqual(v.toArray(), [7, 3, 10, 1, 9, 2, 8, 4, 6, 5]);
+    });
+
+    it("should return the least elements in ascending order", function() {
+      assert.deepEqual(new Vector([3, 1, 2, 1]).topK(3, {desc: false}).toArray(), [1, 1, 2]);
+    });
+
+    it("should throw error if arguments are not an integer and options", function() {
+      assert.throws(function() {
+        v1.topK(-1);
+      }, Error);
+      assert.throws(function() {
+        v1.topK(1, {desc: 1});
+      }, Error);
+      assert.throws(function() {
+        v2.topK(1);
+      }, Error);
+    });
+  });
+
   describe("#toString", function() {
     it("should convert the vectors into strings", function() {
       assert.equal(v1.toString(), JSON.stringify(array1));
@@ -706,5 +1282,57 @@ describe('Vector', function() {
       assert.equal(v3.toString(), JSON.stringify(array3));
       assert.equal(new Vector(v2).toString(), JSON.stringify(array2));
     });
+
+    it("should write values of every type as JSON.stringify() does", function() {
+      var values = [0, -0, 1.5, -2147483649, 4294967296, 1e21, -1e-7, 0.1 + 0.2, 5e-324, NaN, Infinity, true, false,
+          null, undefined, "a\"b\\c\n\u0001\u00e9", new Date(0), [1, "x", undefined], {a: 1, b: undefined},
+          function() {}];
+      assert.equal(new Vector(values).toString(), JSON.stringify(values));
+    });
+
+    it("should write nested collections as their JSON", function() {
+      assert.equal(new Vector([new Vector([1, "a"]), new Set([2]), new Map({k: 3}), [new Vector()]]).toString(),
+          '[[1,"a"],[2],{"k":3},[[]]]');
+    });
+
+    it("should throw error if the vector contains itself or a value cannot be written", function() {
+      var v = new Vector([1]);
+      v.add(v);
+      assert.throws(function() {
+        v.toString();
+      }, Error);
+      assert.throws(function() {
+        new Vector([{toJSON: function() { throw new Error(); }}]).toString();
+      }, Error);
+      v = new Vector([{toJSON: function() { v.add(1); }}]);
+      assert.throws(function() {
+        v.toString();
+      }, Error);
+    });
+  });
+
+  describe("#writeJSON", function() {
+    it("should hand the text of toString() to a function in chunks", function() {
+      var v = new Vector(), chunks = [];
+      for (var i = 0; i < 50000; i++) {
+        v.add("value " + i);
+      }
+      var size = v.writeJSON(function(chunk) {
+        assert(Buffer.isBuffer(chunk));
+        chunks.push(chunk);
+      });
+      assert(chunks.length > 1);
+      assert.equal(Buffer.concat(chunks).toString(), v.toString());
+      assert.equal(size, Buffer.concat(chunks).length);
+    });
+
+    it("should throw error if argument is not a function or the function throws", function() {
+      assert.throws(function() {
+        v1.writeJSON();
+      }, Error);
+      assert.throws(function() {
+        v1.writeJSON(function() { throw new Error(); });
+      }, Error);
+    });
   });
 });